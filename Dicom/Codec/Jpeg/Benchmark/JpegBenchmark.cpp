@@ -0,0 +1,421 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+// Native throughput benchmark for the IJG libraries behind the DICOM JPEG codecs.
+//
+// Every case encodes and decodes a synthetic frame with libijg8, libijg12 or libijg16, configured
+// as JpegCodec.i configures them for the same transfer syntax, or with JpegLsCoder, and reports MB/s
+// (of uncompressed frame data) and frames/s for each direction.  The JPEG-LS cases code the same
+// frames as the Process 14 SV1 cases, so --filter "MONOCHROME2 12-bit" compares the two lossless
+// transfer syntaxes.  The corpus is generated from a fixed seed, so runs on the same machine are
+// comparable.  Lossless cases are checked to round-trip exactly.
+//
+//   JpegBenchmark [--filter text] [--size WxH]... [--time seconds]
+//                 [--csv results.csv] [--baseline previous.csv [--tolerance percent]]
+//
+// With --baseline, cases whose encode or decode throughput has dropped by more than the tolerance
+// (10% by default) against the earlier --csv output are reported, and the exit code is 1.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "JpegBenchmark.h"
+#include "../JpegLsCoder.h"
+
+using namespace ClearCanvas::Dicom::Codec::Jpeg;
+using namespace ClearCanvas::Dicom::Codec::Jpeg::Benchmark;
+
+namespace {
+
+struct BenchmarkCase {
+	const char *process;
+	const char *photometricInterpretation;
+	unsigned int bitsStored;
+	BenchmarkCoding coding;
+};
+
+// The transfer syntaxes of DicomJpegProcess1Codec, DicomJpegProcess24Codec, DicomJpegLossless14Codec
+// and DicomJpegLossless14SV1Codec at their default parameters, plus the variations that select a
+// different path through the libraries (chroma subsampling, restart markers, progressive scans), and
+// DicomJpegLsLosslessCodec at its default parameters (colour components interleaved by line).
+const BenchmarkCase Cases[] = {
+	//  process       photometric     bits   mode                  quality predictor pt restart 422
+	{ "Process1",    "MONOCHROME2",   8, { BenchmarkBaseline,    90, 0, 0, 0, false } },
+	{ "Process1",    "RGB",           8, { BenchmarkBaseline,    90, 0, 0, 0, false } },
+	{ "Process1",    "RGB",           8, { BenchmarkBaseline,    90, 0, 0, 0, true } },
+	{ "Process1",    "YBR_FULL",      8, { BenchmarkBaseline,    90, 0, 0, 0, true } },
+	{ "Process1",    "MONOCHROME2",   8, { BenchmarkBaseline,    90, 0, 0, 1, false } },
+	{ "Process2_4",  "MONOCHROME2",   8, { BenchmarkSequential,  90, 0, 0, 0, false } },
+	{ "Process2_4",  "MONOCHROME2",  12, { BenchmarkSequential,  90, 0, 0, 0, false } },
+	{ "Process2_4",  "RGB",           8, { BenchmarkSequential,  90, 0, 0, 0, false } },
+	{ "Progressive", "MONOCHROME2",   8, { BenchmarkProgressive, 90, 0, 0, 0, false } },
+	{ "Process14SV1", "MONOCHROME2",  8, { BenchmarkLossless,     0, 1, 0, 0, false } },
+	{ "Process14SV1", "MONOCHROME2", 12, { BenchmarkLossless,     0, 1, 0, 0, false } },
+	{ "Process14SV1", "MONOCHROME2", 16, { BenchmarkLossless,     0, 1, 0, 0, false } },
+	{ "Process14SV1", "RGB",          8, { BenchmarkLossless,     0, 1, 0, 0, false } },
+	{ "Process14",   "MONOCHROME2",  16, { BenchmarkLossless,     0, 6, 0, 0, false } },
+	{ "Process14",   "MONOCHROME2",  12, { BenchmarkLossless,     0, 7, 0, 0, false } },
+	{ "JpegLs",      "MONOCHROME2",   8, { BenchmarkJpegLs,       0, 0, 0, 0, false } },
+	{ "JpegLs",      "MONOCHROME2",  12, { BenchmarkJpegLs,       0, 0, 0, 0, false } },
+	{ "JpegLs",      "MONOCHROME2",  16, { BenchmarkJpegLs,       0, 0, 0, 0, false } },
+	{ "JpegLs",      "RGB",           8, { BenchmarkJpegLs,       0, 0, 0, 0, false } },
+};
+
+const int MeasureRounds = 5;
+const int MeasureFrames = 2;
+
+struct BenchmarkResult {
+	double ratio;
+	double encodeMBps;
+	double encodeFps;
+	double decodeMBps;
+	double decodeFps;
+};
+
+double now() {
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#endif
+}
+
+// 32 bit linear congruential generator, so the corpus is the same on every platform
+struct Random {
+	unsigned int state;
+	Random(unsigned int seed) : state(seed) { }
+	unsigned int Next() {
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+};
+
+// A synthetic frame that exercises the coders the way clinical images do: smooth background, a few
+// large uniform structures with sharp edges, a patch of fine detail, and low level noise.
+void generateImage(BenchmarkImage& image, unsigned int width, unsigned int height, const char *photometricInterpretation,
+	unsigned int bitsStored) {
+	std::string pi = photometricInterpretation;
+	image.width = width;
+	image.height = height;
+	image.components = pi == "MONOCHROME1" || pi == "MONOCHROME2" ? 1 : 3;
+	image.bitsStored = bitsStored;
+	image.photometricInterpretation = pi;
+
+	size_t bytesPerSample = bitsStored > 8 ? 2 : 1;
+	image.data.resize((size_t)width * height * image.components * bytesPerSample);
+
+	Random random(width * 31 + height * 17 + bitsStored);
+	double maxValue = (double)((1 << bitsStored) - 1);
+	for (unsigned int y = 0; y < height; y++) {
+		for (unsigned int x = 0; x < width; x++) {
+			double u = (double)x / width, v = (double)y / height;
+			double sample[3];
+			for (unsigned int c = 0; c < 3; c++) {
+				double value = 0.15 + 0.2 * u + 0.1 * v * (c + 1);
+				double dx = u - 0.5, dy = v - 0.5;
+				if (dx * dx + dy * dy < 0.16)
+					value += 0.25;
+				if ((u - 0.35) * (u - 0.35) + (v - 0.4) * (v - 0.4) < 0.01 * (c + 1))
+					value += 0.3;
+				if (u > 0.6 && u < 0.8 && v > 0.6 && v < 0.8 && ((x / 2 + y / 3 + c) & 1))
+					value += 0.15;
+				value += ((int)(random.Next() & 255) - 128) / 128.0 * 0.01;
+				sample[c] = value < 0 ? 0 : value > 1 ? 1 : value;
+			}
+
+			if (pi == "YBR_FULL") {
+				double r = sample[0], g = sample[1], b = sample[2];
+				sample[0] = 0.299 * r + 0.587 * g + 0.114 * b;
+				sample[1] = 0.5 - 0.168736 * r - 0.331264 * g + 0.5 * b;
+				sample[2] = 0.5 + 0.5 * r - 0.418688 * g - 0.081312 * b;
+			}
+
+			for (unsigned int c = 0; c < image.components; c++) {
+				unsigned int value = (unsigned int)(sample[c] * maxValue + 0.5);
+				size_t index = ((size_t)y * width + x) * image.components + c;
+				if (bytesPerSample == 1)
+					image.data[index] = (unsigned char)value;
+				else
+					((unsigned short *)&image.data[0])[index] = (unsigned short)value;
+			}
+		}
+	}
+}
+
+JpegLsImage jpegLsImage(const BenchmarkImage& image, unsigned char *data, size_t size) {
+	JpegLsImage lsImage;
+	lsImage.data = data;
+	lsImage.size = size;
+	lsImage.width = image.width;
+	lsImage.height = image.height;
+	lsImage.components = image.components;
+	lsImage.bitsStored = image.bitsStored;
+	lsImage.bytesPerSample = image.bitsStored > 8 ? 2 : 1;
+	lsImage.planar = false;
+	return lsImage;
+}
+
+bool jpegLsResult(JpegLsStatus status, std::string& error) {
+	if (status == JpegLsOk)
+		return true;
+	error = JpegLsCoder::GetStatusMessage(status);
+	return false;
+}
+
+bool encode(const BenchmarkImage& image, const BenchmarkCoding& coding, std::vector<unsigned char>& output, std::string& error) {
+	if (coding.mode == BenchmarkJpegLs) {
+		JpegLsImage lsImage = jpegLsImage(image, const_cast<unsigned char *>(&image.data[0]), image.data.size());
+		output.clear();
+		return jpegLsResult(JpegLsCoder::Encode(lsImage, 0, image.components > 1 ? JpegLsInterleaveLine : JpegLsInterleaveNone, output), error);
+	}
+	if (image.bitsStored <= 8)
+		return IJG8::Encode(image, coding, output, error);
+	else if (image.bitsStored <= 12)
+		return IJG12::Encode(image, coding, output, error);
+	else
+		return IJG16::Encode(image, coding, output, error);
+}
+
+bool decode(const BenchmarkImage& image, const BenchmarkCoding& coding, const std::vector<unsigned char>& input,
+	std::vector<unsigned char>& output, std::string& error) {
+	if (coding.mode == BenchmarkJpegLs) {
+		output.resize(image.data.size());
+		return jpegLsResult(JpegLsCoder::Decode(&input[0], input.size(), jpegLsImage(image, &output[0], output.size())), error);
+	}
+	if (image.bitsStored <= 8)
+		return IJG8::Decode(input, output, error);
+	else if (image.bitsStored <= 12)
+		return IJG12::Decode(input, output, error);
+	else
+		return IJG16::Decode(input, output, error);
+}
+
+std::string caseName(const BenchmarkCase& benchmarkCase) {
+	char name[128];
+	sprintf(name, "%s %s %u-bit%s%s", benchmarkCase.process, benchmarkCase.photometricInterpretation, benchmarkCase.bitsStored,
+		benchmarkCase.coding.subsample422 ? " 422" : "", benchmarkCase.coding.restartInterval > 0 ? " RST" : "");
+	return name;
+}
+
+// Frames per second in one direction: the best of MeasureRounds rounds, each of at least a share of
+// minTime and MeasureFrames frames, so that a busy moment on the machine doesn't count as a regression.
+bool measure(const BenchmarkCase& benchmarkCase, const BenchmarkImage& image, bool encoding, double minTime,
+	std::vector<unsigned char>& compressed, std::vector<unsigned char>& decompressed, double& fps, std::string& error) {
+	fps = 0;
+	for (int round = 0; round < MeasureRounds; round++) {
+		int frames = 0;
+		double start = now(), elapsed = 0;
+		while (frames < MeasureFrames || elapsed < minTime / MeasureRounds) {
+			bool ok = encoding ? encode(image, benchmarkCase.coding, compressed, error) : decode(image, benchmarkCase.coding, compressed, decompressed, error);
+			if (!ok)
+				return false;
+			frames++;
+			elapsed = now() - start;
+		}
+		if (frames / elapsed > fps)
+			fps = frames / elapsed;
+	}
+	return true;
+}
+
+bool runCase(const BenchmarkCase& benchmarkCase, const BenchmarkImage& image, double minTime, BenchmarkResult& result, std::string& error) {
+	std::vector<unsigned char> compressed, decompressed;
+	if (!encode(image, benchmarkCase.coding, compressed, error) || !decode(image, benchmarkCase.coding, compressed, decompressed, error))
+		return false;
+	if (decompressed.size() != image.data.size()) {
+		error = "decoded frame has the wrong size";
+		return false;
+	}
+	bool lossless = benchmarkCase.coding.mode == BenchmarkJpegLs ||
+		(benchmarkCase.coding.mode == BenchmarkLossless && benchmarkCase.coding.pointTransform == 0);
+	if (lossless && decompressed != image.data) {
+		error = "lossless frame did not round-trip";
+		return false;
+	}
+
+	double megabytes = image.data.size() / (1024.0 * 1024.0);
+	result.ratio = (double)image.data.size() / compressed.size();
+
+	if (!measure(benchmarkCase, image, true, minTime, compressed, decompressed, result.encodeFps, error) ||
+		!measure(benchmarkCase, image, false, minTime, compressed, decompressed, result.decodeFps, error))
+		return false;
+	result.encodeMBps = result.encodeFps * megabytes;
+	result.decodeMBps = result.decodeFps * megabytes;
+	return true;
+}
+
+// reads the encode and decode MB/s of each case from an earlier --csv file
+bool readBaseline(const char *path, std::map<std::string, BenchmarkResult>& baseline) {
+	FILE *file = fopen(path, "r");
+	if (file == NULL)
+		return false;
+
+	char line[512];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		char name[256], size[64];
+		BenchmarkResult result;
+		if (sscanf(line, "%255[^,],%63[^,],%lf,%lf,%lf,%lf,%lf", name, size, &result.ratio,
+				&result.encodeMBps, &result.encodeFps, &result.decodeMBps, &result.decodeFps) == 7)
+			baseline[std::string(name) + "," + size] = result;
+	}
+	fclose(file);
+	return true;
+}
+
+void usage() {
+	fprintf(stderr, "usage: JpegBenchmark [--filter text] [--size WxH]... [--time seconds]\n"
+		"                     [--csv results.csv] [--baseline previous.csv [--tolerance percent]]\n");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	const char *filter = NULL;
+	const char *csvPath = NULL;
+	const char *baselinePath = NULL;
+	double minTime = 1.0;
+	double tolerance = 10.0;
+	std::vector<std::pair<unsigned int, unsigned int> > sizes;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			usage();
+			return 2;
+		}
+		if (arg == "--filter")
+			filter = argv[++i];
+		else if (arg == "--csv")
+			csvPath = argv[++i];
+		else if (arg == "--baseline")
+			baselinePath = argv[++i];
+		else if (arg == "--time")
+			minTime = atof(argv[++i]);
+		else if (arg == "--tolerance")
+			tolerance = atof(argv[++i]);
+		else if (arg == "--size") {
+			unsigned int width, height;
+			if (sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+				usage();
+				return 2;
+			}
+			sizes.push_back(std::make_pair(width, height));
+		}
+		else {
+			usage();
+			return 2;
+		}
+	}
+
+	// a typical MR/CT frame and a typical CR/DX frame
+	if (sizes.empty()) {
+		sizes.push_back(std::make_pair(512u, 512u));
+		sizes.push_back(std::make_pair(2048u, 2048u));
+	}
+
+	std::map<std::string, BenchmarkResult> baseline;
+	if (baselinePath != NULL && !readBaseline(baselinePath, baseline)) {
+		fprintf(stderr, "Unable to read baseline %s\n", baselinePath);
+		return 2;
+	}
+
+	FILE *csv = NULL;
+	if (csvPath != NULL) {
+		csv = fopen(csvPath, "w");
+		if (csv == NULL) {
+			fprintf(stderr, "Unable to write %s\n", csvPath);
+			return 2;
+		}
+		fprintf(csv, "case,size,ratio,encode MB/s,encode frames/s,decode MB/s,decode frames/s\n");
+	}
+
+	printf("%-36s %-10s %7s %11s %9s %11s %9s\n", "case", "size", "ratio", "enc MB/s", "enc f/s", "dec MB/s", "dec f/s");
+
+	int failures = 0, regressions = 0;
+	for (size_t s = 0; s < sizes.size(); s++) {
+		char size[32];
+		sprintf(size, "%ux%u", sizes[s].first, sizes[s].second);
+
+		for (size_t c = 0; c < sizeof(Cases) / sizeof(Cases[0]); c++) {
+			const BenchmarkCase& benchmarkCase = Cases[c];
+			std::string name = caseName(benchmarkCase);
+			if (filter != NULL && name.find(filter) == std::string::npos)
+				continue;
+
+			BenchmarkImage image;
+			generateImage(image, sizes[s].first, sizes[s].second, benchmarkCase.photometricInterpretation, benchmarkCase.bitsStored);
+
+			BenchmarkResult result;
+			std::string error;
+			if (!runCase(benchmarkCase, image, minTime, result, error)) {
+				printf("%-36s %-10s FAILED: %s\n", name.c_str(), size, error.c_str());
+				failures++;
+				continue;
+			}
+
+			printf("%-36s %-10s %6.2f:1 %11.1f %9.1f %11.1f %9.1f", name.c_str(), size, result.ratio,
+				result.encodeMBps, result.encodeFps, result.decodeMBps, result.decodeFps);
+			if (csv != NULL)
+				fprintf(csv, "%s,%s,%.3f,%.2f,%.2f,%.2f,%.2f\n", name.c_str(), size, result.ratio,
+					result.encodeMBps, result.encodeFps, result.decodeMBps, result.decodeFps);
+
+			std::map<std::string, BenchmarkResult>::const_iterator previous = baseline.find(name + "," + size);
+			if (previous != baseline.end()) {
+				double encodeChange = 100.0 * (result.encodeMBps / previous->second.encodeMBps - 1);
+				double decodeChange = 100.0 * (result.decodeMBps / previous->second.decodeMBps - 1);
+				printf("  (enc %+.1f%%, dec %+.1f%%)", encodeChange, decodeChange);
+				if (encodeChange < -tolerance || decodeChange < -tolerance) {
+					printf(" REGRESSION");
+					regressions++;
+				}
+			}
+			printf("\n");
+			fflush(stdout);
+		}
+	}
+
+	if (csv != NULL)
+		fclose(csv);
+
+	if (failures > 0 || regressions > 0) {
+		printf("%d case(s) failed, %d regression(s) beyond %.0f%%\n", failures, regressions, tolerance);
+		return 1;
+	}
+	return 0;
+}
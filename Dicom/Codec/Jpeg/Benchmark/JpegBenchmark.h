@@ -0,0 +1,95 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#ifndef __JPEGBENCHMARK_H__
+#define __JPEGBENCHMARK_H__
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+namespace Benchmark {
+
+// The coding processes the DICOM JPEG codecs use, as JpegMode in JpegCodec.h, and lossless JPEG-LS
+// as DicomJpegLsLosslessCodec codes it
+enum BenchmarkMode {
+	BenchmarkBaseline,
+	BenchmarkSequential,
+	BenchmarkProgressive,
+	BenchmarkLossless,
+	BenchmarkJpegLs
+};
+
+// One uncompressed frame: interleaved samples in the low bitsStored bits of 1 (8 bit) or
+// 2 (12 and 16 bit) byte words, as DicomUncompressedPixelData holds them.
+struct BenchmarkImage {
+	std::vector<unsigned char> data;
+	unsigned int width;
+	unsigned int height;
+	unsigned int components;
+	unsigned int bitsStored;
+	std::string photometricInterpretation;
+};
+
+// The encoder settings that DicomJpegParameters and the codec's mode select
+struct BenchmarkCoding {
+	BenchmarkMode mode;
+	int quality;
+	int predictor;
+	int pointTransform;
+	int restartInterval;
+	bool subsample422;
+};
+
+// Encodes and decodes one frame with each IJG library, configured the way JpegCodec.i configures
+// it for the same parameters (see JpegBenchmark.i).  They return false with the library's message
+// if it reports an error.
+namespace IJG8 {
+	bool Encode(const BenchmarkImage& image, const BenchmarkCoding& coding, std::vector<unsigned char>& output, std::string& error);
+	bool Decode(const std::vector<unsigned char>& input, std::vector<unsigned char>& output, std::string& error);
+}
+
+namespace IJG12 {
+	bool Encode(const BenchmarkImage& image, const BenchmarkCoding& coding, std::vector<unsigned char>& output, std::string& error);
+	bool Decode(const std::vector<unsigned char>& input, std::vector<unsigned char>& output, std::string& error);
+}
+
+namespace IJG16 {
+	bool Encode(const BenchmarkImage& image, const BenchmarkCoding& coding, std::vector<unsigned char>& output, std::string& error);
+	bool Decode(const std::vector<unsigned char>& input, std::vector<unsigned char>& output, std::string& error);
+}
+
+} // Benchmark
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
+
+#endif
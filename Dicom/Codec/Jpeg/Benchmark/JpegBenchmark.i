@@ -0,0 +1,245 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+// The encoder and decoder of the benchmark, included by JpegBenchmark8.cpp, JpegBenchmark12.cpp and
+// JpegBenchmark16.cpp with IJGVERS defined, as JpegCodec.i is by the codecs.  The settings follow
+// JPEGCODEC::Encode and JPEGCODEC::Decode; only the managed buffers, arenas and exceptions are
+// replaced by native equivalents, so that the numbers measure the libraries themselves.
+
+namespace IJGVERS {
+
+	// error handler that jumps back to the caller rather than exiting the process
+	struct ErrorStruct {
+		struct jpeg_error_mgr pub;
+		jmp_buf setjmpBuffer;
+	};
+
+	static void ErrorExit(j_common_ptr cinfo) {
+		longjmp(((ErrorStruct *)cinfo->err)->setjmpBuffer, 1);
+	}
+
+	static void OutputMessage(j_common_ptr /* cinfo */) {
+	}
+
+	static std::string getMessage(j_common_ptr cinfo) {
+		char buffer[JMSG_LENGTH_MAX];
+		(*cinfo->err->format_message)(cinfo, buffer);
+		return std::string(buffer);
+	}
+
+	// destination manager that appends to a vector, which keeps its capacity from frame to frame
+	struct DestinationStruct {
+		struct jpeg_destination_mgr pub;
+		std::vector<unsigned char> *output;
+	};
+
+	static void initDestination(j_compress_ptr cinfo) {
+		DestinationStruct *dest = (DestinationStruct *)cinfo->dest;
+		dest->output->resize(IJGE_BLOCKSIZE);
+		dest->pub.next_output_byte = &(*dest->output)[0];
+		dest->pub.free_in_buffer = IJGE_BLOCKSIZE;
+	}
+
+	static ijg_boolean emptyOutputBuffer(j_compress_ptr cinfo) {
+		DestinationStruct *dest = (DestinationStruct *)cinfo->dest;
+		size_t used = dest->output->size();
+		dest->output->resize(used + IJGE_BLOCKSIZE);
+		dest->pub.next_output_byte = &(*dest->output)[used];
+		dest->pub.free_in_buffer = IJGE_BLOCKSIZE;
+		return TRUE;
+	}
+
+	static void termDestination(j_compress_ptr cinfo) {
+		DestinationStruct *dest = (DestinationStruct *)cinfo->dest;
+		dest->output->resize(dest->output->size() - dest->pub.free_in_buffer);
+	}
+
+	// source manager over a complete frame in memory
+	static void initSource(j_decompress_ptr /* cinfo */) {
+	}
+
+	static ijg_boolean fillInputBuffer(j_decompress_ptr cinfo) {
+		// the frame is truncated; insert a fake EOI marker, as jdatasrc.c does
+		static const JOCTET eoi[2] = { 0xFF, JPEG_EOI };
+		cinfo->src->next_input_byte = (JOCTET *)eoi;
+		cinfo->src->bytes_in_buffer = 2;
+		return TRUE;
+	}
+
+	static void skipInputData(j_decompress_ptr cinfo, long num_bytes) {
+		if (num_bytes <= 0)
+			return;
+		while ((size_t)num_bytes > cinfo->src->bytes_in_buffer) {
+			num_bytes -= (long)cinfo->src->bytes_in_buffer;
+			fillInputBuffer(cinfo);
+		}
+		cinfo->src->next_input_byte += num_bytes;
+		cinfo->src->bytes_in_buffer -= num_bytes;
+	}
+
+	static void termSource(j_decompress_ptr /* cinfo */) {
+	}
+
+	static J_COLOR_SPACE getJpegColorSpace(const std::string& photometricInterpretation) {
+		if (photometricInterpretation == "RGB")
+			return JCS_RGB;
+		else if (photometricInterpretation == "MONOCHROME1" || photometricInterpretation == "MONOCHROME2")
+			return JCS_GRAYSCALE;
+		else if (photometricInterpretation == "YBR_FULL" || photometricInterpretation == "YBR_FULL_422" || photometricInterpretation == "YBR_PARTIAL_422")
+			return JCS_YCbCr;
+		else
+			return JCS_UNKNOWN;
+	}
+
+	bool Encode(const BenchmarkImage& image, const BenchmarkCoding& coding, std::vector<unsigned char>& output, std::string& error) {
+		struct jpeg_compress_struct cinfo;
+		ErrorStruct jerr;
+		memset(&cinfo, 0, sizeof(cinfo));
+		cinfo.err = jpeg_std_error(&jerr.pub);
+		jerr.pub.error_exit = ErrorExit;
+		jerr.pub.output_message = OutputMessage;
+
+		if (setjmp(jerr.setjmpBuffer)) {
+			error = getMessage((j_common_ptr)&cinfo);
+			jpeg_destroy_compress(&cinfo);
+			return false;
+		}
+
+		// no arena is attached: every frame allocates from the heap, as the codecs do with ArenaLimit 0
+		jpeg_create_compress(&cinfo);
+
+		DestinationStruct dest;
+		dest.pub.init_destination = initDestination;
+		dest.pub.empty_output_buffer = emptyOutputBuffer;
+		dest.pub.term_destination = termDestination;
+		dest.output = &output;
+		cinfo.dest = &dest.pub;
+
+		cinfo.image_width = image.width;
+		cinfo.image_height = image.height;
+		cinfo.input_components = image.components;
+		cinfo.in_color_space = getJpegColorSpace(image.photometricInterpretation);
+
+		jpeg_set_defaults(&cinfo);
+
+		cinfo.optimize_coding = TRUE;
+
+		if (coding.mode == BenchmarkLossless)
+			jpeg_simple_lossless(&cinfo, coding.predictor, coding.pointTransform);
+		else {
+			jpeg_set_quality(&cinfo, coding.quality, 0);
+			if (coding.mode == BenchmarkProgressive)
+				jpeg_simple_progression(&cinfo);
+		}
+
+		if (coding.restartInterval > 0) {
+			int mcusPerRow = coding.mode == BenchmarkLossless ? cinfo.image_width : (cinfo.image_width + DCTSIZE - 1) / DCTSIZE;
+			cinfo.restart_in_rows = coding.restartInterval < 65535 / mcusPerRow ? coding.restartInterval : 65535 / mcusPerRow;
+		}
+
+		if (coding.mode == BenchmarkLossless || cinfo.jpeg_color_space != JCS_YCbCr) {
+			jpeg_set_colorspace(&cinfo, cinfo.in_color_space);
+			cinfo.comp_info[0].h_samp_factor = 1;
+			cinfo.comp_info[0].v_samp_factor = 1;
+		}
+		else {
+			cinfo.comp_info[0].h_samp_factor = coding.subsample422 ? 2 : 1;
+			cinfo.comp_info[0].v_samp_factor = 1;
+		}
+
+		for (int sfi = 1; sfi < MAX_COMPONENTS; sfi++) {
+			cinfo.comp_info[sfi].h_samp_factor = 1;
+			cinfo.comp_info[sfi].v_samp_factor = 1;
+		}
+
+		jpeg_start_compress(&cinfo, TRUE);
+
+		// the frame holds interleaved, unsigned JSAMPLEs, so rows are passed to the library in place
+		size_t rowStride = (size_t)image.width * image.components * sizeof(JSAMPLE);
+		JSAMPROW rowPointers[IJGE_STRIP_ROWS];
+		while (cinfo.next_scanline < cinfo.image_height) {
+			JDIMENSION rows = cinfo.image_height - cinfo.next_scanline;
+			if (rows > IJGE_STRIP_ROWS)
+				rows = IJGE_STRIP_ROWS;
+			for (JDIMENSION i = 0; i < rows; i++)
+				rowPointers[i] = (JSAMPROW)&image.data[(cinfo.next_scanline + i) * rowStride];
+			jpeg_write_scanlines(&cinfo, rowPointers, rows);
+		}
+
+		jpeg_finish_compress(&cinfo);
+		jpeg_destroy_compress(&cinfo);
+		return true;
+	}
+
+	bool Decode(const std::vector<unsigned char>& input, std::vector<unsigned char>& output, std::string& error) {
+		struct jpeg_decompress_struct dinfo;
+		ErrorStruct jerr;
+		memset(&dinfo, 0, sizeof(dinfo));
+		dinfo.err = jpeg_std_error(&jerr.pub);
+		jerr.pub.error_exit = ErrorExit;
+		jerr.pub.output_message = OutputMessage;
+
+		if (setjmp(jerr.setjmpBuffer)) {
+			error = getMessage((j_common_ptr)&dinfo);
+			jpeg_destroy_decompress(&dinfo);
+			return false;
+		}
+
+		jpeg_create_decompress(&dinfo);
+
+		struct jpeg_source_mgr src;
+		src.init_source = initSource;
+		src.fill_input_buffer = fillInputBuffer;
+		src.skip_input_data = skipInputData;
+		src.resync_to_restart = jpeg_resync_to_restart;
+		src.term_source = termSource;
+		src.next_input_byte = (JOCTET *)&input[0];
+		src.bytes_in_buffer = input.size();
+		dinfo.src = &src;
+
+		jpeg_read_header(&dinfo, TRUE);
+
+		// as selectColorSpace with ConvertYBRtoRGB, the default
+		if (dinfo.out_color_space == JCS_YCbCr || dinfo.out_color_space == JCS_RGB)
+			dinfo.out_color_space = JCS_RGB;
+
+		jpeg_start_decompress(&dinfo);
+
+		size_t rowStride = (size_t)dinfo.output_width * dinfo.output_components * sizeof(JSAMPLE);
+		output.resize(rowStride * dinfo.output_height);
+		JSAMPROW rowPointers[IJGE_STRIP_ROWS];
+		while (dinfo.output_scanline < dinfo.output_height) {
+			JDIMENSION rows = dinfo.output_height - dinfo.output_scanline;
+			if (rows > IJGE_STRIP_ROWS)
+				rows = IJGE_STRIP_ROWS;
+			for (JDIMENSION i = 0; i < rows; i++)
+				rowPointers[i] = (JSAMPROW)&output[(dinfo.output_scanline + i) * rowStride];
+			jpeg_read_scanlines(&dinfo, rowPointers, rows);
+		}
+
+		jpeg_finish_decompress(&dinfo);
+		jpeg_destroy_decompress(&dinfo);
+		return true;
+	}
+}
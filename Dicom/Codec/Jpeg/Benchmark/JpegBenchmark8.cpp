@@ -0,0 +1,61 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#include <setjmp.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "JpegBenchmark.h"
+
+#define IJGVERS IJG8
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+namespace Benchmark {
+
+extern "C" {
+#define boolean ijg_boolean
+#include "stdio.h"
+#include "../libijg8/jpeglib8.h"
+#define IJGE_BLOCKSIZE 16384
+
+// number of rows passed to jpeg_write_scanlines and jpeg_read_scanlines at a time
+#define IJGE_STRIP_ROWS 16
+
+// disable any preprocessor magic the IJG library might be doing with the "const" keyword
+#ifdef const
+#undef const
+#endif
+} // extern "C"
+
+#include "JpegBenchmark.i"
+
+} // Benchmark
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
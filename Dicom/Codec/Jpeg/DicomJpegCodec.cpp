@@ -48,29 +48,6 @@
 //    Colby Dillion (colby.dillion@gmail.com)
 #pragma endregion
 
-#pragma region GetJpegBitDepth() Copyright
-
-/*
- *  The GetJpegBitDepth() method has this copyright:  
- *
- *  Copyright (C) 1997-2008, OFFIS
- *
- *  This software and supporting documentation were developed by
- *
- *    Kuratorium OFFIS e.V.
- *    Healthcare Information and Communication Systems
- *    Escherweg 2
- *    D-26121 Oldenburg, Germany
- *
- *  THIS SOFTWARE IS MADE AVAILABLE,  AS IS,  AND OFFIS MAKES NO  WARRANTY
- *  REGARDING  THE  SOFTWARE,  ITS  PERFORMANCE,  ITS  MERCHANTABILITY  OR
- *  FITNESS FOR ANY PARTICULAR USE, FREEDOM FROM ANY COMPUTER DISEASES  OR
- *  ITS CONFORMITY TO ANY SPECIFICATION. THE ENTIRE RISK AS TO QUALITY AND
- *  PERFORMANCE OF THE SOFTWARE IS WITH THE USER.
- */
-
-#pragma endregion
-
 #include "DicomJpegCodec.h"
 
 using namespace System;
@@ -81,6 +58,7 @@ using namespace ClearCanvas::Dicom;
 using namespace ClearCanvas::Common;
 
 #include "JpegCodec.h"
+#include "DicomJpegHeader.h"
 #include "DicomJpegParameters.h"
 
 namespace ClearCanvas {
@@ -179,6 +157,13 @@ void DicomJpegCodec::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompr
 }
 
 void DicomJpegCodec::Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters)
+{
+	for (int frame = 0; frame < oldPixelData->NumberOfFrames; frame++) {
+		DecodeFrame(frame, oldPixelData, newPixelData, parameters);
+	}
+}
+
+void DicomJpegCodec::DecodeFrame(int frame, DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters)
 {
 	if (parameters == nullptr) parameters = gcnew DicomJpegParameters();
 
@@ -187,30 +172,17 @@ void DicomJpegCodec::Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompr
 
 	DicomJpegParameters^ jparams = (DicomJpegParameters^)parameters;
 
+	IJpegCodec^ codec = GetDecoder(oldPixelData->GetFrameFragmentData(frame), oldPixelData->BitsStored, jparams);
+	codec->Decode(oldPixelData, newPixelData, jparams, frame);	
 
-	for (int frame = 0; frame < oldPixelData->NumberOfFrames; frame++) {
-		array<unsigned char>^ jpegData = oldPixelData->GetFrameFragmentData(frame);
-		pin_ptr<unsigned char> jpegPin = &jpegData[0];
-		unsigned char* jpegPtr = jpegPin;
-		size_t jpegSize = jpegData->Length;
-	
-		unsigned char bitsStored = GetJpegBitDepth(jpegPtr,jpegData->Length);
-		if (bitsStored != oldPixelData->BitsStored)
-			Platform::Log(LogLevel::Warn,"Bit depth in jpeg data ({0}) doesn't match DICOM header bit depth ({1}).",
-							bitsStored, oldPixelData->BitsStored);
-
-		IJpegCodec^ codec = GetCodec(bitsStored, jparams);
-		codec->Decode(oldPixelData, newPixelData, jparams, frame);	
-
-		if (oldPixelData->PhotometricInterpretation->StartsWith("YBR_")) {
-			if (jparams->ConvertYBRtoRGB) {
-				newPixelData->PhotometricInterpretation = "RGB";
-			}
+	if (oldPixelData->PhotometricInterpretation->StartsWith("YBR_")) {
+		if (jparams->ConvertYBRtoRGB) {
+			newPixelData->PhotometricInterpretation = "RGB";
 		}
 	}
 }
 
-void DicomJpegCodec::DecodeFrame(int frame, DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters)
+void DicomJpegCodec::Transcode(DicomCompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomCodecParameters^ parameters)
 {
 	if (parameters == nullptr) parameters = gcnew DicomJpegParameters();
 
@@ -219,171 +191,65 @@ void DicomJpegCodec::DecodeFrame(int frame, DicomCompressedPixelData^ oldPixelDa
 
 	DicomJpegParameters^ jparams = (DicomJpegParameters^)parameters;
 
-	array<unsigned char>^ jpegData = oldPixelData->GetFrameFragmentData(frame);
-	pin_ptr<unsigned char> jpegPin = &jpegData[0];
-	unsigned char* jpegPtr = jpegPin;
-	size_t jpegSize = jpegData->Length;
+	for (int frame = 0; frame < oldPixelData->NumberOfFrames; frame++) {
+		DicomJpegHeader^ header = DicomJpegHeader::Read(oldPixelData->GetFrameFragmentData(frame));
+		if (header->IsLossless || header->IsHierarchical)
+			throw gcnew DicomCodecUnsupportedSopException(String::Format("Unable to transcode JPEG (SOF marker 0x{0:X2})", header->SofMarker));
 
-	unsigned char bitsStored = GetJpegBitDepth(jpegPtr,jpegData->Length);
-	if (bitsStored != oldPixelData->BitsStored)
-		Platform::Log(LogLevel::Warn,"Bit depth in jpeg data ({0}) doesn't match DICOM header bit depth ({1}).",
-						bitsStored, oldPixelData->BitsStored);
+		IJpegCodec^ codec = GetCodec(header->Precision, jparams);
+		codec->Transcode(oldPixelData, newPixelData, jparams, frame);
+	}
 
-	IJpegCodec^ codec = GetCodec(bitsStored, jparams);
-	codec->Decode(oldPixelData, newPixelData, jparams, frame);	
+	newPixelData->TransferSyntax = CodecTransferSyntax;
+}
 
-	if (oldPixelData->PhotometricInterpretation->StartsWith("YBR_")) {
-		if (jparams->ConvertYBRtoRGB) {
-			newPixelData->PhotometricInterpretation = "RGB";
-		}
-	}
+array<unsigned char>^ DicomJpegCodec::DecodeFrameRegion(int frame, int x, int y, int width, int height,
+	DicomCompressedPixelData^ oldPixelData, DicomCodecParameters^ parameters)
+{
+	if (parameters == nullptr) parameters = gcnew DicomJpegParameters();
+
+	if (parameters->GetType() != DicomJpegParameters::typeid)
+		throw gcnew DicomCodecException("Invalid codec parameters");
+
+	DicomJpegParameters^ jparams = (DicomJpegParameters^)parameters;
+
+	IJpegCodec^ codec = GetDecoder(oldPixelData->GetFrameFragmentData(frame), oldPixelData->BitsStored, jparams);
+	return codec->DecodeRegion(oldPixelData, jparams, frame, x, y, width, height);
 }
 
-unsigned short DicomJpegCodec::readUint16(const unsigned char *data)
+IJpegCodec^ DicomJpegCodec::GetDecoder(array<unsigned char>^ jpegData, int bitsStored, DicomJpegParameters^ jparams)
 {
-  return (((unsigned short)(*data) << 8) | ((unsigned short)(*(data+1))));
+	DicomJpegHeader^ header = DicomJpegHeader::TryRead(jpegData);
+	if (header == nullptr) {
+		// As before the header was read here, leave it to the 8 bit IJG library to report what is
+		// wrong with the frame; it may still decode.
+		Platform::Log(LogLevel::Warn,"Unable to read the JPEG frame header, decoding with the 8 bit codec.");
+		return GetCodec(8, jparams);
+	}
+
+	if (header->Precision != bitsStored)
+		Platform::Log(LogLevel::Warn,"Bit depth in jpeg data ({0}) doesn't match DICOM header bit depth ({1}).",
+						header->Precision, bitsStored);
+
+	if (header->IsHierarchical)
+		throw gcnew DicomCodecUnsupportedSopException(String::Format("Unable to decode hierarchical JPEG (SOF marker 0x{0:X2})", header->SofMarker));
+
+	return GetCodec(header->Precision, jparams);
 }
 
-unsigned char DicomJpegCodec::GetJpegBitDepth(
-  const unsigned char *data,
-  const unsigned int fragmentLength)
+JpegIncrementalDecoder^ JpegIncrementalDecoder::Create(int precision, DicomJpegParameters^ params)
 {
-  unsigned int offset = 0;
-  while(offset+4 < fragmentLength)
-  {
-    switch(readUint16(data+offset))
-    {
-      case 0xffc0: // SOF_0: JPEG baseline
-        return data[offset+4];
-        /* break; */
-      case 0xffc1: // SOF_1: JPEG extended sequential DCT
-        return data[offset+4];
-        /* break; */
-      case 0xffc2: // SOF_2: JPEG progressive DCT
-        return data[offset+4];
-        /* break; */
-      case 0xffc3 : // SOF_3: JPEG lossless sequential
-        return data[offset+4];
-        /* break; */
-      case 0xffc5: // SOF_5: differential (hierarchical) extended sequential, Huffman
-        return data[offset+4];
-        /* break; */
-      case 0xffc6: // SOF_6: differential (hierarchical) progressive, Huffman
-        return data[offset+4];
-        /* break; */
-      case 0xffc7: // SOF_7: differential (hierarchical) lossless, Huffman
-        return data[offset+4];
-        /* break; */
-      case 0xffc8: // Reserved for JPEG extentions
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xffc9: // SOF_9: extended sequential, arithmetic
-        return data[offset+4];
-        /* break; */
-      case 0xffca: // SOF_10: progressive, arithmetic
-        return data[offset+4];
-        /* break; */
-      case 0xffcb: // SOF_11: lossless, arithmetic
-        return data[offset+4];
-        /* break; */
-      case 0xffcd: // SOF_13: differential (hierarchical) extended sequential, arithmetic
-        return data[offset+4];
-        /* break; */
-      case 0xffce: // SOF_14: differential (hierarchical) progressive, arithmetic
-        return data[offset+4];
-        /* break; */
-      case 0xffcf: // SOF_15: differential (hierarchical) lossless, arithmetic
-        return data[offset+4];
-        /* break; */
-      case 0xffc4: // DHT
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xffcc: // DAC
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xffd0: // RST m
-      case 0xffd1:
-      case 0xffd2:
-      case 0xffd3:
-      case 0xffd4:
-      case 0xffd5:
-      case 0xffd6:
-      case 0xffd7:
-        offset +=2;
-        break;
-      case 0xffd8: // SOI
-        offset +=2;
-        break;
-      case 0xffd9: // EOI
-        offset +=2;
-        break;
-      case 0xffda: // SOS
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xffdb: // DQT
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xffdc: // DNL
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xffdd: // DRI
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xffde: // DHP
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xffdf: // EXP
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xffe0: // APPn
-      case 0xffe1:
-      case 0xffe2:
-      case 0xffe3:
-      case 0xffe4:
-      case 0xffe5:
-      case 0xffe6:
-      case 0xffe7:
-      case 0xffe8:
-      case 0xffe9:
-      case 0xffea:
-      case 0xffeb:
-      case 0xffec:
-      case 0xffed:
-      case 0xffee:
-      case 0xffef:
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xfff0: // JPGn
-      case 0xfff1:
-      case 0xfff2:
-      case 0xfff3:
-      case 0xfff4:
-      case 0xfff5:
-      case 0xfff6:
-      case 0xfff7:
-      case 0xfff8:
-      case 0xfff9:
-      case 0xfffa:
-      case 0xfffb:
-      case 0xfffc:
-      case 0xfffd:
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xfffe: // COM
-        offset += readUint16(data+offset+2)+2;
-        break;
-      case 0xff01: // TEM
-        break;
-      default:
-        if ((data[offset]==0xff) && (data[offset+1]>2) && (data[offset+1] <= 0xbf)) // RES reserved markers
-        {
-          offset += 2;
-        }
-        else return 0; // syntax error, stop parsing
-        break;
-    }
-  } // while
-  return 0; // no SOF marker found
+	if (params == nullptr) params = gcnew DicomJpegParameters();
+
+	// The IJG library follows the frame precision; only lossless frames have more than 12 bits
+	if (precision <= 8)
+		return gcnew Jpeg8IncrementalDecoder(params);
+	else if (precision <= 12)
+		return gcnew Jpeg12IncrementalDecoder(params);
+	else if (precision <= 16)
+		return gcnew Jpeg16IncrementalDecoder(params);
+	else
+		throw gcnew DicomCodecUnsupportedSopException(String::Format("Unable to create JPEG decoder for bits stored == {0}", precision));
 }
 
 } // Jpeg
@@ -61,6 +61,7 @@ using namespace ClearCanvas::Dicom;
 using namespace ClearCanvas::Dicom::Codec;
 
 #include "JpegCodec.h"
+#include "DicomJpegHeader.h"
 #include "DicomJpegParameters.h"
 
 namespace ClearCanvas {
@@ -77,9 +78,21 @@ public:
 	virtual void Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters);
 	virtual void DecodeFrame(int frame, DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters);
 
+	// Converts every frame of JPEG pixel data in another DCT-based process to this codec's transfer
+	// syntax in the coefficient domain (see IJpegCodec::Transcode).  Unlike decoding and encoding again,
+	// it is exact.
+	virtual void Transcode(DicomCompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomCodecParameters^ parameters);
+
+	// Decodes a rectangle of one frame (see IJpegCodec::DecodeRegion).  The cost is roughly proportional
+	// to the rows down to the bottom of the region, and within those rows to the width of the region.
+	virtual array<unsigned char>^ DecodeFrameRegion(int frame, int x, int y, int width, int height,
+		DicomCompressedPixelData^ oldPixelData, DicomCodecParameters^ parameters);
+
 	virtual IJpegCodec^ GetCodec(int bits, DicomJpegParameters^ jparams) = 0;
-	unsigned char DicomJpegCodec::GetJpegBitDepth(const unsigned char *data, const unsigned int fragmentLength);
-	unsigned short DicomJpegCodec::readUint16(const unsigned char *data);
+
+	// The codec for decoding a frame, from GetCodec with the precision in the frame header, or the
+	// 8 bit codec if the header cannot be read.
+	IJpegCodec^ GetDecoder(array<unsigned char>^ jpegData, int bitsStored, DicomJpegParameters^ jparams);
 
 };
 
@@ -249,6 +249,91 @@ namespace Jpeg {
 		return gcnew DicomJpegLossless14SV1Codec();
 	}
 
+	//DicomJpegLsLosslessCodecFactory
+	TransferSyntax^ DicomJpegLsLosslessCodecFactory::CodecTransferSyntax::get()  {
+		return TransferSyntax::JpegLsLosslessImageCompression;
+	}
+	String^ DicomJpegLsLosslessCodecFactory::Name::get()  {
+		return ClearCanvas::Dicom::TransferSyntax::JpegLsLosslessImageCompression->Name;	
+	}
+	bool DicomJpegLsLosslessCodecFactory::Enabled::get()  {
+		return true;
+	}
+	DicomCodecParameters^ DicomJpegLsLosslessCodecFactory::GetCodecParameters(DicomAttributeCollection^ dataSet)
+	{
+		DicomJpegLsParameters^ codecParms = gcnew DicomJpegLsParameters();
+		codecParms->ConvertPaletteToRGB = true;
+		return codecParms;
+	}
+	DicomCodecParameters^ DicomJpegLsLosslessCodecFactory::GetCodecParameters(XmlDocument^ parms)
+    {
+		DicomJpegLsParameters^ codecParms = gcnew DicomJpegLsParameters();
+
+		XmlElement^ element = parms->DocumentElement;
+		if (element->Attributes["convertFromPalette"])
+		{
+			String^ boolString = element->Attributes["convertFromPalette"]->Value;
+			bool convert;
+			if (false == bool::TryParse(boolString, convert))
+				throw gcnew ApplicationException("Invalid convertFromPalette specified for JPEG-LS Lossless: " + boolString);
+			codecParms->ConvertPaletteToRGB = convert;
+		}
+		else
+			codecParms->ConvertPaletteToRGB = true;
+
+		return codecParms;
+	}
+	IDicomCodec^ DicomJpegLsLosslessCodecFactory::GetDicomCodec() {
+		return gcnew DicomJpegLsLosslessCodec();
+	}
+
+	//DicomJpegLsNearLosslessCodecFactory
+	TransferSyntax^ DicomJpegLsNearLosslessCodecFactory::CodecTransferSyntax::get()  {
+		return TransferSyntax::JpegLsLossyNearLosslessImageCompression;
+	}
+	String^ DicomJpegLsNearLosslessCodecFactory::Name::get()  {
+		return ClearCanvas::Dicom::TransferSyntax::JpegLsLossyNearLosslessImageCompression->Name;	
+	}
+	bool DicomJpegLsNearLosslessCodecFactory::Enabled::get()  {
+		return true;
+	}
+	DicomCodecParameters^ DicomJpegLsNearLosslessCodecFactory::GetCodecParameters(DicomAttributeCollection^ dataSet)
+	{
+		DicomJpegLsParameters^ codecParms = gcnew DicomJpegLsParameters();
+		codecParms->AllowedError = 2;
+		codecParms->ConvertPaletteToRGB = true;
+		return codecParms;
+	}
+	DicomCodecParameters^ DicomJpegLsNearLosslessCodecFactory::GetCodecParameters(XmlDocument^ parms)
+    {
+		DicomJpegLsParameters^ codecParms = gcnew DicomJpegLsParameters();
+
+		XmlElement^ element = parms->DocumentElement;
+
+		String^ allowedErrorString = element->Attributes["allowedError"]->Value;
+		int allowedError;
+		if (false == int::TryParse(allowedErrorString, allowedError))
+			throw gcnew ApplicationException("Invalid allowedError specified for JPEG-LS Near Lossless: " + allowedErrorString);
+
+		codecParms->AllowedError = allowedError;
+
+		if (element->Attributes["convertFromPalette"])
+		{
+			String^ boolString = element->Attributes["convertFromPalette"]->Value;
+			bool convert;
+			if (false == bool::TryParse(boolString, convert))
+				throw gcnew ApplicationException("Invalid convertFromPalette specified for JPEG-LS Near Lossless: " + boolString);
+			codecParms->ConvertPaletteToRGB = convert;
+		}
+		else
+			codecParms->ConvertPaletteToRGB = true;
+
+		return codecParms;
+	}
+	IDicomCodec^ DicomJpegLsNearLosslessCodecFactory::GetDicomCodec() {
+		return gcnew DicomJpegLsNearLosslessCodec();
+	}
+
 
 } // Jpeg
 } // Codec
@@ -58,6 +58,7 @@ using namespace ClearCanvas::Dicom;
 using namespace ClearCanvas::Dicom::Codec;
 
 #include "DicomJpegCodec.h"
+#include "DicomJpegLsCodec.h"
 #include "DicomJpegParameters.h"
 
 namespace ClearCanvas {
@@ -113,6 +114,30 @@ public:
 	virtual IDicomCodec^ GetDicomCodec();
 };
 
+[ClearCanvas::Common::ExtensionOf(DicomCodecFactoryExtensionPoint::typeid)]
+public ref class DicomJpegLsLosslessCodecFactory : public IDicomCodecFactory {
+public:
+    virtual property String^ Name { String^ get();}
+    virtual property bool Enabled { bool get(); }
+    virtual property ClearCanvas::Dicom::TransferSyntax^ CodecTransferSyntax { ClearCanvas::Dicom::TransferSyntax^ get(); };
+
+    virtual DicomCodecParameters^ GetCodecParameters(DicomAttributeCollection^ dataSet);
+    virtual DicomCodecParameters^ GetCodecParameters(XmlDocument^ parms);
+	virtual IDicomCodec^ GetDicomCodec();
+};
+
+[ClearCanvas::Common::ExtensionOf(DicomCodecFactoryExtensionPoint::typeid)]
+public ref class DicomJpegLsNearLosslessCodecFactory : public IDicomCodecFactory {
+public:
+    virtual property String^ Name { String^ get();}
+    virtual property bool Enabled { bool get(); }
+    virtual property ClearCanvas::Dicom::TransferSyntax^ CodecTransferSyntax { ClearCanvas::Dicom::TransferSyntax^ get(); };
+
+    virtual DicomCodecParameters^ GetCodecParameters(DicomAttributeCollection^ dataSet);
+    virtual DicomCodecParameters^ GetCodecParameters(XmlDocument^ parms);
+	virtual IDicomCodec^ GetDicomCodec();
+};
+
 } // Jpeg
 } // Codec
 } // Dicom
@@ -44,11 +44,13 @@ array<Object^>^ StubExtensionFactory::CreateExtensions(ExtensionPoint^ extension
 	if (extensionPoint->GetType() != DicomCodecFactoryExtensionPoint::typeid)
 		return gcnew array<Object^>(0);
 
-	array<Object^>^ theArray = gcnew array<Object^>(4);
+	array<Object^>^ theArray = gcnew array<Object^>(6);
 	theArray[0] = gcnew DicomJpegProcess1CodecFactory;
 	theArray[1] = gcnew DicomJpegProcess24CodecFactory;
 	theArray[2] = gcnew DicomJpegLossless14CodecFactory;
 	theArray[3] = gcnew DicomJpegLossless14SV1CodecFactory;
+	theArray[4] = gcnew DicomJpegLsLosslessCodecFactory;
+	theArray[5] = gcnew DicomJpegLsNearLosslessCodecFactory;
 	return theArray;
 }
 
@@ -324,6 +326,373 @@ void DicomJpegCodecTest::DicomJpegLossless14SV1CodecTest_8BitsStored16BitsAlloca
 	LosslessImageTestWithBitsAllocatedConversion(syntax, file);
 }
 
+void DicomJpegCodecTest::DicomJpegLossless14SV1CodecTest_RestartInterval()
+{
+	TransferSyntax^ syntax = TransferSyntax::JpegLosslessNonHierarchicalFirstOrderPredictionProcess14SelectionValue1;
+	array<DicomFile^>^ files = gcnew array<DicomFile^> {
+		CreateFile(512, 512, "MONOCHROME2", 16, 16, false, 1),
+		CreateFile(512, 500, "MONOCHROME2", 12, 16, false, 2),
+		CreateFile(512, 512, "RGB", 8, 8, false, 1)
+	};
+
+	for each (DicomFile^ file in files)
+	{
+		DicomFile^ saveCopy = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+
+		// 16 row restart intervals, decoded in 4 bands
+		DicomJpegParameters^ parameters = gcnew DicomJpegParameters();
+		parameters->RestartInterval = 16;
+		parameters->DecodeThreads = 4;
+
+		DicomJpegLossless14SV1Codec^ codec = gcnew DicomJpegLossless14SV1Codec();
+		file->ChangeTransferSyntax(syntax, codec, parameters);
+		file->ChangeTransferSyntax(saveCopy->TransferSyntax, codec, parameters);
+
+		String^ failureDescription;
+		bool result = Compare(DicomPixelData::CreateFrom(file), DicomPixelData::CreateFrom(saveCopy), failureDescription);
+		Assert::IsTrue(result, failureDescription);
+	}
+}
+
+void DicomJpegCodecTest::DicomJpegLossless14SV1CodecTest_HuffmanTables()
+{
+	TransferSyntax^ syntax = TransferSyntax::JpegLosslessNonHierarchicalFirstOrderPredictionProcess14SelectionValue1;
+	array<DicomFile^>^ files = gcnew array<DicomFile^> {
+		CreateFile(256, 256, "MONOCHROME2", 16, 16, false, 2),
+		CreateFile(256, 200, "MONOCHROME2", 12, 16, false, 3),
+		CreateFile(256, 256, "RGB", 8, 8, false, 2)
+	};
+
+	// tables built from the first frame are reused, losslessly, for the later frames
+	DicomJpegParameters^ parameters = gcnew DicomJpegParameters();
+	parameters->LosslessHuffmanTables = JpegLosslessHuffmanTables::FirstFrame;
+
+	for each (DicomFile^ file in files)
+	{
+		DicomFile^ saveCopy = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+
+		DicomJpegLossless14SV1Codec^ codec = gcnew DicomJpegLossless14SV1Codec();
+		file->ChangeTransferSyntax(syntax, codec, parameters);
+		file->ChangeTransferSyntax(saveCopy->TransferSyntax, codec, parameters);
+
+		String^ failureDescription;
+		bool result = Compare(DicomPixelData::CreateFrom(file), DicomPixelData::CreateFrom(saveCopy), failureDescription);
+		Assert::IsTrue(result, failureDescription);
+	}
+}
+
+void DicomJpegCodecTest::DicomJpegProcess1CodecTest_MemoryArena()
+{
+	DicomFile^ file = CreateFile(512, 512, "RGB", 8, 8, false, 3);
+	DicomUncompressedPixelData^ original = gcnew DicomUncompressedPixelData(file);
+	DicomCompressedPixelData^ compressed = gcnew DicomCompressedPixelData(original);
+
+	// once the first frame has sized the thread's arena, later frames never go to the heap
+	DicomJpegParameters^ parameters = gcnew DicomJpegParameters();
+	Jpeg8Codec^ codec = gcnew Jpeg8Codec(JpegMode::Baseline, 0, 0);
+	for (int frame = 0; frame < original->NumberOfFrames; frame++)
+	{
+		codec->Encode(original, compressed, parameters, frame);
+		Assert::Greater(codec->MemoryStatistics.Allocations, (Int64)0);
+		Assert::Greater(codec->MemoryStatistics.Bytes, (Int64)0);
+		if (frame > 0)
+			Assert::AreEqual((Int64)0, codec->MemoryStatistics.HeapAllocations);
+	}
+
+	// nothing is counted with the arena disabled
+	parameters->ArenaLimit = 0;
+	codec->Decode(compressed, gcnew DicomUncompressedPixelData(compressed), parameters, 0);
+	Assert::AreEqual((Int64)0, codec->MemoryStatistics.Allocations);
+}
+
+void DicomJpegCodecTest::JpegIncrementalDecoderTest()
+{
+	DicomFile^ file = CreateFile(512, 384, "RGB", 8, 8, false, 1);
+	DicomUncompressedPixelData^ original = gcnew DicomUncompressedPixelData(file);
+	DicomJpegParameters^ parameters = gcnew DicomJpegParameters();
+
+	array<JpegMode>^ modes = { JpegMode::Progressive, JpegMode::Baseline };
+	for each (JpegMode mode in modes)
+	{
+		DicomCompressedPixelData^ compressed = gcnew DicomCompressedPixelData(original);
+		Jpeg8Codec^ codec = gcnew Jpeg8Codec(mode, 0, 0);
+		codec->Encode(original, compressed, parameters, 0);
+
+		DicomUncompressedPixelData^ decoded = gcnew DicomUncompressedPixelData(compressed);
+		codec->Decode(compressed, decoded, parameters, 0);
+
+		// feed the frame in 1 KB pieces; an image should be available well before the end
+		array<unsigned char>^ jpegData = compressed->GetFrameFragmentData(0);
+		JpegIncrementalDecoder^ decoder = JpegIncrementalDecoder::Create(8, parameters);
+		int images = 0;
+		for (int offset = 0; offset < jpegData->Length; offset += 1024)
+		{
+			decoder->AddData(jpegData, offset, Math::Min(1024, jpegData->Length - offset));
+			if (decoder->Decode())
+				images++;
+		}
+		decoder->EndOfData();
+		decoder->Decode();
+
+		Assert::IsTrue(decoder->IsComplete);
+		Assert::Greater(images, 1);
+		Assert::AreEqual(384, decoder->RowsDecoded);
+		if (mode == JpegMode::Progressive)
+			Assert::Greater(decoder->ScansDecoded, 1);
+		Assert::AreEqual(decoded->GetFrame(0), decoder->Image);
+		delete decoder;
+	}
+}
+
+void DicomJpegCodecTest::DicomJpegTranscodeTest()
+{
+	DicomFile^ file = CreateFile(512, 384, "RGB", 8, 8, false, 2);
+	DicomUncompressedPixelData^ original = gcnew DicomUncompressedPixelData(file);
+	DicomJpegParameters^ parameters = gcnew DicomJpegParameters();
+
+	DicomCompressedPixelData^ baseline = gcnew DicomCompressedPixelData(original);
+	DicomJpegProcess1Codec^ process1 = gcnew DicomJpegProcess1Codec();
+	process1->Encode(original, baseline, parameters);
+	DicomUncompressedPixelData^ expected = gcnew DicomUncompressedPixelData(baseline);
+	process1->Decode(baseline, expected, parameters);
+
+	// baseline to progressive and back, with restart markers; the samples must not change
+	DicomCompressedPixelData^ progressive = gcnew DicomCompressedPixelData(original);
+	Jpeg8Codec^ codec = gcnew Jpeg8Codec(JpegMode::Progressive, 0, 0);
+	for (int frame = 0; frame < baseline->NumberOfFrames; frame++)
+		codec->Transcode(baseline, progressive, parameters, frame);
+	Assert::IsTrue(DicomJpegHeader::Read(progressive->GetFrameFragmentData(0))->IsProgressive);
+
+	parameters->RestartInterval = 4;
+	DicomCompressedPixelData^ restarted = gcnew DicomCompressedPixelData(original);
+	process1->Transcode(progressive, restarted, parameters);
+	Assert::AreEqual(TransferSyntax::JpegBaselineProcess1, restarted->TransferSyntax);
+	Assert::AreEqual(4 * 64, DicomJpegHeader::Read(restarted->GetFrameFragmentData(1))->RestartInterval);
+
+	// back to baseline in a single pass with the standard tables, which only makes the frames larger
+	parameters->RestartInterval = 0;
+	parameters->TranscodeHuffmanTables = JpegTranscodeHuffmanTables::Standard;
+	DicomCompressedPixelData^ standard = gcnew DicomCompressedPixelData(original);
+	process1->Transcode(progressive, standard, parameters);
+	Assert::Greater(standard->GetFrameFragmentData(0)->Length, baseline->GetFrameFragmentData(0)->Length);
+
+	for each (DicomCompressedPixelData^ transcoded in gcnew array<DicomCompressedPixelData^> { progressive, restarted, standard })
+	{
+		DicomUncompressedPixelData^ decoded = gcnew DicomUncompressedPixelData(transcoded);
+		for (int frame = 0; frame < transcoded->NumberOfFrames; frame++)
+			codec->Decode(transcoded, decoded, parameters, frame);
+		for (int frame = 0; frame < transcoded->NumberOfFrames; frame++)
+			Assert::AreEqual(expected->GetFrame(frame), decoded->GetFrame(frame));
+	}
+}
+
+void DicomJpegCodecTest::DicomJpegRegionDecodeTest()
+{
+	DicomFile^ file = CreateFile(600, 400, "RGB", 8, 8, false, 2);
+	DicomUncompressedPixelData^ original = gcnew DicomUncompressedPixelData(file);
+	DicomJpegProcess1Codec^ process1 = gcnew DicomJpegProcess1Codec();
+	DicomJpegParameters^ parameters = gcnew DicomJpegParameters();
+
+	// baseline, baseline with restart markers (decoded from the intervals covering the region only)
+	// and progressive
+	DicomCompressedPixelData^ baseline = gcnew DicomCompressedPixelData(original);
+	process1->Encode(original, baseline, parameters);
+	parameters->RestartInterval = 2;
+	DicomCompressedPixelData^ restarted = gcnew DicomCompressedPixelData(original);
+	process1->Encode(original, restarted, parameters);
+	parameters->RestartInterval = 0;
+	DicomCompressedPixelData^ progressive = gcnew DicomCompressedPixelData(original);
+	Jpeg8Codec^ codec = gcnew Jpeg8Codec(JpegMode::Progressive, 0, 0);
+	for (int frame = 0; frame < baseline->NumberOfFrames; frame++)
+		codec->Transcode(baseline, progressive, parameters, frame);
+
+	array<int>^ regions = gcnew array<int> { 0, 0, 600, 400,  123, 77, 200, 150,  599, 399, 1, 1,  301, 0, 17, 400,  0, 250, 64, 8 };
+	for each (DicomCompressedPixelData^ compressed in gcnew array<DicomCompressedPixelData^> { baseline, restarted, progressive })
+	{
+		DicomUncompressedPixelData^ expected = gcnew DicomUncompressedPixelData(compressed);
+		process1->Decode(compressed, expected, parameters);
+		array<unsigned char>^ full = expected->GetFrame(1);
+
+		for (int i = 0; i < regions->Length; i += 4) {
+			int x = regions[i], y = regions[i + 1], width = regions[i + 2], height = regions[i + 3];
+			array<unsigned char>^ region = process1->DecodeFrameRegion(1, x, y, width, height, compressed, parameters);
+			Assert::AreEqual(width * height * 3, region->Length);
+			for (int row = 0; row < height; row++)
+				for (int col = 0; col < width * 3; col++)
+					Assert::AreEqual(full[((y + row) * 600 + x) * 3 + col], region[row * width * 3 + col],
+						String::Format("Region {0},{1} {2}x{3}", x, y, width, height));
+		}
+	}
+
+	bool rejected = false;
+	try {
+		process1->DecodeFrameRegion(0, 590, 0, 20, 10, baseline, parameters);
+	}
+	catch (ArgumentOutOfRangeException^) {
+		rejected = true;
+	}
+	Assert::IsTrue(rejected, "Region outside the frame was not rejected");
+}
+
+void DicomJpegCodecTest::DicomJpegHeaderTest()
+{
+	DicomFile^ file = CreateFile(512, 300, "MONOCHROME2", 12, 16, false, 1);
+	DicomJpegParameters^ parameters = gcnew DicomJpegParameters();
+	parameters->RestartInterval = 4;
+	file->ChangeTransferSyntax(TransferSyntax::JpegLosslessNonHierarchicalProcess14, gcnew DicomJpegLossless14Codec(), parameters);
+
+	DicomCompressedPixelData^ pd = gcnew DicomCompressedPixelData(file);
+	DicomJpegHeader^ header = DicomJpegHeader::Read(pd->GetFrameFragmentData(0), true);
+	Assert::AreEqual(0xC3, header->SofMarker);
+	Assert::IsTrue(header->IsLossless);
+	Assert::AreEqual(12, header->Precision);
+	Assert::AreEqual(512, header->ImageWidth);
+	Assert::AreEqual(300, header->ImageHeight);
+	Assert::AreEqual(1, header->Components);
+	Assert::AreEqual(4 * 512, header->RestartInterval);
+	Assert::AreEqual(1, header->ScanCount);
+	Assert::AreEqual(512 * 300 * 2, header->DecodedFrameSize);
+
+	file = CreateFile(255, 255, "RGB", 8, 8, false, 1);
+	file->ChangeTransferSyntax(TransferSyntax::JpegBaselineProcess1);
+	pd = gcnew DicomCompressedPixelData(file);
+	header = DicomJpegHeader::Read(pd->GetFrameFragmentData(0));
+	Assert::AreEqual(8, header->Precision);
+	Assert::AreEqual(3, header->Components);
+	Assert::IsFalse(header->IsLossless);
+
+	array<unsigned char>^ truncated = gcnew array<unsigned char>(20);
+	Array::Copy(pd->GetFrameFragmentData(0), truncated, truncated->Length);
+	bool rejected = false;
+	try {
+		DicomJpegHeader::Read(truncated);
+	}
+	catch (DicomCodecException^) {
+		rejected = true;
+	}
+	Assert::IsTrue(rejected, "Truncated JPEG header was not rejected");
+	Assert::IsNull(DicomJpegHeader::TryRead(truncated));
+
+	// a 65535 x 65535 RGB frame does not fit in an array
+	array<unsigned char>^ huge = (array<unsigned char>^)pd->GetFrameFragmentData(0)->Clone();
+	int sof = 2;
+	while (huge[sof + 1] != 0xC0)
+		sof += 2 + (huge[sof + 2] << 8 | huge[sof + 3]);
+	huge[sof + 5] = huge[sof + 6] = huge[sof + 7] = huge[sof + 8] = 0xFF;
+	header = DicomJpegHeader::Read(huge);
+	Assert::AreEqual(65535, header->ImageWidth);
+	rejected = false;
+	try {
+		Assert::Greater(header->DecodedFrameSize, 0);
+	}
+	catch (DicomCodecException^) {
+		rejected = true;
+	}
+	Assert::IsTrue(rejected, "Oversized JPEG frame was not rejected");
+}
+
+void DicomJpegCodecTest::DicomJpegLsLosslessCodecTest()
+{
+	TransferSyntax^ syntax = TransferSyntax::JpegLsLosslessImageCompression;
+	DicomFile^ file = CreateFile(512, 512, "MONOCHROME1", 12, 16, false, 1);
+	LosslessImageTest(syntax, file);
+
+	// signed samples are coded as their two's complement bits
+	file = CreateFile(512, 512, "MONOCHROME1", 12, 16, true, 1);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(255, 255, "MONOCHROME1", 8, 8, false, 1);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(255, 255, "MONOCHROME1", 8, 8, true, 1);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(256, 255, "MONOCHROME2", 16, 16, false, 1);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(256, 255, "MONOCHROME2", 16, 16, true, 1);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(256, 255, "MONOCHROME2", 13, 16, false, 1);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(256, 256, "MONOCHROME1", 8, 16, false, 1);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(255, 255, "MONOCHROME1", 12, 16, false, 5);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(255, 255, "RGB", 8, 8, false, 1);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(512, 512, "RGB", 8, 8, false, 5);
+	LosslessImageTest(syntax, file);
+
+	file = CreateFile(255, 255, "YBR_FULL", 8, 8, false, 2);
+	LosslessImageTest(syntax, file);
+
+	// every interleave mode, serial and parallel frames
+	array<JpegLsInterleaveMode>^ modes = gcnew array<JpegLsInterleaveMode> {
+		JpegLsInterleaveMode::None,
+		JpegLsInterleaveMode::Line,
+		JpegLsInterleaveMode::Sample
+	};
+
+	for each (JpegLsInterleaveMode mode in modes)
+	{
+		for (int threads = 1; threads <= 2; threads++)
+		{
+			file = CreateFile(255, 200, "RGB", 8, 8, false, 3);
+			DicomFile^ saveCopy = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+
+			DicomJpegLsParameters^ parameters = gcnew DicomJpegLsParameters();
+			parameters->InterleaveMode = mode;
+			parameters->Threads = threads;
+
+			DicomJpegLsLosslessCodec^ codec = gcnew DicomJpegLsLosslessCodec();
+			file->ChangeTransferSyntax(syntax, codec, parameters);
+			file->ChangeTransferSyntax(saveCopy->TransferSyntax, codec, parameters);
+
+			String^ failureDescription;
+			bool result = Compare(DicomPixelData::CreateFrom(file), DicomPixelData::CreateFrom(saveCopy), failureDescription);
+			Assert::IsTrue(result, failureDescription);
+		}
+	}
+}
+
+void DicomJpegCodecTest::DicomJpegLsNearLosslessCodecTest()
+{
+	TransferSyntax^ syntax = TransferSyntax::JpegLsLossyNearLosslessImageCompression;
+	DicomFile^ file = CreateFile(512, 512, "MONOCHROME1", 12, 16, false, 1);
+	LossyImageTest(syntax, file);
+
+	file = CreateFile(255, 255, "MONOCHROME2", 8, 8, false, 5);
+	LossyImageTest(syntax, file);
+
+	file = CreateFile(512, 512, "RGB", 8, 8, false, 1);
+	LossyImageTest(syntax, file);
+
+	file = CreateFile(255, 255, "MONOCHROME2", 12, 16, false, 1);
+	DicomUncompressedPixelData^ original = gcnew DicomUncompressedPixelData(file);
+	array<unsigned char>^ originalFrame = original->GetFrame(0);
+
+	DicomJpegLsParameters^ parameters = gcnew DicomJpegLsParameters();
+	parameters->AllowedError = 3;
+
+	DicomJpegLsNearLosslessCodec^ codec = gcnew DicomJpegLsNearLosslessCodec();
+	file->ChangeTransferSyntax(syntax, codec, parameters);
+	file->ChangeTransferSyntax(TransferSyntax::ExplicitVrLittleEndian, codec, parameters);
+
+	// no sample may be further than NEAR from the original
+	array<unsigned char>^ decodedFrame = (gcnew DicomUncompressedPixelData(file))->GetFrame(0);
+	for (int i = 0; i < originalFrame->Length; i += 2)
+	{
+		int originalValue = originalFrame[i] | (originalFrame[i + 1] << 8);
+		int decodedValue = decodedFrame[i] | (decodedFrame[i + 1] << 8);
+		Assert::LessOrEqual(Math::Abs(originalValue - decodedValue), 3);
+	}
+}
+
 }
 }
 }
@@ -100,6 +100,33 @@ public:
 
 	[NUnit::Framework::Test]
 	void DicomJpegCodecTest::DicomJpegLossless14SV1CodecTest_8BitsStored16BitsAllocated();
+
+	[NUnit::Framework::Test]
+	void DicomJpegCodecTest::DicomJpegLossless14SV1CodecTest_RestartInterval();
+
+	[NUnit::Framework::Test]
+	void DicomJpegCodecTest::DicomJpegLossless14SV1CodecTest_HuffmanTables();
+
+	[NUnit::Framework::Test]
+	void DicomJpegCodecTest::DicomJpegProcess1CodecTest_MemoryArena();
+
+	[NUnit::Framework::Test]
+	void DicomJpegCodecTest::JpegIncrementalDecoderTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpegCodecTest::DicomJpegTranscodeTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpegCodecTest::DicomJpegRegionDecodeTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpegCodecTest::DicomJpegHeaderTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpegCodecTest::DicomJpegLsLosslessCodecTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpegCodecTest::DicomJpegLsNearLosslessCodecTest();
 };
 
 }
@@ -0,0 +1,105 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+
+#include "DicomJpegHeader.h"
+#include "JpegHeaderProbe.h"
+
+using namespace System;
+
+using namespace ClearCanvas::Dicom::Codec;
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+DicomJpegHeader^ DicomJpegHeader::Read(array<unsigned char>^ jpegData, bool countScans)
+{
+	String^ reason;
+	DicomJpegHeader^ header = Parse(jpegData, countScans, reason);
+	if (header == nullptr)
+		throw gcnew DicomCodecException("Unable to read JPEG header. Reason: " + reason);
+	return header;
+}
+
+DicomJpegHeader^ DicomJpegHeader::TryRead(array<unsigned char>^ jpegData)
+{
+	String^ reason;
+	return Parse(jpegData, false, reason);
+}
+
+int DicomJpegHeader::DecodedFrameSize::get()
+{
+	Int64 size = (Int64)_width * _height * Components * (_precision > 8 ? 2 : 1);
+	if (size > Int32::MaxValue)
+		throw gcnew DicomCodecException(String::Format("Unable to decode JPEG. Reason: Frame too large ({0} bytes)", size));
+	return (int)size;
+}
+
+DicomJpegHeader^ DicomJpegHeader::Parse(array<unsigned char>^ jpegData, bool countScans, String^% reason)
+{
+	if (jpegData == nullptr || jpegData->Length == 0) {
+		reason = "No data";
+		return nullptr;
+	}
+
+	pin_ptr<unsigned char> jpegPin = &jpegData[0];
+
+	JpegHeaderProbe probe;
+	if (!probe.Probe(jpegPin, jpegData->Length, countScans)) {
+		reason = "Invalid or truncated JPEG stream";
+		return nullptr;
+	}
+	if (probe.GetComponents() > JPEG_PROBE_MAX_COMPONENTS) {
+		reason = String::Format("Unsupported number of components ({0})", probe.GetComponents());
+		return nullptr;
+	}
+
+	DicomJpegHeader^ header = gcnew DicomJpegHeader();
+	header->_sofMarker = probe.GetSofMarker();
+	header->_precision = probe.GetPrecision();
+	header->_width = probe.GetImageWidth();
+	header->_height = probe.GetImageHeight();
+	header->_restartInterval = probe.GetRestartInterval();
+	header->_scanCount = probe.GetScanCount();
+	header->_isLossless = probe.IsLossless();
+	header->_isProgressive = probe.IsProgressive();
+	header->_isArithmetic = probe.IsArithmetic();
+	header->_isHierarchical = probe.IsHierarchical();
+
+	header->_hSampling = gcnew array<int>(probe.GetComponents());
+	header->_vSampling = gcnew array<int>(probe.GetComponents());
+	for (unsigned int c = 0; c < probe.GetComponents(); c++) {
+		header->_hSampling[c] = probe.GetComponent(c).hSampling;
+		header->_vSampling[c] = probe.GetComponent(c).vSampling;
+	}
+
+	return header;
+}
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
@@ -0,0 +1,120 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+
+#ifndef __DICOMJPEGHEADER_H__
+#define __DICOMJPEGHEADER_H__
+
+#pragma once
+
+using namespace System;
+
+using namespace ClearCanvas::Dicom;
+using namespace ClearCanvas::Dicom::Codec;
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+///<summary>
+/// Frame geometry of a JPEG stream, read directly from its marker segments.
+///</summary>
+///<remarks>
+/// The entropy coded data is not decoded, so this is cheap enough to call before choosing
+/// a codec or allocating buffers for a frame.
+///</remarks>
+public ref class DicomJpegHeader {
+public:
+	///<summary>
+	/// Reads the header of a JPEG frame up to its first scan.
+	///</summary>
+	///<exception cref="DicomCodecException">The data does not contain a valid JPEG frame header.</exception>
+	static DicomJpegHeader^ Read(array<unsigned char>^ jpegData) { return Read(jpegData, false); }
+
+	///<summary>
+	/// Reads the header of a JPEG frame, optionally skipping the entropy coded data of every scan to count the scans.
+	///</summary>
+	///<exception cref="DicomCodecException">The data does not contain a valid JPEG frame header.</exception>
+	static DicomJpegHeader^ Read(array<unsigned char>^ jpegData, bool countScans);
+
+	///<summary>
+	/// Reads the header of a JPEG frame up to its first scan, or returns null if it is not a valid JPEG frame header.
+	///</summary>
+	static DicomJpegHeader^ TryRead(array<unsigned char>^ jpegData);
+
+	///<summary>
+	/// The SOF marker code of the frame (0xC0 - 0xCF).
+	///</summary>
+	property int SofMarker { int get() { return _sofMarker; } }
+	property int Precision { int get() { return _precision; } }
+	property int ImageWidth { int get() { return _width; } }
+	property int ImageHeight { int get() { return _height; } }
+	property int Components { int get() { return _hSampling->Length; } }
+	property int RestartInterval { int get() { return _restartInterval; } }
+
+	///<summary>
+	/// The number of scans in the frame.  Always 1 unless the header was read with scan counting.
+	///</summary>
+	property int ScanCount { int get() { return _scanCount; } }
+
+	property bool IsLossless { bool get() { return _isLossless; } }
+	property bool IsProgressive { bool get() { return _isProgressive; } }
+	property bool IsArithmetic { bool get() { return _isArithmetic; } }
+	property bool IsHierarchical { bool get() { return _isHierarchical; } }
+
+	int GetHorizontalSampling(int component) { return _hSampling[component]; }
+	int GetVerticalSampling(int component) { return _vSampling[component]; }
+
+	///<summary>
+	/// The size in bytes of the frame once decoded by the IJG libraries.
+	///</summary>
+	///<exception cref="DicomCodecException">The decoded frame would not fit in an array.</exception>
+	property int DecodedFrameSize { int get(); }
+
+private:
+	DicomJpegHeader() {}
+
+	static DicomJpegHeader^ Parse(array<unsigned char>^ jpegData, bool countScans, String^% reason);
+
+	int _sofMarker;
+	int _precision;
+	int _width;
+	int _height;
+	int _restartInterval;
+	int _scanCount;
+	bool _isLossless;
+	bool _isProgressive;
+	bool _isArithmetic;
+	bool _isHierarchical;
+	array<int>^ _hSampling;
+	array<int>^ _vSampling;
+};
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
+
+#endif
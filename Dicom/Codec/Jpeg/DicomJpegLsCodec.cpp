@@ -0,0 +1,274 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#include "string.h"
+#include <vector>
+
+#include "DicomJpegLsCodec.h"
+#include "JpegLsCoder.h"
+
+using namespace System;
+using namespace System::IO;
+using namespace System::Runtime::InteropServices;
+
+using namespace ClearCanvas::Common;
+using namespace ClearCanvas::Dicom;
+using namespace ClearCanvas::Dicom::Codec;
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+	String^ DicomJpegLsCodec::Name::get()
+	{
+		return nullptr;
+	}
+	ClearCanvas::Dicom::TransferSyntax^ DicomJpegLsCodec::CodecTransferSyntax::get()
+	{
+		return nullptr;
+	}
+
+	ClearCanvas::Dicom::TransferSyntax^ DicomJpegLsLosslessCodec::CodecTransferSyntax::get()  {
+		return TransferSyntax::JpegLsLosslessImageCompression;
+	}
+	String^ DicomJpegLsLosslessCodec::Name::get()  {
+		return TransferSyntax::JpegLsLosslessImageCompression->Name;
+	}
+
+	ClearCanvas::Dicom::TransferSyntax^ DicomJpegLsNearLosslessCodec::CodecTransferSyntax::get()  {
+		return TransferSyntax::JpegLsLossyNearLosslessImageCompression;
+	}
+	String^ DicomJpegLsNearLosslessCodec::Name::get()  {
+		return TransferSyntax::JpegLsLossyNearLosslessImageCompression->Name;
+	}
+
+// Encodes or decodes a batch of frames.  The frames are independent, so the
+// batch is spread over the thread pool with Parallel::For.
+ref class JpegLsFrameCoder {
+public:
+	JpegLsFrameCoder(DicomPixelData^ pixelData, int allowedError, JpegLsInterleave interleave, int frames) {
+		_width = pixelData->ImageWidth;
+		_height = pixelData->ImageHeight;
+		_components = pixelData->SamplesPerPixel;
+		_bitsStored = pixelData->BitsStored;
+		_bytesPerSample = pixelData->BytesAllocated;
+		_planar = pixelData->IsPlanar;
+		_allowedError = allowedError;
+		_interleave = interleave;
+		Input = gcnew array<array<unsigned char>^>(frames);
+		Output = gcnew array<array<unsigned char>^>(frames);
+	}
+
+	array<array<unsigned char>^>^ Input;
+	array<array<unsigned char>^>^ Output;
+
+	void EncodeFrame(int index) {
+		array<unsigned char>^ frameArray = Input[index];
+		pin_ptr<unsigned char> framePin = &frameArray[0];
+
+		std::vector<unsigned char> encoded;
+		Check(JpegLsCoder::Encode(GetImage(framePin, frameArray->Length), _allowedError, _interleave, encoded), "compress");
+
+		// Force the output fragment/frame to be even length
+		size_t length = encoded.size();
+		array<unsigned char>^ cbuf = gcnew array<unsigned char>((int)(length + (length & 1)));
+		Marshal::Copy((IntPtr)&encoded[0], cbuf, 0, (int)length);
+		Output[index] = cbuf;
+	}
+
+	void DecodeFrame(int index) {
+		array<unsigned char>^ jpegArray = Input[index];
+		pin_ptr<unsigned char> jpegPin = &jpegArray[0];
+
+		JpegLsFrameInfo info;
+		Check(JpegLsCoder::ReadHeader(jpegPin, jpegArray->Length, info), "decompress");
+		if (info.bitsPerSample != (_bitsStored < 2 ? 2 : _bitsStored))
+			Platform::Log(LogLevel::Warn, "Bit depth in JPEG-LS data ({0}) doesn't match DICOM header bit depth ({1}).",
+							info.bitsPerSample, _bitsStored);
+
+		array<unsigned char>^ destArray = gcnew array<unsigned char>((int)(_width * _height * _components * _bytesPerSample));
+		pin_ptr<unsigned char> destPin = &destArray[0];
+		Check(JpegLsCoder::Decode(jpegPin, jpegArray->Length, GetImage(destPin, destArray->Length)), "decompress");
+		Output[index] = destArray;
+	}
+
+private:
+	JpegLsImage GetImage(unsigned char* data, size_t size) {
+		JpegLsImage image;
+		image.data = data;
+		image.size = size;
+		image.width = _width;
+		image.height = _height;
+		image.components = _components;
+		image.bitsStored = _bitsStored;
+		image.bytesPerSample = _bytesPerSample;
+		image.planar = _planar;
+		return image;
+	}
+
+	static void Check(JpegLsStatus status, String^ operation) {
+		if (status == JpegLsOk)
+			return;
+		String^ message = String::Format("Unable to {0} JPEG-LS image. Reason: {1}", operation, gcnew String(JpegLsCoder::GetStatusMessage(status)));
+		if (status == JpegLsUnsupported)
+			throw gcnew DicomCodecUnsupportedSopException(message);
+		throw gcnew DicomCodecException(message);
+	}
+
+	unsigned int _width;
+	unsigned int _height;
+	unsigned int _components;
+	unsigned int _bitsStored;
+	unsigned int _bytesPerSample;
+	bool _planar;
+	int _allowedError;
+	JpegLsInterleave _interleave;
+};
+
+static void RunFrames(Action<int>^ action, int frames) {
+	if (frames == 1) {
+		action->Invoke(0);
+		return;
+	}
+
+	try
+	{
+		System::Threading::Tasks::Parallel::For(0, frames, action);
+	}
+	catch (AggregateException^ e)
+	{
+		throw e->Flatten()->InnerExceptions[0];
+	}
+}
+
+DicomJpegLsParameters^ DicomJpegLsCodec::GetParameters(DicomCodecParameters^ parameters)
+{
+	if (parameters == nullptr)
+		return (DicomJpegLsParameters^)GetDefaultParameters();
+
+	if (parameters->GetType() != DicomJpegLsParameters::typeid)
+		throw gcnew DicomCodecException("Invalid codec parameters");
+
+	return (DicomJpegLsParameters^)parameters;
+}
+
+int DicomJpegLsCodec::GetThreadCount(DicomJpegLsParameters^ jparams, int frames)
+{
+	int threads = jparams->Threads > 0 ? jparams->Threads : Environment::ProcessorCount;
+	if (threads > frames)
+		threads = frames;
+	return threads < 1 ? 1 : threads;
+}
+
+void DicomJpegLsCodec::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomCodecParameters^ parameters)
+{
+	if ((oldPixelData->PhotometricInterpretation == "YBR_FULL_422")    ||
+		(oldPixelData->PhotometricInterpretation == "YBR_PARTIAL_422") ||
+		(oldPixelData->PhotometricInterpretation == "YBR_PARTIAL_420"))
+		throw gcnew DicomCodecUnsupportedSopException(String::Format("Photometric Interpretation '{0}' not supported by JPEG-LS encoder",
+														oldPixelData->PhotometricInterpretation));
+
+	DicomJpegLsParameters^ jparams = GetParameters(parameters);
+
+	// Convert to RGB
+	if (oldPixelData->HasPaletteColorLut && jparams->ConvertPaletteToRGB)
+	{
+		oldPixelData->ConvertPaletteColorToRgb();
+		newPixelData->HasPaletteColorLut = false;
+		newPixelData->SamplesPerPixel = oldPixelData->SamplesPerPixel;
+		newPixelData->PlanarConfiguration = oldPixelData->PlanarConfiguration;
+		newPixelData->PhotometricInterpretation = oldPixelData->PhotometricInterpretation;
+	}
+
+	if (oldPixelData->BitsStored > 16 || oldPixelData->BytesAllocated > 2 || oldPixelData->SamplesPerPixel > 4)
+		throw gcnew DicomCodecUnsupportedSopException(String::Format("Unable to create JPEG-LS codec for bits stored == {0}, samples per pixel == {1}",
+														oldPixelData->BitsStored, oldPixelData->SamplesPerPixel));
+
+	int allowedError = GetAllowedError(jparams);
+	int maxAllowedError = ((1 << oldPixelData->BitsStored) - 1) / 2;
+	if (allowedError < 0 || allowedError > 255 || allowedError > maxAllowedError)
+		throw gcnew DicomCodecException(String::Format("Invalid JPEG-LS allowed error for bits stored == {0}: {1}", oldPixelData->BitsStored, allowedError));
+
+	JpegLsInterleave interleave = (JpegLsInterleave)(int)jparams->InterleaveMode;
+	int frames = oldPixelData->NumberOfFrames;
+	int batchSize = GetThreadCount(jparams, frames);
+
+	for (int first = 0; first < frames; first += batchSize) {
+		int count = Math::Min(batchSize, frames - first);
+		JpegLsFrameCoder^ coder = gcnew JpegLsFrameCoder(oldPixelData, allowedError, interleave, count);
+		for (int i = 0; i < count; i++)
+			coder->Input[i] = oldPixelData->GetFrame(first + i);
+
+		RunFrames(gcnew Action<int>(coder, &JpegLsFrameCoder::EncodeFrame), count);
+
+		for (int i = 0; i < count; i++)
+			newPixelData->AddFrameFragment(coder->Output[i]);
+	}
+
+	if (allowedError > 0) {
+		newPixelData->LossyImageCompressionMethod = "ISO_14495_1";
+
+		double oldSize = oldPixelData->BitsStoredFrameSize;
+		double newSize = newPixelData->GetCompressedFrameSize(0);
+		newPixelData->LossyImageCompressionRatio = (float) (oldSize / newSize);
+		newPixelData->LossyImageCompression = "01";
+		newPixelData->DerivationDescription = String::Format("JPEG-LS Near Lossless Compressed: {0:0.000}:1", oldSize / newSize);
+	}
+}
+
+void DicomJpegLsCodec::Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters)
+{
+	DicomJpegLsParameters^ jparams = GetParameters(parameters);
+
+	int frames = oldPixelData->NumberOfFrames;
+	int batchSize = GetThreadCount(jparams, frames);
+
+	for (int first = 0; first < frames; first += batchSize) {
+		int count = Math::Min(batchSize, frames - first);
+		JpegLsFrameCoder^ coder = gcnew JpegLsFrameCoder(oldPixelData, 0, JpegLsInterleaveNone, count);
+		for (int i = 0; i < count; i++)
+			coder->Input[i] = oldPixelData->GetFrameFragmentData(first + i);
+
+		RunFrames(gcnew Action<int>(coder, &JpegLsFrameCoder::DecodeFrame), count);
+
+		for (int i = 0; i < count; i++)
+			newPixelData->AppendFrame(coder->Output[i]);
+	}
+}
+
+void DicomJpegLsCodec::DecodeFrame(int frame, DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters)
+{
+	GetParameters(parameters);
+
+	JpegLsFrameCoder^ coder = gcnew JpegLsFrameCoder(oldPixelData, 0, JpegLsInterleaveNone, 1);
+	coder->Input[0] = oldPixelData->GetFrameFragmentData(frame);
+	coder->DecodeFrame(0);
+	newPixelData->AppendFrame(coder->Output[0]);
+}
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
@@ -0,0 +1,102 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#ifndef __DICOMJPEGLSCODEC_H__
+#define __DICOMJPEGLSCODEC_H__
+
+#pragma once
+
+using namespace System;
+using namespace System::IO;
+
+using namespace ClearCanvas::Dicom;
+using namespace ClearCanvas::Dicom::Codec;
+
+#include "DicomJpegParameters.h"
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+// JPEG-LS (ISO/IEC 14495-1) codec, implemented by the native JpegLsCoder rather
+// than the IJG libraries.  The frames of a multi-frame image are coded in parallel.
+public ref class DicomJpegLsCodec abstract : public IDicomCodec {
+public:
+	virtual property String^ Name { String^ get(); };
+	virtual property ClearCanvas::Dicom::TransferSyntax^ CodecTransferSyntax { ClearCanvas::Dicom::TransferSyntax^ get(); };
+
+	virtual DicomCodecParameters^ GetDefaultParameters() = 0;
+
+	virtual void Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomCodecParameters^ parameters);
+	virtual void Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters);
+	virtual void DecodeFrame(int frame, DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters);
+
+protected:
+	// The NEAR value to encode with; always 0 for the lossless transfer syntax
+	virtual int GetAllowedError(DicomJpegLsParameters^ jparams) = 0;
+
+private:
+	DicomJpegLsParameters^ GetParameters(DicomCodecParameters^ parameters);
+	int GetThreadCount(DicomJpegLsParameters^ jparams, int frames);
+};
+
+public ref class DicomJpegLsLosslessCodec : public DicomJpegLsCodec {
+public:
+	property String^ Name { virtual String^ get() override;}
+	property ClearCanvas::Dicom::TransferSyntax^ CodecTransferSyntax { virtual ClearCanvas::Dicom::TransferSyntax^ get() override; };
+
+	virtual DicomCodecParameters^ GetDefaultParameters() override {
+		return gcnew DicomJpegLsParameters();
+	}
+
+protected:
+	virtual int GetAllowedError(DicomJpegLsParameters^ jparams) override {
+		return 0;
+	}
+};
+
+public ref class DicomJpegLsNearLosslessCodec : public DicomJpegLsCodec {
+public:
+	property String^ Name { virtual String^ get() override;}
+	property ClearCanvas::Dicom::TransferSyntax^ CodecTransferSyntax { virtual ClearCanvas::Dicom::TransferSyntax^ get() override; };
+
+	virtual DicomCodecParameters^ GetDefaultParameters() override {
+		DicomJpegLsParameters^ jparams = gcnew DicomJpegLsParameters();
+		jparams->AllowedError = 2;
+		return jparams;
+	}
+
+protected:
+	virtual int GetAllowedError(DicomJpegLsParameters^ jparams) override {
+		return jparams->AllowedError;
+	}
+};
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
+
+#endif
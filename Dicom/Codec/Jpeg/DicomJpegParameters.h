@@ -73,6 +73,16 @@ public enum class JpegSampleFactor {
 	Unknown
 };
 
+public enum class JpegLosslessHuffmanTables {
+	Optimized,
+	FirstFrame
+};
+
+public enum class JpegTranscodeHuffmanTables {
+	Optimized,
+	Standard
+};
+
 public ref class DicomJpegParameters : public DicomCodecParameters {
 private:
 	int _quality;
@@ -81,6 +91,11 @@ private:
 	JpegSampleFactor _sample;
 	int _predictor;
 	int _pointTransform;
+	int _restartInterval;
+	int _decodeThreads;
+	JpegLosslessHuffmanTables _losslessTables;
+	JpegTranscodeHuffmanTables _transcodeTables;
+	int _arenaLimit;
 
 public:
 	DicomJpegParameters() {
@@ -90,6 +105,11 @@ public:
 		_sample = JpegSampleFactor::SF444;
 		_predictor = 1;
 		_pointTransform = 0;
+		_restartInterval = 0;
+		_decodeThreads = 0;
+		_losslessTables = JpegLosslessHuffmanTables::Optimized;
+		_transcodeTables = JpegTranscodeHuffmanTables::Optimized;
+		_arenaLimit = 8 * 1024 * 1024;
 	}
 
 	///<summary>
@@ -130,6 +150,103 @@ public:
 		int get() { return _pointTransform; }
 		void set(int value) { _pointTransform = value; }
 	}
+
+	///<summary>
+	/// The restart interval, in MCU rows, written by the encoder.  Default is 0 (no restart markers).
+	/// Frames with restart markers on MCU row boundaries can be decoded in parallel bands.
+	///</summary>
+	property int RestartInterval {
+		int get() { return _restartInterval; }
+		void set(int value) { _restartInterval = value; }
+	}
+
+	///<summary>
+	/// The maximum number of threads used to decode a single frame containing restart markers.
+	/// Default is 0 (one per processor); 1 disables parallel decoding.
+	///</summary>
+	property int DecodeThreads {
+		int get() { return _decodeThreads; }
+		void set(int value) { _decodeThreads = value; }
+	}
+
+	///<summary>
+	/// How the Huffman tables for lossless compression are chosen.  Optimized (the default) gathers
+	/// statistics for each frame and encodes it in a second pass.  FirstFrame optimizes the first frame
+	/// and encodes the remaining frames in a single pass with its tables.
+	///</summary>
+	property JpegLosslessHuffmanTables LosslessHuffmanTables {
+		JpegLosslessHuffmanTables get() { return _losslessTables; }
+		void set(JpegLosslessHuffmanTables value) { _losslessTables = value; }
+	}
+
+	///<summary>
+	/// How the Huffman tables of transcoded frames are chosen.  Optimized (the default) gathers
+	/// statistics for each frame and writes it in a second pass.  Standard writes sequential 8-bit
+	/// frames in a single pass with the tables of Annex K, which is faster but gives larger frames;
+	/// progressive output and 12-bit frames are always optimized.
+	///</summary>
+	property JpegTranscodeHuffmanTables TranscodeHuffmanTables {
+		JpegTranscodeHuffmanTables get() { return _transcodeTables; }
+		void set(JpegTranscodeHuffmanTables value) { _transcodeTables = value; }
+	}
+
+	///<summary>
+	/// The most memory, in bytes, each thread keeps between frames for the IJG library to reuse.
+	/// Pool threads keep it for as long as they live, so it is sized for the pools and row buffers
+	/// of typical frames; larger whole-image buffers come from the process heap.  Default is 8 MB;
+	/// 0 allocates every frame's memory from the process heap and releases the thread's arena.
+	///</summary>
+	property int ArenaLimit {
+		int get() { return _arenaLimit; }
+		void set(int value) { _arenaLimit = value; }
+	}
+};
+
+public enum class JpegLsInterleaveMode {
+	None,
+	Line,
+	Sample
+};
+
+public ref class DicomJpegLsParameters : public DicomCodecParameters {
+private:
+	int _allowedError;
+	JpegLsInterleaveMode _interleave;
+	int _threads;
+
+public:
+	DicomJpegLsParameters() {
+		_allowedError = 0;
+		_interleave = JpegLsInterleaveMode::Line;
+		_threads = 0;
+	}
+
+	///<summary>
+	/// The maximum absolute difference between an original and a decoded sample (NEAR).
+	/// Default is 0 (lossless).  Ignored by the JPEG-LS Lossless codec.
+	///</summary>
+	property int AllowedError {
+		int get() { return _allowedError; }
+		void set(int value) { _allowedError = value; }
+	}
+
+	///<summary>
+	/// How the components of colour images are interleaved in the scans.  Default is Line.
+	/// Single component images always use a single non-interleaved scan.
+	///</summary>
+	property JpegLsInterleaveMode InterleaveMode {
+		JpegLsInterleaveMode get() { return _interleave; }
+		void set(JpegLsInterleaveMode value) { _interleave = value; }
+	}
+
+	///<summary>
+	/// The maximum number of frames of a multi-frame image encoded or decoded at the same time.
+	/// Default is 0 (one per processor); 1 codes the frames one after the other.
+	///</summary>
+	property int Threads {
+		int get() { return _threads; }
+		void set(int value) { _threads = value; }
+	}
 };
 
 } // Jpeg
@@ -59,9 +59,12 @@ using namespace ClearCanvas::Dicom;
 using namespace ClearCanvas::Dicom::Iod;
 
 #include "JpegCodec.h"
+#include "JpegRestartIndex.h"
 
 #define IJGVERS IJG12
 #define JPEGCODEC Jpeg12Codec
+#define JPEGDECODER Jpeg12IncrementalDecoder
+#define JPEGSTATE Jpeg12IncrementalState
 
 namespace ClearCanvas {
 namespace Dicom {
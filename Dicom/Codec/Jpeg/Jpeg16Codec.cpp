@@ -33,9 +33,12 @@ using namespace ClearCanvas::Dicom;
 using namespace ClearCanvas::Dicom::Iod;
 
 #include "JpegCodec.h"
+#include "JpegRestartIndex.h"
 
 #define IJGVERS IJG16
 #define JPEGCODEC Jpeg16Codec
+#define JPEGDECODER Jpeg16IncrementalDecoder
+#define JPEGSTATE Jpeg16IncrementalState
 
 namespace ClearCanvas {
 namespace Dicom {
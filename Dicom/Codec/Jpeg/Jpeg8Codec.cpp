@@ -60,9 +60,12 @@ using namespace ClearCanvas::Dicom;
 using namespace ClearCanvas::Dicom::Iod;
 
 #include "JpegCodec.h"
+#include "JpegRestartIndex.h"
 
 #define IJGVERS IJG8
 #define JPEGCODEC Jpeg8Codec
+#define JPEGDECODER Jpeg8IncrementalDecoder
+#define JPEGSTATE Jpeg8IncrementalState
 
 namespace ClearCanvas {
 namespace Dicom {
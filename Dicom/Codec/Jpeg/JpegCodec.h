@@ -62,6 +62,7 @@ using namespace ClearCanvas::Dicom::Codec;
 using namespace ClearCanvas::Dicom;
 
 #include "DicomJpegParameters.h"
+#include "JpegMemoryArena.h"
 
 namespace ClearCanvas {
 namespace Dicom {
@@ -81,6 +82,21 @@ public:
 	virtual void Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) abstract;
 	virtual void Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) abstract;
 
+	// Rewrites a DCT-based frame in this codec's mode from its quantized coefficients, without decoding
+	// it to samples, so the image is unchanged.  The Huffman tables are re-optimized, and restart markers
+	// are inserted as for Encode.
+	virtual void Transcode(DicomCompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) abstract;
+
+	// Decodes only the rectangle [x, x + width) by [y, y + height) of a frame, as interleaved rows in the
+	// same layout as Decode.  Rows above the region are entropy decoded without the IDCT, or skipped
+	// outright when restart markers allow it, and only the iMCU columns that intersect the region are
+	// reconstructed and colour converted.
+	virtual array<unsigned char>^ DecodeRegion(DicomCompressedPixelData^ oldPixelData, DicomJpegParameters^ params, int frame,
+		int x, int y, int width, int height) abstract;
+
+	// Memory the IJG library requested during the last Encode or Decode call
+	property JpegMemoryStatistics MemoryStatistics { JpegMemoryStatistics get() { return LastMemoryStatistics; } }
+
 internal:
 	MemoryStream^ MemoryBuffer;
 	array<unsigned char>^ DataBuffer;
@@ -89,6 +105,11 @@ internal:
 	JpegMode Mode;
 	int Predictor;
 	int PointTransform;
+
+	// Huffman table frequencies learned from the first frame, for JpegLosslessHuffmanTables::FirstFrame
+	array<int>^ LosslessFrequencies;
+
+	JpegMemoryStatistics LastMemoryStatistics;
 };
 
 public ref class Jpeg16Codec : public IJpegCodec {
@@ -96,6 +117,9 @@ public:
 	Jpeg16Codec(JpegMode mode, int predictor, int point_transform);
 	virtual void Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) override;
 	virtual void Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) override;
+	virtual void Transcode(DicomCompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) override;
+	virtual array<unsigned char>^ DecodeRegion(DicomCompressedPixelData^ oldPixelData, DicomJpegParameters^ params, int frame,
+		int x, int y, int width, int height) override;
 
 internal:
 	[ThreadStatic]
@@ -107,6 +131,9 @@ public:
 	Jpeg12Codec(JpegMode mode, int predictor, int point_transform);
 	virtual void Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) override;
 	virtual void Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) override;
+	virtual void Transcode(DicomCompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) override;
+	virtual array<unsigned char>^ DecodeRegion(DicomCompressedPixelData^ oldPixelData, DicomJpegParameters^ params, int frame,
+		int x, int y, int width, int height) override;
 
 internal:
 	[ThreadStatic]
@@ -118,12 +145,144 @@ public:
 	Jpeg8Codec(JpegMode mode, int predictor, int point_transform);
 	virtual void Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) override;
 	virtual void Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) override;
+	virtual void Transcode(DicomCompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) override;
+	virtual array<unsigned char>^ DecodeRegion(DicomCompressedPixelData^ oldPixelData, DicomJpegParameters^ params, int frame,
+		int x, int y, int width, int height) override;
 
 internal:
 	[ThreadStatic]
 	static Jpeg8Codec^ This;
 };
 
+// Native decoder state of the JpegNIncrementalDecoder classes, defined in JpegCodec.i
+struct Jpeg16IncrementalState;
+struct Jpeg12IncrementalState;
+struct Jpeg8IncrementalState;
+
+// Decodes one JPEG frame from compressed data that arrives in pieces, such as a frame streamed to a
+// remote viewer, so that a usable image is available long before the last byte.
+//
+// Each call to Decode uses the data received so far and returns without waiting for more.  A
+// progressive (or other multi-scan) frame is decoded in IJG's buffered-image mode: Image is redrawn
+// at full size from the scans received so far, and gets sharper with every scan.  A single-scan
+// frame is decoded from the top down, and RowsDecoded tells how many rows of Image are valid.
+//
+// Unlike the codecs, the decoder does not use the per-thread memory arenas, so successive calls may
+// come from different threads.  Calls must not overlap.
+public ref class JpegIncrementalDecoder abstract {
+public:
+	// Creates a decoder for a frame with the given sample precision (the P field of its SOF marker)
+	static JpegIncrementalDecoder^ Create(int precision, DicomJpegParameters^ params);
+
+	// Appends the next piece of the compressed frame
+	virtual void AddData(array<unsigned char>^ data, int offset, int count) abstract;
+
+	// Signals that no more data will arrive.  The next Decode then completes the frame, filling in
+	// whatever is missing from a truncated stream.
+	virtual void EndOfData() abstract;
+
+	// Decodes as much as the data received allows.  Returns true if Image has changed.
+	virtual bool Decode() abstract;
+
+	// Divides the output width and height by 1, 2, 4 or 8, for a faster preview of a lossy frame.
+	// Lossless frames are always decoded at full size.  Must be set before the header is read.
+	property int ScaleDenominator {
+		int get() { return _scaleDenominator; }
+		void set(int value) {
+			if (value != 1 && value != 2 && value != 4 && value != 8)
+				throw gcnew ArgumentOutOfRangeException("value");
+			if (_headerRead)
+				throw gcnew InvalidOperationException("The scale must be set before the JPEG header is decoded");
+			_scaleDenominator = value;
+		}
+	}
+
+	// True once the frame header has been decoded and Image allocated
+	property bool HeaderRead { bool get() { return _headerRead; } }
+
+	// True once the whole frame has been decoded
+	property bool IsComplete { bool get() { return _complete; } }
+
+	property int Width { int get() { return _width; } }
+	property int Height { int get() { return _height; } }
+	property int Components { int get() { return _components; } }
+
+	// Number of scans reflected in Image; 1 for a single-scan frame once it is complete
+	property int ScansDecoded { int get() { return _scansDecoded; } }
+
+	// Number of rows of Image, from the top, that hold decoded samples
+	property int RowsDecoded { int get() { return _rowsDecoded; } }
+
+	// The decoded samples, interleaved by pixel, in 1 or 2 byte little endian words as
+	// for the uncompressed frames produced by the codecs
+	property array<unsigned char>^ Image { array<unsigned char>^ get() { return _image; } }
+
+internal:
+	JpegIncrementalDecoder(DicomJpegParameters^ params) {
+		_params = params;
+		_scaleDenominator = 1;
+	}
+
+	DicomJpegParameters^ _params;
+	int _scaleDenominator;
+	bool _headerRead;
+	bool _started;
+	bool _endOfData;
+	bool _inputComplete;
+	bool _complete;
+	int _width;
+	int _height;
+	int _components;
+	int _scansDecoded;
+	int _rowsDecoded;
+	array<unsigned char>^ _image;
+};
+
+public ref class Jpeg16IncrementalDecoder : public JpegIncrementalDecoder {
+public:
+	Jpeg16IncrementalDecoder(DicomJpegParameters^ params);
+	~Jpeg16IncrementalDecoder();
+	!Jpeg16IncrementalDecoder();
+	virtual void AddData(array<unsigned char>^ data, int offset, int count) override;
+	virtual void EndOfData() override;
+	virtual bool Decode() override;
+
+private:
+	bool decodeScans();
+	bool decodeRows();
+	Jpeg16IncrementalState *_state;
+};
+
+public ref class Jpeg12IncrementalDecoder : public JpegIncrementalDecoder {
+public:
+	Jpeg12IncrementalDecoder(DicomJpegParameters^ params);
+	~Jpeg12IncrementalDecoder();
+	!Jpeg12IncrementalDecoder();
+	virtual void AddData(array<unsigned char>^ data, int offset, int count) override;
+	virtual void EndOfData() override;
+	virtual bool Decode() override;
+
+private:
+	bool decodeScans();
+	bool decodeRows();
+	Jpeg12IncrementalState *_state;
+};
+
+public ref class Jpeg8IncrementalDecoder : public JpegIncrementalDecoder {
+public:
+	Jpeg8IncrementalDecoder(DicomJpegParameters^ params);
+	~Jpeg8IncrementalDecoder();
+	!Jpeg8IncrementalDecoder();
+	virtual void AddData(array<unsigned char>^ data, int offset, int count) override;
+	virtual void EndOfData() override;
+	virtual bool Decode() override;
+
+private:
+	bool decodeScans();
+	bool decodeRows();
+	Jpeg8IncrementalState *_state;
+};
+
 } // Jpeg
 } // Codec
 } // Dicom
@@ -1,5 +1,17 @@
 #define IJGE_BLOCKSIZE 16384
 
+// number of rows repacked and passed to jpeg_write_scanlines at a time
+#define IJGE_STRIP_ROWS 16
+
+// number of difference categories coded by the lossless Huffman tables
+#define IJGE_DIFF_CATEGORIES 17
+
+// minimum number of rows in each band of a frame decoded in parallel
+#define IJGE_MIN_BAND_ROWS 128
+
+// memory for the tables and control structures of an IJG object, beyond its sample and coefficient buffers
+#define IJGE_ARENA_OVERHEAD 65536
+
 namespace IJGVERS {
 	// private error handler struct
 	struct ErrorStruct {
@@ -25,6 +37,61 @@ namespace IJGVERS {
 		//Console::WriteLine(gcnew String(buffer));
 		Platform::Log(LogLevel::Info, "IJG: {0}", gcnew String(buffer));
 	}
+
+	// private arena manager struct
+	struct ArenaManagerStruct {
+		// the standard IJG arena object
+		struct jpeg_arena_mgr pub;
+
+		// the calling thread's arena, or NULL if arenas are disabled
+		JpegMemoryArena *arena;
+
+		// arena totals when the object was attached, to count the requests of this object alone
+		JpegArenaStatistics start;
+	};
+
+	// arena callbacks, called by the native memory manager for every pool
+#pragma managed(push, off)
+	void *getArenaMemory(jpeg_arena_mgr *mgr, size_t sizeofobject) {
+		return ((ArenaManagerStruct *)mgr)->arena->Allocate(sizeofobject);
+	}
+
+	void freeArenaMemory(jpeg_arena_mgr *mgr, void *object, size_t sizeofobject) {
+		((ArenaManagerStruct *)mgr)->arena->Free(object, sizeofobject);
+	}
+#pragma managed(pop)
+
+	// A guess at the memory an IJG object needs for a frame, used to size the arena before its first frame.
+	// Multi-pass coding buffers the whole image as coefficients (DCT) or samples (lossless); otherwise
+	// only a few MCU rows are held at a time.
+	size_t estimateWorkingSet(int width, int height, int components, JpegMode mode, bool wholeImage) {
+		size_t size = IJGE_ARENA_OVERHEAD + 4 * DCTSIZE * (size_t)width * components * sizeof(JSAMPLE);
+		if (wholeImage)
+			size += (size_t)width * height * components * (mode == JpegMode::Lossless ? sizeof(JSAMPLE) : sizeof(JCOEF));
+		return size;
+	}
+
+	// Makes a JPEG object that has just been created draw the rest of its memory from the calling thread's
+	// arena.  Does nothing when arenas are disabled.
+	void attachArena(j_common_ptr cinfo, ArenaManagerStruct *mgr, DicomJpegParameters^ params, size_t workingSet) {
+		memset(mgr, 0, sizeof(ArenaManagerStruct));
+		mgr->arena = JpegThreadArena::Get(params->ArenaLimit);
+		if (mgr->arena == NULL)
+			return;
+
+		mgr->pub.get_mem = getArenaMemory;
+		mgr->pub.free_mem = freeArenaMemory;
+		mgr->arena->Reserve(workingSet);
+		mgr->start = mgr->arena->GetStatistics();
+		jpeg_attach_arena(cinfo, &mgr->pub);
+	}
+
+	// requests made through the arena since attachArena; zero if arenas are disabled
+	JpegMemoryStatistics getArenaStatistics(ArenaManagerStruct *mgr) {
+		if (mgr->arena == NULL)
+			return JpegMemoryStatistics();
+		return JpegMemoryStatistics(mgr->start, mgr->arena->GetStatistics());
+	}
 }
 
 
@@ -72,6 +139,66 @@ namespace IJGVERS {
 		thisPtr->DataBuffer = nullptr;
 	}
 
+	// Conversion of signed samples to unsigned ones, as DicomUncompressedPixelData::TogglePixelRepresentation
+	// does it: the stored bits are sign extended, right aligned, and offset by 2^(BitsStored-1).
+	struct SignConversion {
+		int signShift;
+		int rightAlignShift;
+		int rescale;
+	};
+
+	// Sets up the conversion for the frame and returns the offset it adds to every sample.
+	int initSignConversion(SignConversion *sign, DicomUncompressedPixelData^ pixelData) {
+		if ((pixelData->BitsAllocated != 8 && pixelData->BitsAllocated != 16) || pixelData->BitsStored > pixelData->BitsAllocated)
+			throw gcnew DicomCodecUnsupportedSopException("Invalid bits allocated/stored value(s).");
+		if (pixelData->HighBit >= pixelData->BitsAllocated || pixelData->HighBit < pixelData->BitsStored - 1)
+			throw gcnew ArgumentException(String::Format("Invalid high bit for {0}-bit pixel data ({1}).", pixelData->BitsAllocated, pixelData->HighBit));
+
+		sign->signShift = pixelData->BitsAllocated - 1 - pixelData->HighBit;
+		sign->rightAlignShift = pixelData->BitsAllocated - pixelData->BitsStored;
+		sign->rescale = 1 << (pixelData->BitsStored - 1);
+		return sign->rescale;
+	}
+
+	// Copies one row of a frame into a row of JSAMPLEs, interleaving the samples of a planar frame,
+	// converting signed samples if sign is given, and narrowing the 16 bit words of 8 bit samples
+	// to their low byte, as DicomUncompressedPixelData::ToggleBitDepth does.
+#pragma managed(push, off)
+	void packRow(JSAMPROW dest, const unsigned char *frame, unsigned int row, unsigned int width, unsigned int height,
+				int samplesPerPixel, int bytesAllocated, bool planar, const SignConversion *sign) {
+		size_t pixels = (size_t)width * height;
+		for (int s = 0; s < samplesPerPixel; s++) {
+			// index of the row's first sample of component s, and the distance between its samples
+			size_t first = planar ? s * pixels + (size_t)row * width : (size_t)row * width * samplesPerPixel + s;
+			size_t step = planar ? 1 : samplesPerPixel;
+
+			JSAMPROW out = dest + s;
+			if (bytesAllocated == 1) {
+				const unsigned char *in = frame + first;
+				if (sign == NULL) {
+					for (unsigned int x = 0; x < width; x++, in += step, out += samplesPerPixel)
+						*out = (JSAMPLE) *in;
+				}
+				else {
+					for (unsigned int x = 0; x < width; x++, in += step, out += samplesPerPixel)
+						*out = (JSAMPLE) ((((signed char) (*in << sign->signShift)) >> sign->rightAlignShift) + sign->rescale);
+				}
+			}
+			else {
+				const unsigned short *in = (const unsigned short *)frame + first;
+				if (sign == NULL) {
+					for (unsigned int x = 0; x < width; x++, in += step, out += samplesPerPixel)
+						*out = (JSAMPLE) *in;
+				}
+				else {
+					for (unsigned int x = 0; x < width; x++, in += step, out += samplesPerPixel)
+						*out = (JSAMPLE) ((((short) (*in << sign->signShift)) >> sign->rightAlignShift) + sign->rescale);
+				}
+			}
+		}
+	}
+#pragma managed(pop)
+
 	// Borrowed from DCMTK djeijgXX.cxx
 	/*
 	 * jpeg_simple_spectral_selection() creates a scan script
@@ -204,11 +331,54 @@ namespace IJGVERS {
 			}
 		}
 	}
+
+	// Records the lossless Huffman tables chosen for a frame as pseudo-frequencies:
+	// a code of length l stands for a frequency of 2^(16-l).
+	array<int>^ getLosslessFrequencies(j_compress_ptr cinfo) {
+		array<int>^ frequencies = gcnew array<int>(NUM_HUFF_TBLS * IJGE_DIFF_CATEGORIES);
+		for (int tbl = 0; tbl < NUM_HUFF_TBLS; tbl++) {
+			JHUFF_TBL* htbl = cinfo->dc_huff_tbl_ptrs[tbl];
+			if (htbl == NULL)
+				continue;
+			int p = 0;
+			for (int l = 1; l <= 16; l++) {
+				for (int i = 0; i < htbl->bits[l]; i++, p++) {
+					if (htbl->huffval[p] < IJGE_DIFF_CATEGORIES)
+						frequencies[tbl * IJGE_DIFF_CATEGORIES + htbl->huffval[p]] = 1 << (16 - l);
+				}
+			}
+		}
+		return frequencies;
+	}
+
+	// Reinstates tables recorded by getLosslessFrequencies; categories the recorded frame
+	// did not use still get a (long) code, so any frame can be coded with them.
+	void setLosslessFrequencies(j_compress_ptr cinfo, array<int>^ frequencies) {
+		long freq[IJGE_DIFF_CATEGORIES];
+		for (int ci = 0; ci < cinfo->num_components; ci++) {
+			int tbl = cinfo->comp_info[ci].dc_tbl_no;
+			for (int c = 0; c < IJGE_DIFF_CATEGORIES; c++)
+				freq[c] = frequencies[tbl * IJGE_DIFF_CATEGORIES + c];
+			jpeg_lossless_huff_table(cinfo, tbl, freq);
+		}
+		cinfo->optimize_coding = false;
+	}
+
+	// restart markers on MCU row boundaries let the decoder split the frame into bands;
+	// the interval is stored in 16 bits, so it must stay a whole number of MCU rows below 65536 MCUs
+	void setRestartInterval(j_compress_ptr cinfo, DicomJpegParameters^ params, bool lossless) {
+		if (params->RestartInterval > 0) {
+			int mcusPerRow = lossless ? cinfo->image_width : (cinfo->image_width + DCTSIZE - 1) / DCTSIZE;
+			cinfo->restart_in_rows = Math::Min(params->RestartInterval, 65535 / mcusPerRow);
+		}
+	}
 }
 
 void JPEGCODEC::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) 
 {
 	struct jpeg_compress_struct cinfo;
+	IJGVERS::ArenaManagerStruct arenaMgr;
+	memset(&arenaMgr, 0, sizeof(arenaMgr));
 	bool cleanupRequired = false;
 	try{
 		if ((oldPixelData->PhotometricInterpretation == "YBR_ICT")      ||
@@ -223,6 +393,8 @@ void JPEGCODEC::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressed
 		pin_ptr<unsigned char> framePin = &frameData[0];
 		unsigned char* framePtr = framePin;
 		unsigned int frameSize = frameData->Length;
+		if (frameSize < (unsigned int)oldPixelData->UncompressedFrameSize)
+			throw gcnew DicomCodecException(String::Format("Frame {0} is shorter than the image it describes", frame));
 
 		DataBuffer = gcnew array<unsigned char>(IJGE_BLOCKSIZE);
 		pin_ptr<unsigned char> DataPin = &DataBuffer[0];
@@ -230,12 +402,14 @@ void JPEGCODEC::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressed
 	
 		
 	
-		if (oldPixelData->IsPlanar && oldPixelData->SamplesPerPixel > 1) {
+		// planar frames are interleaved as they are compressed
+		bool planar = oldPixelData->IsPlanar && oldPixelData->SamplesPerPixel > 1;
+		if (planar)
 			newPixelData->PlanarConfiguration = 0;
-			DicomUncompressedPixelData::TogglePlanarConfiguration(frameData, frameData->Length / oldPixelData->BytesAllocated, 
-				oldPixelData->BitsAllocated, oldPixelData->SamplesPerPixel, 1);
-		}
 		
+		// signed samples are made unsigned as they are compressed
+		IJGVERS::SignConversion sign;
+		bool convertSign = false;
 		if (oldPixelData->IsSigned) {
 			if (oldPixelData->HasDataModalityLut)
 				throw gcnew DicomCodecUnsupportedSopException("JPEG compression not supported when modality LUT exists for pixel data");
@@ -245,8 +419,8 @@ void JPEGCODEC::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressed
 			    if (oldPixelData->SopClass->Uid->Equals(Dicom::SopClass::MrImageStorageUid)
 			        && !oldPixelData->HasDataVoiLuts)
 				{
-					int rescaleAmount;
-					DicomUncompressedPixelData::TogglePixelRepresentation(frameData, oldPixelData->HighBit, oldPixelData->BitsStored, oldPixelData->BitsAllocated, rescaleAmount);
+					int rescaleAmount = IJGVERS::initSignConversion(&sign, oldPixelData);
+					convertSign = true;
 					newPixelData->PixelRepresentation = 0;
 					if (oldPixelData->HasLinearVoiLuts)
 					{
@@ -263,8 +437,8 @@ void JPEGCODEC::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressed
 			}
 			else
 			{		
-				int rescaleAmount;
-				DicomUncompressedPixelData::TogglePixelRepresentation(frameData, oldPixelData->HighBit, oldPixelData->BitsStored, oldPixelData->BitsAllocated, rescaleAmount);
+				int rescaleAmount = IJGVERS::initSignConversion(&sign, oldPixelData);
+				convertSign = true;
 				newPixelData->DecimalRescaleIntercept -= rescaleAmount;
 				newPixelData->PixelRepresentation = 0;
 			}
@@ -275,10 +449,17 @@ void JPEGCODEC::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressed
 		cinfo.err = jpeg_std_error(&jerr.pub);
 		jerr.pub.error_exit = IJGVERS::ErrorExit;
 		jerr.pub.output_message = IJGVERS::OutputMessage;
+
+		bool wholeImage = Mode != JpegMode::Lossless
+			|| params->LosslessHuffmanTables == JpegLosslessHuffmanTables::Optimized
+			|| (params->LosslessHuffmanTables == JpegLosslessHuffmanTables::FirstFrame && LosslessFrequencies == nullptr);
 	
 		jpeg_create_compress(&cinfo);
 		cleanupRequired = true;
 
+		IJGVERS::attachArena((j_common_ptr)&cinfo, &arenaMgr, params, IJGVERS::estimateWorkingSet(oldPixelData->ImageWidth,
+			oldPixelData->ImageHeight, oldPixelData->SamplesPerPixel, Mode, wholeImage));
+
 		cinfo.client_data = nullptr;
 		
 		JPEGCODEC::This = this;
@@ -317,6 +498,8 @@ void JPEGCODEC::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressed
 		
 		cinfo.smoothing_factor = params->SmoothingFactor;	
 
+		IJGVERS::setRestartInterval(&cinfo, params, Mode == JpegMode::Lossless);
+
 		if (Mode == JpegMode::Lossless) {
 			jpeg_set_colorspace(&cinfo, cinfo.in_color_space);
 			cinfo.comp_info[0].h_samp_factor = 1;
@@ -355,34 +538,52 @@ void JPEGCODEC::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressed
 			cinfo.comp_info[sfi].v_samp_factor = 1;
 		}
 
-		jpeg_start_compress(&cinfo, TRUE);
-
-		if (oldPixelData->BitsAllocated == 16 && oldPixelData->BitsStored == 8)
-		{
-		    array<unsigned char>^ toggledFrameData = DicomUncompressedPixelData::ToggleBitDepth(frameData,frameData->Length, oldPixelData->UncompressedFrameSize, oldPixelData->BitsStored, oldPixelData->BitsAllocated);
-			pin_ptr<unsigned char> toggledFramePin = &toggledFrameData[0];
-		    unsigned char* toggledFramePtr = toggledFramePin;
-			unsigned int toggledFrameSize = toggledFrameData->Length;
-			JSAMPROW row_pointer[1];
-			int row_stride = oldPixelData->ImageWidth * oldPixelData->SamplesPerPixel;
-
-			while (cinfo.next_scanline < cinfo.image_height) {
-				row_pointer[0] = (JSAMPLE *)(&toggledFramePtr[cinfo.next_scanline * row_stride]);
-				jpeg_write_scanlines(&cinfo, row_pointer, 1);
+		// single-pass lossless: install fixed tables instead of gathering statistics for every frame
+		bool learnTables = false;
+		if (Mode == JpegMode::Lossless) {
+			if (params->LosslessHuffmanTables == JpegLosslessHuffmanTables::FirstFrame) {
+				if (LosslessFrequencies != nullptr)
+					IJGVERS::setLosslessFrequencies(&cinfo, LosslessFrequencies);
+				else
+					learnTables = true;
 			}
 		}
-		else
-		{
-		JSAMPROW row_pointer[1];
-		int row_stride = oldPixelData->ImageWidth * oldPixelData->SamplesPerPixel * oldPixelData->BytesAllocated;
+
+		jpeg_start_compress(&cinfo, TRUE);
+
+		// Rows are handed to the library in place when the frame already holds interleaved, unsigned JSAMPLEs.
+		// Otherwise (planar frames, signed samples, and 8 bit samples in 16 bit words) a strip of rows at a
+		// time is repacked into a small buffer, rather than converting the whole frame first.
+		int width = oldPixelData->ImageWidth;
+		int samplesPerPixel = oldPixelData->SamplesPerPixel;
+		int bytesAllocated = oldPixelData->BytesAllocated;
+		bool repack = planar || convertSign || bytesAllocated != sizeof(JSAMPLE);
+		std::vector<JSAMPLE> strip;
+		if (repack)
+			strip.resize((size_t)width * samplesPerPixel * IJGE_STRIP_ROWS);
+
+		size_t row_stride = (size_t)width * samplesPerPixel * bytesAllocated;
+		JSAMPROW row_pointer[IJGE_STRIP_ROWS];
 
 		while (cinfo.next_scanline < cinfo.image_height) {
-			row_pointer[0] = (JSAMPLE *)(&framePtr[cinfo.next_scanline * row_stride]);
-			jpeg_write_scanlines(&cinfo, row_pointer, 1);
-		}
+			unsigned int rows = Math::Min((unsigned int)IJGE_STRIP_ROWS, cinfo.image_height - cinfo.next_scanline);
+			for (unsigned int r = 0; r < rows; r++) {
+				unsigned int row = cinfo.next_scanline + r;
+				if (repack) {
+					row_pointer[r] = &strip[(size_t)r * width * samplesPerPixel];
+					IJGVERS::packRow(row_pointer[r], framePtr, row, width, cinfo.image_height, samplesPerPixel, bytesAllocated, planar,
+						convertSign ? &sign : NULL);
+				}
+				else
+					row_pointer[r] = (JSAMPLE *)(&framePtr[row * row_stride]);
+			}
+			jpeg_write_scanlines(&cinfo, row_pointer, rows);
 		}
 
 		jpeg_finish_compress(&cinfo);
+
+		if (learnTables)
+			LosslessFrequencies = IJGVERS::getLosslessFrequencies(&cinfo);
 		
 		if ((MemoryBuffer->Length %2 ) == 1)
 			MemoryBuffer->WriteByte(0);
@@ -397,6 +598,7 @@ void JPEGCODEC::Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressed
 		MemoryBuffer = nullptr;
 		if (cleanupRequired)
 			jpeg_destroy_compress(&cinfo);
+		LastMemoryStatistics = IJGVERS::getArenaStatistics(&arenaMgr);
     }	
 }
 
@@ -471,6 +673,171 @@ namespace IJGVERS {
 
 	void termSource(j_decompress_ptr /* cinfo */) {
 	}
+
+	// attach the in-memory source manager to dinfo, with jpegPtr as its first buffer (NULL to start out empty)
+	void attachSource(j_decompress_ptr dinfo, SourceManagerStruct *src, unsigned char *jpegPtr, size_t jpegSize) {
+		memset(src, 0, sizeof(SourceManagerStruct));
+		src->pub.init_source       = initSource;
+		src->pub.fill_input_buffer = fillInputBuffer;
+		src->pub.skip_input_data   = skipInputData;
+		src->pub.resync_to_restart = jpeg_resync_to_restart;
+		src->pub.term_source       = termSource;
+		src->pub.bytes_in_buffer   = 0;
+		src->pub.next_input_byte   = NULL;
+		src->skip_bytes            = 0;
+		src->next_buffer           = jpegPtr;
+		src->next_buffer_size      = (unsigned int*)jpegSize;
+
+		dinfo->src = (jpeg_source_mgr*)&src->pub;
+	}
+
+	// select the output colour space of a decompressor whose header has been read
+	void selectColorSpace(j_decompress_ptr dinfo, bool convertYBRtoRGB, bool isSigned) {
+		if (convertYBRtoRGB) {
+			if (dinfo->out_color_space == JCS_YCbCr || dinfo->out_color_space == JCS_RGB)
+			{
+				if (isSigned)
+					throw gcnew DicomCodecException(gcnew String("JPEG codec unable to perform colorspace conversion on signed pixel data"));
+				dinfo->out_color_space = JCS_RGB;
+			}
+		}
+		else 
+		{
+  				dinfo->jpeg_color_space = JCS_UNKNOWN;
+				dinfo->out_color_space = JCS_UNKNOWN;
+		}
+	}
+
+	// attach the in-memory source manager to dinfo, read the JPEG header and select the output colour space
+	void readHeader(j_decompress_ptr dinfo, SourceManagerStruct *src, unsigned char *jpegPtr, size_t jpegSize, bool convertYBRtoRGB, bool isSigned) {
+		attachSource(dinfo, src, jpegPtr, jpegSize);
+
+		if (jpeg_read_header(dinfo, TRUE) == JPEG_SUSPENDED)
+			throw gcnew DicomCodecException(gcnew String("Unable to decompress JPEG. Reason: Suspended"));
+
+		selectColorSpace(dinfo, convertYBRtoRGB, isSigned);
+     
+		jpeg_calc_output_dimensions(dinfo);
+	}
+
+	// Decodes one band of restart intervals of a frame straight into its rows of the output frame.
+	// Each band is a standalone JPEG stream, so the bands can be decoded concurrently.
+	ref class RestartBandDecoder {
+	public:
+		RestartBandDecoder(const JpegRestartIndex *index, unsigned int intervalsPerBand, unsigned int bands, unsigned char *dest, size_t destSize,
+							DicomJpegParameters^ params, bool isSigned) {
+			_index = index;
+			_intervalsPerBand = intervalsPerBand;
+			_dest = dest;
+			_destSize = destSize;
+			_params = params;
+			_isSigned = isSigned;
+			BandMemoryStatistics = gcnew array<JpegMemoryStatistics>(bands);
+		}
+
+		array<JpegMemoryStatistics>^ BandMemoryStatistics;
+
+		void DecodeBand(int band) {
+			unsigned int firstInterval = band * _intervalsPerBand;
+			unsigned int intervalCount = _intervalsPerBand;
+			if (firstInterval + intervalCount > _index->GetIntervalCount())
+				intervalCount = _index->GetIntervalCount() - firstInterval;
+
+			std::vector<unsigned char> bandData;
+			unsigned int firstRow;
+			unsigned int rowCount;
+			_index->BuildBand(firstInterval, intervalCount, bandData, firstRow, rowCount);
+
+			bool cleanupRequired = false;
+			jpeg_decompress_struct dinfo;
+			ArenaManagerStruct arenaMgr;
+			memset(&arenaMgr, 0, sizeof(arenaMgr));
+			try
+			{
+				memset(&dinfo, 0, sizeof(dinfo));
+
+				ErrorStruct jerr;
+				memset(&jerr, 0, sizeof(ErrorStruct));
+				dinfo.err = jpeg_std_error(&jerr.pub);
+				jerr.pub.error_exit = ErrorExit;
+				jerr.pub.output_message = OutputMessage;
+
+				jpeg_create_decompress(&dinfo);
+				cleanupRequired = true;
+
+				attachArena((j_common_ptr)&dinfo, &arenaMgr, _params, estimateWorkingSet(_index->GetImageWidth(), rowCount,
+					_index->GetComponents(), JpegMode::Sequential, false));
+
+				SourceManagerStruct src;
+				readHeader(&dinfo, &src, &bandData[0], bandData.size(), _params->ConvertYBRtoRGB, _isSigned);
+
+				size_t rowsize = dinfo.output_width * dinfo.output_components * sizeof(JSAMPLE);
+				if (dinfo.output_height != rowCount || (firstRow + rowCount) * rowsize > _destSize)
+					throw gcnew DicomCodecException(gcnew String("Unable to decompress JPEG. Reason: Restart interval band does not match frame"));
+
+				jpeg_start_decompress(&dinfo);
+
+				unsigned char* rowptr = _dest + firstRow * rowsize;
+				while (dinfo.output_scanline < dinfo.output_height) {
+					jpeg_read_scanlines(&dinfo, (JSAMPARRAY)&rowptr, 1);
+					rowptr += rowsize;
+				}
+			}
+			finally {
+				if (cleanupRequired)
+					jpeg_destroy_decompress(&dinfo);
+				BandMemoryStatistics[band] = getArenaStatistics(&arenaMgr);
+			}
+		}
+
+	private:
+		const JpegRestartIndex *_index;
+		unsigned int _intervalsPerBand;
+		unsigned char *_dest;
+		size_t _destSize;
+		DicomJpegParameters^ _params;
+		bool _isSigned;
+	};
+
+	// Decodes the frame in parallel bands if it has restart markers that allow it.  Returns nullptr otherwise.
+	array<unsigned char>^ decodeRestartBands(unsigned char *jpegPtr, size_t jpegSize, DicomJpegParameters^ params, bool isSigned,
+											JpegMemoryStatistics% memoryStatistics) {
+		if (params->DecodeThreads == 1)
+			return nullptr;
+
+		JpegRestartIndex index;
+		if (!index.Build(jpegPtr, jpegSize))
+			return nullptr;
+
+		unsigned int bands = params->DecodeThreads > 0 ? params->DecodeThreads : Environment::ProcessorCount;
+		if (bands > index.GetIntervalCount())
+			bands = index.GetIntervalCount();
+		if (bands > index.GetImageHeight() / IJGE_MIN_BAND_ROWS)
+			bands = index.GetImageHeight() / IJGE_MIN_BAND_ROWS;
+		if (bands < 2)
+			return nullptr;
+
+		unsigned int intervalsPerBand = (index.GetIntervalCount() + bands - 1) / bands;
+		bands = (index.GetIntervalCount() + intervalsPerBand - 1) / intervalsPerBand;
+
+		size_t outsize = (size_t)index.GetImageWidth() * index.GetImageHeight() * index.GetComponents() * sizeof(JSAMPLE);
+		array<unsigned char>^ frameData = gcnew array<unsigned char>((int)outsize);
+		pin_ptr<unsigned char> framePin = &frameData[0];
+
+		RestartBandDecoder^ decoder = gcnew RestartBandDecoder(&index, intervalsPerBand, bands, framePin, outsize, params, isSigned);
+		try
+		{
+			System::Threading::Tasks::Parallel::For(0, (int)bands, gcnew Action<int>(decoder, &RestartBandDecoder::DecodeBand));
+		}
+		catch (AggregateException^ e)
+		{
+			throw e->Flatten()->InnerExceptions[0];
+		}
+
+		for each (JpegMemoryStatistics bandStatistics in decoder->BandMemoryStatistics)
+			memoryStatistics = memoryStatistics + bandStatistics;
+		return frameData;
+	}
 }
 
 void JPEGCODEC::Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) {
@@ -478,6 +845,9 @@ void JPEGCODEC::Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressed
           
 	bool cleanupRequired = false;
 	jpeg_decompress_struct dinfo;
+	IJGVERS::ArenaManagerStruct arenaMgr;
+	memset(&arenaMgr, 0, sizeof(arenaMgr));
+	LastMemoryStatistics = JpegMemoryStatistics();
 	
 	try
 	{
@@ -485,22 +855,15 @@ void JPEGCODEC::Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressed
 		pin_ptr<unsigned char> jpegPin = &jpegData[0];
 		unsigned char* jpegPtr = jpegPin;
 		size_t jpegSize = jpegData->Length;
+
+		array<unsigned char>^ bandedFrame = IJGVERS::decodeRestartBands(jpegPtr, jpegSize, params, oldPixelData->IsSigned, LastMemoryStatistics);
+		if (bandedFrame != nullptr) {
+			newPixelData->AppendFrame(bandedFrame);
+			return;
+		}
 	
 		memset(&dinfo, 0, sizeof(dinfo));
 
-		IJGVERS::SourceManagerStruct src;
-		memset(&src, 0, sizeof(IJGVERS::SourceManagerStruct));
-		src.pub.init_source       = IJGVERS::initSource;
-		src.pub.fill_input_buffer = IJGVERS::fillInputBuffer;
-		src.pub.skip_input_data   = IJGVERS::skipInputData;
-		src.pub.resync_to_restart = jpeg_resync_to_restart;
-		src.pub.term_source       = IJGVERS::termSource;
-		src.pub.bytes_in_buffer   = 0;
-		src.pub.next_input_byte   = NULL;
-		src.skip_bytes            = 0;
-		src.next_buffer           = jpegPin;
-		src.next_buffer_size      = (unsigned int*)jpegSize;
-
 		IJGVERS::ErrorStruct jerr;
 		memset(&jerr, 0, sizeof(IJGVERS::ErrorStruct));
 		dinfo.err = jpeg_std_error(&jerr.pub);
@@ -510,26 +873,11 @@ void JPEGCODEC::Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressed
 		jpeg_create_decompress(&dinfo);
 		cleanupRequired = true;
 
-		dinfo.src = (jpeg_source_mgr*)&src.pub;
-
-		if (jpeg_read_header(&dinfo, TRUE) == JPEG_SUSPENDED)
-			throw gcnew DicomCodecException(gcnew String("Unable to decompress JPEG. Reason: Suspended"));
+		IJGVERS::attachArena((j_common_ptr)&dinfo, &arenaMgr, params, IJGVERS::estimateWorkingSet(oldPixelData->ImageWidth,
+			oldPixelData->ImageHeight, oldPixelData->SamplesPerPixel, Mode, Mode == JpegMode::Progressive));
 
-		if (params->ConvertYBRtoRGB) {
-			if (dinfo.out_color_space == JCS_YCbCr || dinfo.out_color_space == JCS_RGB)
-			{
-				if (oldPixelData->IsSigned)
-					throw gcnew DicomCodecException(gcnew String("JPEG codec unable to perform colorspace conversion on signed pixel data"));
-				dinfo.out_color_space = JCS_RGB;
-			}
-		}
-		else 
-		{
-  				dinfo.jpeg_color_space = JCS_UNKNOWN;
-				dinfo.out_color_space = JCS_UNKNOWN;
-		}
-     
-		jpeg_calc_output_dimensions(&dinfo);
+		IJGVERS::SourceManagerStruct src;
+		IJGVERS::readHeader(&dinfo, &src, jpegPtr, jpegSize, params->ConvertYBRtoRGB, oldPixelData->IsSigned);
 
 		int bufsize = dinfo.output_width * dinfo.output_components;
 		size_t rowsize = bufsize * sizeof(JSAMPLE);
@@ -555,8 +903,406 @@ void JPEGCODEC::Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressed
 		throw;
 	}
 	finally {
-		if (cleanupRequired)
+		if (cleanupRequired) {
 			jpeg_destroy_decompress(&dinfo);
+			LastMemoryStatistics = IJGVERS::getArenaStatistics(&arenaMgr);
+		}
     }	
 	
 }
+
+array<unsigned char>^ JPEGCODEC::DecodeRegion(DicomCompressedPixelData^ oldPixelData, DicomJpegParameters^ params, int frame,
+	int x, int y, int width, int height) {
+	if (x < 0 || width <= 0 || x + width > oldPixelData->ImageWidth)
+		throw gcnew ArgumentOutOfRangeException("width");
+	if (y < 0 || height <= 0 || y + height > oldPixelData->ImageHeight)
+		throw gcnew ArgumentOutOfRangeException("height");
+
+	bool cleanupRequired = false;
+	jpeg_decompress_struct dinfo;
+	IJGVERS::ArenaManagerStruct arenaMgr;
+	memset(&arenaMgr, 0, sizeof(arenaMgr));
+	LastMemoryStatistics = JpegMemoryStatistics();
+
+	try
+	{
+		array<unsigned char>^ jpegData = oldPixelData->GetFrameFragmentData(frame);
+		pin_ptr<unsigned char> jpegPin = &jpegData[0];
+		unsigned char* jpegPtr = jpegPin;
+		size_t jpegSize = jpegData->Length;
+
+		// With whole-row restart intervals, only the intervals that cover the region need to be
+		// entropy decoded at all; otherwise every row above the region still has to be.
+		std::vector<unsigned char> bandData;
+		unsigned int streamFirstRow = 0;
+		JpegRestartIndex index;
+		if (index.Build(jpegPtr, jpegSize) && index.GetRowsPerInterval() > 0) {
+			unsigned int firstInterval = y / index.GetRowsPerInterval();
+			unsigned int lastInterval = (y + height - 1) / index.GetRowsPerInterval();
+			if (lastInterval >= index.GetIntervalCount())
+				lastInterval = index.GetIntervalCount() - 1;
+
+			unsigned int rowCount;
+			index.BuildBand(firstInterval, lastInterval - firstInterval + 1, bandData, streamFirstRow, rowCount);
+			jpegPtr = &bandData[0];
+			jpegSize = bandData.size();
+		}
+
+		memset(&dinfo, 0, sizeof(dinfo));
+
+		IJGVERS::ErrorStruct jerr;
+		memset(&jerr, 0, sizeof(IJGVERS::ErrorStruct));
+		dinfo.err = jpeg_std_error(&jerr.pub);
+		jerr.pub.error_exit = IJGVERS::ErrorExit;
+		jerr.pub.output_message = IJGVERS::OutputMessage;
+
+		jpeg_create_decompress(&dinfo);
+		cleanupRequired = true;
+
+		IJGVERS::attachArena((j_common_ptr)&dinfo, &arenaMgr, params, IJGVERS::estimateWorkingSet(oldPixelData->ImageWidth,
+			oldPixelData->ImageHeight, oldPixelData->SamplesPerPixel, Mode, Mode == JpegMode::Progressive));
+
+		IJGVERS::SourceManagerStruct src;
+		IJGVERS::readHeader(&dinfo, &src, jpegPtr, jpegSize, params->ConvertYBRtoRGB, oldPixelData->IsSigned);
+
+		if (streamFirstRow + dinfo.output_height < (unsigned int)(y + height) || dinfo.output_width < (unsigned int)(x + width))
+			throw gcnew DicomCodecException(gcnew String("Unable to decompress JPEG. Reason: Region is outside the frame"));
+
+		int components = dinfo.output_components;
+		array<unsigned char>^ rowbuf = gcnew array<unsigned char>(dinfo.output_width * components * sizeof(JSAMPLE));
+		pin_ptr<unsigned char> rowpin = &rowbuf[0];
+		unsigned char* rowptr = rowpin;
+
+		jpeg_start_decompress(&dinfo);
+
+		// Keep one sample of context on either side, so that fancy upsampling of the edge
+		// columns sees the same neighbours as in a full decode.  The library widens the
+		// window further to whole iMCU columns.
+		JDIMENSION cropX = x > 0 ? x - 1 : 0;
+		JDIMENSION cropWidth = Math::Min((JDIMENSION)(x + width + 1), dinfo.output_width) - cropX;
+		jpeg_crop_scanline(&dinfo, &cropX, &cropWidth);
+
+		jpeg_skip_scanlines(&dinfo, y - streamFirstRow);
+
+		size_t regionRowSize = width * components * sizeof(JSAMPLE);
+		array<unsigned char>^ region = gcnew array<unsigned char>((int)(regionRowSize * height));
+		int regionOffset = (int)((x - cropX) * components * sizeof(JSAMPLE));
+		for (int row = 0; row < height; row++) {
+			jpeg_read_scanlines(&dinfo, (JSAMPARRAY)&rowptr, 1);
+			Buffer::BlockCopy(rowbuf, regionOffset, region, (int)(row * regionRowSize), (int)regionRowSize);
+		}
+
+		// the rest of the frame is never read, so the decompressor is destroyed without finishing
+		return region;
+	}
+	catch(DicomException^ e){
+		Console::WriteLine(e->Message);
+		throw;
+	}
+	finally {
+		if (cleanupRequired) {
+			jpeg_destroy_decompress(&dinfo);
+			LastMemoryStatistics = IJGVERS::getArenaStatistics(&arenaMgr);
+		}
+	}
+}
+
+void JPEGCODEC::Transcode(DicomCompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomJpegParameters^ params, int frame) {
+	if (Mode == JpegMode::Lossless)
+		throw gcnew DicomCodecUnsupportedSopException("JPEG transcoding is only possible between DCT-based processes");
+
+	bool decompressCreated = false;
+	bool compressCreated = false;
+	jpeg_decompress_struct dinfo;
+	jpeg_compress_struct cinfo;
+	IJGVERS::ArenaManagerStruct arenaMgr;
+	memset(&arenaMgr, 0, sizeof(arenaMgr));
+	LastMemoryStatistics = JpegMemoryStatistics();
+
+	try
+	{
+		array<unsigned char>^ jpegData = oldPixelData->GetFrameFragmentData(frame);
+		pin_ptr<unsigned char> jpegPin = &jpegData[0];
+
+		memset(&dinfo, 0, sizeof(dinfo));
+		memset(&cinfo, 0, sizeof(cinfo));
+
+		IJGVERS::ErrorStruct jerr;
+		memset(&jerr, 0, sizeof(IJGVERS::ErrorStruct));
+		dinfo.err = jpeg_std_error(&jerr.pub);
+		jerr.pub.error_exit = IJGVERS::ErrorExit;
+		jerr.pub.output_message = IJGVERS::OutputMessage;
+		cinfo.err = dinfo.err;
+
+		jpeg_create_decompress(&dinfo);
+		decompressCreated = true;
+		jpeg_create_compress(&cinfo);
+		compressCreated = true;
+
+		// the compressor writes straight from the decompressor's coefficient arrays, so both objects
+		// share one arena, sized for the whole image in coefficients
+		IJGVERS::attachArena((j_common_ptr)&dinfo, &arenaMgr, params, IJGVERS::estimateWorkingSet(oldPixelData->ImageWidth,
+			oldPixelData->ImageHeight, oldPixelData->SamplesPerPixel, JpegMode::Progressive, true));
+		jpeg_attach_arena((j_common_ptr)&cinfo, dinfo.arena);
+
+		IJGVERS::SourceManagerStruct src;
+		IJGVERS::attachSource(&dinfo, &src, jpegPin, jpegData->Length);
+		if (jpeg_read_header(&dinfo, TRUE) == JPEG_SUSPENDED)
+			throw gcnew DicomCodecException(gcnew String("Unable to transcode JPEG. Reason: Suspended"));
+		if (dinfo.process == JPROC_LOSSLESS)
+			throw gcnew DicomCodecUnsupportedSopException("Unable to transcode lossless JPEG");
+
+		// the quantized coefficients of the whole frame; nothing is dequantized, so the
+		// transcoded frame decodes to exactly the same samples
+		jvirt_barray_ptr *coefficients = jpeg_read_coefficients(&dinfo);
+
+		JPEGCODEC::This = this;
+		DataBuffer = gcnew array<unsigned char>(IJGE_BLOCKSIZE);
+		pin_ptr<unsigned char> DataPin = &DataBuffer[0];
+		DataPtr = DataPin;
+
+		jpeg_destination_mgr dest;
+		dest.init_destination = IJGVERS::initDestination;
+		dest.empty_output_buffer = IJGVERS::emptyOutputBuffer;
+		dest.term_destination = IJGVERS::termDestination;
+		cinfo.dest = &dest;
+
+		// quantization tables, sampling and dimensions come from the source and the scan script
+		// follows the codec's mode.  The standard Huffman tables that jpeg_copy_critical_parameters
+		// installs can code any 8-bit frame, so with them a sequential frame is written in one pass;
+		// wider coefficients need optimized tables, and the library optimizes progressive scans itself.
+		jpeg_copy_critical_parameters(&dinfo, &cinfo);
+		cinfo.optimize_coding = params->TranscodeHuffmanTables == JpegTranscodeHuffmanTables::Optimized
+			|| dinfo.data_precision != 8;
+		if (Mode == JpegMode::SpectralSelection)
+			IJGVERS::jpeg_simple_spectral_selection(&cinfo);
+		else if (Mode == JpegMode::Progressive)
+			jpeg_simple_progression(&cinfo);
+
+		IJGVERS::setRestartInterval(&cinfo, params, false);
+
+		jpeg_write_coefficients(&cinfo, coefficients);
+		jpeg_finish_compress(&cinfo);
+		jpeg_finish_decompress(&dinfo);
+
+		if ((MemoryBuffer->Length %2 ) == 1)
+			MemoryBuffer->WriteByte(0);
+
+		newPixelData->AddFrameFragment(MemoryBuffer->ToArray());
+	}
+	catch(DicomException^ e){
+		Console::WriteLine(e->Message);
+		throw;
+	}
+	finally {
+		MemoryBuffer = nullptr;
+		if (compressCreated)
+			jpeg_destroy_compress(&cinfo);
+		if (decompressCreated)
+			jpeg_destroy_decompress(&dinfo);
+		LastMemoryStatistics = IJGVERS::getArenaStatistics(&arenaMgr);
+	}
+}
+
+// Incremental decoding.  The compressed data received so far is kept in a buffer that the suspending
+// source manager reads from; whenever the library runs out of data it suspends, and Decode returns
+// to wait for the next AddData.
+struct JPEGSTATE {
+	jpeg_decompress_struct dinfo;
+	IJGVERS::ErrorStruct jerr;
+	IJGVERS::SourceManagerStruct src;
+
+	// data received and not yet consumed by the library, which reads it through src
+	std::vector<unsigned char> data;
+};
+
+JPEGDECODER::JPEGDECODER(DicomJpegParameters^ params) : JpegIncrementalDecoder(params) {
+	JPEGSTATE *state = new JPEGSTATE();
+	try
+	{
+		memset(&state->dinfo, 0, sizeof(state->dinfo));
+		memset(&state->jerr, 0, sizeof(IJGVERS::ErrorStruct));
+		state->dinfo.err = jpeg_std_error(&state->jerr.pub);
+		state->jerr.pub.error_exit = IJGVERS::ErrorExit;
+		state->jerr.pub.output_message = IJGVERS::OutputMessage;
+
+		// the calls may come from different threads, so no per-thread arena is attached
+		jpeg_create_decompress(&state->dinfo);
+	}
+	catch (Exception^)
+	{
+		delete state;
+		throw;
+	}
+
+	IJGVERS::attachSource(&state->dinfo, &state->src, NULL, 0);
+	_state = state;
+}
+
+JPEGDECODER::~JPEGDECODER() {
+	this->!JPEGDECODER();
+}
+
+JPEGDECODER::!JPEGDECODER() {
+	if (_state != NULL) {
+		jpeg_destroy_decompress(&_state->dinfo);
+		delete _state;
+		_state = NULL;
+	}
+}
+
+void JPEGDECODER::AddData(array<unsigned char>^ data, int offset, int count) {
+	if (_state == NULL)
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	if (_endOfData)
+		throw gcnew InvalidOperationException("Data added after the end of the JPEG stream");
+	if (count == 0)
+		return;
+
+	// drop what the library has finished with, then append; the library holds no pointers into
+	// the buffer besides the source manager's, which are set again below
+	std::vector<unsigned char>& buffer = _state->data;
+	jpeg_source_mgr& pub = _state->src.pub;
+	buffer.erase(buffer.begin(), buffer.end() - pub.bytes_in_buffer);
+
+	size_t used = buffer.size();
+	buffer.resize(used + count);
+	Marshal::Copy(data, offset, (IntPtr)&buffer[used], count);
+
+	// finish a skip that ran past the end of the data received earlier
+	size_t skip = _state->src.skip_bytes;
+	if (skip > buffer.size())
+		skip = buffer.size();
+	_state->src.skip_bytes -= (long)skip;
+
+	pub.next_input_byte = &buffer[skip];
+	pub.bytes_in_buffer = buffer.size() - skip;
+}
+
+void JPEGDECODER::EndOfData() {
+	if (_endOfData)
+		return;
+
+	// an EOI marker ends a truncated stream; the library fills in the rest of the frame
+	// with a warning.  It is never reached if the stream was complete.
+	array<unsigned char>^ eoi = { 0xFF, JPEG_EOI };
+	AddData(eoi, 0, eoi->Length);
+	_endOfData = true;
+}
+
+bool JPEGDECODER::Decode() {
+	if (_state == NULL)
+		throw gcnew ObjectDisposedException(GetType()->Name);
+	if (_complete)
+		return false;
+
+	jpeg_decompress_struct *dinfo = &_state->dinfo;
+
+	if (!_headerRead) {
+		if (jpeg_read_header(dinfo, TRUE) == JPEG_SUSPENDED)
+			return false;
+
+		IJGVERS::selectColorSpace(dinfo, _params->ConvertYBRtoRGB, false);
+		dinfo->buffered_image = jpeg_has_multiple_scans(dinfo);
+		dinfo->scale_num = 1;
+		dinfo->scale_denom = _scaleDenominator;
+		jpeg_calc_output_dimensions(dinfo);
+
+		_width = dinfo->output_width;
+		_height = dinfo->output_height;
+		_components = dinfo->output_components;
+		_image = gcnew array<unsigned char>((int)((size_t)_width * _height * _components * sizeof(JSAMPLE)));
+		_headerRead = true;
+	}
+
+	if (!_started) {
+		if (!jpeg_start_decompress(dinfo))
+			return false;
+		_started = true;
+	}
+
+	return dinfo->buffered_image ? decodeScans() : decodeRows();
+}
+
+// Decodes the rows of a single-scan frame as their data arrives
+bool JPEGDECODER::decodeRows() {
+	jpeg_decompress_struct *dinfo = &_state->dinfo;
+	unsigned int firstRow = dinfo->output_scanline;
+
+	if (dinfo->output_scanline < dinfo->output_height) {
+		size_t rowsize = dinfo->output_width * dinfo->output_components * sizeof(JSAMPLE);
+		pin_ptr<unsigned char> imagePin = &_image[0];
+
+		JSAMPROW row_pointer[IJGE_STRIP_ROWS];
+		while (dinfo->output_scanline < dinfo->output_height) {
+			unsigned int rows = dinfo->output_height - dinfo->output_scanline;
+			if (rows > IJGE_STRIP_ROWS)
+				rows = IJGE_STRIP_ROWS;
+			for (unsigned int r = 0; r < rows; r++)
+				row_pointer[r] = (JSAMPROW)(imagePin + (dinfo->output_scanline + r) * rowsize);
+
+			if (jpeg_read_scanlines(dinfo, row_pointer, rows) == 0)
+				break;
+		}
+		_rowsDecoded = dinfo->output_scanline;
+	}
+
+	// reading up to the EOI marker may suspend as well
+	if (dinfo->output_scanline == dinfo->output_height && jpeg_finish_decompress(dinfo)) {
+		_scansDecoded = 1;
+		_complete = true;
+	}
+
+	return dinfo->output_scanline > firstRow;
+}
+
+// Reads the scans of a multi-scan frame as their data arrives, and redraws the image when a scan
+// has been received in full.  Only complete scans are drawn, so an output pass never has to wait for
+// data: the library stops at the start of the next scan, or at the EOI marker after the last one.
+bool JPEGDECODER::decodeScans() {
+	jpeg_decompress_struct *dinfo = &_state->dinfo;
+	int lastScan = _scansDecoded;
+
+	while (!_inputComplete) {
+		int status = jpeg_consume_input(dinfo);
+		if (status == JPEG_SUSPENDED)
+			break;
+		if (status == JPEG_REACHED_SOS)
+			lastScan = dinfo->input_scan_number - 1;
+		else if (status == JPEG_REACHED_EOI) {
+			lastScan = dinfo->input_scan_number;
+			_inputComplete = true;
+		}
+	}
+
+	bool updated = false;
+	if (lastScan > _scansDecoded) {
+		jpeg_start_output(dinfo, lastScan);
+
+		size_t rowsize = dinfo->output_width * dinfo->output_components * sizeof(JSAMPLE);
+		pin_ptr<unsigned char> imagePin = &_image[0];
+
+		JSAMPROW row_pointer[IJGE_STRIP_ROWS];
+		while (dinfo->output_scanline < dinfo->output_height) {
+			unsigned int rows = dinfo->output_height - dinfo->output_scanline;
+			if (rows > IJGE_STRIP_ROWS)
+				rows = IJGE_STRIP_ROWS;
+			for (unsigned int r = 0; r < rows; r++)
+				row_pointer[r] = (JSAMPROW)(imagePin + (dinfo->output_scanline + r) * rowsize);
+
+			jpeg_read_scanlines(dinfo, row_pointer, rows);
+		}
+
+		jpeg_finish_output(dinfo);
+		_scansDecoded = lastScan;
+		_rowsDecoded = dinfo->output_height;
+		updated = true;
+	}
+
+	if (_inputComplete) {
+		jpeg_finish_decompress(dinfo);
+		_complete = true;
+	}
+
+	return updated;
+}
@@ -0,0 +1,186 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+
+#include "string.h"
+
+#include "JpegHeaderProbe.h"
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+static unsigned int readUint16(const unsigned char *data)
+{
+	return (((unsigned int)data[0]) << 8) | ((unsigned int)data[1]);
+}
+
+JpegHeaderProbe::JpegHeaderProbe()
+{
+	_sofMarker = 0;
+	_precision = 0;
+	_width = 0;
+	_height = 0;
+	_components = 0;
+	memset(_component, 0, sizeof(_component));
+	_restartInterval = 0;
+	_scanCount = 0;
+	_firstScanComponents = 0;
+	_sofOffset = 0;
+	_entropyOffset = 0;
+}
+
+unsigned char JpegHeaderProbe::GetMaxHSampling() const
+{
+	unsigned char max = 1;
+	for (unsigned int c = 0; c < _components && c < JPEG_PROBE_MAX_COMPONENTS; c++)
+		if (_component[c].hSampling > max)
+			max = _component[c].hSampling;
+	return max;
+}
+
+unsigned char JpegHeaderProbe::GetMaxVSampling() const
+{
+	unsigned char max = 1;
+	for (unsigned int c = 0; c < _components && c < JPEG_PROBE_MAX_COMPONENTS; c++)
+		if (_component[c].vSampling > max)
+			max = _component[c].vSampling;
+	return max;
+}
+
+bool JpegHeaderProbe::IsHierarchical() const
+{
+	unsigned char process = _sofMarker & 0x0F;
+	return (process >= 5 && process <= 7) || process >= 13;
+}
+
+bool JpegHeaderProbe::Probe(const unsigned char* data, size_t length, bool countScans)
+{
+	_sofMarker = 0;
+	_restartInterval = 0;
+	_scanCount = 0;
+
+	if (length < 4 || data[0] != 0xFF || data[1] != 0xD8)
+		return false;
+
+	size_t offset = 2;
+	for (;;) {
+		if (offset + 2 > length)
+			return countScans && _scanCount > 0; // no EOI; accept what we have
+		if (data[offset] != 0xFF)
+			return false;
+		// skip any fill bytes preceding the marker
+		while (offset + 2 < length && data[offset + 1] == 0xFF)
+			offset++;
+
+		unsigned char marker = data[offset + 1];
+		if (marker == 0xD9) // EOI
+			return _scanCount > 0;
+		if (marker == 0xD8 || marker == 0x01 || marker == 0x00 || (marker >= 0xD0 && marker <= 0xD7))
+			return false; // not expected between marker segments
+
+		if (offset + 4 > length)
+			return false;
+		unsigned int segmentLength = readUint16(data + offset + 2);
+		if (segmentLength < 2 || offset + 2 + segmentLength > length)
+			return false;
+		const unsigned char* segment = data + offset + 4;
+
+		if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+			// SOFn: precision, lines, samples per line, components, then 3 bytes per component
+			if (_sofMarker != 0 || segmentLength < 8)
+				return false;
+			_sofMarker = marker;
+			_sofOffset = offset;
+			_precision = segment[0];
+			_height = readUint16(segment + 1);
+			_width = readUint16(segment + 3);
+			_components = segment[5];
+			if (_components == 0 || segmentLength < 8 + 3 * _components)
+				return false;
+			for (unsigned int c = 0; c < _components && c < JPEG_PROBE_MAX_COMPONENTS; c++) {
+				_component[c].id = segment[6 + 3 * c];
+				_component[c].hSampling = segment[7 + 3 * c] >> 4;
+				_component[c].vSampling = segment[7 + 3 * c] & 0x0F;
+				_component[c].quantTable = segment[8 + 3 * c];
+			}
+		}
+		else if (marker == 0xDD) {
+			// DRI
+			if (segmentLength < 4)
+				return false;
+			_restartInterval = readUint16(segment);
+		}
+		else if (marker == 0xDC) {
+			// DNL: only valid after the first scan, defines the number of lines
+			if (segmentLength < 4 || _scanCount == 0)
+				return false;
+			if (_height == 0)
+				_height = readUint16(segment);
+		}
+		else if (marker == 0xDA) {
+			// SOS
+			if (_sofMarker == 0 || segmentLength < 3)
+				return false;
+			if (_scanCount == 0) {
+				_firstScanComponents = segment[0];
+				_entropyOffset = offset + 2 + segmentLength;
+			}
+			_scanCount++;
+			if (!countScans)
+				return true;
+
+			// skip the entropy coded segment: only a marker other than RSTn ends it
+			size_t position = offset + 2 + segmentLength;
+			for (;;) {
+				const unsigned char* found = (const unsigned char*) memchr(data + position, 0xFF, length - position);
+				if (found == NULL)
+					return true; // truncated after the scan data
+				position = found - data;
+				size_t next = position + 1;
+				while (next < length && data[next] == 0xFF)
+					next++;
+				if (next >= length)
+					return true;
+				if (data[next] == 0x00 || (data[next] >= 0xD0 && data[next] <= 0xD7)) {
+					position = next + 1;
+					continue;
+				}
+				// back up to the last fill byte so the marker parser sees 0xFF, code
+				position = next - 1;
+				break;
+			}
+			offset = position;
+			continue;
+		}
+
+		offset += 2 + segmentLength;
+	}
+}
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
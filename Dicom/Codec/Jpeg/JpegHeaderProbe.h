@@ -0,0 +1,103 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+
+#ifndef __JPEGHEADERPROBE_H__
+#define __JPEGHEADERPROBE_H__
+
+#pragma once
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+// the IJG libraries support at most 4 components per frame
+#define JPEG_PROBE_MAX_COMPONENTS 4
+
+struct JpegComponentInfo {
+	unsigned char id;
+	unsigned char hSampling;
+	unsigned char vSampling;
+	unsigned char quantTable;
+};
+
+// Reads the frame geometry of a JPEG stream straight from its marker segments,
+// without setting up an IJG decompressor.  Every length is checked against the
+// end of the buffer, so truncated or corrupt streams fail the probe rather than
+// reading out of bounds.
+class JpegHeaderProbe {
+public:
+	JpegHeaderProbe();
+
+	// Parses the stream up to the first SOS.  If countScans is true, the entropy
+	// coded data of every scan is skipped (by looking for its terminating marker
+	// only) so the number of scans and a DNL-defined height can be reported.
+	// Returns false if the stream has no frame header or is malformed.
+	bool Probe(const unsigned char* data, size_t length, bool countScans);
+
+	// SOF marker code (0xC0 - 0xCF, excluding DHT, JPG and DAC).
+	unsigned char GetSofMarker() const { return _sofMarker; }
+	unsigned char GetPrecision() const { return _precision; }
+	unsigned int GetImageWidth() const { return _width; }
+	unsigned int GetImageHeight() const { return _height; }
+	unsigned int GetComponents() const { return _components; }
+	const JpegComponentInfo& GetComponent(unsigned int index) const { return _component[index]; }
+	unsigned char GetMaxHSampling() const;
+	unsigned char GetMaxVSampling() const;
+	unsigned int GetRestartInterval() const { return _restartInterval; }
+
+	// Number of scans; only the first is counted unless Probe was asked to count scans.
+	unsigned int GetScanCount() const { return _scanCount; }
+
+	bool IsLossless() const { return _sofMarker == 0xC3 || _sofMarker == 0xC7 || _sofMarker == 0xCB || _sofMarker == 0xCF; }
+	bool IsProgressive() const { return _sofMarker == 0xC2 || _sofMarker == 0xC6 || _sofMarker == 0xCA || _sofMarker == 0xCE; }
+	bool IsArithmetic() const { return _sofMarker >= 0xC9; }
+	bool IsHierarchical() const;
+
+	// Offsets into the stream, for callers that rewrite or split it.
+	size_t GetSofOffset() const { return _sofOffset; }
+	size_t GetEntropyOffset() const { return _entropyOffset; }
+	unsigned int GetFirstScanComponents() const { return _firstScanComponents; }
+
+private:
+	unsigned char _sofMarker;
+	unsigned char _precision;
+	unsigned int _width;
+	unsigned int _height;
+	unsigned int _components;
+	JpegComponentInfo _component[JPEG_PROBE_MAX_COMPONENTS];
+	unsigned int _restartInterval;
+	unsigned int _scanCount;
+	unsigned int _firstScanComponents;
+	size_t _sofOffset;
+	size_t _entropyOffset;
+};
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
+
+#endif
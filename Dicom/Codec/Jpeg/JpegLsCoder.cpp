@@ -0,0 +1,1505 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#include "string.h"
+
+#include "JpegLsCoder.h"
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define JPEGLS_SSE2_SUPPORTED
+#include <intrin.h>
+#include <emmintrin.h>
+#endif
+
+// The coder is compiled to native code; the line loops gain nothing from IL.
+#pragma managed(push, off)
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+namespace {
+
+const unsigned int MaxComponents = 4;
+
+// Regular mode contexts; context 0 is only used in sample interleaved scans,
+// where a component is coded in regular mode when another one breaks the run.
+const int RegularContexts = 365;
+
+const int DefaultReset = 64;
+
+// Run length order table (ISO/IEC 14495-1, A.7.1.1)
+const int J[32] = {
+	0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+	4, 4, 5, 5, 6, 6, 7, 7, 8, 9, 10, 11, 12, 13, 14, 15
+};
+
+struct CodingParameters {
+	int maxval;
+	int t1;
+	int t2;
+	int t3;
+	int reset;
+	int allowedError;		// NEAR
+	int range;
+	int qbpp;
+	int limit;
+};
+
+inline int Log2Ceil(int n)
+{
+	int x = 0;
+	while (n > (1 << x))
+		++x;
+	return x;
+}
+
+inline int ClampThreshold(int i, int j, int maxval)
+{
+	return (i > maxval || i < j) ? j : i;
+}
+
+// Completes the parameters of a scan once NEAR is known.  Thresholds and RESET
+// left at zero take their default values (C.2.4.1.1.1).
+void CompleteParameters(CodingParameters& p)
+{
+	if (p.t1 == 0 || p.t2 == 0 || p.t3 == 0) {
+		int t1, t2, t3;
+		if (p.maxval >= 128) {
+			int factor = ((p.maxval < 4095 ? p.maxval : 4095) + 128) / 256;
+			t1 = ClampThreshold(factor * (3 - 2) + 2 + 3 * p.allowedError, p.allowedError + 1, p.maxval);
+			t2 = ClampThreshold(factor * (7 - 3) + 3 + 5 * p.allowedError, t1, p.maxval);
+			t3 = ClampThreshold(factor * (21 - 4) + 4 + 7 * p.allowedError, t2, p.maxval);
+		}
+		else {
+			int factor = 256 / (p.maxval + 1);
+			int basic1 = 3 / factor + 3 * p.allowedError;
+			int basic2 = 7 / factor + 5 * p.allowedError;
+			int basic3 = 21 / factor + 7 * p.allowedError;
+			t1 = ClampThreshold(basic1 > 2 ? basic1 : 2, p.allowedError + 1, p.maxval);
+			t2 = ClampThreshold(basic2 > 3 ? basic2 : 3, t1, p.maxval);
+			t3 = ClampThreshold(basic3 > 4 ? basic3 : 4, t2, p.maxval);
+		}
+		if (p.t1 == 0) p.t1 = t1;
+		if (p.t2 == 0) p.t2 = t2;
+		if (p.t3 == 0) p.t3 = t3;
+	}
+	if (p.reset == 0)
+		p.reset = DefaultReset;
+
+	int bpp = Log2Ceil(p.maxval + 1);
+	if (bpp < 2)
+		bpp = 2;
+	p.range = (p.maxval + 2 * p.allowedError) / (2 * p.allowedError + 1) + 1;
+	p.qbpp = Log2Ceil(p.range);
+	p.limit = 2 * (bpp + (bpp > 8 ? bpp : 8));
+}
+
+bool ValidParameters(const CodingParameters& p)
+{
+	return p.maxval >= 1 && p.maxval <= 65535
+		&& p.t1 >= p.allowedError + 1 && p.t1 <= p.t2 && p.t2 <= p.t3 && p.t3 <= p.maxval
+		&& p.reset >= 3;
+}
+
+#ifdef JPEGLS_SSE2_SUPPORTED
+
+bool Sse2Available()
+{
+#ifdef _M_IX86
+	static int sse2 = -1; // benign race: every thread stores the same value
+
+	if (sse2 < 0) {
+		int info[4];
+		__cpuid(info, 1);
+		sse2 = (info[3] >> 26) & 1;
+	}
+	return sse2 != 0;
+#else
+	return true;
+#endif
+}
+
+#endif
+
+inline int HighestBit(unsigned long long value)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	if (_BitScanReverse(&index, (unsigned long) (value >> 32)))
+		return (int) index + 32;
+	_BitScanReverse(&index, (unsigned long) value);
+	return (int) index;
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+// A, B, C and N of a regular mode context (A.2.1)
+struct RegularContext {
+	int a;
+	int b;
+	int c;
+	int n;
+
+	void Init(int a0)
+	{
+		a = a0;
+		b = 0;
+		c = 0;
+		n = 1;
+	}
+
+	int GetGolombCode() const
+	{
+		int k = 0;
+		while ((n << k) < a && k < 24)
+			k++;
+		return k;
+	}
+
+	// -1 when the mapping of the error value has to be inverted (A.5.2)
+	int GetErrorCorrection(int k) const
+	{
+		if (k != 0)
+			return 0;
+		return (2 * b + n - 1) >> 31;
+	}
+
+	void Update(int errval, int allowedError, int reset)
+	{
+		int aa = a + (errval < 0 ? -errval : errval);
+		int bb = b + errval * (2 * allowedError + 1);
+		int nn = n;
+		if (nn == reset) {
+			aa >>= 1;
+			bb >>= 1;
+			nn >>= 1;
+		}
+		nn++;
+		a = aa;
+		n = nn;
+
+		// bias cancellation (A.6.2)
+		if (bb + nn <= 0) {
+			bb += nn;
+			if (bb <= -nn)
+				bb = -nn + 1;
+			if (c > -128)
+				c--;
+		}
+		else if (bb > 0) {
+			bb -= nn;
+			if (bb > 0)
+				bb = 0;
+			if (c < 127)
+				c++;
+		}
+		b = bb;
+	}
+};
+
+// A, N and Nn of a run interruption context (A.7.2)
+struct RunContext {
+	int a;
+	int n;
+	int nn;
+	int riType;
+
+	void Init(int a0, int type)
+	{
+		a = a0;
+		n = 1;
+		nn = 0;
+		riType = type;
+	}
+
+	int GetGolombCode() const
+	{
+		int temp = a + (n >> 1) * riType;
+		int test = n;
+		int k = 0;
+		while (test < temp && k < 24) {
+			test <<= 1;
+			k++;
+		}
+		return k;
+	}
+
+	bool ComputeMap(int errval, int k) const
+	{
+		if (k == 0 && errval > 0 && 2 * nn < n)
+			return true;
+		if (errval < 0 && 2 * nn >= n)
+			return true;
+		if (errval < 0 && k != 0)
+			return true;
+		return false;
+	}
+
+	int ComputeErrval(int temp, int k) const
+	{
+		bool map = (temp & 1) != 0;
+		int errvalAbs = (temp + (map ? 1 : 0)) / 2;
+		if ((k != 0 || 2 * nn >= n) == map)
+			return -errvalAbs;
+		return errvalAbs;
+	}
+
+	void Update(int errval, int emErrval, int reset)
+	{
+		if (errval < 0)
+			nn++;
+		a += (emErrval + 1 - riType) >> 1;
+		if (n == reset) {
+			a >>= 1;
+			n >>= 1;
+			nn >>= 1;
+		}
+		n++;
+	}
+};
+
+// Writes the entropy coded segment.  A zero bit is stuffed after every 0xFF
+// byte, so that the byte following it is never mistaken for a marker.
+class BitWriter {
+public:
+	BitWriter(std::vector<unsigned char>& output)
+		: _output(output), _bits(0), _count(0), _afterFF(false)
+	{
+	}
+
+	void Write(unsigned int value, int length)
+	{
+		_bits = (_bits << length) | value;
+		_count += length;
+		for (;;) {
+			int size = _afterFF ? 7 : 8;
+			if (_count < size)
+				break;
+			_count -= size;
+			unsigned int byte = (unsigned int) (_bits >> _count) & ((1u << size) - 1);
+			_output.push_back((unsigned char) byte);
+			_afterFF = byte == 0xFF;
+		}
+		_bits &= (1ull << _count) - 1;
+	}
+
+	// Writes 'length' zero bits followed by a one bit
+	void WriteUnary(int length)
+	{
+		while (length > 31) {
+			Write(0, 31);
+			length -= 31;
+		}
+		Write(1, length + 1);
+	}
+
+	void Flush()
+	{
+		if (_count > 0)
+			Write(0, (_afterFF ? 7 : 8) - _count);
+		if (_afterFF)
+			Write(0, 7);
+		_afterFF = false;
+	}
+
+private:
+	std::vector<unsigned char>& _output;
+	unsigned long long _bits;
+	int _count;
+	bool _afterFF;
+};
+
+// Reads an entropy coded segment up to the marker that ends it.  Reading past
+// the end yields zero bits; more than a few bytes of that means the data is damaged.
+class BitReader {
+public:
+	BitReader(const unsigned char* data, const unsigned char* end)
+		: _position(data), _end(end), _bits(0), _count(0), _padding(0), _afterFF(false), _error(false)
+	{
+	}
+
+	bool Failed() const { return _error || _padding > 16; }
+	void SetError() { _error = true; }
+
+	unsigned int Read(int length)
+	{
+		if (_count < length)
+			Fill();
+		_count -= length;
+		return (unsigned int) (_bits >> _count) & ((1u << length) - 1);
+	}
+
+	bool ReadBit()
+	{
+		return Read(1) != 0;
+	}
+
+	// Counts the zero bits before the next one bit, which is consumed; stops at maximum.
+	int ReadUnary(int maximum)
+	{
+		int zeros = 0;
+		for (;;) {
+			if (_count == 0)
+				Fill();
+			unsigned long long window = _bits & ((1ull << _count) - 1);
+			if (window != 0) {
+				int top = HighestBit(window);
+				zeros += _count - 1 - top;
+				_count = top;
+				return zeros;
+			}
+			zeros += _count;
+			_count = 0;
+			if (zeros > maximum) {
+				_error = true;
+				return zeros;
+			}
+		}
+	}
+
+private:
+	void Fill()
+	{
+		_bits &= (1ull << _count) - 1;
+		while (_count <= 48) {
+			unsigned int byte = 0;
+			if (_position < _end) {
+				byte = *_position;
+				if (byte == 0xFF && (_position + 1 >= _end || (_position[1] & 0x80) != 0)) {
+					_end = _position; // a marker
+					byte = 0;
+					_padding++;
+				}
+				else {
+					_position++;
+				}
+			}
+			else {
+				_padding++;
+			}
+
+			if (_afterFF) {
+				_bits = (_bits << 7) | (byte & 0x7F);
+				_count += 7;
+			}
+			else {
+				_bits = (_bits << 8) | byte;
+				_count += 8;
+			}
+			_afterFF = byte == 0xFF;
+		}
+	}
+
+	const unsigned char* _position;
+	const unsigned char* _end;
+	unsigned long long _bits;
+	int _count;
+	int _padding;
+	bool _afterFF;
+	bool _error;
+};
+
+// Line buffers of one component; index -1 and width hold the edge samples.
+class ComponentLines {
+public:
+	void Init(unsigned int width)
+	{
+		_width = width;
+		_storage.assign(2 * (width + 2) + width, 0);
+		_previous = &_storage[1];
+		_current = &_storage[width + 3];
+		_partial = &_storage[2 * (width + 2)];
+	}
+
+	int* Current() { return _current; }
+	int* Previous() { return _previous; }
+	int* Partial() { return _partial; }
+
+	// Makes the line just coded the previous line, and sets up the edges (A.2.1)
+	void NextLine()
+	{
+		int* line = _previous;
+		_previous = _current;
+		_current = line;
+		_current[-1] = _previous[0];
+		_previous[_width] = _previous[_width - 1];
+	}
+
+private:
+	std::vector<int> _storage;
+	int* _previous;
+	int* _current;
+	int* _partial;
+	unsigned int _width;
+};
+
+// The state shared by the encoder and the decoder of one scan.
+class ScanCoder {
+public:
+	ScanCoder(const CodingParameters& parameters, unsigned int width)
+		: _p(parameters), _width((int) width)
+	{
+		int a0 = (_p.range + 32) / 64;
+		if (a0 < 2)
+			a0 = 2;
+		for (int i = 0; i < RegularContexts; i++)
+			_contexts[i].Init(a0);
+		_runContexts[0].Init(a0, 0);
+		_runContexts[1].Init(a0, 1);
+		for (unsigned int c = 0; c < MaxComponents; c++)
+			_runIndex[c] = 0;
+
+		// gradient quantization table (A.3.3), indexed by -maxval..maxval
+		_quantizeTable.resize(2 * _p.maxval + 1);
+		for (int d = -_p.maxval; d <= _p.maxval; d++)
+			_quantizeTable[d + _p.maxval] = (signed char) QuantizeGradient(d);
+		_quantize = &_quantizeTable[_p.maxval];
+
+#ifdef JPEGLS_SSE2_SUPPORTED
+		_sse2 = Sse2Available();
+#endif
+	}
+
+protected:
+	int QuantizeGradient(int d) const
+	{
+		if (d <= -_p.t3) return -4;
+		if (d <= -_p.t2) return -3;
+		if (d <= -_p.t1) return -2;
+		if (d < -_p.allowedError) return -1;
+		if (d <= _p.allowedError) return 0;
+		if (d < _p.t1) return 1;
+		if (d < _p.t2) return 2;
+		if (d < _p.t3) return 3;
+		return 4;
+	}
+
+	// Computes 81 Q(D1) + 9 Q(D2) for every sample of the line; D1 and D2 only
+	// depend on the previous line.  The context of a sample is then this plus
+	// Q(D3), with the sign of the result selecting the sign of the context.
+	void ComputePartialContexts(const int* previous, int* partial) const
+	{
+		int x = 0;
+#ifdef JPEGLS_SSE2_SUPPORTED
+		if (_sse2) {
+			// Q(d) = (d > NEAR) + (d >= T1) + (d >= T2) + (d >= T3)
+			//      - (d < -NEAR) - (d <= -T1) - (d <= -T2) - (d <= -T3)
+			const __m128i nearValue = _mm_set1_epi32(_p.allowedError);
+			const __m128i t1 = _mm_set1_epi32(_p.t1 - 1);
+			const __m128i t2 = _mm_set1_epi32(_p.t2 - 1);
+			const __m128i t3 = _mm_set1_epi32(_p.t3 - 1);
+			const __m128i minusNear = _mm_set1_epi32(-_p.allowedError);
+			const __m128i minusT1 = _mm_set1_epi32(1 - _p.t1);
+			const __m128i minusT2 = _mm_set1_epi32(1 - _p.t2);
+			const __m128i minusT3 = _mm_set1_epi32(1 - _p.t3);
+
+#define JPEGLS_QUANTIZE_SSE2(d) \
+			_mm_sub_epi32( \
+				_mm_add_epi32(_mm_add_epi32(_mm_cmplt_epi32(d, minusNear), _mm_cmplt_epi32(d, minusT1)), \
+							  _mm_add_epi32(_mm_cmplt_epi32(d, minusT2), _mm_cmplt_epi32(d, minusT3))), \
+				_mm_add_epi32(_mm_add_epi32(_mm_cmpgt_epi32(d, nearValue), _mm_cmpgt_epi32(d, t1)), \
+							  _mm_add_epi32(_mm_cmpgt_epi32(d, t2), _mm_cmpgt_epi32(d, t3))))
+
+			for (; x + 4 <= _width; x += 4) {
+				__m128i rc = _mm_loadu_si128((const __m128i*) (previous + x - 1));
+				__m128i rb = _mm_loadu_si128((const __m128i*) (previous + x));
+				__m128i rd = _mm_loadu_si128((const __m128i*) (previous + x + 1));
+				__m128i q1 = JPEGLS_QUANTIZE_SSE2(_mm_sub_epi32(rd, rb));
+				__m128i q2 = JPEGLS_QUANTIZE_SSE2(_mm_sub_epi32(rb, rc));
+
+				// 81 q1 + 9 q2 = 9 (9 q1 + q2)
+				__m128i t = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(q1, 3), q1), q2);
+				t = _mm_add_epi32(_mm_slli_epi32(t, 3), t);
+				_mm_storeu_si128((__m128i*) (partial + x), t);
+			}
+
+#undef JPEGLS_QUANTIZE_SSE2
+		}
+#endif
+		for (; x < _width; x++)
+			partial[x] = 81 * _quantize[previous[x + 1] - previous[x]] + 9 * _quantize[previous[x] - previous[x - 1]];
+	}
+
+	int Context(const int* partial, const int* current, const int* previous, int x) const
+	{
+		return partial[x] + _quantize[previous[x - 1] - current[x - 1]];
+	}
+
+	static int Predict(int ra, int rb, int rc)
+	{
+		if (ra < rb) {
+			if (rc >= rb)
+				return ra;
+			if (rc <= ra)
+				return rb;
+		}
+		else {
+			if (rc >= ra)
+				return rb;
+			if (rc <= rb)
+				return ra;
+		}
+		return ra + rb - rc;
+	}
+
+	int Clamp(int value) const
+	{
+		if (value < 0)
+			return 0;
+		if (value > _p.maxval)
+			return _p.maxval;
+		return value;
+	}
+
+	// Quantizes and reduces modulo RANGE a prediction error (A.4.4, A.4.5)
+	int QuantizeError(int errval) const
+	{
+		if (_p.allowedError > 0) {
+			if (errval > 0)
+				errval = (errval + _p.allowedError) / (2 * _p.allowedError + 1);
+			else
+				errval = -(_p.allowedError - errval) / (2 * _p.allowedError + 1);
+		}
+		if (errval < 0)
+			errval += _p.range;
+		if (errval >= (_p.range + 1) / 2)
+			errval -= _p.range;
+		return errval;
+	}
+
+	int Reconstruct(int prediction, int errval) const
+	{
+		int value = prediction + errval * (2 * _p.allowedError + 1);
+		if (value < -_p.allowedError)
+			value += _p.range * (2 * _p.allowedError + 1);
+		else if (value > _p.maxval + _p.allowedError)
+			value -= _p.range * (2 * _p.allowedError + 1);
+		return Clamp(value);
+	}
+
+	bool IsNear(int a, int b) const
+	{
+		int d = a - b;
+		return d <= _p.allowedError && d >= -_p.allowedError;
+	}
+
+	static int Sign(int value)
+	{
+		return value < 0 ? -1 : 1;
+	}
+
+	static int MapError(int errval)
+	{
+		return (errval >> 30) ^ (2 * errval);
+	}
+
+	static int UnmapError(int mapped)
+	{
+		int sign = -(mapped & 1);
+		return sign ^ (mapped >> 1);
+	}
+
+	void IncrementRunIndex(int& runIndex)
+	{
+		if (runIndex < 31)
+			runIndex++;
+	}
+
+	void DecrementRunIndex(int& runIndex)
+	{
+		if (runIndex > 0)
+			runIndex--;
+	}
+
+	CodingParameters _p;
+	int _width;
+	RegularContext _contexts[RegularContexts];
+	RunContext _runContexts[2];
+	int _runIndex[MaxComponents];
+	std::vector<signed char> _quantizeTable;
+	const signed char* _quantize;
+#ifdef JPEGLS_SSE2_SUPPORTED
+	bool _sse2;
+#endif
+};
+
+class ScanEncoder : public ScanCoder {
+public:
+	ScanEncoder(const CodingParameters& parameters, unsigned int width, BitWriter& writer)
+		: ScanCoder(parameters, width), _writer(writer)
+	{
+	}
+
+	// Codes one line of a component; lines of separate components share the
+	// contexts but each has its own run index.
+	void EncodeLine(ComponentLines& lines, unsigned int component)
+	{
+		int* current = lines.Current();
+		const int* previous = lines.Previous();
+		int* partial = lines.Partial();
+		int& runIndex = _runIndex[component];
+
+		ComputePartialContexts(previous, partial);
+
+		int x = 0;
+		while (x < _width) {
+			int qs = Context(partial, current, previous, x);
+			if (qs != 0) {
+				current[x] = EncodeRegular(qs, current[x], Predict(current[x - 1], previous[x], previous[x - 1]));
+				x++;
+			}
+			else {
+				x += EncodeRun(current, previous, x, runIndex);
+			}
+		}
+	}
+
+	// Codes one line of each component, sample interleaved.  Run mode is
+	// entered only where every component is in a run.
+	void EncodeInterleavedLine(ComponentLines* lines, unsigned int components)
+	{
+		int* current[MaxComponents];
+		const int* previous[MaxComponents];
+		const int* partial[MaxComponents];
+		for (unsigned int c = 0; c < components; c++) {
+			current[c] = lines[c].Current();
+			previous[c] = lines[c].Previous();
+			partial[c] = lines[c].Partial();
+			ComputePartialContexts(previous[c], lines[c].Partial());
+		}
+
+		int x = 0;
+		while (x < _width) {
+			int qs[MaxComponents];
+			bool run = true;
+			for (unsigned int c = 0; c < components; c++) {
+				qs[c] = Context(partial[c], current[c], previous[c], x);
+				run = run && qs[c] == 0;
+			}
+
+			if (!run) {
+				for (unsigned int c = 0; c < components; c++)
+					current[c][x] = EncodeRegular(qs[c], current[c][x], Predict(current[c][x - 1], previous[c][x], previous[c][x - 1]));
+				x++;
+				continue;
+			}
+
+			int remaining = _width - x;
+			int length = 0;
+			for (;;) {
+				bool inRun = true;
+				for (unsigned int c = 0; c < components && inRun; c++)
+					inRun = IsNear(current[c][x + length], current[c][x - 1]);
+				if (!inRun)
+					break;
+				for (unsigned int c = 0; c < components; c++)
+					current[c][x + length] = current[c][x - 1];
+				if (++length == remaining)
+					break;
+			}
+
+			EncodeRunLength(length, length == remaining, _runIndex[0]);
+			if (length < remaining) {
+				int i = x + length;
+				for (unsigned int c = 0; c < components; c++) {
+					int ra = current[c][x - 1];
+					int rb = previous[c][i];
+					int sign = Sign(rb - ra);
+					int errval = QuantizeError(sign * (current[c][i] - rb));
+					EncodeRunInterruptionError(_runContexts[0], errval, _runIndex[0]);
+					current[c][i] = Reconstruct(rb, errval * sign);
+				}
+				DecrementRunIndex(_runIndex[0]);
+				length++;
+			}
+			x += length;
+		}
+	}
+
+private:
+	void EncodeMappedValue(int k, int mapped, int limit)
+	{
+		int high = mapped >> k;
+		if (high < limit - _p.qbpp - 1) {
+			_writer.WriteUnary(high);
+			if (k > 0)
+				_writer.Write(mapped & ((1 << k) - 1), k);
+		}
+		else {
+			_writer.WriteUnary(limit - _p.qbpp - 1);
+			_writer.Write((mapped - 1) & ((1 << _p.qbpp) - 1), _p.qbpp);
+		}
+	}
+
+	int EncodeRegular(int qs, int sample, int prediction)
+	{
+		int sign = qs >> 31;
+		RegularContext& context = _contexts[(qs ^ sign) - sign];
+		int k = context.GetGolombCode();
+		prediction = Clamp(prediction + ((context.c ^ sign) - sign));
+
+		int errval = QuantizeError(((sample - prediction) ^ sign) - sign);
+		EncodeMappedValue(k, MapError(context.GetErrorCorrection(k | _p.allowedError) ^ errval), _p.limit);
+		context.Update(errval, _p.allowedError, _p.reset);
+		return Reconstruct(prediction, (errval ^ sign) - sign);
+	}
+
+	int EncodeRun(int* current, const int* previous, int x, int& runIndex)
+	{
+		int remaining = _width - x;
+		int ra = current[x - 1];
+		int length = 0;
+		while (IsNear(current[x + length], ra)) {
+			current[x + length] = ra;
+			if (++length == remaining)
+				break;
+		}
+
+		EncodeRunLength(length, length == remaining, runIndex);
+		if (length == remaining)
+			return length;
+
+		// run interruption sample (A.7.2)
+		int i = x + length;
+		int rb = previous[i];
+		if (IsNear(ra, rb)) {
+			int errval = QuantizeError(current[i] - ra);
+			EncodeRunInterruptionError(_runContexts[1], errval, runIndex);
+			current[i] = Reconstruct(ra, errval);
+		}
+		else {
+			int sign = Sign(rb - ra);
+			int errval = QuantizeError(sign * (current[i] - rb));
+			EncodeRunInterruptionError(_runContexts[0], errval, runIndex);
+			current[i] = Reconstruct(rb, errval * sign);
+		}
+		DecrementRunIndex(runIndex);
+		return length + 1;
+	}
+
+	void EncodeRunLength(int length, bool endOfLine, int& runIndex)
+	{
+		while (length >= (1 << J[runIndex])) {
+			_writer.Write(1, 1);
+			length -= 1 << J[runIndex];
+			IncrementRunIndex(runIndex);
+		}
+
+		if (endOfLine) {
+			if (length != 0)
+				_writer.Write(1, 1);
+		}
+		else {
+			_writer.Write(length, J[runIndex] + 1);
+		}
+	}
+
+	void EncodeRunInterruptionError(RunContext& context, int errval, int runIndex)
+	{
+		int k = context.GetGolombCode();
+		bool map = context.ComputeMap(errval, k);
+		int emErrval = 2 * (errval < 0 ? -errval : errval) - context.riType - (map ? 1 : 0);
+		EncodeMappedValue(k, emErrval, _p.limit - J[runIndex] - 1);
+		context.Update(errval, emErrval, _p.reset);
+	}
+
+	BitWriter& _writer;
+};
+
+class ScanDecoder : public ScanCoder {
+public:
+	ScanDecoder(const CodingParameters& parameters, unsigned int width, BitReader& reader)
+		: ScanCoder(parameters, width), _reader(reader)
+	{
+	}
+
+	void DecodeLine(ComponentLines& lines, unsigned int component)
+	{
+		int* current = lines.Current();
+		const int* previous = lines.Previous();
+		int* partial = lines.Partial();
+		int& runIndex = _runIndex[component];
+
+		ComputePartialContexts(previous, partial);
+
+		int x = 0;
+		while (x < _width) {
+			int qs = Context(partial, current, previous, x);
+			if (qs != 0) {
+				current[x] = DecodeRegular(qs, Predict(current[x - 1], previous[x], previous[x - 1]));
+				x++;
+			}
+			else {
+				x += DecodeRun(current, previous, x, runIndex);
+			}
+		}
+	}
+
+	void DecodeInterleavedLine(ComponentLines* lines, unsigned int components)
+	{
+		int* current[MaxComponents];
+		const int* previous[MaxComponents];
+		const int* partial[MaxComponents];
+		for (unsigned int c = 0; c < components; c++) {
+			current[c] = lines[c].Current();
+			previous[c] = lines[c].Previous();
+			partial[c] = lines[c].Partial();
+			ComputePartialContexts(previous[c], lines[c].Partial());
+		}
+
+		int x = 0;
+		while (x < _width) {
+			int qs[MaxComponents];
+			bool run = true;
+			for (unsigned int c = 0; c < components; c++) {
+				qs[c] = Context(partial[c], current[c], previous[c], x);
+				run = run && qs[c] == 0;
+			}
+
+			if (!run) {
+				for (unsigned int c = 0; c < components; c++)
+					current[c][x] = DecodeRegular(qs[c], Predict(current[c][x - 1], previous[c][x], previous[c][x - 1]));
+				x++;
+				continue;
+			}
+
+			int remaining = _width - x;
+			int length = DecodeRunLength(remaining, _runIndex[0]);
+			for (unsigned int c = 0; c < components; c++) {
+				int ra = current[c][x - 1];
+				for (int i = 0; i < length; i++)
+					current[c][x + i] = ra;
+			}
+
+			if (length < remaining) {
+				int i = x + length;
+				for (unsigned int c = 0; c < components; c++) {
+					int ra = current[c][x - 1];
+					int rb = previous[c][i];
+					int errval = DecodeRunInterruptionError(_runContexts[0], _runIndex[0]);
+					current[c][i] = Reconstruct(rb, errval * Sign(rb - ra));
+				}
+				DecrementRunIndex(_runIndex[0]);
+				length++;
+			}
+			x += length;
+		}
+	}
+
+private:
+	int DecodeMappedValue(int k, int limit)
+	{
+		int high = _reader.ReadUnary(limit);
+		if (high >= limit - _p.qbpp - 1)
+			return (int) _reader.Read(_p.qbpp) + 1;
+		if (k == 0)
+			return high;
+		if (high > 0xFFFF >> k) {
+			_reader.SetError();
+			return 0;
+		}
+		return (high << k) + (int) _reader.Read(k);
+	}
+
+	int DecodeRegular(int qs, int prediction)
+	{
+		int sign = qs >> 31;
+		RegularContext& context = _contexts[(qs ^ sign) - sign];
+		int k = context.GetGolombCode();
+		prediction = Clamp(prediction + ((context.c ^ sign) - sign));
+
+		int errval = UnmapError(DecodeMappedValue(k, _p.limit));
+		if (k == 0)
+			errval ^= context.GetErrorCorrection(_p.allowedError);
+		context.Update(errval, _p.allowedError, _p.reset);
+		return Reconstruct(prediction, (errval ^ sign) - sign);
+	}
+
+	int DecodeRun(int* current, const int* previous, int x, int& runIndex)
+	{
+		int remaining = _width - x;
+		int ra = current[x - 1];
+		int length = DecodeRunLength(remaining, runIndex);
+		for (int i = 0; i < length; i++)
+			current[x + i] = ra;
+
+		if (length == remaining)
+			return length;
+
+		int i = x + length;
+		int rb = previous[i];
+		if (IsNear(ra, rb)) {
+			int errval = DecodeRunInterruptionError(_runContexts[1], runIndex);
+			current[i] = Reconstruct(ra, errval);
+		}
+		else {
+			int errval = DecodeRunInterruptionError(_runContexts[0], runIndex);
+			current[i] = Reconstruct(rb, errval * Sign(rb - ra));
+		}
+		DecrementRunIndex(runIndex);
+		return length + 1;
+	}
+
+	int DecodeRunLength(int remaining, int& runIndex)
+	{
+		int length = 0;
+		while (_reader.ReadBit()) {
+			int count = 1 << J[runIndex];
+			if (count > remaining - length)
+				count = remaining - length;
+			length += count;
+			if (count == (1 << J[runIndex]))
+				IncrementRunIndex(runIndex);
+			if (length == remaining)
+				return length;
+		}
+
+		if (J[runIndex] > 0)
+			length += (int) _reader.Read(J[runIndex]);
+		if (length > remaining) {
+			_reader.SetError();
+			length = remaining;
+		}
+		return length;
+	}
+
+	int DecodeRunInterruptionError(RunContext& context, int runIndex)
+	{
+		int k = context.GetGolombCode();
+		int emErrval = DecodeMappedValue(k, _p.limit - J[runIndex] - 1);
+		int errval = context.ComputeErrval(emErrval + context.riType, k);
+		context.Update(errval, emErrval, _p.reset);
+		return errval;
+	}
+
+	BitReader& _reader;
+};
+
+// Moves samples of one component line between the image and the line buffers.
+class SampleAccess {
+public:
+	SampleAccess(const JpegLsImage& image)
+		: _image(image)
+	{
+		_mask = (1u << image.bitsStored) - 1;
+	}
+
+	void Load(unsigned int component, unsigned int row, int* line) const
+	{
+		const unsigned char* p;
+		size_t step;
+		Locate(component, row, p, step);
+		if (_image.bytesPerSample == 1) {
+			for (unsigned int x = 0; x < _image.width; x++, p += step)
+				line[x] = (int) (p[0] & _mask);
+		}
+		else {
+			for (unsigned int x = 0; x < _image.width; x++, p += step)
+				line[x] = (int) ((p[0] | (p[1] << 8)) & _mask);
+		}
+	}
+
+	void Store(unsigned int component, unsigned int row, const int* line) const
+	{
+		const unsigned char* position;
+		size_t step;
+		Locate(component, row, position, step);
+		unsigned char* p = const_cast<unsigned char*>(position);
+		if (_image.bytesPerSample == 1) {
+			for (unsigned int x = 0; x < _image.width; x++, p += step)
+				p[0] = (unsigned char) line[x];
+		}
+		else {
+			for (unsigned int x = 0; x < _image.width; x++, p += step) {
+				p[0] = (unsigned char) line[x];
+				p[1] = (unsigned char) (line[x] >> 8);
+			}
+		}
+	}
+
+private:
+	void Locate(unsigned int component, unsigned int row, const unsigned char*& p, size_t& step) const
+	{
+		size_t bytes = _image.bytesPerSample;
+		if (_image.planar) {
+			p = _image.data + ((size_t) component * _image.height + row) * _image.width * bytes;
+			step = bytes;
+		}
+		else {
+			p = _image.data + ((size_t) row * _image.width * _image.components + component) * bytes;
+			step = _image.components * bytes;
+		}
+	}
+
+	const JpegLsImage& _image;
+	unsigned int _mask;
+};
+
+bool ValidImage(const JpegLsImage& image)
+{
+	if (image.data == NULL || image.width == 0 || image.width > 65535 || image.height == 0 || image.height > 65535)
+		return false;
+	if (image.components == 0 || image.components > MaxComponents)
+		return false;
+	if (image.bytesPerSample != 1 && image.bytesPerSample != 2)
+		return false;
+	if (image.bitsStored == 0 || image.bitsStored > 8 * image.bytesPerSample)
+		return false;
+	return image.size >= (size_t) image.width * image.height * image.components * image.bytesPerSample;
+}
+
+void WriteMarker(std::vector<unsigned char>& output, unsigned char marker)
+{
+	output.push_back(0xFF);
+	output.push_back(marker);
+}
+
+void WriteWord(std::vector<unsigned char>& output, unsigned int value)
+{
+	output.push_back((unsigned char) (value >> 8));
+	output.push_back((unsigned char) value);
+}
+
+void EncodeScan(const JpegLsImage& image, const CodingParameters& parameters, JpegLsInterleave interleave,
+				unsigned int firstComponent, unsigned int components, std::vector<unsigned char>& output)
+{
+	// SOS
+	WriteMarker(output, 0xDA);
+	WriteWord(output, 6 + 2 * components);
+	output.push_back((unsigned char) components);
+	for (unsigned int c = 0; c < components; c++) {
+		output.push_back((unsigned char) (firstComponent + c + 1));
+		output.push_back(0); // no mapping table
+	}
+	output.push_back((unsigned char) parameters.allowedError);
+	output.push_back((unsigned char) interleave);
+	output.push_back(0); // no point transform
+
+	SampleAccess samples(image);
+	ComponentLines lines[MaxComponents];
+	for (unsigned int c = 0; c < components; c++)
+		lines[c].Init(image.width);
+
+	BitWriter writer(output);
+	ScanEncoder encoder(parameters, image.width, writer);
+	for (unsigned int y = 0; y < image.height; y++) {
+		for (unsigned int c = 0; c < components; c++) {
+			lines[c].NextLine();
+			samples.Load(firstComponent + c, y, lines[c].Current());
+		}
+
+		if (interleave == JpegLsInterleaveSample) {
+			encoder.EncodeInterleavedLine(lines, components);
+		}
+		else {
+			for (unsigned int c = 0; c < components; c++)
+				encoder.EncodeLine(lines[c], c);
+		}
+	}
+	writer.Flush();
+}
+
+bool DecodeScan(const unsigned char* data, const unsigned char* end, const CodingParameters& parameters,
+				JpegLsInterleave interleave, const unsigned int* componentIndex, unsigned int components,
+				const JpegLsImage& image)
+{
+	SampleAccess samples(image);
+	ComponentLines lines[MaxComponents];
+	for (unsigned int c = 0; c < components; c++)
+		lines[c].Init(image.width);
+
+	BitReader reader(data, end);
+	ScanDecoder decoder(parameters, image.width, reader);
+	for (unsigned int y = 0; y < image.height; y++) {
+		for (unsigned int c = 0; c < components; c++)
+			lines[c].NextLine();
+
+		if (interleave == JpegLsInterleaveSample) {
+			decoder.DecodeInterleavedLine(lines, components);
+		}
+		else {
+			for (unsigned int c = 0; c < components; c++)
+				decoder.DecodeLine(lines[c], c);
+		}
+		if (reader.Failed())
+			return false;
+
+		for (unsigned int c = 0; c < components; c++)
+			samples.Store(componentIndex[c], y, lines[c].Current());
+	}
+	return true;
+}
+
+// Walks the marker segments of a JPEG-LS stream.
+class StreamParser {
+public:
+	StreamParser(const unsigned char* data, size_t length)
+		: _data(data), _length(length), _position(0)
+	{
+		_parameters.maxval = 0;
+		_parameters.t1 = 0;
+		_parameters.t2 = 0;
+		_parameters.t3 = 0;
+		_parameters.reset = 0;
+		_parameters.allowedError = 0;
+		_frameRead = false;
+		_width = 0;
+		_height = 0;
+		_components = 0;
+		_bitsPerSample = 0;
+	}
+
+	// Reads up to and including the next SOS; on success the scan header is in
+	// the members and the position is at the first entropy coded byte.
+	// Returns false with status JpegLsOk at the end of the image.
+	bool NextScan(JpegLsStatus& status)
+	{
+		status = JpegLsOk;
+		if (_position == 0) {
+			if (_length < 2 || _data[0] != 0xFF || _data[1] != 0xD8) {
+				status = JpegLsInvalidData;
+				return false;
+			}
+			_position = 2;
+		}
+
+		for (;;) {
+			if (_position + 2 > _length || _data[_position] != 0xFF) {
+				status = JpegLsInvalidData;
+				return false;
+			}
+			while (_position + 1 < _length && _data[_position + 1] == 0xFF)
+				_position++;
+			if (_position + 2 > _length) {
+				status = JpegLsInvalidData;
+				return false;
+			}
+
+			unsigned char marker = _data[_position + 1];
+			_position += 2;
+			if (marker == 0xD9)
+				return false;
+			if (marker >= 0xD0 && marker <= 0xD7) {
+				status = JpegLsInvalidData;
+				return false;
+			}
+
+			if (_position + 2 > _length) {
+				status = JpegLsInvalidData;
+				return false;
+			}
+			size_t segmentLength = Word(_position);
+			if (segmentLength < 2 || _position + segmentLength > _length) {
+				status = JpegLsInvalidData;
+				return false;
+			}
+			const unsigned char* segment = _data + _position + 2;
+			size_t size = segmentLength - 2;
+			_position += segmentLength;
+
+			if (marker == 0xF7) {
+				status = ReadFrame(segment, size);
+			}
+			else if (marker == 0xF8) {
+				status = ReadPresets(segment, size);
+			}
+			else if (marker == 0xDA) {
+				status = ReadScan(segment, size);
+				return status == JpegLsOk;
+			}
+			else if ((marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) || marker == 0xF9) {
+				status = JpegLsUnsupported; // another coding process, or JPEG-LS extensions
+			}
+			else if (marker == 0xDD || marker == 0xDC) {
+				status = JpegLsUnsupported; // restart intervals, number of lines
+			}
+			else if ((marker >= 0xE0 && marker <= 0xEF) || marker == 0xFE) {
+				// application data and comments
+			}
+			else {
+				status = JpegLsInvalidData;
+			}
+
+			if (status != JpegLsOk)
+				return false;
+		}
+	}
+
+	// Moves past the entropy coded data of the scan just read.
+	void SkipScan()
+	{
+		while (_position + 1 < _length && !(_data[_position] == 0xFF && (_data[_position + 1] & 0x80) != 0))
+			_position++;
+		if (_position + 1 >= _length)
+			_position = _length;
+	}
+
+	const unsigned char* ScanData() const { return _data + _position; }
+	const unsigned char* End() const { return _data + _length; }
+
+	bool FrameRead() const { return _frameRead; }
+	unsigned int Width() const { return _width; }
+	unsigned int Height() const { return _height; }
+	unsigned int Components() const { return _components; }
+	unsigned int BitsPerSample() const { return _bitsPerSample; }
+
+	unsigned int ScanComponents() const { return _scanComponents; }
+	unsigned int ScanComponentIndex(unsigned int c) const { return _scanComponentIndex[c]; }
+	JpegLsInterleave Interleave() const { return _interleave; }
+
+	// The complete coding parameters of the scan just read
+	CodingParameters ScanParameters() const
+	{
+		CodingParameters p = _parameters;
+		if (p.maxval == 0)
+			p.maxval = (1 << _bitsPerSample) - 1;
+		CompleteParameters(p);
+		return p;
+	}
+
+private:
+	unsigned int Word(size_t position) const
+	{
+		return (_data[position] << 8) | _data[position + 1];
+	}
+
+	JpegLsStatus ReadFrame(const unsigned char* segment, size_t size)
+	{
+		if (_frameRead || size < 6)
+			return JpegLsInvalidData;
+		_bitsPerSample = segment[0];
+		_height = (segment[1] << 8) | segment[2];
+		_width = (segment[3] << 8) | segment[4];
+		_components = segment[5];
+		if (_bitsPerSample < 2 || _bitsPerSample > 16 || _components == 0 || size < 6 + 3 * (size_t) _components)
+			return JpegLsInvalidData;
+		if (_width == 0 || _height == 0 || _components > MaxComponents)
+			return JpegLsUnsupported;
+		for (unsigned int c = 0; c < _components; c++) {
+			_componentId[c] = segment[6 + 3 * c];
+			if (segment[7 + 3 * c] != 0x11)
+				return JpegLsUnsupported; // subsampled components
+		}
+		_frameRead = true;
+		return JpegLsOk;
+	}
+
+	JpegLsStatus ReadPresets(const unsigned char* segment, size_t size)
+	{
+		if (size < 1)
+			return JpegLsInvalidData;
+		if (segment[0] != 1)
+			return JpegLsUnsupported; // mapping tables or oversize dimensions
+		if (size < 11)
+			return JpegLsInvalidData;
+		_parameters.maxval = (segment[1] << 8) | segment[2];
+		_parameters.t1 = (segment[3] << 8) | segment[4];
+		_parameters.t2 = (segment[5] << 8) | segment[6];
+		_parameters.t3 = (segment[7] << 8) | segment[8];
+		_parameters.reset = (segment[9] << 8) | segment[10];
+		return JpegLsOk;
+	}
+
+	JpegLsStatus ReadScan(const unsigned char* segment, size_t size)
+	{
+		if (!_frameRead || size < 1)
+			return JpegLsInvalidData;
+		_scanComponents = segment[0];
+		if (_scanComponents == 0 || _scanComponents > _components || size < 4 + 2 * (size_t) _scanComponents)
+			return JpegLsInvalidData;
+		for (unsigned int c = 0; c < _scanComponents; c++) {
+			unsigned int id = segment[1 + 2 * c];
+			unsigned int index = 0;
+			while (index < _components && _componentId[index] != id)
+				index++;
+			if (index == _components)
+				return JpegLsInvalidData;
+			_scanComponentIndex[c] = index;
+			if (segment[2 + 2 * c] != 0)
+				return JpegLsUnsupported; // mapping table
+		}
+
+		const unsigned char* tail = segment + 1 + 2 * _scanComponents;
+		_parameters.allowedError = tail[0];
+		if (tail[1] > 2)
+			return JpegLsInvalidData;
+		_interleave = (JpegLsInterleave) tail[1];
+		if ((tail[2] & 0x0F) != 0)
+			return JpegLsUnsupported; // point transform
+		if ((_interleave == JpegLsInterleaveNone) != (_scanComponents == 1))
+			return JpegLsInvalidData;
+
+		CodingParameters p = ScanParameters();
+		if (2 * p.allowedError > p.maxval || !ValidParameters(p))
+			return JpegLsInvalidData;
+		return JpegLsOk;
+	}
+
+	const unsigned char* _data;
+	size_t _length;
+	size_t _position;
+
+	CodingParameters _parameters;
+	bool _frameRead;
+	unsigned int _width;
+	unsigned int _height;
+	unsigned int _components;
+	unsigned int _bitsPerSample;
+	unsigned int _componentId[MaxComponents];
+
+	unsigned int _scanComponents;
+	unsigned int _scanComponentIndex[MaxComponents];
+	JpegLsInterleave _interleave;
+};
+
+} // namespace
+
+JpegLsStatus JpegLsCoder::Encode(const JpegLsImage& image, int allowedError, JpegLsInterleave interleave,
+								 std::vector<unsigned char>& output)
+{
+	if (!ValidImage(image))
+		return JpegLsInvalidParameter;
+
+	unsigned int bitsPerSample = image.bitsStored < 2 ? 2 : image.bitsStored;
+	CodingParameters parameters;
+	parameters.maxval = (1 << bitsPerSample) - 1;
+	parameters.t1 = 0;
+	parameters.t2 = 0;
+	parameters.t3 = 0;
+	parameters.reset = 0;
+	parameters.allowedError = allowedError;
+	if (allowedError < 0 || allowedError > 255 || 2 * allowedError > parameters.maxval)
+		return JpegLsInvalidParameter;
+	CompleteParameters(parameters);
+
+	if (image.components == 1)
+		interleave = JpegLsInterleaveNone;
+
+	output.clear();
+	output.reserve(image.size / 2 + 1024);
+
+	// SOI, SOF55
+	WriteMarker(output, 0xD8);
+	WriteMarker(output, 0xF7);
+	WriteWord(output, 8 + 3 * image.components);
+	output.push_back((unsigned char) bitsPerSample);
+	WriteWord(output, image.height);
+	WriteWord(output, image.width);
+	output.push_back((unsigned char) image.components);
+	for (unsigned int c = 0; c < image.components; c++) {
+		output.push_back((unsigned char) (c + 1));
+		output.push_back(0x11);
+		output.push_back(0);
+	}
+
+	if (interleave == JpegLsInterleaveNone) {
+		for (unsigned int c = 0; c < image.components; c++)
+			EncodeScan(image, parameters, interleave, c, 1, output);
+	}
+	else {
+		EncodeScan(image, parameters, interleave, 0, image.components, output);
+	}
+
+	WriteMarker(output, 0xD9);
+	return JpegLsOk;
+}
+
+JpegLsStatus JpegLsCoder::ReadHeader(const unsigned char* data, size_t length, JpegLsFrameInfo& info)
+{
+	StreamParser parser(data, length);
+	JpegLsStatus status;
+	if (!parser.NextScan(status))
+		return status == JpegLsOk ? JpegLsInvalidData : status;
+
+	info.width = parser.Width();
+	info.height = parser.Height();
+	info.components = parser.Components();
+	info.bitsPerSample = parser.BitsPerSample();
+	info.allowedError = parser.ScanParameters().allowedError;
+	info.interleave = parser.Interleave();
+	return JpegLsOk;
+}
+
+JpegLsStatus JpegLsCoder::Decode(const unsigned char* data, size_t length, const JpegLsImage& image)
+{
+	if (!ValidImage(image))
+		return JpegLsInvalidParameter;
+
+	StreamParser parser(data, length);
+	bool decoded[MaxComponents] = { false, false, false, false };
+	JpegLsStatus status;
+	while (parser.NextScan(status)) {
+		if (parser.Width() != image.width || parser.Height() != image.height || parser.Components() != image.components
+			|| parser.BitsPerSample() > 8 * image.bytesPerSample)
+			return JpegLsInvalidParameter;
+
+		unsigned int components = parser.ScanComponents();
+		unsigned int componentIndex[MaxComponents];
+		for (unsigned int c = 0; c < components; c++) {
+			componentIndex[c] = parser.ScanComponentIndex(c);
+			if (decoded[componentIndex[c]])
+				return JpegLsInvalidData;
+			decoded[componentIndex[c]] = true;
+		}
+
+		if (!DecodeScan(parser.ScanData(), parser.End(), parser.ScanParameters(), parser.Interleave(),
+						componentIndex, components, image))
+			return JpegLsInvalidData;
+		parser.SkipScan();
+	}
+	if (status != JpegLsOk)
+		return status;
+
+	for (unsigned int c = 0; c < image.components; c++) {
+		if (!decoded[c])
+			return JpegLsInvalidData;
+	}
+	return JpegLsOk;
+}
+
+const char* JpegLsCoder::GetStatusMessage(JpegLsStatus status)
+{
+	switch (status) {
+	case JpegLsOk:
+		return "Success";
+	case JpegLsInvalidData:
+		return "The JPEG-LS data is invalid or damaged";
+	case JpegLsUnsupported:
+		return "The JPEG-LS data uses features that are not supported";
+	case JpegLsInvalidParameter:
+		return "The image description does not match the JPEG-LS data";
+	default:
+		return "Unknown JPEG-LS error";
+	}
+}
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
+
+#pragma managed(pop)
@@ -0,0 +1,112 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#ifndef __JPEGLSCODER_H__
+#define __JPEGLSCODER_H__
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+enum JpegLsStatus {
+	JpegLsOk,
+	JpegLsInvalidData,		// the stream is damaged or is not JPEG-LS
+	JpegLsUnsupported,		// valid JPEG-LS that this coder does not handle (mapping tables, restarts, ...)
+	JpegLsInvalidParameter,	// the frame does not fit the image description, or a bad encoder parameter
+};
+
+// Interleave mode of the scans (ILV in the SOS marker)
+enum JpegLsInterleave {
+	JpegLsInterleaveNone = 0,	// one scan per component
+	JpegLsInterleaveLine = 1,	// one scan, components interleaved line by line
+	JpegLsInterleaveSample = 2	// one scan, components interleaved sample by sample
+};
+
+// The uncompressed samples of one frame, in the low bitsStored bits of 1 or 2
+// byte little endian words, either interleaved by pixel or planar.  The encoder
+// ignores the bits above bitsStored and the decoder clears them, so signed
+// samples are coded as their two's complement bits.
+struct JpegLsImage {
+	unsigned char* data;
+	size_t size;
+	unsigned int width;
+	unsigned int height;
+	unsigned int components;
+	unsigned int bitsStored;
+	unsigned int bytesPerSample;
+	bool planar;
+};
+
+// Frame and scan parameters read from a JPEG-LS stream.
+struct JpegLsFrameInfo {
+	unsigned int width;
+	unsigned int height;
+	unsigned int components;
+	unsigned int bitsPerSample;
+	int allowedError;			// NEAR of the first scan
+	JpegLsInterleave interleave;
+};
+
+// Native JPEG-LS (ISO/IEC 14495-1, ITU-T T.87) baseline encoder and decoder.
+//
+// Implements the regular and run modes of LOCO-I for 2 to 16 bit samples and up
+// to four components, lossless and near-lossless, in all three interleave modes.
+// Preset coding parameters (LSE type 1) are read; mapping tables, oversize
+// dimensions and restart intervals are not supported.
+//
+// The context modeller computes the previous-row part of every context (the
+// D1 and D2 gradients) for a whole line at once, four samples at a time with
+// SSE2 where available, so that only the D3 gradient, which depends on the
+// sample just decoded, is left on the serial path.
+//
+// All methods are reentrant; separate frames can be coded on separate threads.
+class JpegLsCoder {
+public:
+	// Encodes a frame with the default coding parameters.  allowedError is NEAR,
+	// 0 for lossless.
+	static JpegLsStatus Encode(const JpegLsImage& image, int allowedError, JpegLsInterleave interleave,
+		std::vector<unsigned char>& output);
+
+	// Reads the frame header and the first scan header.
+	static JpegLsStatus ReadHeader(const unsigned char* data, size_t length, JpegLsFrameInfo& info);
+
+	// Decodes a frame into image, which must match the frame's dimensions and
+	// have room for all of its samples.
+	static JpegLsStatus Decode(const unsigned char* data, size_t length, const JpegLsImage& image);
+
+	static const char* GetStatusMessage(JpegLsStatus status);
+};
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
+
+#endif
@@ -0,0 +1,183 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#include "stdlib.h"
+
+#include "JpegMemoryArena.h"
+
+// slab offsets are kept at this alignment, enough for any IJG structure and the SSE2 code paths
+#define ARENA_ALIGNMENT 16
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+// The allocator is called from the native IJG code for every pool; keep it native too.
+#pragma managed(push, off)
+
+static size_t AlignedSize(size_t size)
+{
+	return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+JpegMemoryArena::JpegMemoryArena(size_t limit)
+{
+	_slab = NULL;
+	_capacity = 0;
+	_used = 0;
+	_limit = limit;
+	_outstanding = 0;
+	_outstandingBytes = 0;
+	_highWater = 0;
+	_statistics.allocations = 0;
+	_statistics.bytes = 0;
+	_statistics.heapAllocations = 0;
+}
+
+JpegMemoryArena::~JpegMemoryArena()
+{
+	free(_slab);
+}
+
+void JpegMemoryArena::SetLimit(size_t limit)
+{
+	_limit = limit;
+	if (_outstanding == 0 && _capacity > _limit)
+		Resize(_limit);
+}
+
+void JpegMemoryArena::Reserve(size_t bytes)
+{
+	if (bytes > _limit)
+		bytes = _limit;
+	if (_outstanding == 0 && bytes > _capacity)
+		Resize(bytes);
+}
+
+void JpegMemoryArena::Resize(size_t capacity)
+{
+	free(_slab);
+	_slab = capacity > 0 ? (char*) malloc(AlignedSize(capacity)) : NULL;
+	_capacity = _slab != NULL ? AlignedSize(capacity) : 0;
+	_used = 0;
+}
+
+void* JpegMemoryArena::Allocate(size_t size)
+{
+	size_t aligned = AlignedSize(size > 0 ? size : 1);
+
+	void* object;
+	if (_capacity - _used >= aligned) {
+		object = _slab + _used;
+		_used += aligned;
+	}
+	else {
+		object = malloc(size);
+		if (object == NULL)
+			return NULL;
+		_statistics.heapAllocations++;
+	}
+
+	_statistics.allocations++;
+	_statistics.bytes += size;
+
+	_outstanding++;
+	_outstandingBytes += aligned;
+	if (_outstandingBytes > _highWater)
+		_highWater = _outstandingBytes;
+	return object;
+}
+
+void JpegMemoryArena::Free(void* object, size_t size)
+{
+	char* block = (char*) object;
+	if (block < _slab || block >= _slab + _capacity)
+		free(object);
+
+	_outstandingBytes -= AlignedSize(size > 0 ? size : 1);
+	if (--_outstanding > 0)
+		return;
+
+	// idle: rewind, and make room for everything the objects just destroyed needed
+	_used = 0;
+	_outstandingBytes = 0;
+	if (_highWater > _capacity && _capacity < _limit)
+		Resize(_highWater < _limit ? _highWater : _limit);
+	_highWater = 0;
+}
+
+#pragma managed(pop)
+
+JpegMemoryStatistics::JpegMemoryStatistics(const JpegArenaStatistics& before, const JpegArenaStatistics& after)
+{
+	_allocations = (Int64) (after.allocations - before.allocations);
+	_bytes = (Int64) (after.bytes - before.bytes);
+	_heapAllocations = (Int64) (after.heapAllocations - before.heapAllocations);
+}
+
+JpegMemoryStatistics JpegMemoryStatistics::operator+(JpegMemoryStatistics a, JpegMemoryStatistics b)
+{
+	a._allocations += b._allocations;
+	a._bytes += b._bytes;
+	a._heapAllocations += b._heapAllocations;
+	return a;
+}
+
+JpegThreadArena::JpegThreadArena(size_t limit)
+{
+	_arena = new JpegMemoryArena(limit);
+}
+
+JpegThreadArena::~JpegThreadArena()
+{
+	this->!JpegThreadArena();
+}
+
+JpegThreadArena::!JpegThreadArena()
+{
+	delete _arena;
+	_arena = NULL;
+}
+
+JpegMemoryArena* JpegThreadArena::Get(int limit)
+{
+	if (limit <= 0) {
+		// give back the memory of a thread that no longer uses its arena
+		if (_current != nullptr)
+			_current->_arena->SetLimit(0);
+		return NULL;
+	}
+
+	if (_current == nullptr)
+		_current = gcnew JpegThreadArena(limit);
+	else
+		_current->_arena->SetLimit(limit);
+	return _current->_arena;
+}
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
@@ -0,0 +1,145 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#ifndef __JPEGMEMORYARENA_H__
+#define __JPEGMEMORYARENA_H__
+
+#pragma once
+
+#include <stddef.h>
+
+using namespace System;
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+// Running totals of the requests served by a JpegMemoryArena.
+struct JpegArenaStatistics {
+	size_t allocations;
+	size_t bytes;
+	size_t heapAllocations;		// requests that did not fit in the slab and went to malloc()
+};
+
+// Memory source for the IJG libraries (see jpeg_arena_mgr in jpeglibN.h).
+//
+// The IJG memory manager requests a handful of pools and large buffers per
+// JPEG object and frees all of them when the object is destroyed, so the
+// arena serves requests by bumping a pointer through one slab and rewinds
+// when the last outstanding block comes back.  The slab outlives the JPEG
+// objects: the next frame coded on the same thread reuses it instead of going
+// back to the process heap.  Requests that do not fit are passed on to
+// malloc(), and the slab is grown to the high-water mark, up to the limit,
+// once it is idle again.
+//
+// An arena is not thread safe; JpegThreadArena gives each thread its own.
+class JpegMemoryArena {
+public:
+	explicit JpegMemoryArena(size_t limit);
+	~JpegMemoryArena();
+
+	// Largest slab the arena keeps.  Lowering the limit releases a larger slab
+	// as soon as the arena is idle.
+	size_t GetLimit() const { return _limit; }
+	void SetLimit(size_t limit);
+
+	size_t GetCapacity() const { return _capacity; }
+
+	// Grows an idle slab to hold at least bytes (but no more than the limit),
+	// typically an estimate from the geometry of the image about to be coded.
+	void Reserve(size_t bytes);
+
+	// Returns NULL when a request that does not fit in the slab cannot be met by malloc().
+	void* Allocate(size_t size);
+	void Free(void* object, size_t size);
+
+	const JpegArenaStatistics& GetStatistics() const { return _statistics; }
+
+private:
+	JpegMemoryArena(const JpegMemoryArena&);
+	JpegMemoryArena& operator=(const JpegMemoryArena&);
+
+	void Resize(size_t capacity);
+
+	char* _slab;
+	size_t _capacity;
+	size_t _used;
+	size_t _limit;
+
+	// blocks handed out and not yet freed, and the most bytes outstanding since the slab was last idle
+	size_t _outstanding;
+	size_t _outstandingBytes;
+	size_t _highWater;
+
+	JpegArenaStatistics _statistics;
+};
+
+// Memory drawn from the IJG memory arenas by a codec call.
+public value class JpegMemoryStatistics {
+public:
+	// Number of memory requests made by the IJG library
+	property Int64 Allocations { Int64 get() { return _allocations; } }
+	// Total bytes requested
+	property Int64 Bytes { Int64 get() { return _bytes; } }
+	// Requests that were not served from an arena and went to the process heap
+	property Int64 HeapAllocations { Int64 get() { return _heapAllocations; } }
+
+	static JpegMemoryStatistics operator+(JpegMemoryStatistics a, JpegMemoryStatistics b);
+
+internal:
+	// the requests made between two readings of an arena's statistics
+	JpegMemoryStatistics(const JpegArenaStatistics& before, const JpegArenaStatistics& after);
+
+private:
+	Int64 _allocations;
+	Int64 _bytes;
+	Int64 _heapAllocations;
+};
+
+// The JpegMemoryArena of the current thread.  Arenas are created on first use
+// and released when their thread is gone.
+ref class JpegThreadArena {
+public:
+	// Returns the calling thread's arena with its limit set to limit, or NULL when limit is 0.
+	static JpegMemoryArena* Get(int limit);
+
+	~JpegThreadArena();
+	!JpegThreadArena();
+
+private:
+	JpegThreadArena(size_t limit);
+
+	JpegMemoryArena* _arena;
+
+	[ThreadStatic]
+	static JpegThreadArena^ _current;
+};
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
+
+#endif
@@ -0,0 +1,177 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#include "string.h"
+
+#include "JpegHeaderProbe.h"
+#include "JpegRestartIndex.h"
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+JpegRestartIndex::JpegRestartIndex()
+{
+	_data = NULL;
+	_sofOffset = 0;
+	_entropyOffset = 0;
+	_width = 0;
+	_height = 0;
+	_components = 0;
+	_rowsPerInterval = 0;
+}
+
+bool JpegRestartIndex::Build(const unsigned char* data, size_t length)
+{
+	_data = data;
+	_intervalStart.clear();
+	_intervalEnd.clear();
+
+	JpegHeaderProbe header;
+	if (!header.Probe(data, length, false))
+		return false;
+
+	// baseline, extended sequential and lossless Huffman only
+	unsigned char sof = header.GetSofMarker();
+	if (sof != 0xC0 && sof != 0xC1 && sof != 0xC3)
+		return false;
+
+	// every component must be in the one and only scan
+	_width = header.GetImageWidth();
+	_height = header.GetImageHeight();
+	_components = header.GetComponents();
+	if (_width == 0 || _height == 0 || _components > JPEG_PROBE_MAX_COMPONENTS || header.GetFirstScanComponents() != _components)
+		return false;
+
+	unsigned int restartInterval = header.GetRestartInterval();
+	if (restartInterval == 0)
+		return false;
+
+	unsigned int maxH = header.GetMaxHSampling();
+	unsigned int maxV = header.GetMaxVSampling();
+	for (unsigned int c = 0; c < _components; c++) {
+		if (header.GetComponent(c).vSampling != maxV)
+			return false;
+	}
+
+	_sofOffset = header.GetSofOffset();
+	_entropyOffset = header.GetEntropyOffset();
+	unsigned int dataUnit = header.IsLossless() ? 1 : 8;
+
+	// MCU geometry; a single component scan is not interleaved, so its MCU is one data unit
+	unsigned int mcuWidth = dataUnit;
+	unsigned int mcuHeight = dataUnit;
+	if (_components > 1) {
+		mcuWidth *= maxH;
+		mcuHeight *= maxV;
+	}
+	unsigned int mcusPerRow = (_width + mcuWidth - 1) / mcuWidth;
+	unsigned int mcuRows = (_height + mcuHeight - 1) / mcuHeight;
+
+	// intervals must end on MCU row boundaries for the bands to be rectangular
+	if (restartInterval % mcusPerRow != 0)
+		return false;
+	unsigned int mcuRowsPerInterval = restartInterval / mcusPerRow;
+	_rowsPerInterval = mcuRowsPerInterval * mcuHeight;
+
+	// find the RST markers in the entropy coded data
+	size_t position = _entropyOffset;
+	size_t scanEnd = length;
+	_intervalStart.push_back(position);
+	while (position < length) {
+		const unsigned char* found = (const unsigned char*) memchr(data + position, 0xFF, length - position);
+		if (found == NULL)
+			break;
+
+		size_t markerOffset = found - data;
+		size_t next = markerOffset + 1;
+		while (next < length && data[next] == 0xFF)
+			next++;
+		if (next >= length) {
+			scanEnd = markerOffset;
+			break;
+		}
+
+		unsigned char code = data[next];
+		if (code == 0x00) {
+			position = next + 1; // stuffed zero byte
+		}
+		else if (code >= 0xD0 && code <= 0xD7) {
+			_intervalEnd.push_back(markerOffset);
+			_intervalStart.push_back(next + 1);
+			position = next + 1;
+		}
+		else if (code == 0xD9) {
+			scanEnd = markerOffset;
+			break;
+		}
+		else {
+			return false; // another scan, DNL or a damaged stream
+		}
+	}
+	_intervalEnd.push_back(scanEnd);
+
+	unsigned int expectedIntervals = (mcuRows + mcuRowsPerInterval - 1) / mcuRowsPerInterval;
+	if (_intervalStart.size() != expectedIntervals)
+		return false;
+
+	return true;
+}
+
+void JpegRestartIndex::BuildBand(unsigned int firstInterval, unsigned int intervalCount,
+								 std::vector<unsigned char>& band, unsigned int& firstRow, unsigned int& rowCount) const
+{
+	firstRow = firstInterval * _rowsPerInterval;
+	rowCount = intervalCount * _rowsPerInterval;
+	if (firstRow + rowCount > _height)
+		rowCount = _height - firstRow;
+
+	size_t entropyLength = _intervalEnd[firstInterval + intervalCount - 1] - _intervalStart[firstInterval];
+
+	band.clear();
+	band.reserve(_entropyOffset + entropyLength + 2);
+	band.insert(band.end(), _data, _data + _entropyOffset);
+
+	// SOF: length(2), precision(1), then the number of lines
+	band[_sofOffset + 5] = (unsigned char) (rowCount >> 8);
+	band[_sofOffset + 6] = (unsigned char) (rowCount & 0xFF);
+
+	for (unsigned int i = 0; i < intervalCount; i++) {
+		unsigned int interval = firstInterval + i;
+		if (i > 0) {
+			band.push_back(0xFF);
+			band.push_back((unsigned char) (0xD0 + ((i - 1) & 7)));
+		}
+		band.insert(band.end(), _data + _intervalStart[interval], _data + _intervalEnd[interval]);
+	}
+
+	band.push_back(0xFF);
+	band.push_back(0xD9);
+}
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
@@ -0,0 +1,92 @@
+#pragma region License
+
+// Copyright (c) 2012, ClearCanvas Inc.
+// All rights reserved.
+// http://www.clearcanvas.ca
+//
+// This file is part of the ClearCanvas RIS/PACS open source project.
+//
+// The ClearCanvas RIS/PACS open source project is free software: you can
+// redistribute it and/or modify it under the terms of the GNU Lesser Public
+// License as published by the Free Software Foundation, either version 3 of
+// the License, or (at your option) any later version.
+//
+// The ClearCanvas RIS/PACS open source project is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+// warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser Public License for more details.
+//
+// You should have received a copy of the GNU Lesser Public License along with
+// the ClearCanvas RIS/PACS open source project.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#pragma endregion
+
+#ifndef __JPEGRESTARTINDEX_H__
+#define __JPEGRESTARTINDEX_H__
+
+#pragma once
+
+#include <vector>
+
+namespace ClearCanvas {
+namespace Dicom {
+namespace Codec {
+namespace Jpeg {
+
+// Index of the restart intervals in a single-scan JPEG frame.
+//
+// When a frame was encoded with a restart interval that is a whole number of
+// MCU rows, every interval can be entropy decoded independently of the others.
+// The index records where each interval starts in the compressed data, and
+// can build a standalone JPEG stream for any run of intervals (a "band") so
+// that the bands of one frame can be decoded on separate threads.
+class JpegRestartIndex {
+public:
+	JpegRestartIndex();
+
+	// Scans the stream and indexes its restart markers.  Returns false if the
+	// frame cannot be split into independently decodable bands: no restart
+	// interval, more than one scan, arithmetic coding, restart intervals that
+	// are not whole MCU rows, vertically subsampled components (fancy
+	// upsampling needs context across band boundaries), or a damaged stream.
+	bool Build(const unsigned char* data, size_t length);
+
+	unsigned int GetImageWidth() const { return _width; }
+	unsigned int GetImageHeight() const { return _height; }
+	unsigned int GetComponents() const { return _components; }
+
+	// Number of restart intervals in the scan.
+	unsigned int GetIntervalCount() const { return (unsigned int) _intervalStart.size(); }
+
+	// Number of image rows covered by each full restart interval.
+	unsigned int GetRowsPerInterval() const { return _rowsPerInterval; }
+
+	// Builds a standalone JPEG stream for the intervals [firstInterval, firstInterval + intervalCount).
+	// The SOF height is patched to the band height and the restart markers are
+	// renumbered from RST0, so the band decodes exactly as the same rows of the
+	// full frame.  Returns the first image row and the number of rows in the band.
+	void BuildBand(unsigned int firstInterval, unsigned int intervalCount,
+		std::vector<unsigned char>& band, unsigned int& firstRow, unsigned int& rowCount) const;
+
+private:
+	const unsigned char* _data;
+	size_t _sofOffset;
+	size_t _entropyOffset;
+	unsigned int _width;
+	unsigned int _height;
+	unsigned int _components;
+	unsigned int _rowsPerInterval;
+
+	// offset of the first entropy coded byte of each interval, and of the
+	// marker that terminates it (RSTn or the end-of-scan marker)
+	std::vector<size_t> _intervalStart;
+	std::vector<size_t> _intervalEnd;
+};
+
+} // Jpeg
+} // Codec
+} // Dicom
+} // ClearCanvas
+
+#endif
@@ -19,6 +19,7 @@
 #define JPEG_INTERNALS
 #include "jinclude12.h"
 #include "jpeglib12.h"
+#include "jsimd12.h"		/* Private declarations for SSE2 code */
 
 
 /* Private subobject */
@@ -180,6 +181,100 @@ rgb_ycc_convert (j_compress_ptr cinfo,
 }
 
 
+#ifdef RGB_SSE2_SUPPORTED
+
+/*
+ * SSE2 version of rgb_ycc_convert, for eight pixels at a time.
+ *
+ * The table entries are computed on the fly with _mm_madd_epi16 on the
+ * pairs (R,G), (B,G) and (G,B).  FIX(0.58700) does not fit in 16 bits, so
+ * it is split between the two pairs holding G, and FIX(0.50000) is just
+ * 1 << (SCALEBITS-1).  The sums and the rounding are those of rgb_ycc_start,
+ * so the output is identical to rgb_ycc_convert's.
+ */
+
+INLINE
+LOCAL(void)
+rgb_ycc_4 (JSAMPROW inptr, __m128i * y, __m128i * cb, __m128i * cr)
+{
+  const __m128i k_y0 = PAIR(FIX(0.29900), FIX(0.58700) - 32767);
+  const __m128i k_y1 = PAIR(FIX(0.11400), 32767);
+  const __m128i k_cb = PAIR(-FIX(0.16874), -FIX(0.33126));
+  const __m128i k_cr = PAIR(-FIX(0.41869), -FIX(0.08131));
+  const __m128i y_offset = _mm_set1_epi32(ONE_HALF);
+  const __m128i cbcr_offset = _mm_set1_epi32(CBCR_OFFSET + ONE_HALF-1);
+  __m128i r, g, b, rg, bg, gb;
+
+  load_rgb(inptr, &r, &g, &b);
+  rg = _mm_or_si128(r, _mm_slli_epi32(g, 16));
+  bg = _mm_or_si128(b, _mm_slli_epi32(g, 16));
+  gb = _mm_or_si128(g, _mm_slli_epi32(b, 16));
+
+  *y = _mm_add_epi32(_mm_madd_epi16(rg, k_y0), _mm_madd_epi16(bg, k_y1));
+  *y = _mm_srai_epi32(_mm_add_epi32(*y, y_offset), SCALEBITS);
+  *cb = _mm_add_epi32(_mm_madd_epi16(rg, k_cb),
+		      _mm_slli_epi32(b, SCALEBITS-1));
+  *cb = _mm_srai_epi32(_mm_add_epi32(*cb, cbcr_offset), SCALEBITS);
+  *cr = _mm_add_epi32(_mm_slli_epi32(r, SCALEBITS-1),
+		      _mm_madd_epi16(gb, k_cr));
+  *cr = _mm_srai_epi32(_mm_add_epi32(*cr, cbcr_offset), SCALEBITS);
+}
+
+
+INLINE
+LOCAL(void)
+rgb_ycc_8 (JSAMPROW inptr,
+	   JSAMPROW outptr0, JSAMPROW outptr1, JSAMPROW outptr2)
+{
+  __m128i y0, cb0, cr0, y1, cb1, cr1;
+
+  rgb_ycc_4(inptr, &y0, &cb0, &cr0);
+  rgb_ycc_4(inptr + 4 * RGB_PIXELSIZE, &y1, &cb1, &cr1);
+  STORE_SAMPLES(outptr0, _mm_packs_epi32(y0, y1));
+  STORE_SAMPLES(outptr1, _mm_packs_epi32(cb0, cb1));
+  STORE_SAMPLES(outptr2, _mm_packs_epi32(cr0, cr1));
+}
+
+
+METHODDEF(void)
+rgb_ycc_convert_sse2 (j_compress_ptr cinfo,
+		      JSAMPARRAY input_buf, JSAMPIMAGE output_buf,
+		      JDIMENSION output_row, int num_rows)
+{
+  JSAMPROW inptr;
+  JSAMPROW outptr0, outptr1, outptr2;
+  JDIMENSION col, tail;
+  JDIMENSION num_cols = cinfo->image_width;
+  JSAMPLE inbuf[8 * RGB_PIXELSIZE], outbuf[3][8];
+
+  while (--num_rows >= 0) {
+    inptr = *input_buf++;
+    outptr0 = output_buf[0][output_row];
+    outptr1 = output_buf[1][output_row];
+    outptr2 = output_buf[2][output_row];
+    output_row++;
+    for (col = 0; col + 8 <= num_cols; col += 8) {
+      rgb_ycc_8(inptr, outptr0 + col, outptr1 + col, outptr2 + col);
+      inptr += 8 * RGB_PIXELSIZE;
+    }
+    /* The last few pixels go through a buffer, so that we neither read nor
+     * write beyond the ends of the rows.
+     */
+    tail = num_cols - col;
+    if (tail > 0) {
+      MEMZERO(inbuf, SIZEOF(inbuf));
+      MEMCOPY(inbuf, inptr, tail * RGB_PIXELSIZE * SIZEOF(JSAMPLE));
+      rgb_ycc_8(inbuf, outbuf[0], outbuf[1], outbuf[2]);
+      MEMCOPY(outptr0 + col, outbuf[0], tail * SIZEOF(JSAMPLE));
+      MEMCOPY(outptr1 + col, outbuf[1], tail * SIZEOF(JSAMPLE));
+      MEMCOPY(outptr2 + col, outbuf[2], tail * SIZEOF(JSAMPLE));
+    }
+  }
+}
+
+#endif /* RGB_SSE2_SUPPORTED */
+
+
 /**************** Cases other than RGB -> YCbCr **************/
 
 
@@ -430,6 +525,10 @@ jinit_color_converter (j_compress_ptr cinfo)
     if (cinfo->in_color_space == JCS_RGB) {
       cconvert->pub.start_pass = rgb_ycc_start;
       cconvert->pub.color_convert = rgb_ycc_convert;
+#ifdef RGB_SSE2_SUPPORTED
+      if (jpeg_simd_sse2())
+	cconvert->pub.color_convert = rgb_ycc_convert_sse2;
+#endif
     } else if (cinfo->in_color_space == JCS_YCbCr)
       cconvert->pub.color_convert = null_convert;
     else
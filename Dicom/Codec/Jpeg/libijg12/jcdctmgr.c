@@ -369,6 +369,10 @@ jinit_forward_dct (j_compress_ptr cinfo)
   case JDCT_ISLOW:
     lossyc->fdct_forward_DCT = forward_DCT;
     fdct->do_dct = jpeg_fdct_islow;
+#ifdef DCT_SSE2_SUPPORTED
+    if (jpeg_simd_sse2())
+      fdct->do_dct = jpeg_fdct_islow_sse2;
+#endif
     break;
 #endif
 #ifdef DCT_IFAST_SUPPORTED
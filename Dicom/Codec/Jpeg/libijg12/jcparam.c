@@ -21,6 +21,7 @@
 #define JPEG_INTERNALS
 #include "jinclude12.h"
 #include "jpeglib12.h"
+#include "jchuff12.h"		/* Declarations shared with jc*huff.c */
 
 
 /*
@@ -658,6 +659,12 @@ jpeg_simple_lossless (j_compress_ptr cinfo, int predictor, int point_transform)
 
   cinfo->lossless = TRUE;
 
+  /* The default DC tables cannot code every difference, so gather
+   * statistics unless the application installs tables of its own with
+   * jpeg_lossless_huff_table.
+   */
+  cinfo->optimize_coding = TRUE;
+
   /* Set jpeg_color_space. */
   jpeg_default_colorspace(cinfo);
 
@@ -692,4 +699,38 @@ jpeg_simple_lossless (j_compress_ptr cinfo, int predictor, int point_transform)
   scanptr->Al = point_transform;
 }
 
+
+/*
+ * Define DC Huffman table tblno for single-pass lossless compression.
+ * freq[] holds the relative frequencies of the difference categories
+ * 0..MAX_DIFF_BITS.  Every category gets a code, even one whose frequency
+ * is 0, so that the table can code any image; the application can then
+ * clear optimize_coding and skip the statistics-gathering pass.
+ */
+
+GLOBAL(void)
+jpeg_lossless_huff_table (j_compress_ptr cinfo, int tblno, const long * freq)
+{
+  JHUFF_TBL ** htblptr;
+  long counts[257];
+  int i;
+
+  /* Safety check to ensure start_compress not called yet. */
+  if (cinfo->global_state != CSTATE_START)
+    ERREXIT1(cinfo, JERR_BAD_STATE, cinfo->global_state);
+
+  if (tblno < 0 || tblno >= NUM_HUFF_TBLS)
+    ERREXIT1(cinfo, JERR_NO_HUFF_TABLE, tblno);
+
+  htblptr = & cinfo->dc_huff_tbl_ptrs[tblno];
+  if (*htblptr == NULL)
+    *htblptr = jpeg_alloc_huff_table((j_common_ptr) cinfo);
+
+  /* Note that jpeg_gen_optimal_table expects 257 entries, and clobbers them */
+  MEMZERO(counts, SIZEOF(counts));
+  for (i = 0; i <= MAX_DIFF_BITS; i++)
+    counts[i] = freq[i] > 0 ? freq[i] : 1;
+  jpeg_gen_optimal_table(cinfo, *htblptr, counts);
+}
+
 #endif /* C_LOSSLESS_SUPPORTED */
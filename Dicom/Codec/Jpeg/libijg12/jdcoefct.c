@@ -180,6 +180,13 @@ decompress_onepass (j_decompress_ptr cinfo, JSAMPIMAGE output_buf)
 	coef->MCU_ctr = MCU_col_num;
 	return JPEG_SUSPENDED;
       }
+      /* Only the MCUs in the crop window are inverse transformed, and none
+       * while rows are being skipped.
+       */
+      if (cinfo->master->skip_idct ||
+	  MCU_col_num < cinfo->master->first_iMCU_col ||
+	  MCU_col_num > cinfo->master->last_iMCU_col)
+	continue;
       /* Determine where data should go in output_buf and do the IDCT thing.
        * We skip dummy blocks at the right and bottom edges (but blkn gets
        * incremented past them!).  Note the inner loop relies on having
@@ -198,7 +205,8 @@ decompress_onepass (j_decompress_ptr cinfo, JSAMPIMAGE output_buf)
 						    : compptr->last_col_width;
 	output_ptr = output_buf[compptr->component_index] +
 	  yoffset * compptr->codec_data_unit;
-	start_col = MCU_col_num * compptr->MCU_sample_width;
+	start_col = (MCU_col_num - cinfo->master->first_iMCU_col) *
+		    compptr->MCU_sample_width;
 	for (yindex = 0; yindex < compptr->MCU_height; yindex++) {
 	  if (cinfo->input_iMCU_row < last_iMCU_row ||
 	      yoffset+yindex < compptr->last_row_height) {
@@ -348,8 +356,8 @@ decompress_data (j_decompress_ptr cinfo, JSAMPIMAGE output_buf)
   /* OK, output from the virtual arrays. */
   for (ci = 0, compptr = cinfo->comp_info; ci < cinfo->num_components;
        ci++, compptr++) {
-    /* Don't bother to IDCT an uninteresting component. */
-    if (! compptr->component_needed)
+    /* Don't bother to IDCT an uninteresting component, or skipped rows. */
+    if (! compptr->component_needed || cinfo->master->skip_idct)
       continue;
     /* Align the virtual buffer for this component. */
     buffer = (*cinfo->mem->access_virt_barray)
@@ -366,11 +374,12 @@ decompress_data (j_decompress_ptr cinfo, JSAMPIMAGE output_buf)
     }
     inverse_DCT = lossyd->inverse_DCT[ci];
     output_ptr = output_buf[ci];
-    /* Loop over all DCT blocks to be processed. */
+    /* Loop over the DCT blocks in the crop window. */
     for (block_row = 0; block_row < block_rows; block_row++) {
-      buffer_ptr = buffer[block_row];
+      buffer_ptr = buffer[block_row] + cinfo->master->first_MCU_col[ci];
       output_col = 0;
-      for (block_num = 0; block_num < compptr->width_in_data_units; block_num++) {
+      for (block_num = cinfo->master->first_MCU_col[ci];
+	   block_num <= cinfo->master->last_MCU_col[ci]; block_num++) {
 	(*inverse_DCT) (cinfo, compptr, (JCOEFPTR) buffer_ptr,
 			output_ptr, output_col);
 	buffer_ptr++;
@@ -476,7 +485,7 @@ decompress_smooth_data (j_decompress_ptr cinfo, JSAMPIMAGE output_buf)
   j_lossy_d_ptr lossyd = (j_lossy_d_ptr) cinfo->codec;
   d_coef_ptr coef = (d_coef_ptr) lossyd->coef_private;
   JDIMENSION last_iMCU_row = cinfo->total_iMCU_rows - 1;
-  JDIMENSION block_num, last_block_column;
+  JDIMENSION block_num, first_block_column, last_block_column;
   int ci, block_row, block_rows, access_rows;
   JBLOCKARRAY buffer;
   JBLOCKROW buffer_ptr, prev_block_row, next_block_row;
@@ -512,8 +521,8 @@ decompress_smooth_data (j_decompress_ptr cinfo, JSAMPIMAGE output_buf)
   /* OK, output from the virtual arrays. */
   for (ci = 0, compptr = cinfo->comp_info; ci < cinfo->num_components;
        ci++, compptr++) {
-    /* Don't bother to IDCT an uninteresting component. */
-    if (! compptr->component_needed)
+    /* Don't bother to IDCT an uninteresting component, or skipped rows. */
+    if (! compptr->component_needed || cinfo->master->skip_idct)
       continue;
     /* Count non-dummy DCT block rows in this iMCU row. */
     if (cinfo->output_iMCU_row < last_iMCU_row) {
@@ -553,26 +562,34 @@ decompress_smooth_data (j_decompress_ptr cinfo, JSAMPIMAGE output_buf)
     Q02 = quanttbl->quantval[Q02_POS];
     inverse_DCT = lossyd->inverse_DCT[ci];
     output_ptr = output_buf[ci];
-    /* Loop over all DCT blocks to be processed. */
+    /* Loop over the DCT blocks in the crop window. */
+    first_block_column = cinfo->master->first_MCU_col[ci];
     for (block_row = 0; block_row < block_rows; block_row++) {
-      buffer_ptr = buffer[block_row];
+      buffer_ptr = buffer[block_row] + first_block_column;
       if (first_row && block_row == 0)
 	prev_block_row = buffer_ptr;
       else
-	prev_block_row = buffer[block_row-1];
+	prev_block_row = buffer[block_row-1] + first_block_column;
       if (last_row && block_row == block_rows-1)
 	next_block_row = buffer_ptr;
       else
-	next_block_row = buffer[block_row+1];
+	next_block_row = buffer[block_row+1] + first_block_column;
       /* We fetch the surrounding DC values using a sliding-register approach.
        * Initialize all nine here so as to do the right thing on narrow pics.
+       * Inside a crop window, the left neighbours are real blocks.
        */
       DC1 = DC2 = DC3 = (int) prev_block_row[0][0];
       DC4 = DC5 = DC6 = (int) buffer_ptr[0][0];
       DC7 = DC8 = DC9 = (int) next_block_row[0][0];
+      if (first_block_column > 0) {
+	DC1 = (int) prev_block_row[-1][0];
+	DC4 = (int) buffer_ptr[-1][0];
+	DC7 = (int) next_block_row[-1][0];
+      }
       output_col = 0;
       last_block_column = compptr->width_in_data_units - 1;
-      for (block_num = 0; block_num <= last_block_column; block_num++) {
+      for (block_num = first_block_column;
+	   block_num <= cinfo->master->last_MCU_col[ci]; block_num++) {
 	/* Fetch current DCT block into workspace so we can modify it. */
 	jcopy_block_row(buffer_ptr, (JBLOCKROW) workspace, (JDIMENSION) 1);
 	/* Update DC values */
@@ -19,6 +19,7 @@
 #define JPEG_INTERNALS
 #include "jinclude12.h"
 #include "jpeglib12.h"
+#include "jsimd12.h"		/* Private declarations for SSE2 code */
 
 
 /* Private subobject */
@@ -182,6 +183,113 @@ ycc_rgb_convert (j_decompress_ptr cinfo,
 }
 
 
+#ifdef RGB_SSE2_SUPPORTED
+
+/*
+ * SSE2 version of ycc_rgb_convert, for eight pixels at a time.
+ *
+ * The table entries are computed on the fly with _mm_madd_epi16.  Each
+ * multiplier FIX(k) needs 17 bits, so it is split as 4 * (FIX(k) >> 2) +
+ * (FIX(k) & 3) and applied to the pair (4x, x), which is exact as long as
+ * 4x fits in 16 bits (BITS_IN_JSAMPLE <= 12).  The rounding is that of
+ * build_ycc_rgb_table, and since the offsets never exceed the margins of
+ * sample_range_limit, its range limiting is a clamp; the output is
+ * therefore identical to ycc_rgb_convert's.
+ */
+
+INLINE
+LOCAL(void)
+ycc_rgb_offsets (__m128i cb, __m128i cr,
+		 __m128i * cred, __m128i * cgreen, __m128i * cblue)
+{
+  const __m128i center = _mm_set1_epi16(CENTERJSAMPLE);
+  const __m128i one_half = _mm_set1_epi32(ONE_HALF);
+  const __m128i k_r = PAIR(FIX(1.40200) >> 2, FIX(1.40200) & 3);
+  const __m128i k_b = PAIR(FIX(1.77200) >> 2, FIX(1.77200) & 3);
+  const __m128i k_gb = PAIR(-(FIX(0.34414) >> 2), -(FIX(0.34414) & 3));
+  const __m128i k_gr = PAIR(-(FIX(0.71414) >> 2), -(FIX(0.71414) & 3));
+  __m128i b_lo, b_hi, r_lo, r_hi, lo, hi;
+
+  cb = _mm_sub_epi16(cb, center);
+  cr = _mm_sub_epi16(cr, center);
+  b_lo = _mm_unpacklo_epi16(_mm_slli_epi16(cb, 2), cb);
+  b_hi = _mm_unpackhi_epi16(_mm_slli_epi16(cb, 2), cb);
+  r_lo = _mm_unpacklo_epi16(_mm_slli_epi16(cr, 2), cr);
+  r_hi = _mm_unpackhi_epi16(_mm_slli_epi16(cr, 2), cr);
+
+  lo = _mm_add_epi32(_mm_madd_epi16(r_lo, k_r), one_half);
+  hi = _mm_add_epi32(_mm_madd_epi16(r_hi, k_r), one_half);
+  *cred = _mm_packs_epi32(_mm_srai_epi32(lo, SCALEBITS),
+			  _mm_srai_epi32(hi, SCALEBITS));
+
+  lo = _mm_add_epi32(_mm_madd_epi16(b_lo, k_b), one_half);
+  hi = _mm_add_epi32(_mm_madd_epi16(b_hi, k_b), one_half);
+  *cblue = _mm_packs_epi32(_mm_srai_epi32(lo, SCALEBITS),
+			   _mm_srai_epi32(hi, SCALEBITS));
+
+  lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(b_lo, k_gb),
+				   _mm_madd_epi16(r_lo, k_gr)), one_half);
+  hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(b_hi, k_gb),
+				   _mm_madd_epi16(r_hi, k_gr)), one_half);
+  *cgreen = _mm_packs_epi32(_mm_srai_epi32(lo, SCALEBITS),
+			    _mm_srai_epi32(hi, SCALEBITS));
+}
+
+
+INLINE
+LOCAL(void)
+ycc_rgb_8 (JSAMPROW inptr0, JSAMPROW inptr1, JSAMPROW inptr2,
+	   JSAMPROW outptr)
+{
+  __m128i y, cred, cgreen, cblue;
+
+  ycc_rgb_offsets(LOAD_SAMPLES(inptr1), LOAD_SAMPLES(inptr2),
+		  &cred, &cgreen, &cblue);
+  y = LOAD_SAMPLES(inptr0);
+  store_rgb(outptr, CLAMP_SAMPLES(_mm_add_epi16(y, cred)),
+	    CLAMP_SAMPLES(_mm_add_epi16(y, cgreen)),
+	    CLAMP_SAMPLES(_mm_add_epi16(y, cblue)));
+}
+
+
+METHODDEF(void)
+ycc_rgb_convert_sse2 (j_decompress_ptr cinfo,
+		      JSAMPIMAGE input_buf, JDIMENSION input_row,
+		      JSAMPARRAY output_buf, int num_rows)
+{
+  JSAMPROW inptr0, inptr1, inptr2, outptr;
+  JDIMENSION col, tail;
+  JDIMENSION num_cols = cinfo->output_width;
+  JSAMPLE inbuf[3][8], outbuf[8 * RGB_PIXELSIZE];
+
+  while (--num_rows >= 0) {
+    inptr0 = input_buf[0][input_row];
+    inptr1 = input_buf[1][input_row];
+    inptr2 = input_buf[2][input_row];
+    input_row++;
+    outptr = *output_buf++;
+    for (col = 0; col + 8 <= num_cols; col += 8) {
+      ycc_rgb_8(inptr0 + col, inptr1 + col, inptr2 + col, outptr);
+      outptr += 8 * RGB_PIXELSIZE;
+    }
+    /* The last few pixels go through a buffer, so that we neither read nor
+     * write beyond the ends of the rows.
+     */
+    tail = num_cols - col;
+    if (tail > 0) {
+      MEMZERO(inbuf, SIZEOF(inbuf));
+      MEMCOPY(inbuf[0], inptr0 + col, tail * SIZEOF(JSAMPLE));
+      MEMCOPY(inbuf[1], inptr1 + col, tail * SIZEOF(JSAMPLE));
+      MEMCOPY(inbuf[2], inptr2 + col, tail * SIZEOF(JSAMPLE));
+      ycc_rgb_8(inbuf[0], inbuf[1], inbuf[2], outbuf);
+      MEMCOPY(outptr, outbuf, tail * RGB_PIXELSIZE * SIZEOF(JSAMPLE));
+    }
+  }
+}
+
+#endif /* RGB_SSE2_SUPPORTED */
+
+
 /**************** Cases other than YCbCr -> RGB **************/
 
 
@@ -384,6 +492,10 @@ jinit_color_deconverter (j_decompress_ptr cinfo)
     cinfo->out_color_components = RGB_PIXELSIZE;
     if (cinfo->jpeg_color_space == JCS_YCbCr) {
       cconvert->pub.color_convert = ycc_rgb_convert;
+#ifdef RGB_SSE2_SUPPORTED
+      if (jpeg_simd_sse2())
+	cconvert->pub.color_convert = ycc_rgb_convert_sse2;
+#endif
       build_ycc_rgb_table(cinfo);
     } else if (cinfo->jpeg_color_space == JCS_GRAYSCALE) {
       cconvert->pub.color_convert = gray_rgb_convert;
@@ -0,0 +1,749 @@
+#pragma region License (non-CC)
+
+// This source code contains the work of the Independent JPEG Group.
+// Please see accompanying notice in code comments and/or readme file
+// for the terms of distribution and use regarding this code.
+
+#pragma endregion
+
+/*
+ * jdctsse2.c
+ *
+ * This file contains SSE2 versions of the slow-but-accurate integer
+ * forward and inverse DCT (jfdctint.c and jidctint.c).
+ *
+ * Apart from the final descaling shifts, every output of a 1-D pass is a
+ * fixed integer combination of its eight inputs, and the C code evaluates
+ * it with 32-bit IJG_INT32 additions and multiplications.  Whenever the
+ * inputs of a pass are small enough (16 bits for the IDCT, 14 for the
+ * forward DCT, which adds them up before multiplying), that combination is
+ * computed here with pmaddwd on eight rows or columns at once; being exact
+ * modulo 2^32 it gives the same bits as the C code.  Blocks that do not
+ * fit (corrupt data, unusual quantization tables, 12-bit forward DCT of
+ * extreme blocks) go through a second path that repeats the C arithmetic
+ * step by step on 32-bit lanes, including the zero AC shortcuts.  The
+ * range limiting table lookup is replaced by the equivalent wrap-and-clamp.
+ * The results are therefore bit-exact with jpeg_fdct_islow and
+ * jpeg_idct_islow for any input.
+ *
+ * These routines are selected at runtime by jcdctmgr.c and jddctmgr.c
+ * when the processor supports SSE2.
+ */
+
+#define JPEG_INTERNALS
+#include "jinclude12.h"
+#include "jpeglib12.h"
+#include "jdct12.h"		/* Private declarations for DCT subsystem */
+
+#ifdef DCT_SSE2_SUPPORTED
+
+#include <emmintrin.h>
+
+
+/*
+ * This module is specialized to the case DCTSIZE = 8.
+ */
+
+#if DCTSIZE != 8
+  Sorry, this code only copes with 8x8 DCTs. /* deliberate syntax err */
+#endif
+
+
+/* Scaling and constants are the same as in jfdctint.c and jidctint.c. */
+
+#if BITS_IN_JSAMPLE == 8
+#define CONST_BITS  13
+#define PASS1_BITS  2
+#else
+#define CONST_BITS  13
+#define PASS1_BITS  1		/* lose a little precision to avoid overflow */
+#endif
+
+#define FIX_0_298631336  2446
+#define FIX_0_390180644  3196
+#define FIX_0_541196100  4433
+#define FIX_0_765366865  6270
+#define FIX_0_899976223  7373
+#define FIX_1_175875602  9633
+#define FIX_1_501321110  12299
+#define FIX_1_847759065  15137
+#define FIX_1_961570560  16069
+#define FIX_2_053119869  16819
+#define FIX_2_562915447  20995
+#define FIX_3_072711026  25172
+
+
+/*
+ * Helpers for the 16-bit path.
+ *
+ * MADD(u,c0,c1) multiplies the 16-bit pairs (a,b) interleaved in u by
+ * _mm_unpack*_epi16 as a*c0 + b*c1; all the constants below fit in 16
+ * bits, so the products and their sum cannot overflow.
+ */
+
+#define PAIR(c0,c1)  _mm_set_epi16(c1,c0,c1,c0,c1,c0,c1,c0)
+
+#define MADD(u,c0,c1)  _mm_madd_epi16(u, PAIR(c0,c1))
+
+/* Coefficients of the odd part, expanded from the rotations of figure 8 */
+/* for inputs (i0, i1, i2, i3) of the C code. */
+
+#define ODD_C  FIX_1_175875602
+#define ODD_0  (FIX_0_298631336 - FIX_0_899976223 - FIX_1_961570560 + ODD_C)
+#define ODD_1  (FIX_2_053119869 - FIX_2_562915447 - FIX_0_390180644 + ODD_C)
+#define ODD_2  (FIX_3_072711026 - FIX_2_562915447 - FIX_1_961570560 + ODD_C)
+#define ODD_3  (FIX_1_501321110 - FIX_0_899976223 - FIX_0_390180644 + ODD_C)
+
+/*
+ * Pack the 32-bit values lo/hi[k] (lanes 0..3 and 4..7) into x[k].
+ * Returns FALSE if any of them does not fit in the given number of bits.
+ */
+
+LOCAL(boolean)
+pack_16 (const __m128i lo[8], const __m128i hi[8], __m128i x[8], int bits)
+{
+  __m128i bias = _mm_set1_epi32(1 << (bits-1));
+  __m128i acc = _mm_setzero_si128();
+  int i;
+
+  for (i = 0; i < DCTSIZE; i++) {
+    acc = _mm_or_si128(acc, _mm_add_epi32(lo[i], bias));
+    acc = _mm_or_si128(acc, _mm_add_epi32(hi[i], bias));
+    x[i] = _mm_packs_epi32(lo[i], hi[i]);
+  }
+  acc = _mm_srl_epi32(acc, _mm_cvtsi32_si128(bits));
+  return _mm_movemask_epi8(_mm_cmpeq_epi32(acc, _mm_setzero_si128())) == 0xFFFF;
+}
+
+/* Transpose an 8x8 block of 16-bit values. */
+
+LOCAL(void)
+transpose8_16 (__m128i x[8])
+{
+  __m128i a0, a1, a2, a3, a4, a5, a6, a7;
+  __m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+  a0 = _mm_unpacklo_epi16(x[0], x[1]);
+  a1 = _mm_unpackhi_epi16(x[0], x[1]);
+  a2 = _mm_unpacklo_epi16(x[2], x[3]);
+  a3 = _mm_unpackhi_epi16(x[2], x[3]);
+  a4 = _mm_unpacklo_epi16(x[4], x[5]);
+  a5 = _mm_unpackhi_epi16(x[4], x[5]);
+  a6 = _mm_unpacklo_epi16(x[6], x[7]);
+  a7 = _mm_unpackhi_epi16(x[6], x[7]);
+
+  b0 = _mm_unpacklo_epi32(a0, a2);
+  b1 = _mm_unpackhi_epi32(a0, a2);
+  b2 = _mm_unpacklo_epi32(a1, a3);
+  b3 = _mm_unpackhi_epi32(a1, a3);
+  b4 = _mm_unpacklo_epi32(a4, a6);
+  b5 = _mm_unpackhi_epi32(a4, a6);
+  b6 = _mm_unpacklo_epi32(a5, a7);
+  b7 = _mm_unpackhi_epi32(a5, a7);
+
+  x[0] = _mm_unpacklo_epi64(b0, b4);
+  x[1] = _mm_unpackhi_epi64(b0, b4);
+  x[2] = _mm_unpacklo_epi64(b1, b5);
+  x[3] = _mm_unpackhi_epi64(b1, b5);
+  x[4] = _mm_unpacklo_epi64(b2, b6);
+  x[5] = _mm_unpackhi_epi64(b2, b6);
+  x[6] = _mm_unpacklo_epi64(b3, b7);
+  x[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+
+/*
+ * Helpers for the 32-bit path.
+ *
+ * mul_const returns the low 32 bits of the product of each lane of a and
+ * the constant c, which is what the C code gets from an IJG_INT32
+ * multiply.  SSE2 has no 32-bit multiply-low, so the even and odd lanes go
+ * through pmuludq separately; the low half of a product does not depend
+ * on the signedness of the operands.
+ */
+
+LOCAL(__m128i)
+mul_const (__m128i a, __m128i c)
+{
+  __m128i even = _mm_mul_epu32(a, c);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), c);
+
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)),
+			    _mm_shuffle_epi32(odd, _MM_SHUFFLE(0,0,2,0)));
+}
+
+/* Same, for two variables. */
+
+LOCAL(__m128i)
+mul_var (__m128i a, __m128i b)
+{
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)),
+			    _mm_shuffle_epi32(odd, _MM_SHUFFLE(0,0,2,0)));
+}
+
+#define MULTIPLY(var,const)  mul_const(var, _mm_set1_epi32(const))
+
+/* DESCALE with the shift count held in a register, see jdct12.h. */
+
+LOCAL(__m128i)
+descale (__m128i x, int n)
+{
+  x = _mm_add_epi32(x, _mm_set1_epi32(1 << (n-1)));
+  return _mm_sra_epi32(x, _mm_cvtsi32_si128(n));
+}
+
+/* Transpose the 4x4 block of 32-bit values held in r0..r3. */
+
+#define TRANSPOSE4(r0,r1,r2,r3)  { \
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1); \
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3); \
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1); \
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3); \
+    r0 = _mm_unpacklo_epi64(t0, t1); \
+    r1 = _mm_unpackhi_epi64(t0, t1); \
+    r2 = _mm_unpacklo_epi64(t2, t3); \
+    r3 = _mm_unpackhi_epi64(t2, t3); }
+
+/* Transpose an 8x8 block of 32-bit values held as 8 rows of two halves. */
+
+LOCAL(void)
+transpose8_32 (__m128i lo[8], __m128i hi[8])
+{
+  __m128i t;
+  int i;
+
+  TRANSPOSE4(lo[0], lo[1], lo[2], lo[3]);
+  TRANSPOSE4(hi[4], hi[5], hi[6], hi[7]);
+  TRANSPOSE4(hi[0], hi[1], hi[2], hi[3]);
+  TRANSPOSE4(lo[4], lo[5], lo[6], lo[7]);
+  /* swap the off-diagonal blocks */
+  for (i = 0; i < 4; i++) {
+    t = hi[i];
+    hi[i] = lo[i+4];
+    lo[i+4] = t;
+  }
+}
+
+
+#ifdef DCT_ISLOW_SUPPORTED
+
+/*
+ * Multiplications of the forward DCT for four lanes.  u[0..3] hold the
+ * interleaved pairs (tmp10,tmp11), (tmp13,tmp12), (tmp4,tmp5), (tmp6,tmp7)
+ * of the C code.
+ */
+
+LOCAL(void)
+fdct_half_16 (const __m128i u[4], __m128i out[8], boolean pass1)
+{
+  int n = pass1 ? CONST_BITS-PASS1_BITS : CONST_BITS+PASS1_BITS;
+
+  /* Even part */
+
+  out[0] = MADD(u[0], 1, 1);
+  out[4] = MADD(u[0], 1, -1);
+  if (pass1) {
+    out[0] = _mm_slli_epi32(out[0], PASS1_BITS);
+    out[4] = _mm_slli_epi32(out[4], PASS1_BITS);
+  } else {
+    out[0] = descale(out[0], PASS1_BITS);
+    out[4] = descale(out[4], PASS1_BITS);
+  }
+
+  out[2] = descale(MADD(u[1], FIX_0_541196100 + FIX_0_765366865,
+			FIX_0_541196100), n);
+  out[6] = descale(MADD(u[1], FIX_0_541196100,
+			FIX_0_541196100 - FIX_1_847759065), n);
+
+  /* Odd part; i0..i3 are tmp4..tmp7. */
+
+  out[7] = descale(_mm_add_epi32(MADD(u[2], ODD_0, ODD_C),
+    MADD(u[3], ODD_C - FIX_1_961570560, ODD_C - FIX_0_899976223)), n);
+  out[5] = descale(_mm_add_epi32(MADD(u[2], ODD_C, ODD_1),
+    MADD(u[3], ODD_C - FIX_2_562915447, ODD_C - FIX_0_390180644)), n);
+  out[3] = descale(_mm_add_epi32(MADD(u[2], ODD_C - FIX_1_961570560, ODD_C - FIX_2_562915447),
+    MADD(u[3], ODD_2, ODD_C)), n);
+  out[1] = descale(_mm_add_epi32(MADD(u[2], ODD_C - FIX_0_899976223, ODD_C - FIX_0_390180644),
+    MADD(u[3], ODD_C, ODD_3)), n);
+}
+
+
+/*
+ * One 1-D pass of the forward DCT over the eight 16-bit lanes of x[0..7],
+ * leaving the outputs of lanes 0..3 in lo[0..7] and of lanes 4..7 in
+ * hi[0..7].  The inputs must fit in 14 bits, so that the sums and
+ * differences of the first two stages fit in 16.
+ */
+
+LOCAL(void)
+fdct_1d_16 (const __m128i x[8], __m128i lo[8], __m128i hi[8], boolean pass1)
+{
+  __m128i tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+  __m128i tmp10, tmp11, tmp12, tmp13;
+  __m128i u[4];
+
+  tmp0 = _mm_add_epi16(x[0], x[7]);
+  tmp7 = _mm_sub_epi16(x[0], x[7]);
+  tmp1 = _mm_add_epi16(x[1], x[6]);
+  tmp6 = _mm_sub_epi16(x[1], x[6]);
+  tmp2 = _mm_add_epi16(x[2], x[5]);
+  tmp5 = _mm_sub_epi16(x[2], x[5]);
+  tmp3 = _mm_add_epi16(x[3], x[4]);
+  tmp4 = _mm_sub_epi16(x[3], x[4]);
+
+  tmp10 = _mm_add_epi16(tmp0, tmp3);
+  tmp13 = _mm_sub_epi16(tmp0, tmp3);
+  tmp11 = _mm_add_epi16(tmp1, tmp2);
+  tmp12 = _mm_sub_epi16(tmp1, tmp2);
+
+  u[0] = _mm_unpacklo_epi16(tmp10, tmp11);
+  u[1] = _mm_unpacklo_epi16(tmp13, tmp12);
+  u[2] = _mm_unpacklo_epi16(tmp4, tmp5);
+  u[3] = _mm_unpacklo_epi16(tmp6, tmp7);
+  fdct_half_16(u, lo, pass1);
+
+  u[0] = _mm_unpackhi_epi16(tmp10, tmp11);
+  u[1] = _mm_unpackhi_epi16(tmp13, tmp12);
+  u[2] = _mm_unpackhi_epi16(tmp4, tmp5);
+  u[3] = _mm_unpackhi_epi16(tmp6, tmp7);
+  fdct_half_16(u, hi, pass1);
+}
+
+
+/*
+ * One 1-D pass of the forward DCT over four 32-bit lanes, in place,
+ * following the C code step by step.
+ */
+
+LOCAL(void)
+fdct_1d_32 (__m128i d[8], boolean pass1)
+{
+  __m128i tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+  __m128i tmp10, tmp11, tmp12, tmp13;
+  __m128i z1, z2, z3, z4, z5;
+  int n = pass1 ? CONST_BITS-PASS1_BITS : CONST_BITS+PASS1_BITS;
+
+  tmp0 = _mm_add_epi32(d[0], d[7]);
+  tmp7 = _mm_sub_epi32(d[0], d[7]);
+  tmp1 = _mm_add_epi32(d[1], d[6]);
+  tmp6 = _mm_sub_epi32(d[1], d[6]);
+  tmp2 = _mm_add_epi32(d[2], d[5]);
+  tmp5 = _mm_sub_epi32(d[2], d[5]);
+  tmp3 = _mm_add_epi32(d[3], d[4]);
+  tmp4 = _mm_sub_epi32(d[3], d[4]);
+
+  /* Even part */
+
+  tmp10 = _mm_add_epi32(tmp0, tmp3);
+  tmp13 = _mm_sub_epi32(tmp0, tmp3);
+  tmp11 = _mm_add_epi32(tmp1, tmp2);
+  tmp12 = _mm_sub_epi32(tmp1, tmp2);
+
+  if (pass1) {
+    d[0] = _mm_slli_epi32(_mm_add_epi32(tmp10, tmp11), PASS1_BITS);
+    d[4] = _mm_slli_epi32(_mm_sub_epi32(tmp10, tmp11), PASS1_BITS);
+  } else {
+    d[0] = descale(_mm_add_epi32(tmp10, tmp11), PASS1_BITS);
+    d[4] = descale(_mm_sub_epi32(tmp10, tmp11), PASS1_BITS);
+  }
+
+  z1 = MULTIPLY(_mm_add_epi32(tmp12, tmp13), FIX_0_541196100);
+  d[2] = descale(_mm_add_epi32(z1, MULTIPLY(tmp13, FIX_0_765366865)), n);
+  d[6] = descale(_mm_add_epi32(z1, MULTIPLY(tmp12, - FIX_1_847759065)), n);
+
+  /* Odd part */
+
+  z1 = _mm_add_epi32(tmp4, tmp7);
+  z2 = _mm_add_epi32(tmp5, tmp6);
+  z3 = _mm_add_epi32(tmp4, tmp6);
+  z4 = _mm_add_epi32(tmp5, tmp7);
+  z5 = MULTIPLY(_mm_add_epi32(z3, z4), FIX_1_175875602);
+
+  tmp4 = MULTIPLY(tmp4, FIX_0_298631336);
+  tmp5 = MULTIPLY(tmp5, FIX_2_053119869);
+  tmp6 = MULTIPLY(tmp6, FIX_3_072711026);
+  tmp7 = MULTIPLY(tmp7, FIX_1_501321110);
+  z1 = MULTIPLY(z1, - FIX_0_899976223);
+  z2 = MULTIPLY(z2, - FIX_2_562915447);
+  z3 = MULTIPLY(z3, - FIX_1_961570560);
+  z4 = MULTIPLY(z4, - FIX_0_390180644);
+
+  z3 = _mm_add_epi32(z3, z5);
+  z4 = _mm_add_epi32(z4, z5);
+
+  d[7] = descale(_mm_add_epi32(tmp4, _mm_add_epi32(z1, z3)), n);
+  d[5] = descale(_mm_add_epi32(tmp5, _mm_add_epi32(z2, z4)), n);
+  d[3] = descale(_mm_add_epi32(tmp6, _mm_add_epi32(z2, z3)), n);
+  d[1] = descale(_mm_add_epi32(tmp7, _mm_add_epi32(z1, z4)), n);
+}
+
+
+/*
+ * Perform the forward DCT on one block of samples.
+ * DCTELEM must be 32 bits wide, which jdct12.h guarantees when it enables
+ * DCT_SSE2_SUPPORTED.
+ */
+
+GLOBAL(void)
+jpeg_fdct_islow_sse2 (DCTELEM * data)
+{
+  __m128i x[8], lo[8], hi[8];
+  int i;
+
+  for (i = 0; i < DCTSIZE; i++) {
+    lo[i] = _mm_loadu_si128((const __m128i *) (data + i*DCTSIZE));
+    hi[i] = _mm_loadu_si128((const __m128i *) (data + i*DCTSIZE + 4));
+  }
+
+  if (pack_16(lo, hi, x, 14)) {
+    /* Pass 1: process rows; x[k] holds sample k of every row, and the */
+    /* outputs for rows 0..3 and 4..7 land in lo/hi[k]. */
+    transpose8_16(x);
+    fdct_1d_16(x, lo, hi, TRUE);
+
+    /* Pass 2: process columns; x[k] holds row k. */
+    if (pack_16(lo, hi, x, 14)) {
+      transpose8_16(x);
+      fdct_1d_16(x, lo, hi, FALSE);
+      goto store;
+    }
+  } else {
+    transpose8_32(lo, hi);
+    fdct_1d_32(lo, TRUE);
+    fdct_1d_32(hi, TRUE);
+  }
+
+  /* Pass 2 with 32-bit intermediates; lo/hi[k] are back to holding row k. */
+  transpose8_32(lo, hi);
+  fdct_1d_32(lo, FALSE);
+  fdct_1d_32(hi, FALSE);
+
+store:
+  for (i = 0; i < DCTSIZE; i++) {
+    _mm_storeu_si128((__m128i *) (data + i*DCTSIZE), lo[i]);
+    _mm_storeu_si128((__m128i *) (data + i*DCTSIZE + 4), hi[i]);
+  }
+}
+
+
+/*
+ * One 1-D pass of the inverse DCT for four lanes, descaling by n.  u[0..3]
+ * hold the interleaved input pairs (0,4), (2,6), (7,5) and (3,1).
+ */
+
+LOCAL(void)
+idct_half_16 (const __m128i u[4], __m128i out[8], int n)
+{
+  __m128i tmp0, tmp1, tmp2, tmp3;
+  __m128i tmp10, tmp11, tmp12, tmp13;
+
+  /* Even part */
+
+  tmp0 = MADD(u[0], 1 << CONST_BITS, 1 << CONST_BITS);
+  tmp1 = MADD(u[0], 1 << CONST_BITS, - (1 << CONST_BITS));
+  tmp2 = MADD(u[1], FIX_0_541196100, FIX_0_541196100 - FIX_1_847759065);
+  tmp3 = MADD(u[1], FIX_0_541196100 + FIX_0_765366865, FIX_0_541196100);
+
+  tmp10 = _mm_add_epi32(tmp0, tmp3);
+  tmp13 = _mm_sub_epi32(tmp0, tmp3);
+  tmp11 = _mm_add_epi32(tmp1, tmp2);
+  tmp12 = _mm_sub_epi32(tmp1, tmp2);
+
+  /* Odd part; i0..i3 are inputs 7, 5, 3 and 1. */
+
+  tmp0 = _mm_add_epi32(MADD(u[2], ODD_0, ODD_C),
+    MADD(u[3], ODD_C - FIX_1_961570560, ODD_C - FIX_0_899976223));
+  tmp1 = _mm_add_epi32(MADD(u[2], ODD_C, ODD_1),
+    MADD(u[3], ODD_C - FIX_2_562915447, ODD_C - FIX_0_390180644));
+  tmp2 = _mm_add_epi32(MADD(u[2], ODD_C - FIX_1_961570560, ODD_C - FIX_2_562915447),
+    MADD(u[3], ODD_2, ODD_C));
+  tmp3 = _mm_add_epi32(MADD(u[2], ODD_C - FIX_0_899976223, ODD_C - FIX_0_390180644),
+    MADD(u[3], ODD_C, ODD_3));
+
+  /* Final output stage */
+
+  out[0] = descale(_mm_add_epi32(tmp10, tmp3), n);
+  out[7] = descale(_mm_sub_epi32(tmp10, tmp3), n);
+  out[1] = descale(_mm_add_epi32(tmp11, tmp2), n);
+  out[6] = descale(_mm_sub_epi32(tmp11, tmp2), n);
+  out[2] = descale(_mm_add_epi32(tmp12, tmp1), n);
+  out[5] = descale(_mm_sub_epi32(tmp12, tmp1), n);
+  out[3] = descale(_mm_add_epi32(tmp13, tmp0), n);
+  out[4] = descale(_mm_sub_epi32(tmp13, tmp0), n);
+}
+
+
+/*
+ * One 1-D pass of the inverse DCT over the eight 16-bit lanes of x[0..7],
+ * leaving the outputs of lanes 0..3 in lo[0..7] and of lanes 4..7 in
+ * hi[0..7].  With 16-bit inputs the C code's zero AC shortcuts produce the
+ * same values as the full calculation.
+ */
+
+LOCAL(void)
+idct_1d_16 (const __m128i x[8], __m128i lo[8], __m128i hi[8], int n)
+{
+  __m128i u[4];
+
+  u[0] = _mm_unpacklo_epi16(x[0], x[4]);
+  u[1] = _mm_unpacklo_epi16(x[2], x[6]);
+  u[2] = _mm_unpacklo_epi16(x[7], x[5]);
+  u[3] = _mm_unpacklo_epi16(x[3], x[1]);
+  idct_half_16(u, lo, n);
+
+  u[0] = _mm_unpackhi_epi16(x[0], x[4]);
+  u[1] = _mm_unpackhi_epi16(x[2], x[6]);
+  u[2] = _mm_unpackhi_epi16(x[7], x[5]);
+  u[3] = _mm_unpackhi_epi16(x[3], x[1]);
+  idct_half_16(u, hi, n);
+}
+
+
+/*
+ * One 1-D pass of the inverse DCT over four 32-bit lanes, in place,
+ * following the C code step by step.  The lanes of zero_mask whose AC
+ * inputs are all zero get dc instead, as the C code's shortcut would
+ * produce.
+ */
+
+LOCAL(void)
+idct_1d_32 (__m128i w[8], int n, __m128i zero_mask, __m128i dc)
+{
+  __m128i tmp0, tmp1, tmp2, tmp3;
+  __m128i tmp10, tmp11, tmp12, tmp13;
+  __m128i z1, z2, z3, z4, z5;
+  int i;
+
+  /* Even part */
+
+  z2 = w[2];
+  z3 = w[6];
+
+  z1 = MULTIPLY(_mm_add_epi32(z2, z3), FIX_0_541196100);
+  tmp2 = _mm_add_epi32(z1, MULTIPLY(z3, - FIX_1_847759065));
+  tmp3 = _mm_add_epi32(z1, MULTIPLY(z2, FIX_0_765366865));
+
+  tmp0 = _mm_slli_epi32(_mm_add_epi32(w[0], w[4]), CONST_BITS);
+  tmp1 = _mm_slli_epi32(_mm_sub_epi32(w[0], w[4]), CONST_BITS);
+
+  tmp10 = _mm_add_epi32(tmp0, tmp3);
+  tmp13 = _mm_sub_epi32(tmp0, tmp3);
+  tmp11 = _mm_add_epi32(tmp1, tmp2);
+  tmp12 = _mm_sub_epi32(tmp1, tmp2);
+
+  /* Odd part */
+
+  tmp0 = w[7];
+  tmp1 = w[5];
+  tmp2 = w[3];
+  tmp3 = w[1];
+
+  z1 = _mm_add_epi32(tmp0, tmp3);
+  z2 = _mm_add_epi32(tmp1, tmp2);
+  z3 = _mm_add_epi32(tmp0, tmp2);
+  z4 = _mm_add_epi32(tmp1, tmp3);
+  z5 = MULTIPLY(_mm_add_epi32(z3, z4), FIX_1_175875602);
+
+  tmp0 = MULTIPLY(tmp0, FIX_0_298631336);
+  tmp1 = MULTIPLY(tmp1, FIX_2_053119869);
+  tmp2 = MULTIPLY(tmp2, FIX_3_072711026);
+  tmp3 = MULTIPLY(tmp3, FIX_1_501321110);
+  z1 = MULTIPLY(z1, - FIX_0_899976223);
+  z2 = MULTIPLY(z2, - FIX_2_562915447);
+  z3 = MULTIPLY(z3, - FIX_1_961570560);
+  z4 = MULTIPLY(z4, - FIX_0_390180644);
+
+  z3 = _mm_add_epi32(z3, z5);
+  z4 = _mm_add_epi32(z4, z5);
+
+  tmp0 = _mm_add_epi32(tmp0, _mm_add_epi32(z1, z3));
+  tmp1 = _mm_add_epi32(tmp1, _mm_add_epi32(z2, z4));
+  tmp2 = _mm_add_epi32(tmp2, _mm_add_epi32(z2, z3));
+  tmp3 = _mm_add_epi32(tmp3, _mm_add_epi32(z1, z4));
+
+  /* Final output stage */
+
+  w[0] = descale(_mm_add_epi32(tmp10, tmp3), n);
+  w[7] = descale(_mm_sub_epi32(tmp10, tmp3), n);
+  w[1] = descale(_mm_add_epi32(tmp11, tmp2), n);
+  w[6] = descale(_mm_sub_epi32(tmp11, tmp2), n);
+  w[2] = descale(_mm_add_epi32(tmp12, tmp1), n);
+  w[5] = descale(_mm_sub_epi32(tmp12, tmp1), n);
+  w[3] = descale(_mm_add_epi32(tmp13, tmp0), n);
+  w[4] = descale(_mm_sub_epi32(tmp13, tmp0), n);
+
+  for (i = 0; i < DCTSIZE; i++)
+    w[i] = _mm_or_si128(_mm_and_si128(zero_mask, dc),
+			_mm_andnot_si128(zero_mask, w[i]));
+}
+
+
+/*
+ * Pass 2 of the IDCT with 32-bit intermediates for four rows, with the
+ * zero AC row test of the C code applied per lane.
+ */
+
+LOCAL(void)
+idct_rows_32 (__m128i w[8])
+{
+  __m128i zero_mask = _mm_setzero_si128();
+  int i;
+
+#ifndef NO_ZERO_ROW_TEST
+  {
+    __m128i ac = w[1];
+
+    for (i = 2; i < DCTSIZE; i++)
+      ac = _mm_or_si128(ac, w[i]);
+    zero_mask = _mm_cmpeq_epi32(ac, _mm_setzero_si128());
+  }
+#endif
+
+  idct_1d_32(w, CONST_BITS+PASS1_BITS+3, zero_mask,
+	     descale(w[0], PASS1_BITS+3));
+}
+
+
+/*
+ * Dequantize the coefficients into x[0..7] as 16-bit values.  Returns
+ * FALSE if a multiplier or a dequantized coefficient does not fit.
+ */
+
+LOCAL(boolean)
+dequantize_16 (JCOEFPTR coef_block, ISLOW_MULT_TYPE * quantptr, __m128i x[8])
+{
+  __m128i qacc = _mm_setzero_si128();
+  __m128i fit = _mm_cmpeq_epi16(qacc, qacc);
+  __m128i coef, qlo, qhi, q16;
+  int i;
+
+  for (i = 0; i < DCTSIZE; i++) {
+    coef = _mm_loadu_si128((const __m128i *) (coef_block + i*DCTSIZE));
+    qlo = _mm_loadu_si128((const __m128i *) (quantptr + i*DCTSIZE));
+    qhi = _mm_loadu_si128((const __m128i *) (quantptr + i*DCTSIZE + 4));
+    qacc = _mm_or_si128(qacc, _mm_or_si128(qlo, qhi));
+    q16 = _mm_packs_epi32(qlo, qhi);
+    x[i] = _mm_mullo_epi16(coef, q16);
+    /* the product fits if its high half is the sign of its low half */
+    fit = _mm_and_si128(fit, _mm_cmpeq_epi16(_mm_mulhi_epi16(coef, q16),
+					     _mm_srai_epi16(x[i], 15)));
+  }
+  /* multipliers must lie in 0..32767 */
+  qacc = _mm_srli_epi32(qacc, 15);
+  fit = _mm_and_si128(fit, _mm_cmpeq_epi32(qacc, _mm_setzero_si128()));
+  return _mm_movemask_epi8(fit) == 0xFFFF;
+}
+
+
+/*
+ * Map descaled IDCT outputs to samples.  This computes exactly what
+ * range_limit[x & RANGE_MASK] returns for the table built by
+ * prepare_range_limit_table (jdmaster.c): the masked value wraps to
+ * +-2*(MAXJSAMPLE+1), and is then offset by CENTERJSAMPLE and clamped
+ * (the clamp is left to put_row).
+ */
+
+LOCAL(__m128i)
+range_limit_16 (__m128i lo, __m128i hi)
+{
+  __m128i half = _mm_set1_epi32(2 * (MAXJSAMPLE+1));
+  __m128i mask = _mm_set1_epi32(RANGE_MASK);
+  __m128i center = _mm_set1_epi32(2 * (MAXJSAMPLE+1) - CENTERJSAMPLE);
+
+  lo = _mm_sub_epi32(_mm_and_si128(_mm_add_epi32(lo, half), mask), center);
+  hi = _mm_sub_epi32(_mm_and_si128(_mm_add_epi32(hi, half), mask), center);
+  /* both now lie within 16 bits, so the pack does not saturate */
+  return _mm_packs_epi32(lo, hi);
+}
+
+/* Clamp a row of range limited values and store it as samples. */
+
+LOCAL(void)
+put_row (JSAMPROW outptr, __m128i row)
+{
+#if BITS_IN_JSAMPLE == 8
+  _mm_storel_epi64((__m128i *) outptr, _mm_packus_epi16(row, row));
+#else
+  row = _mm_max_epi16(row, _mm_setzero_si128());
+  row = _mm_min_epi16(row, _mm_set1_epi16(MAXJSAMPLE));
+  _mm_storeu_si128((__m128i *) outptr, row);
+#endif
+}
+
+
+/*
+ * Perform dequantization and inverse DCT on one block of coefficients.
+ */
+
+GLOBAL(void)
+jpeg_idct_islow_sse2 (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+		      JCOEFPTR coef_block,
+		      JSAMPARRAY output_buf, JDIMENSION output_col)
+{
+  ISLOW_MULT_TYPE * quantptr = (ISLOW_MULT_TYPE *) compptr->dct_table;
+  __m128i x[8], lo[8], hi[8];
+  int i;
+
+  if (dequantize_16(coef_block, quantptr, x)) {
+    /* Pass 1: process columns; x[k] holds row k of the coefficients, and */
+    /* the outputs for columns 0..3 and 4..7 land in lo/hi[k]. */
+    idct_1d_16(x, lo, hi, CONST_BITS-PASS1_BITS);
+
+    /* Pass 2: process rows; after the transpose x[k] holds element k of */
+    /* every row, and lo/hi[k] receive output column k of rows 0..3 and */
+    /* 4..7. */
+    if (pack_16(lo, hi, x, 16)) {
+      transpose8_16(x);
+      idct_1d_16(x, lo, hi, CONST_BITS+PASS1_BITS+3);
+      for (i = 0; i < DCTSIZE; i++)
+	x[i] = range_limit_16(lo[i], hi[i]);
+      transpose8_16(x);
+      for (i = 0; i < DCTSIZE; i++)
+	put_row(output_buf[i] + output_col, x[i]);
+      return;
+    }
+  } else {
+    /* Pass 1 with 32-bit intermediates; lo/hi[k] hold row k of columns */
+    /* 0..3 and 4..7, dequantized. */
+    __m128i coef, ac, zero_lo, zero_hi;
+
+    ac = _mm_setzero_si128();
+    for (i = 0; i < DCTSIZE; i++) {
+      coef = _mm_loadu_si128((const __m128i *) (coef_block + i*DCTSIZE));
+      if (i > 0)
+	ac = _mm_or_si128(ac, coef);
+      lo[i] = mul_var(_mm_srai_epi32(_mm_unpacklo_epi16(coef, coef), 16),
+		      _mm_loadu_si128((const __m128i *) (quantptr + i*DCTSIZE)));
+      hi[i] = mul_var(_mm_srai_epi32(_mm_unpackhi_epi16(coef, coef), 16),
+		      _mm_loadu_si128((const __m128i *) (quantptr + i*DCTSIZE + 4)));
+    }
+
+    /* columns whose AC coefficients are all zero take the DC shortcut */
+    ac = _mm_cmpeq_epi16(ac, _mm_setzero_si128());
+    zero_lo = _mm_unpacklo_epi16(ac, ac);
+    zero_hi = _mm_unpackhi_epi16(ac, ac);
+
+    idct_1d_32(lo, CONST_BITS-PASS1_BITS, zero_lo,
+	       _mm_slli_epi32(lo[0], PASS1_BITS));
+    idct_1d_32(hi, CONST_BITS-PASS1_BITS, zero_hi,
+	       _mm_slli_epi32(hi[0], PASS1_BITS));
+  }
+
+  /* Pass 2 with 32-bit intermediates; after the transpose lo/hi[k] hold */
+  /* element k of rows 0..3 and 4..7. */
+
+  transpose8_32(lo, hi);
+  idct_rows_32(lo);
+  idct_rows_32(hi);
+  transpose8_32(lo, hi);
+
+  for (i = 0; i < DCTSIZE; i++)
+    put_row(output_buf[i] + output_col, range_limit_16(lo[i], hi[i]));
+}
+
+#endif /* DCT_ISLOW_SUPPORTED */
+
+#endif /* DCT_SSE2_SUPPORTED */
@@ -126,6 +126,10 @@ start_pass (j_decompress_ptr cinfo)
 #ifdef DCT_ISLOW_SUPPORTED
       case JDCT_ISLOW:
 	method_ptr = jpeg_idct_islow;
+#ifdef DCT_SSE2_SUPPORTED
+	if (jpeg_simd_sse2())
+	  method_ptr = jpeg_idct_islow_sse2;
+#endif
 	method = JDCT_ISLOW;
 	break;
 #endif
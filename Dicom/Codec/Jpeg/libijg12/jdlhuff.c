@@ -207,6 +207,7 @@ decode_mcus (j_decompress_ptr cinfo, JDIFFIMAGE diff_buf,
   unsigned int mcu_num;
   int sampn, ci, yoffset, MCU_width, ptrn;
   BITREAD_STATE_VARS;
+  SHIFT_TEMPS
 
   /* Set output pointer locations based on MCU_col_num */
   for (ptrn = 0; ptrn < entropy->num_output_ptrs; ptrn++) {
@@ -247,16 +248,9 @@ decode_mcus (j_decompress_ptr cinfo, JDIFFIMAGE diff_buf,
 	register int s, r;
 
 	/* Section H.2.2: decode the sample difference */
-	HUFF_DECODE(s, br_state, dctbl, return mcu_num, label1);
-	if (s) {
-	  if (s == 16)	/* special case: always output 32768 */
-	    s = 32768;
-	  else {	/* normal case: fetch subsequent bits */
-	    CHECK_BIT_BUFFER(br_state, s, return mcu_num);
-	    r = GET_BITS(s);
-	    s = HUFF_EXTEND(r, s);
-	  }
-	}
+	HUFF_DECODE_VALUE(s, r, br_state, dctbl, return mcu_num, label1);
+	if (r)		/* symbol 16, special case: always output 32768 */
+	  s = 32768;
 
 	/* Output the sample difference */
 	*entropy->output_ptr[entropy->output_ptr_index[sampn]]++ = (JDIFF) s;
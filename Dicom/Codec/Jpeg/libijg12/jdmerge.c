@@ -43,6 +43,7 @@
 #define JPEG_INTERNALS
 #include "jinclude12.h"
 #include "jpeglib12.h"
+#include "jsimd12.h"		/* Private declarations for SSE2 code */
 
 #ifdef UPSAMPLE_MERGING_SUPPORTED
 
@@ -366,6 +367,172 @@ h2v2_merged_upsample (j_decompress_ptr cinfo,
 }
 
 
+#ifdef RGB_SSE2_SUPPORTED
+
+/*
+ * SSE2 versions of the merged upsamplers, for sixteen output columns at a
+ * time.  ycc_rgb_offsets is taken directly from jdcolor.c; see that file
+ * for more info.  The output is identical to that of the scalar versions.
+ */
+
+INLINE
+LOCAL(void)
+ycc_rgb_offsets (__m128i cb, __m128i cr,
+		 __m128i * cred, __m128i * cgreen, __m128i * cblue)
+{
+  const __m128i center = _mm_set1_epi16(CENTERJSAMPLE);
+  const __m128i one_half = _mm_set1_epi32(ONE_HALF);
+  const __m128i k_r = PAIR(FIX(1.40200) >> 2, FIX(1.40200) & 3);
+  const __m128i k_b = PAIR(FIX(1.77200) >> 2, FIX(1.77200) & 3);
+  const __m128i k_gb = PAIR(-(FIX(0.34414) >> 2), -(FIX(0.34414) & 3));
+  const __m128i k_gr = PAIR(-(FIX(0.71414) >> 2), -(FIX(0.71414) & 3));
+  __m128i b_lo, b_hi, r_lo, r_hi, lo, hi;
+
+  cb = _mm_sub_epi16(cb, center);
+  cr = _mm_sub_epi16(cr, center);
+  b_lo = _mm_unpacklo_epi16(_mm_slli_epi16(cb, 2), cb);
+  b_hi = _mm_unpackhi_epi16(_mm_slli_epi16(cb, 2), cb);
+  r_lo = _mm_unpacklo_epi16(_mm_slli_epi16(cr, 2), cr);
+  r_hi = _mm_unpackhi_epi16(_mm_slli_epi16(cr, 2), cr);
+
+  lo = _mm_add_epi32(_mm_madd_epi16(r_lo, k_r), one_half);
+  hi = _mm_add_epi32(_mm_madd_epi16(r_hi, k_r), one_half);
+  *cred = _mm_packs_epi32(_mm_srai_epi32(lo, SCALEBITS),
+			  _mm_srai_epi32(hi, SCALEBITS));
+
+  lo = _mm_add_epi32(_mm_madd_epi16(b_lo, k_b), one_half);
+  hi = _mm_add_epi32(_mm_madd_epi16(b_hi, k_b), one_half);
+  *cblue = _mm_packs_epi32(_mm_srai_epi32(lo, SCALEBITS),
+			   _mm_srai_epi32(hi, SCALEBITS));
+
+  lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(b_lo, k_gb),
+				   _mm_madd_epi16(r_lo, k_gr)), one_half);
+  hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(b_hi, k_gb),
+				   _mm_madd_epi16(r_hi, k_gr)), one_half);
+  *cgreen = _mm_packs_epi32(_mm_srai_epi32(lo, SCALEBITS),
+			    _mm_srai_epi32(hi, SCALEBITS));
+}
+
+
+/* Emit 16 pixels from 16 Y values and the chroma terms of 8 Cb/Cr pairs. */
+
+INLINE
+LOCAL(void)
+merged_16 (JSAMPROW inptr0, __m128i * cred, __m128i * cgreen,
+	   __m128i * cblue, JSAMPROW outptr)
+{
+  __m128i y;
+
+  y = LOAD_SAMPLES(inptr0);
+  store_rgb(outptr,
+	    CLAMP_SAMPLES(_mm_add_epi16(y, _mm_unpacklo_epi16(*cred, *cred))),
+	    CLAMP_SAMPLES(_mm_add_epi16(y, _mm_unpacklo_epi16(*cgreen, *cgreen))),
+	    CLAMP_SAMPLES(_mm_add_epi16(y, _mm_unpacklo_epi16(*cblue, *cblue))));
+  y = LOAD_SAMPLES(inptr0 + 8);
+  store_rgb(outptr + 8 * RGB_PIXELSIZE,
+	    CLAMP_SAMPLES(_mm_add_epi16(y, _mm_unpackhi_epi16(*cred, *cred))),
+	    CLAMP_SAMPLES(_mm_add_epi16(y, _mm_unpackhi_epi16(*cgreen, *cgreen))),
+	    CLAMP_SAMPLES(_mm_add_epi16(y, _mm_unpackhi_epi16(*cblue, *cblue))));
+}
+
+
+/*
+ * Upsample and color convert for the case of 2:1 horizontal and 1:1 vertical.
+ * The last few columns go through a buffer, so that we neither read nor
+ * write beyond the ends of the rows.
+ */
+
+METHODDEF(void)
+h2v1_merged_upsample_sse2 (j_decompress_ptr cinfo,
+			   JSAMPIMAGE input_buf, JDIMENSION in_row_group_ctr,
+			   JSAMPARRAY output_buf)
+{
+  JSAMPROW outptr;
+  JSAMPROW inptr0, inptr1, inptr2;
+  JDIMENSION col, tail;
+  JDIMENSION num_cols = cinfo->output_width;
+  __m128i cred, cgreen, cblue;
+  JSAMPLE inbuf0[16], inbuf1[8], inbuf2[8], outbuf[16 * RGB_PIXELSIZE];
+
+  inptr0 = input_buf[0][in_row_group_ctr];
+  inptr1 = input_buf[1][in_row_group_ctr];
+  inptr2 = input_buf[2][in_row_group_ctr];
+  outptr = output_buf[0];
+  for (col = 0; col + 16 <= num_cols; col += 16) {
+    ycc_rgb_offsets(LOAD_SAMPLES(inptr1 + col / 2),
+		    LOAD_SAMPLES(inptr2 + col / 2), &cred, &cgreen, &cblue);
+    merged_16(inptr0 + col, &cred, &cgreen, &cblue, outptr);
+    outptr += 16 * RGB_PIXELSIZE;
+  }
+  tail = num_cols - col;
+  if (tail > 0) {
+    MEMZERO(inbuf0, SIZEOF(inbuf0));
+    MEMZERO(inbuf1, SIZEOF(inbuf1));
+    MEMZERO(inbuf2, SIZEOF(inbuf2));
+    MEMCOPY(inbuf0, inptr0 + col, tail * SIZEOF(JSAMPLE));
+    MEMCOPY(inbuf1, inptr1 + col / 2, ((tail + 1) / 2) * SIZEOF(JSAMPLE));
+    MEMCOPY(inbuf2, inptr2 + col / 2, ((tail + 1) / 2) * SIZEOF(JSAMPLE));
+    ycc_rgb_offsets(LOAD_SAMPLES(inbuf1), LOAD_SAMPLES(inbuf2),
+		    &cred, &cgreen, &cblue);
+    merged_16(inbuf0, &cred, &cgreen, &cblue, outbuf);
+    MEMCOPY(outptr, outbuf, tail * RGB_PIXELSIZE * SIZEOF(JSAMPLE));
+  }
+}
+
+
+/*
+ * Upsample and color convert for the case of 2:1 horizontal and 2:1 vertical.
+ */
+
+METHODDEF(void)
+h2v2_merged_upsample_sse2 (j_decompress_ptr cinfo,
+			   JSAMPIMAGE input_buf, JDIMENSION in_row_group_ctr,
+			   JSAMPARRAY output_buf)
+{
+  JSAMPROW outptr0, outptr1;
+  JSAMPROW inptr00, inptr01, inptr1, inptr2;
+  JDIMENSION col, tail;
+  JDIMENSION num_cols = cinfo->output_width;
+  __m128i cred, cgreen, cblue;
+  JSAMPLE inbuf00[16], inbuf01[16], inbuf1[8], inbuf2[8];
+  JSAMPLE outbuf[16 * RGB_PIXELSIZE];
+
+  inptr00 = input_buf[0][in_row_group_ctr*2];
+  inptr01 = input_buf[0][in_row_group_ctr*2 + 1];
+  inptr1 = input_buf[1][in_row_group_ctr];
+  inptr2 = input_buf[2][in_row_group_ctr];
+  outptr0 = output_buf[0];
+  outptr1 = output_buf[1];
+  for (col = 0; col + 16 <= num_cols; col += 16) {
+    ycc_rgb_offsets(LOAD_SAMPLES(inptr1 + col / 2),
+		    LOAD_SAMPLES(inptr2 + col / 2), &cred, &cgreen, &cblue);
+    merged_16(inptr00 + col, &cred, &cgreen, &cblue, outptr0);
+    merged_16(inptr01 + col, &cred, &cgreen, &cblue, outptr1);
+    outptr0 += 16 * RGB_PIXELSIZE;
+    outptr1 += 16 * RGB_PIXELSIZE;
+  }
+  tail = num_cols - col;
+  if (tail > 0) {
+    MEMZERO(inbuf00, SIZEOF(inbuf00));
+    MEMZERO(inbuf01, SIZEOF(inbuf01));
+    MEMZERO(inbuf1, SIZEOF(inbuf1));
+    MEMZERO(inbuf2, SIZEOF(inbuf2));
+    MEMCOPY(inbuf00, inptr00 + col, tail * SIZEOF(JSAMPLE));
+    MEMCOPY(inbuf01, inptr01 + col, tail * SIZEOF(JSAMPLE));
+    MEMCOPY(inbuf1, inptr1 + col / 2, ((tail + 1) / 2) * SIZEOF(JSAMPLE));
+    MEMCOPY(inbuf2, inptr2 + col / 2, ((tail + 1) / 2) * SIZEOF(JSAMPLE));
+    ycc_rgb_offsets(LOAD_SAMPLES(inbuf1), LOAD_SAMPLES(inbuf2),
+		    &cred, &cgreen, &cblue);
+    merged_16(inbuf00, &cred, &cgreen, &cblue, outbuf);
+    MEMCOPY(outptr0, outbuf, tail * RGB_PIXELSIZE * SIZEOF(JSAMPLE));
+    merged_16(inbuf01, &cred, &cgreen, &cblue, outbuf);
+    MEMCOPY(outptr1, outbuf, tail * RGB_PIXELSIZE * SIZEOF(JSAMPLE));
+  }
+}
+
+#endif /* RGB_SSE2_SUPPORTED */
+
+
 /*
  * Module initialization routine for merged upsampling/color conversion.
  *
@@ -391,6 +558,10 @@ jinit_merged_upsampler (j_decompress_ptr cinfo)
   if (cinfo->max_v_samp_factor == 2) {
     upsample->pub.upsample = merged_2v_upsample;
     upsample->upmethod = h2v2_merged_upsample;
+#ifdef RGB_SSE2_SUPPORTED
+    if (jpeg_simd_sse2())
+      upsample->upmethod = h2v2_merged_upsample_sse2;
+#endif
     /* Allocate a spare row buffer */
     upsample->spare_row = (JSAMPROW)
       (*cinfo->mem->alloc_large) ((j_common_ptr) cinfo, JPOOL_IMAGE,
@@ -398,6 +569,10 @@ jinit_merged_upsampler (j_decompress_ptr cinfo)
   } else {
     upsample->pub.upsample = merged_1v_upsample;
     upsample->upmethod = h2v1_merged_upsample;
+#ifdef RGB_SSE2_SUPPORTED
+    if (jpeg_simd_sse2())
+      upsample->upmethod = h2v1_merged_upsample_sse2;
+#endif
     /* No spare row needed */
     upsample->spare_row = NULL;
   }
@@ -305,6 +305,7 @@ decode_mcu_DC_first (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
   savable_state state;
   d_derived_tbl * tbl;
   jpeg_component_info * compptr;
+  SHIFT_TEMPS
 
   /* Process restart marker if needed; may have to suspend */
   if (cinfo->restart_interval) {
@@ -333,12 +334,7 @@ decode_mcu_DC_first (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
       /* Decode a single block's worth of coefficients */
 
       /* Section F.2.2.1: decode the DC coefficient difference */
-      HUFF_DECODE(s, br_state, tbl, return FALSE, label1);
-      if (s) {
-	CHECK_BIT_BUFFER(br_state, s, return FALSE);
-	r = GET_BITS(s);
-	s = HUFF_EXTEND(r, s);
-      }
+      HUFF_DECODE_VALUE(s, r, br_state, tbl, return FALSE, label1);
 
       /* Convert DC difference to actual value, update last_dc_val */
       s += state.last_dc_val[ci];
@@ -376,6 +372,7 @@ decode_mcu_AC_first (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
   JBLOCKROW block;
   BITREAD_STATE_VARS;
   d_derived_tbl * tbl;
+  SHIFT_TEMPS
 
   /* Process restart marker if needed; may have to suspend */
   if (cinfo->restart_interval) {
@@ -404,14 +401,9 @@ decode_mcu_AC_first (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
       tbl = entropy->ac_derived_tbl;
 
       for (k = cinfo->Ss; k <= Se; k++) {
-	HUFF_DECODE(s, br_state, tbl, return FALSE, label2);
-	r = s >> 4;
-	s &= 15;
+	HUFF_DECODE_VALUE(s, r, br_state, tbl, return FALSE, label2);
 	if (s) {
 	  k += r;
-	  CHECK_BIT_BUFFER(br_state, s, return FALSE);
-	  r = GET_BITS(s);
-	  s = HUFF_EXTEND(r, s);
 	  /* Scale and output coefficient in natural (dezigzagged) order */
 	  (*block)[jpeg_natural_order[k]] = (JCOEF) (s << Al);
 	} else {
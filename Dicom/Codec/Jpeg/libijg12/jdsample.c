@@ -29,6 +29,7 @@
 #define JPEG_INTERNALS
 #include "jinclude12.h"
 #include "jpeglib12.h"
+#include "jsimd12.h"		/* Private declarations for SSE2 code */
 
 
 /* Pointer to routine to upsample a single component */
@@ -399,6 +400,136 @@ h2v2_fancy_upsample (j_decompress_ptr cinfo, jpeg_component_info * compptr,
 }
 
 
+#ifdef SAMPLE_SSE2_SUPPORTED
+
+/*
+ * SSE2 versions of the fancy upsamplers, for eight input columns at a time.
+ * The sums are formed in unsigned 16-bit lanes; with at most 12-bit samples
+ * the largest, 16 * MAXJSAMPLE + 8, still fits, so the output is identical
+ * to that of the scalar versions.  The first and last columns and the
+ * columns left over are done as there.
+ */
+
+#define TIMES_3(x)  _mm_add_epi16(_mm_slli_epi16(x, 1), x)
+
+METHODDEF(void)
+h2v1_fancy_upsample_sse2 (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+			  JSAMPARRAY input_data, JSAMPARRAY * output_data_ptr)
+{
+  JSAMPARRAY output_data = *output_data_ptr;
+  const __m128i one = _mm_set1_epi16(1);
+  const __m128i two = _mm_set1_epi16(2);
+  register JSAMPROW inptr, outptr;
+  register int invalue;
+  JDIMENSION col, width = compptr->downsampled_width;
+  __m128i here, even, odd;
+  int inrow;
+
+  for (inrow = 0; inrow < cinfo->max_v_samp_factor; inrow++) {
+    inptr = input_data[inrow];
+    outptr = output_data[inrow];
+    /* Special case for first column */
+    invalue = GETJSAMPLE(inptr[0]);
+    outptr[0] = (JSAMPLE) invalue;
+    outptr[1] = (JSAMPLE) ((invalue * 3 + GETJSAMPLE(inptr[1]) + 2) >> 2);
+
+    /* General case: 3/4 * nearer pixel + 1/4 * further pixel */
+    for (col = 1; col + 9 <= width; col += 8) {
+      here = TIMES_3(LOAD_SAMPLES(inptr + col));
+      even = _mm_add_epi16(_mm_add_epi16(here, LOAD_SAMPLES(inptr + col - 1)),
+			   one);
+      odd = _mm_add_epi16(_mm_add_epi16(here, LOAD_SAMPLES(inptr + col + 1)),
+			  two);
+      even = _mm_srli_epi16(even, 2);
+      odd = _mm_srli_epi16(odd, 2);
+      STORE_SAMPLES2(outptr + 2 * col, _mm_unpacklo_epi16(even, odd),
+		     _mm_unpackhi_epi16(even, odd));
+    }
+    for (; col < width - 1; col++) {
+      invalue = GETJSAMPLE(inptr[col]) * 3;
+      outptr[2 * col] =
+	(JSAMPLE) ((invalue + GETJSAMPLE(inptr[col - 1]) + 1) >> 2);
+      outptr[2 * col + 1] =
+	(JSAMPLE) ((invalue + GETJSAMPLE(inptr[col + 1]) + 2) >> 2);
+    }
+
+    /* Special case for last column */
+    invalue = GETJSAMPLE(inptr[col]);
+    outptr[2 * col] =
+      (JSAMPLE) ((invalue * 3 + GETJSAMPLE(inptr[col - 1]) + 1) >> 2);
+    outptr[2 * col + 1] = (JSAMPLE) invalue;
+  }
+}
+
+
+METHODDEF(void)
+h2v2_fancy_upsample_sse2 (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+			  JSAMPARRAY input_data, JSAMPARRAY * output_data_ptr)
+{
+  JSAMPARRAY output_data = *output_data_ptr;
+  const __m128i seven = _mm_set1_epi16(7);
+  const __m128i eight = _mm_set1_epi16(8);
+  register JSAMPROW inptr0, inptr1, outptr;
+  register int thiscolsum, lastcolsum, nextcolsum;
+  JDIMENSION col, width = compptr->downsampled_width;
+  __m128i here, even, odd;
+  int inrow, outrow, v;
+
+#define COLSUM(c)  _mm_add_epi16(TIMES_3(LOAD_SAMPLES(inptr0 + (c))), \
+				 LOAD_SAMPLES(inptr1 + (c)))
+
+  inrow = outrow = 0;
+  while (outrow < cinfo->max_v_samp_factor) {
+    for (v = 0; v < 2; v++) {
+      /* inptr0 points to nearest input row, inptr1 points to next nearest */
+      inptr0 = input_data[inrow];
+      if (v == 0)		/* next nearest is row above */
+	inptr1 = input_data[inrow-1];
+      else			/* next nearest is row below */
+	inptr1 = input_data[inrow+1];
+      outptr = output_data[outrow++];
+
+      /* Special case for first column */
+      thiscolsum = GETJSAMPLE(inptr0[0]) * 3 + GETJSAMPLE(inptr1[0]);
+      nextcolsum = GETJSAMPLE(inptr0[1]) * 3 + GETJSAMPLE(inptr1[1]);
+      outptr[0] = (JSAMPLE) ((thiscolsum * 4 + 8) >> 4);
+      outptr[1] = (JSAMPLE) ((thiscolsum * 3 + nextcolsum + 7) >> 4);
+
+      /* General case: 3/4 * nearer pixel + 1/4 * further pixel in each */
+      /* dimension, thus 9/16, 3/16, 3/16, 1/16 overall */
+      for (col = 1; col + 9 <= width; col += 8) {
+	here = TIMES_3(COLSUM(col));
+	even = _mm_add_epi16(_mm_add_epi16(here, COLSUM(col - 1)), eight);
+	odd = _mm_add_epi16(_mm_add_epi16(here, COLSUM(col + 1)), seven);
+	even = _mm_srli_epi16(even, 4);
+	odd = _mm_srli_epi16(odd, 4);
+	STORE_SAMPLES2(outptr + 2 * col, _mm_unpacklo_epi16(even, odd),
+		       _mm_unpackhi_epi16(even, odd));
+      }
+      lastcolsum = GETJSAMPLE(inptr0[col - 1]) * 3 + GETJSAMPLE(inptr1[col - 1]);
+      thiscolsum = GETJSAMPLE(inptr0[col]) * 3 + GETJSAMPLE(inptr1[col]);
+      for (; col < width - 1; col++) {
+	nextcolsum = GETJSAMPLE(inptr0[col + 1]) * 3 +
+		     GETJSAMPLE(inptr1[col + 1]);
+	outptr[2 * col] = (JSAMPLE) ((thiscolsum * 3 + lastcolsum + 8) >> 4);
+	outptr[2 * col + 1] =
+	  (JSAMPLE) ((thiscolsum * 3 + nextcolsum + 7) >> 4);
+	lastcolsum = thiscolsum; thiscolsum = nextcolsum;
+      }
+
+      /* Special case for last column */
+      outptr[2 * col] = (JSAMPLE) ((thiscolsum * 3 + lastcolsum + 8) >> 4);
+      outptr[2 * col + 1] = (JSAMPLE) ((thiscolsum * 4 + 7) >> 4);
+    }
+    inrow++;
+  }
+
+#undef COLSUM
+}
+
+#endif /* SAMPLE_SSE2_SUPPORTED */
+
+
 /*
  * Module initialization routine for upsampling.
  */
@@ -455,15 +586,23 @@ jinit_upsampler (j_decompress_ptr cinfo)
     } else if (h_in_group * 2 == h_out_group &&
 	       v_in_group == v_out_group) {
       /* Special cases for 2h1v upsampling */
-      if (do_fancy && compptr->downsampled_width > 2)
+      if (do_fancy && compptr->downsampled_width > 2) {
 	upsample->methods[ci] = h2v1_fancy_upsample;
-      else
+#ifdef SAMPLE_SSE2_SUPPORTED
+	if (jpeg_simd_sse2())
+	  upsample->methods[ci] = h2v1_fancy_upsample_sse2;
+#endif
+      } else
 	upsample->methods[ci] = h2v1_upsample;
     } else if (h_in_group * 2 == h_out_group &&
 	       v_in_group * 2 == v_out_group) {
       /* Special cases for 2h2v upsampling */
       if (do_fancy && compptr->downsampled_width > 2) {
 	upsample->methods[ci] = h2v2_fancy_upsample;
+#ifdef SAMPLE_SSE2_SUPPORTED
+	if (jpeg_simd_sse2())
+	  upsample->methods[ci] = h2v2_fancy_upsample_sse2;
+#endif
 	upsample->pub.need_context_rows = TRUE;
       } else
 	upsample->methods[ci] = h2v2_upsample;
@@ -236,6 +236,7 @@ decode_mcu (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
   int blkn;
   BITREAD_STATE_VARS;
   savable_state state;
+  SHIFT_TEMPS
 
   /* Process restart marker if needed; may have to suspend */
   if (cinfo->restart_interval) {
@@ -264,12 +265,7 @@ decode_mcu (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
       /* Decode a single block's worth of coefficients */
 
       /* Section F.2.2.1: decode the DC coefficient difference */
-      HUFF_DECODE(s, br_state, dctbl, return FALSE, label1);
-      if (s) {
-	CHECK_BIT_BUFFER(br_state, s, return FALSE);
-	r = GET_BITS(s);
-	s = HUFF_EXTEND(r, s);
-      }
+      HUFF_DECODE_VALUE(s, r, br_state, dctbl, return FALSE, label1);
 
       if (entropy->dc_needed[blkn]) {
 	/* Convert DC difference to actual value, update last_dc_val */
@@ -285,16 +281,10 @@ decode_mcu (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
 	/* Section F.2.2.2: decode the AC coefficients */
 	/* Since zeroes are skipped, output area must be cleared beforehand */
 	for (k = 1; k < DCTSIZE2; k++) {
-	  HUFF_DECODE(s, br_state, actbl, return FALSE, label2);
-      
-	  r = s >> 4;
-	  s &= 15;
+	  HUFF_DECODE_VALUE(s, r, br_state, actbl, return FALSE, label2);
       
 	  if (s) {
 	    k += r;
-	    CHECK_BIT_BUFFER(br_state, s, return FALSE);
-	    r = GET_BITS(s);
-	    s = HUFF_EXTEND(r, s);
 	    /* Output coefficient in natural (dezigzagged) order.
 	     * Note: the extra entries in jpeg_natural_order[] will save us
 	     * if k >= DCTSIZE2, which could happen if the data is corrupted.
@@ -312,15 +302,10 @@ decode_mcu (j_decompress_ptr cinfo, JBLOCKROW *MCU_data)
 	/* Section F.2.2.2: decode the AC coefficients */
 	/* In this path we just discard the values */
 	for (k = 1; k < DCTSIZE2; k++) {
-	  HUFF_DECODE(s, br_state, actbl, return FALSE, label3);
-      
-	  r = s >> 4;
-	  s &= 15;
+	  HUFF_DECODE_VALUE(s, r, br_state, actbl, return FALSE, label3);
       
 	  if (s) {
 	    k += r;
-	    CHECK_BIT_BUFFER(br_state, s, return FALSE);
-	    DROP_BITS(s);
 	  } else {
 	    if (r != 15)
 	      break;
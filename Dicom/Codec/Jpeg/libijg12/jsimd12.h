@@ -0,0 +1,186 @@
+#pragma region License (non-CC)
+
+// This source code contains the work of the Independent JPEG Group.
+// Please see accompanying notice in code comments and/or readme file
+// for the terms of distribution and use regarding this code.
+
+#pragma endregion
+
+/*
+ * jsimd.h
+ *
+ * This include file contains the SSE2 helpers shared by the color
+ * conversion and upsampling modules (jccolor.c, jdcolor.c, jdsample.c,
+ * jdmerge.c).  These declarations are private to those modules.
+ *
+ * Samples are processed eight at a time in 16-bit lanes.  That leaves room
+ * for the intermediate sums of the upsampling and color conversion formulas
+ * only when BITS_IN_JSAMPLE is at most 12, so 16-bit samples keep the
+ * scalar code.  The SSE2 versions produce exactly the same output as the
+ * scalar ones.
+ */
+
+#ifndef JSIMD_H
+#define JSIMD_H
+
+#if defined(SSE2_SUPPORTED) && BITS_IN_JSAMPLE <= 12
+#define SAMPLE_SSE2_SUPPORTED
+#endif
+
+#ifdef SAMPLE_SSE2_SUPPORTED
+
+#include <emmintrin.h>
+
+
+/* The interleaved RGB helpers assume the default pixel layout. */
+
+#if RGB_RED == 0 && RGB_GREEN == 1 && RGB_BLUE == 2 && RGB_PIXELSIZE == 3
+#define RGB_SSE2_SUPPORTED
+#endif
+
+
+/* PAIR(c0,c1) is the multiplier of _mm_madd_epi16 for the 16-bit pairs (a,b)
+ * interleaved by _mm_unpack*_epi16, giving a*c0 + b*c1 in each 32-bit lane.
+ */
+
+#define PAIR(c0,c1)  _mm_set_epi16((short) (c1), (short) (c0), \
+				   (short) (c1), (short) (c0), \
+				   (short) (c1), (short) (c0), \
+				   (short) (c1), (short) (c0))
+
+
+/* Load eight samples into 16-bit lanes, or store eight (sixteen) samples
+ * from 16-bit lanes that already hold values in 0..MAXJSAMPLE.
+ */
+
+#if BITS_IN_JSAMPLE == 8
+#define LOAD_SAMPLES(p)  \
+    _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (p)), _mm_setzero_si128())
+#define STORE_SAMPLES(p,v)  \
+    _mm_storel_epi64((__m128i *) (p), _mm_packus_epi16(v, v))
+#define STORE_SAMPLES2(p,lo,hi)  \
+    _mm_storeu_si128((__m128i *) (p), _mm_packus_epi16(lo, hi))
+#else
+#define LOAD_SAMPLES(p)  _mm_loadu_si128((const __m128i *) (p))
+#define STORE_SAMPLES(p,v)  _mm_storeu_si128((__m128i *) (p), v)
+#define STORE_SAMPLES2(p,lo,hi)  \
+    (_mm_storeu_si128((__m128i *) (p), lo), \
+     _mm_storeu_si128((__m128i *) ((p) + 8), hi))
+#endif
+
+/* Limit 16-bit lanes to 0..MAXJSAMPLE. */
+
+#define CLAMP_SAMPLES(x)  \
+    _mm_min_epi16(_mm_max_epi16(x, _mm_setzero_si128()), \
+		  _mm_set1_epi16(MAXJSAMPLE))
+
+
+#ifdef RGB_SSE2_SUPPORTED
+
+/*
+ * Store the low 12 bytes of a vector whose 64-bit halves each hold 6 bytes
+ * of pixel data followed by 2 zero bytes; nothing beyond them is written.
+ */
+
+INLINE
+LOCAL(void)
+store_12 (char * outptr, __m128i v)
+{
+  v = _mm_or_si128(_mm_move_epi64(v), _mm_slli_si128(_mm_srli_si128(v, 8), 6));
+  _mm_storel_epi64((__m128i *) outptr, v);
+  *(int *) (outptr + 8) = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+}
+
+
+/*
+ * Interleave eight pixels held in 16-bit lanes, each in 0..MAXJSAMPLE,
+ * into RGB_PIXELSIZE * 8 output samples.
+ */
+
+INLINE
+LOCAL(void)
+store_rgb (JSAMPROW outptr, __m128i r, __m128i g, __m128i b)
+{
+  char * out = (char *) outptr;
+#if BITS_IN_JSAMPLE == 8
+  /* Make 32-bit lanes r,g,b,0 then squeeze out every fourth byte. */
+  const __m128i mask_lo = _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF);
+  const __m128i mask_hi = _mm_set_epi32(0x0000FFFF, (int) 0xFF000000,
+					0x0000FFFF, (int) 0xFF000000);
+  __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+  __m128i p;
+
+  p = _mm_unpacklo_epi16(rg, b);
+  p = _mm_or_si128(_mm_and_si128(p, mask_lo),
+		   _mm_and_si128(_mm_srli_epi64(p, 8), mask_hi));
+  store_12(out, p);
+  p = _mm_unpackhi_epi16(rg, b);
+  p = _mm_or_si128(_mm_and_si128(p, mask_lo),
+		   _mm_and_si128(_mm_srli_epi64(p, 8), mask_hi));
+  store_12(out + 12, p);
+#else
+  /* Make 64-bit lanes r,g,b,0; each vector then holds two pixels. */
+  __m128i zero = _mm_setzero_si128();
+  __m128i rg = _mm_unpacklo_epi16(r, g);
+  __m128i b0 = _mm_unpacklo_epi16(b, zero);
+
+  store_12(out, _mm_unpacklo_epi32(rg, b0));
+  store_12(out + 12, _mm_unpackhi_epi32(rg, b0));
+  rg = _mm_unpackhi_epi16(r, g);
+  b0 = _mm_unpackhi_epi16(b, zero);
+  store_12(out + 24, _mm_unpacklo_epi32(rg, b0));
+  store_12(out + 36, _mm_unpackhi_epi32(rg, b0));
+#endif
+}
+
+
+/*
+ * Deinterleave four RGB pixels into 32-bit lanes.
+ * Exactly RGB_PIXELSIZE * 4 samples are read.
+ */
+
+INLINE
+LOCAL(void)
+load_rgb (JSAMPROW inptr, __m128i * r, __m128i * g, __m128i * b)
+{
+  const char * in = (const char *) inptr;
+#if BITS_IN_JSAMPLE == 8
+  /* Spread the 3-byte pixels into 32-bit lanes r,g,b,x. */
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  __m128i v, p;
+
+  v = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *) in),
+			 _mm_cvtsi32_si128(*(const int *) (in + 8)));
+  p = _mm_unpacklo_epi64(_mm_unpacklo_epi32(v, _mm_srli_si128(v, 3)),
+			 _mm_unpacklo_epi32(_mm_srli_si128(v, 6),
+					    _mm_srli_si128(v, 9)));
+  *r = _mm_and_si128(p, mask);
+  *g = _mm_and_si128(_mm_srli_epi32(p, 8), mask);
+  *b = _mm_and_si128(_mm_srli_epi32(p, 16), mask);
+#else
+  /* Spread the 3-sample pixels into 64-bit lanes r,g,b,x, then gather the
+   * (r,g) and (b,x) pairs of the four pixels.
+   */
+  const __m128i mask = _mm_set1_epi32(0xFFFF);
+  __m128i v0 = _mm_loadu_si128((const __m128i *) in);
+  __m128i v1 = _mm_loadl_epi64((const __m128i *) (in + 16));
+  __m128i p01, p23, t0, t1;
+
+  v1 = _mm_or_si128(_mm_srli_si128(v0, 12), _mm_slli_si128(v1, 4));
+  p01 = _mm_unpacklo_epi64(v0, _mm_srli_si128(v0, 6));
+  p23 = _mm_unpacklo_epi64(v1, _mm_srli_si128(v1, 6));
+  t0 = _mm_unpacklo_epi32(p01, p23);
+  t1 = _mm_unpackhi_epi32(p01, p23);
+  v0 = _mm_unpacklo_epi32(t0, t1);	/* (r,g) of pixels 0..3 */
+  v1 = _mm_unpackhi_epi32(t0, t1);	/* (b,x) of pixels 0..3 */
+  *r = _mm_and_si128(v0, mask);
+  *g = _mm_srli_epi32(v0, 16);
+  *b = _mm_and_si128(v1, mask);
+#endif
+}
+
+#endif /* RGB_SSE2_SUPPORTED */
+
+#endif /* SAMPLE_SSE2_SUPPORTED */
+
+#endif /* JSIMD_H */
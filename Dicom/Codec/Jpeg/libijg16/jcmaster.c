@@ -634,16 +634,18 @@ jinit_c_master_control (j_compress_ptr cinfo, boolean transcode_only)
     cinfo->num_scans = 1;
   }
 
+  /* Lossless mode is left alone: jpeg_simple_lossless turns on
+   * optimize_coding, and an application that clears it again must supply
+   * tables able to code every difference (see jpeg_lossless_huff_table).
+   */
 #ifdef WITH_ARITHMETIC_PATCH
   if ((cinfo->arith_code == 0) &&
-      (cinfo->process == JPROC_PROGRESSIVE ||	/*  TEMPORARY HACK ??? */
-       cinfo->process == JPROC_LOSSLESS))
+      cinfo->process == JPROC_PROGRESSIVE)	/*  TEMPORARY HACK ??? */
 #else
-  if (cinfo->process == JPROC_PROGRESSIVE ||	/*  TEMPORARY HACK ??? */
-      cinfo->process == JPROC_LOSSLESS)
+  if (cinfo->process == JPROC_PROGRESSIVE)	/*  TEMPORARY HACK ??? */
 #endif
     cinfo->optimize_coding = TRUE; /* assume default tables no good for
-				    * progressive mode or lossless mode */
+				    * progressive mode */
 
   /* Initialize my private state */
   if (transcode_only) {
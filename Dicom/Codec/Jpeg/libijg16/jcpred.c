@@ -31,6 +31,10 @@
 #include "jpeglib16.h"
 #include "jlossls16.h"		/* Private declarations for lossless codec */
 
+#ifdef SSE2_SUPPORTED
+#include <emmintrin.h>
+#endif
+
 
 #ifdef C_LOSSLESS_SUPPORTED
 
@@ -195,6 +199,173 @@ jpeg_difference7(j_compress_ptr cinfo, int ci,
 }
 
 
+#ifdef SSE2_SUPPORTED
+
+/*
+ * SSE2 differencers, for four samples at a time in 32-bit lanes.  All the
+ * inputs of the predictors are known in the encoder, so every predictor is
+ * vectorized; the results are identical to those of the scalar versions.
+ * Samples are at most 16 bits and never negative, so they are zero-extended.
+ */
+
+#if BITS_IN_JSAMPLE == 8
+#define LOAD_SAMPLES4(p)  \
+    _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int *) (p)), \
+					 zero), zero)
+#else
+#define LOAD_SAMPLES4(p)  \
+    _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) (p)), zero)
+#endif
+
+#define PREDICTOR1_SSE2  Ra4
+#define PREDICTOR2_SSE2  Rb4
+#define PREDICTOR3_SSE2  Rc4
+#define PREDICTOR4_SSE2  _mm_add_epi32(Ra4, _mm_sub_epi32(Rb4, Rc4))
+#define PREDICTOR5_SSE2  \
+    _mm_add_epi32(Ra4, _mm_srai_epi32(_mm_sub_epi32(Rb4, Rc4), 1))
+#define PREDICTOR6_SSE2  \
+    _mm_add_epi32(Rb4, _mm_srai_epi32(_mm_sub_epi32(Ra4, Rc4), 1))
+#define PREDICTOR7_SSE2  _mm_srai_epi32(_mm_add_epi32(Ra4, Rb4), 1)
+
+#define DIFFERENCE_1D_SSE2(INITIAL_PREDICTOR) \
+	j_lossless_c_ptr losslsc = (j_lossless_c_ptr) cinfo->codec; \
+	c_pred_ptr pred = (c_pred_ptr) losslsc->pred_private; \
+	const __m128i zero = _mm_setzero_si128(); \
+	__m128i Ra4; \
+	boolean restart = FALSE; \
+	unsigned int xindex; \
+	int samp, Ra; \
+ \
+	samp = GETJSAMPLE(input_buf[0]); \
+	diff_buf[0] = samp - INITIAL_PREDICTOR; \
+ \
+	for (xindex = 1; xindex + 4 <= width; xindex += 4) { \
+	  Ra4 = LOAD_SAMPLES4(input_buf + xindex - 1); \
+	  _mm_storeu_si128((__m128i *) (diff_buf + xindex), \
+			   _mm_sub_epi32(LOAD_SAMPLES4(input_buf + xindex), Ra4)); \
+	} \
+ \
+	samp = GETJSAMPLE(input_buf[xindex - 1]); \
+	for (; xindex < width; xindex++) { \
+	  Ra = samp; \
+	  samp = GETJSAMPLE(input_buf[xindex]); \
+	  diff_buf[xindex] = samp - PREDICTOR1; \
+	} \
+ \
+	/* Account for restart interval (no-op if not using restarts) */ \
+	if (cinfo->restart_interval) { \
+	  if (--(pred->restart_rows_to_go[ci]) == 0) { \
+	    reset_predictor(cinfo, ci); \
+	    restart = TRUE; \
+	  } \
+	}
+
+#define DIFFERENCE_2D_SSE2(PREDICTOR_SSE2, PREDICTOR) \
+	j_lossless_c_ptr losslsc = (j_lossless_c_ptr) cinfo->codec; \
+	c_pred_ptr pred = (c_pred_ptr) losslsc->pred_private; \
+	const __m128i zero = _mm_setzero_si128(); \
+	__m128i Ra4, Rb4, Rc4; \
+	unsigned int xindex; \
+	int samp, Ra, Rb, Rc; \
+ \
+	Rb = GETJSAMPLE(prev_row[0]); \
+	samp = GETJSAMPLE(input_buf[0]); \
+	diff_buf[0] = samp - PREDICTOR2; \
+ \
+	for (xindex = 1; xindex + 4 <= width; xindex += 4) { \
+	  Ra4 = LOAD_SAMPLES4(input_buf + xindex - 1); \
+	  Rb4 = LOAD_SAMPLES4(prev_row + xindex); \
+	  Rc4 = LOAD_SAMPLES4(prev_row + xindex - 1); \
+	  _mm_storeu_si128((__m128i *) (diff_buf + xindex), \
+			   _mm_sub_epi32(LOAD_SAMPLES4(input_buf + xindex), \
+					 PREDICTOR_SSE2)); \
+	} \
+ \
+	Rb = GETJSAMPLE(prev_row[xindex - 1]); \
+	samp = GETJSAMPLE(input_buf[xindex - 1]); \
+	for (; xindex < width; xindex++) { \
+	  Rc = Rb; \
+	  Rb = GETJSAMPLE(prev_row[xindex]); \
+	  Ra = samp; \
+	  samp = GETJSAMPLE(input_buf[xindex]); \
+	  diff_buf[xindex] = samp - PREDICTOR; \
+	} \
+ \
+	/* Account for restart interval (no-op if not using restarts) */ \
+	if (cinfo->restart_interval) { \
+	  if (--pred->restart_rows_to_go[ci] == 0) \
+	    reset_predictor(cinfo, ci); \
+	}
+
+
+METHODDEF(void)
+jpeg_difference1_sse2(j_compress_ptr cinfo, int ci,
+		      JSAMPROW input_buf, JSAMPROW prev_row,
+		      JDIFFROW diff_buf, JDIMENSION width)
+{
+  DIFFERENCE_1D_SSE2(INITIAL_PREDICTOR2);
+}
+
+METHODDEF(void)
+jpeg_difference2_sse2(j_compress_ptr cinfo, int ci,
+		      JSAMPROW input_buf, JSAMPROW prev_row,
+		      JDIFFROW diff_buf, JDIMENSION width)
+{
+  DIFFERENCE_2D_SSE2(PREDICTOR2_SSE2, PREDICTOR2);
+}
+
+METHODDEF(void)
+jpeg_difference3_sse2(j_compress_ptr cinfo, int ci,
+		      JSAMPROW input_buf, JSAMPROW prev_row,
+		      JDIFFROW diff_buf, JDIMENSION width)
+{
+  DIFFERENCE_2D_SSE2(PREDICTOR3_SSE2, PREDICTOR3);
+}
+
+METHODDEF(void)
+jpeg_difference4_sse2(j_compress_ptr cinfo, int ci,
+		      JSAMPROW input_buf, JSAMPROW prev_row,
+		      JDIFFROW diff_buf, JDIMENSION width)
+{
+  DIFFERENCE_2D_SSE2(PREDICTOR4_SSE2, PREDICTOR4);
+}
+
+METHODDEF(void)
+jpeg_difference5_sse2(j_compress_ptr cinfo, int ci,
+		      JSAMPROW input_buf, JSAMPROW prev_row,
+		      JDIFFROW diff_buf, JDIMENSION width)
+{
+  SHIFT_TEMPS
+  DIFFERENCE_2D_SSE2(PREDICTOR5_SSE2, PREDICTOR5);
+}
+
+METHODDEF(void)
+jpeg_difference6_sse2(j_compress_ptr cinfo, int ci,
+		      JSAMPROW input_buf, JSAMPROW prev_row,
+		      JDIFFROW diff_buf, JDIMENSION width)
+{
+  SHIFT_TEMPS
+  DIFFERENCE_2D_SSE2(PREDICTOR6_SSE2, PREDICTOR6);
+}
+
+METHODDEF(void)
+jpeg_difference7_sse2(j_compress_ptr cinfo, int ci,
+		      JSAMPROW input_buf, JSAMPROW prev_row,
+		      JDIFFROW diff_buf, JDIMENSION width)
+{
+  SHIFT_TEMPS
+  DIFFERENCE_2D_SSE2(PREDICTOR7_SSE2, PREDICTOR7);
+}
+
+#define DIFFERENCER(n)  (jpeg_simd_sse2() ? n##_sse2 : n)
+
+#else
+
+#define DIFFERENCER(n)  n
+
+#endif /* SSE2_SUPPORTED */
+
+
 /*
  * Differencer for the first row in a scan or restart interval.  The first
  * sample in the row is differenced using the special predictor constant
@@ -220,25 +391,25 @@ jpeg_difference_first_row(j_compress_ptr cinfo, int ci,
   if (!restart) {
     switch (cinfo->Ss) {
     case 1:
-      losslsc->predict_difference[ci] = jpeg_difference1;
+      losslsc->predict_difference[ci] = DIFFERENCER(jpeg_difference1);
       break;
     case 2:
-      losslsc->predict_difference[ci] = jpeg_difference2;
+      losslsc->predict_difference[ci] = DIFFERENCER(jpeg_difference2);
       break;
     case 3:
-      losslsc->predict_difference[ci] = jpeg_difference3;
+      losslsc->predict_difference[ci] = DIFFERENCER(jpeg_difference3);
       break;
     case 4:
-      losslsc->predict_difference[ci] = jpeg_difference4;
+      losslsc->predict_difference[ci] = DIFFERENCER(jpeg_difference4);
       break;
     case 5:
-      losslsc->predict_difference[ci] = jpeg_difference5;
+      losslsc->predict_difference[ci] = DIFFERENCER(jpeg_difference5);
       break;
     case 6:
-      losslsc->predict_difference[ci] = jpeg_difference6;
+      losslsc->predict_difference[ci] = DIFFERENCER(jpeg_difference6);
       break;
     case 7:
-      losslsc->predict_difference[ci] = jpeg_difference7;
+      losslsc->predict_difference[ci] = DIFFERENCER(jpeg_difference7);
       break;
     }
   }
@@ -37,7 +37,7 @@ jpeg_make_d_derived_tbl (j_decompress_ptr cinfo, boolean isDC, int tblno,
   JHUFF_TBL *htbl;
   d_derived_tbl *dtbl;
   int p, i, l, si, numsymbols;
-  int lookbits, ctr;
+  int lookbits, ctr, sym, s, extra;
   char huffsize[257];
   unsigned int huffcode[257];
   unsigned int code;
@@ -120,6 +120,7 @@ jpeg_make_d_derived_tbl (j_decompress_ptr cinfo, boolean isDC, int tblno,
    */
 
   MEMZERO(dtbl->look_nbits, SIZEOF(dtbl->look_nbits));
+  MEMZERO(dtbl->look_value, SIZEOF(dtbl->look_value));
 
   p = 0;
   for (l = 1; l <= HUFF_LOOKAHEAD; l++) {
@@ -127,9 +128,24 @@ jpeg_make_d_derived_tbl (j_decompress_ptr cinfo, boolean isDC, int tblno,
       /* l = current code's length, p = its index in huffcode[] & huffval[]. */
       /* Generate left-justified code followed by all possible bit sequences */
       lookbits = huffcode[p] << (HUFF_LOOKAHEAD-l);
+      sym = htbl->huffval[p];
+      s = sym & 15;
       for (ctr = 1 << (HUFF_LOOKAHEAD-l); ctr > 0; ctr--) {
 	dtbl->look_nbits[lookbits] = l;
-	dtbl->look_sym[lookbits] = htbl->huffval[p];
+	dtbl->look_sym[lookbits] = (UINT8) sym;
+	/* If the extra bits are also in the lookahead, combine them too.
+	 * DC symbol 16 (lossless only) has no extra bits; leave it to the
+	 * slow path rather than confuse it with a run.
+	 */
+	if (l + s <= HUFF_LOOKAHEAD && ! (isDC && sym > 15)) {
+	  if (s) {
+	    extra = (lookbits >> (HUFF_LOOKAHEAD - l - s)) & ((1 << s) - 1);
+	    if (extra < (1 << (s - 1)))
+	      extra += (-1 << s) + 1;
+	  } else
+	    extra = 0;
+	  dtbl->look_value[lookbits] = extra * 256 + ((sym >> 4) << 4) + l + s;
+	}
 	lookbits++;
       }
     }
@@ -157,9 +173,9 @@ jpeg_make_d_derived_tbl (j_decompress_ptr cinfo, boolean isDC, int tblno,
  * Note: current values of get_buffer and bits_left are passed as parameters,
  * but are returned in the corresponding fields of the state struct.
  *
- * On most machines MIN_GET_BITS should be 25 to allow the full 32-bit width
- * of get_buffer to be used.  (On machines with wider words, an even larger
- * buffer could be used.)  However, on some machines 32-bit shifts are
+ * On most machines MIN_GET_BITS should be BIT_BUF_SIZE-7 (25 with a 32-bit
+ * buffer, 57 with a 64-bit one) to allow the full width of get_buffer to be
+ * used.  However, on some machines 32-bit shifts are
  * quite slow and take time proportional to the number of places shifted.
  * (This is true with most PC compilers, for instance.)  In this case it may
  * be a win to set MIN_GET_BITS to the minimum value of 15.  This reduces the
@@ -189,6 +205,32 @@ jpeg_fill_bit_buffer (bitread_working_state * state,
   /* We fail to do so only if we hit a marker or are forced to suspend. */
 
   if (cinfo->unread_marker == 0) {	/* cannot advance past a marker */
+    /* Fast path: if the source buffer has a buffer's worth of bytes and
+     * none of the ones we need is 0xFF, there is no stuffed zero or marker
+     * among them and they can go into get_buffer all at once.  Otherwise
+     * the byte-at-a-time loop below deals with them.
+     */
+    if (bits_left < MIN_GET_BITS && bytes_in_buffer >= BIT_BUF_SIZE/8) {
+      register int n = (BIT_BUF_SIZE - bits_left) >> 3;
+      register int i, ff = 0;
+      register bit_buf_type w = 0;
+
+      for (i = 0; i < n; i++) {
+	register int c = GETJOCTET(next_input_byte[i]);
+	ff |= c + 1;		/* sets bit 8 only if c is 0xFF */
+	w = (w << 8) | c;
+      }
+      if ((ff & 0x100) == 0) {
+	if (n < BIT_BUF_SIZE/8)
+	  get_buffer = (get_buffer << (n << 3)) | w;
+	else
+	  get_buffer = w;
+	bits_left += n << 3;
+	next_input_byte += n;
+	bytes_in_buffer -= n;
+      }
+    }
+
     while (bits_left < MIN_GET_BITS) {
       register int c;
 
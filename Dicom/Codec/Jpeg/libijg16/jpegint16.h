@@ -134,6 +134,20 @@ struct jpeg_decomp_master {
 
   /* State variables made visible to other modules */
   boolean is_dummy_pass;	/* True during 1st pass for 2-pass quant */
+
+  /* Columns inverse transformed by the coefficient controller, as set by
+   * jpeg_crop_scanline: iMCU columns for the single-pass controller, and
+   * DCT block columns of each component for the multi-pass one.
+   */
+  JDIMENSION first_iMCU_col;
+  JDIMENSION last_iMCU_col;
+  JDIMENSION first_MCU_col[MAX_COMPONENTS];
+  JDIMENSION last_MCU_col[MAX_COMPONENTS];
+
+  /* TRUE while jpeg_skip_scanlines discards rows: blocks are still entropy
+   * decoded, but not inverse transformed.
+   */
+  boolean skip_idct;
 };
 
 /* Input control module */
@@ -312,6 +326,7 @@ struct jpeg_color_quantizer {
 #define jcopy_sample_rows		jcopy16_sample_rows
 #define jcopy_block_row		jcopy16_block_row
 #define jzero_far		jzero16_far
+#define jpeg_simd_sse2		jpeg16_simd_sse2
 #define jpeg_zigzag_order		jpeg16_zigzag_order
 #define jpeg_natural_order		jpeg16_natural_order
 #endif /* NEED_SHORT_EXTERNAL_NAMES */
@@ -356,6 +371,15 @@ EXTERN(void) jinit_merged_upsampler JPP((j_decompress_ptr cinfo));
 /* Memory manager initialization */
 EXTERN(void) jinit_memory_mgr JPP((j_common_ptr cinfo));
 
+/* SSE2 code paths (the lossless differencers and undifferencers in
+ * jcpred.c and jdpred.c).  They rely on IJG_INT32 being 32 bits wide, which
+ * holds for the Microsoft compilers on x86 and x64, and are selected at
+ * module initialization when jpeg_simd_sse2() reports processor support.
+ */
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define SSE2_SUPPORTED
+#endif
+
 /* Utility routines in jutils.c */
 EXTERN(long) jdiv_round_up JPP((long a, long b));
 EXTERN(long) jround_up JPP((long a, long b));
@@ -365,6 +389,9 @@ EXTERN(void) jcopy_sample_rows JPP((JSAMPARRAY input_array, int source_row,
 EXTERN(void) jcopy_block_row JPP((JBLOCKROW input_row, JBLOCKROW output_row,
 				  JDIMENSION num_blocks));
 EXTERN(void) jzero_far JPP((void FAR * target, size_t bytestozero));
+#ifdef SSE2_SUPPORTED
+EXTERN(boolean) jpeg_simd_sse2 JPP((void));
+#endif
 /* Constant tables in jutils.c */
 #if 0				/* This table is not actually needed in v6a */
 extern const int jpeg_zigzag_order[]; /* natural coef order to zigzag order */
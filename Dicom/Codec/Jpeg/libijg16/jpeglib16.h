@@ -268,6 +268,7 @@ typedef enum {
   struct jpeg_memory_mgr * mem;	/* Memory manager module */\
   struct jpeg_progress_mgr * progress; /* Progress monitor, or NULL if none */\
   void * client_data;		/* Available for use by application */\
+  struct jpeg_arena_mgr * arena;	/* Memory source for jmemnobs.c, or NULL */\
   boolean is_decompressor;	/* So common code can tell which is which */\
   int global_state		/* For checking call sequence validity */
 
@@ -843,6 +844,22 @@ struct jpeg_memory_mgr {
 };
 
 
+/* Memory arena object.
+ * Once the application attaches an arena with jpeg_attach_arena, the
+ * system-dependent memory manager draws the object's memory from the arena
+ * instead of from malloc().  Memory obtained from the arena is handed back
+ * to it, so the arena may keep and reuse it after the JPEG object has been
+ * destroyed.  Like malloc(), get_mem returns NULL on failure.
+ */
+
+struct jpeg_arena_mgr {
+  JMETHOD(void *, get_mem, (struct jpeg_arena_mgr * arena,
+			    size_t sizeofobject));
+  JMETHOD(void, free_mem, (struct jpeg_arena_mgr * arena, void * object,
+			   size_t sizeofobject));
+};
+
+
 /* Routine signature for application-supplied marker processing methods.
  * Need not pass marker code since it is stored in cinfo->unread_marker.
  */
@@ -925,9 +942,11 @@ typedef JMETHOD(boolean, jpeg_marker_parser_method, (j_decompress_ptr cinfo));
 #define jpeg_add_quant_table           jpeg16_add_quant_table
 #define jpeg_alloc_huff_table          jpeg16_alloc_huff_table
 #define jpeg_alloc_quant_table         jpeg16_alloc_quant_table
+#define jpeg_attach_arena              jpeg16_attach_arena
 #define jpeg_calc_output_dimensions    jpeg16_calc_output_dimensions
 #define jpeg_consume_input             jpeg16_consume_input
 #define jpeg_copy_critical_parameters  jpeg16_copy_critical_parameters
+#define jpeg_crop_scanline             jpeg16_crop_scanline
 #define jpeg_default_colorspace        jpeg16_default_colorspace
 #define jpeg_destroy                   jpeg16_destroy
 #define jpeg_destroy_compress          jpeg16_destroy_compress
@@ -953,6 +972,7 @@ typedef JMETHOD(boolean, jpeg_marker_parser_method, (j_decompress_ptr cinfo));
 #define jpeg_idct_ifast                jpeg16_idct_ifast
 #define jpeg_idct_islow                jpeg16_idct_islow
 #define jpeg_input_complete            jpeg16_input_complete
+#define jpeg_lossless_huff_table       jpeg16_lossless_huff_table
 #define jpeg_make_c_derived_tbl        jpeg16_make_c_derived_tbl
 #define jpeg_make_d_derived_tbl        jpeg16_make_d_derived_tbl
 #define jpeg_mem_available             jpeg16_mem_available
@@ -972,8 +992,10 @@ typedef JMETHOD(boolean, jpeg_marker_parser_method, (j_decompress_ptr cinfo));
 #define jpeg_set_linear_quality        jpeg16_set_linear_quality
 #define jpeg_set_marker_processor      jpeg16_set_marker_processor
 #define jpeg_set_quality               jpeg16_set_quality
+#define jpeg_simd_sse2                 jpeg16_simd_sse2
 #define jpeg_simple_lossless           jpeg16_simple_lossless
 #define jpeg_simple_progression        jpeg16_simple_progression
+#define jpeg_skip_scanlines            jpeg16_skip_scanlines
 #define jpeg_start_compress            jpeg16_start_compress
 #define jpeg_start_decompress          jpeg16_start_decompress
 #define jpeg_start_output              jpeg16_start_output
@@ -1041,6 +1063,8 @@ EXTERN(void) jpeg_add_quant_table JPP((j_compress_ptr cinfo, int which_tbl,
 EXTERN(int) jpeg_quality_scaling JPP((int quality));
 EXTERN(void) jpeg_simple_lossless JPP((j_compress_ptr cinfo,
 				       int predictor, int point_transform));
+EXTERN(void) jpeg_lossless_huff_table JPP((j_compress_ptr cinfo, int tblno,
+					   const long * freq));
 EXTERN(void) jpeg_simple_progression JPP((j_compress_ptr cinfo));
 EXTERN(void) jpeg_suppress_tables JPP((j_compress_ptr cinfo,
 				       boolean suppress));
@@ -1093,6 +1117,13 @@ EXTERN(JDIMENSION) jpeg_read_scanlines JPP((j_decompress_ptr cinfo,
 					    JDIMENSION max_lines));
 EXTERN(boolean) jpeg_finish_decompress JPP((j_decompress_ptr cinfo));
 
+/* Restrict the output of a sequential decompression to a region. */
+EXTERN(void) jpeg_crop_scanline JPP((j_decompress_ptr cinfo,
+				     JDIMENSION * xoffset,
+				     JDIMENSION * width));
+EXTERN(JDIMENSION) jpeg_skip_scanlines JPP((j_decompress_ptr cinfo,
+					    JDIMENSION num_lines));
+
 /* Replaces jpeg_read_scanlines when reading raw downsampled data. */
 EXTERN(JDIMENSION) jpeg_read_raw_data JPP((j_decompress_ptr cinfo,
 					   JSAMPIMAGE data,
@@ -1148,6 +1179,12 @@ EXTERN(void) jpeg_abort_decompress JPP((j_decompress_ptr cinfo));
 EXTERN(void) jpeg_abort JPP((j_common_ptr cinfo));
 EXTERN(void) jpeg_destroy JPP((j_common_ptr cinfo));
 
+/* Draw the rest of the object's memory from an arena (NULL for malloc()).
+ * Call after jpeg_create_(de)compress; the arena must outlive the object.
+ */
+EXTERN(void) jpeg_attach_arena JPP((j_common_ptr cinfo,
+				    struct jpeg_arena_mgr * arena));
+
 /* Default restart-marker-resync procedure for use by data source modules */
 EXTERN(boolean) jpeg_resync_to_restart JPP((j_decompress_ptr cinfo,
 					    int desired));
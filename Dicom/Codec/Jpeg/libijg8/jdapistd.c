@@ -184,6 +184,143 @@ jpeg_read_scanlines (j_decompress_ptr cinfo, JSAMPARRAY scanlines,
 }
 
 
+/*
+ * Restrict the scanlines returned by jpeg_read_scanlines to the columns
+ * [*xoffset, *xoffset + *width) of the output image.  Call after
+ * jpeg_start_decompress and before reading the first scanline.
+ *
+ * The window is widened to whole iMCU columns, and to at least two of them so
+ * that the fancy upsamplers keep more than two samples per row; *xoffset and
+ * *width are updated to the columns the scanlines will actually hold.  Every
+ * block must still be entropy decoded, but only the blocks in the window are
+ * inverse transformed, upsampled and color converted.
+ *
+ * The lossless process and color quantization always produce full width
+ * scanlines.
+ */
+
+GLOBAL(void)
+jpeg_crop_scanline (j_decompress_ptr cinfo, JDIMENSION * xoffset,
+		    JDIMENSION * width)
+{
+  JDIMENSION align, first_iMCU_col, last_iMCU_col, num_iMCU_cols;
+  int ci, hsf;
+  jpeg_component_info *compptr;
+
+  if (cinfo->global_state != DSTATE_SCANNING || cinfo->output_scanline != 0)
+    ERREXIT1(cinfo, JERR_BAD_STATE, cinfo->global_state);
+  if (xoffset == NULL || width == NULL || *width == 0 ||
+      *xoffset >= cinfo->output_width ||
+      *width > cinfo->output_width - *xoffset)
+    ERREXIT(cinfo, JERR_BAD_CROP_SPEC);
+
+  if (cinfo->process == JPROC_LOSSLESS || cinfo->quantize_colors ||
+      *width == cinfo->output_width) {
+    *xoffset = 0;
+    *width = cinfo->output_width;
+    return;
+  }
+
+  /* A single component is coded one block per MCU, whatever its sampling
+   * factors; otherwise an iMCU column spans max_h_samp_factor blocks.
+   */
+  if (cinfo->num_components == 1)
+    align = (JDIMENSION) cinfo->min_codec_data_unit;
+  else
+    align = (JDIMENSION) (cinfo->min_codec_data_unit * cinfo->max_h_samp_factor);
+  num_iMCU_cols = (JDIMENSION) jdiv_round_up((long) cinfo->output_width,
+					     (long) align);
+
+  first_iMCU_col = *xoffset / align;
+  last_iMCU_col = (*xoffset + *width - 1) / align;
+  if (first_iMCU_col == last_iMCU_col) {
+    if (last_iMCU_col + 1 < num_iMCU_cols)
+      last_iMCU_col++;
+    else if (first_iMCU_col > 0)
+      first_iMCU_col--;
+  }
+
+  *xoffset = first_iMCU_col * align;
+  if (last_iMCU_col + 1 < num_iMCU_cols)
+    *width = (last_iMCU_col + 1) * align - *xoffset;
+  else
+    *width = cinfo->output_width - *xoffset;
+
+  cinfo->output_width = *width;
+  cinfo->master->first_iMCU_col = first_iMCU_col;
+  cinfo->master->last_iMCU_col = last_iMCU_col;
+  for (ci = 0, compptr = cinfo->comp_info; ci < cinfo->num_components;
+       ci++, compptr++) {
+    hsf = (cinfo->num_components == 1) ? 1 : compptr->h_samp_factor;
+    compptr->downsampled_width = (JDIMENSION)
+      jdiv_round_up((long) cinfo->output_width * (long) compptr->h_samp_factor,
+		    (long) cinfo->max_h_samp_factor);
+    cinfo->master->first_MCU_col[ci] = first_iMCU_col * hsf;
+    cinfo->master->last_MCU_col[ci] = (JDIMENSION)
+      jdiv_round_up((long) (*xoffset + *width) * hsf, (long) align) - 1;
+  }
+}
+
+
+/*
+ * Read and discard num_lines scanlines.  Returns the number of lines skipped,
+ * which is less than num_lines only at the bottom of the image or on
+ * suspension.
+ *
+ * Without restart markers the blocks of the skipped rows must still be
+ * entropy decoded, but their inverse transform is left out.  The rows of the
+ * last three iMCU rows before the target are decoded in full, since the main
+ * buffer controller works an iMCU row ahead and the context upsamplers look
+ * one iMCU row back.  Skipped rows are still upsampled and color converted
+ * within the crop window.
+ */
+
+GLOBAL(JDIMENSION)
+jpeg_skip_scanlines (j_decompress_ptr cinfo, JDIMENSION num_lines)
+{
+  JDIMENSION target, fast_end, margin, start, lines;
+  JSAMPARRAY scratch;
+
+  if (cinfo->global_state != DSTATE_SCANNING)
+    ERREXIT1(cinfo, JERR_BAD_STATE, cinfo->global_state);
+
+  start = cinfo->output_scanline;
+  target = cinfo->output_height - start < num_lines ?
+	   cinfo->output_height : start + num_lines;
+  if (target == start)
+    return 0;
+
+  /* A scratch buffer of rec_outbuf_height rows, which is what the merged
+   * upsampler may emit at once.
+   */
+  scratch = (*cinfo->mem->alloc_sarray)
+    ((j_common_ptr) cinfo, JPOOL_IMAGE,
+     cinfo->output_width * cinfo->out_color_components,
+     (JDIMENSION) cinfo->rec_outbuf_height);
+
+  margin = 3 * cinfo->max_v_samp_factor * cinfo->min_codec_data_unit;
+  fast_end = target > margin ? target - margin : 0;
+
+  cinfo->master->skip_idct = TRUE;
+  while (cinfo->output_scanline < fast_end) {
+    if (jpeg_read_scanlines(cinfo, scratch,
+			    (JDIMENSION) cinfo->rec_outbuf_height) == 0)
+      break;
+  }
+  cinfo->master->skip_idct = FALSE;
+
+  while (cinfo->output_scanline < target) {
+    lines = target - cinfo->output_scanline;
+    if (lines > (JDIMENSION) cinfo->rec_outbuf_height)
+      lines = (JDIMENSION) cinfo->rec_outbuf_height;
+    if (jpeg_read_scanlines(cinfo, scratch, lines) == 0)
+      break;
+  }
+
+  return cinfo->output_scanline - start;
+}
+
+
 /*
  * Alternate entry point to read raw data.
  * Processes exactly one iMCU row per call, unless suspended.
@@ -98,6 +98,8 @@ typedef FAST_FLOAT FLOAT_MULT_TYPE; /* preferred floating type */
 #define jpeg_idct_4x4		jpeg8_idct_4x4
 #define jpeg_idct_2x2		jpeg8_idct_2x2
 #define jpeg_idct_1x1		jpeg8_idct_1x1
+#define jpeg_fdct_islow_sse2	jpeg8_fdct_islow_sse2
+#define jpeg_idct_islow_sse2	jpeg8_idct_islow_sse2
 #endif /* NEED_SHORT_EXTERNAL_NAMES */
 
 /* Extern declarations for the forward and inverse DCT routines. */
@@ -125,6 +127,22 @@ EXTERN(void) jpeg_idct_1x1
     JPP((j_decompress_ptr cinfo, jpeg_component_info * compptr,
 	 JCOEFPTR coef_block, JSAMPARRAY output_buf, JDIMENSION output_col));
 
+/* SSE2 versions of the accurate integer DCT (jdctsse2.c), bit-exact with
+ * jpeg_fdct_islow and jpeg_idct_islow.  They also rely on DCTELEM being
+ * 32 bits wide.
+ */
+
+#ifdef SSE2_SUPPORTED
+#define DCT_SSE2_SUPPORTED
+#endif
+
+#ifdef DCT_SSE2_SUPPORTED
+EXTERN(void) jpeg_fdct_islow_sse2 JPP((DCTELEM * data));
+EXTERN(void) jpeg_idct_islow_sse2
+    JPP((j_decompress_ptr cinfo, jpeg_component_info * compptr,
+	 JCOEFPTR coef_block, JSAMPARRAY output_buf, JDIMENSION output_col));
+#endif
+
 
 /*
  * Macros for handling fixed-point arithmetic; these are used by many
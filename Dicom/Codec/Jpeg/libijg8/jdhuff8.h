@@ -30,7 +30,7 @@
 
 /* Derived data constructed for each Huffman table */
 
-#define HUFF_LOOKAHEAD	8	/* # of bits of lookahead */
+#define HUFF_LOOKAHEAD	9	/* # of bits of lookahead */
 
 typedef struct {
   /* Basic tables: (element [0] of each array is unused) */
@@ -52,6 +52,15 @@ typedef struct {
    */
   int look_nbits[1<<HUFF_LOOKAHEAD]; /* # bits, or 0 if too long */
   UINT8 look_sym[1<<HUFF_LOOKAHEAD]; /* symbol, or unused */
+
+  /* Combined lookahead table, indexed the same way.  If the next Huffman
+   * code and the extra bits that follow it (the low 4 bits of the symbol
+   * give their count) together fit in HUFF_LOOKAHEAD bits, the entry holds
+   * the total number of bits in its low 4 bits, the high 4 bits of the
+   * symbol in the next 4 bits, and the extended value of the extra bits
+   * (0 if there are none) above that.  Otherwise the entry is 0.
+   */
+  int look_value[1<<HUFF_LOOKAHEAD];
 } d_derived_tbl;
 
 /* Expand a Huffman table definition into the derived format */
@@ -78,13 +87,21 @@ EXTERN(void) jpeg_make_d_derived_tbl
  * necessary.
  */
 
-typedef IJG_INT32 bit_buf_type;	/* type of bit-extraction buffer */
-#define BIT_BUF_SIZE  32	/* size of buffer in bits */
-
-/* If long is > 32 bits on your machine, and shifting/masking longs is
- * reasonably fast, making bit_buf_type be long and setting BIT_BUF_SIZE
- * appropriately should be a win.  Unfortunately we can't define the size
- * with something like  #define BIT_BUF_SIZE (sizeof(bit_buf_type)*8)
+#if defined(_WIN64)
+typedef unsigned __int64 bit_buf_type;	/* type of bit-extraction buffer */
+#define BIT_BUF_SIZE  64	/* size of buffer in bits */
+#elif defined(__LP64__)
+typedef unsigned long bit_buf_type;
+#define BIT_BUF_SIZE  64
+#else
+typedef unsigned long bit_buf_type;
+#define BIT_BUF_SIZE  32
+#endif
+
+/* On 64-bit targets the buffer is 64 bits wide, so jpeg_fill_bit_buffer
+ * is called about half as often and can load several bytes at a time.
+ * Unfortunately we can't define the size with something like
+ *   #define BIT_BUF_SIZE (sizeof(bit_buf_type)*8)
  * because not all machines measure sizeof in 8-bit bytes.
  */
 
@@ -204,6 +221,41 @@ slowlabel: \
   } \
 }
 
+/*
+ * HUFF_DECODE_VALUE decodes a Huffman symbol together with the extra bits
+ * that follow it, as the DC and AC coefficients and the lossless sample
+ * differences are coded.  On return, run is the high 4 bits of the symbol
+ * and result is the extended value of the extra bits, which is nonzero
+ * exactly when the low 4 bits of the symbol are.  When the code and its
+ * extra bits fit in HUFF_LOOKAHEAD bits this needs just one probe of the
+ * look_value table; otherwise we fall back on HUFF_DECODE.  HUFF_EXTEND
+ * must be defined by the module using this macro, and the function must
+ * declare SHIFT_TEMPS.
+ */
+
+#define HUFF_DECODE_VALUE(result,run,state,htbl,failaction,slowlabel) \
+{ register int lv; \
+  if (bits_left < HUFF_LOOKAHEAD) { \
+    if (! jpeg_fill_bit_buffer(&state,get_buffer,bits_left, 0)) {failaction;} \
+    get_buffer = state.get_buffer; bits_left = state.bits_left; \
+  } \
+  if (bits_left >= HUFF_LOOKAHEAD && \
+      (lv = htbl->look_value[PEEK_BITS(HUFF_LOOKAHEAD)]) != 0) { \
+    DROP_BITS(lv & 15); \
+    run = (lv >> 4) & 15; \
+    result = (int) RIGHT_SHIFT((IJG_INT32) lv, 8); \
+  } else { \
+    HUFF_DECODE(result, state, htbl, failaction, slowlabel); \
+    run = result >> 4; \
+    if ((lv = result & 15) != 0) { \
+      CHECK_BIT_BUFFER(state, lv, failaction); \
+      result = GET_BITS(lv); \
+      result = HUFF_EXTEND(result, lv); \
+    } else \
+      result = 0; \
+  } \
+}
+
 /* Out-of-line case for Huffman code fetching */
 EXTERN(int) jpeg_huff_decode
 	JPP((bitread_working_state * state, register bit_buf_type get_buffer,
@@ -221,6 +221,8 @@ master_selection (j_decompress_ptr cinfo)
   my_master_ptr master = (my_master_ptr) cinfo->master;
   long samplesperrow;
   JDIMENSION jd_samplesperrow;
+  int ci;
+  jpeg_component_info *compptr;
 
   /* Initialize dimensions and other stuff */
   jpeg_calc_output_dimensions(cinfo);
@@ -310,6 +312,16 @@ master_selection (j_decompress_ptr cinfo)
   /* Initialize input side of decompressor to consume first scan. */
   (*cinfo->inputctl->start_input_pass) (cinfo);
 
+  /* Inverse transform every column until jpeg_crop_scanline says otherwise. */
+  master->pub.first_iMCU_col = 0;
+  master->pub.last_iMCU_col = cinfo->MCUs_per_row - 1;
+  for (ci = 0, compptr = cinfo->comp_info; ci < cinfo->num_components;
+       ci++, compptr++) {
+    master->pub.first_MCU_col[ci] = 0;
+    master->pub.last_MCU_col[ci] = compptr->width_in_data_units - 1;
+  }
+  master->pub.skip_idct = FALSE;
+
 #ifdef D_MULTISCAN_FILES_SUPPORTED
   /* If jpeg_start_decompress will read the whole file, initialize
    * progress monitoring appropriately.  The input step is counted
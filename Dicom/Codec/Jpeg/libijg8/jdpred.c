@@ -31,6 +31,10 @@
 #include "jpeglib8.h"
 #include "jlossls8.h"		/* Private declarations for lossless codec */
 
+#ifdef SSE2_SUPPORTED
+#include <emmintrin.h>
+#endif
+
 
 #ifdef D_LOSSLESS_SUPPORTED
 
@@ -163,6 +167,149 @@ jpeg_undifference7(j_decompress_ptr cinfo, int comp_index,
 }
 
 
+#ifdef SSE2_SUPPORTED
+
+/*
+ * SSE2 undifferencers, for four samples at a time in 32-bit lanes.
+ *
+ * Predictors 2 and 3 do not depend on Ra, so each group of four samples is
+ * reconstructed independently.  Predictors 1, 4 and 5 are Ra plus a term
+ * that depends only on the previous row, so the row is a running sum of
+ * (difference + term), which is computed four lanes at a time by a log-step
+ * prefix sum carried from group to group.  The sum wraps modulo 2^32, which
+ * leaves it unchanged modulo 2^16, so masking once per sample gives exactly
+ * the scalar result.  Predictors 6 and 7 shift Ra itself and have no such
+ * form; they keep the scalar code.
+ *
+ * As in the scalar code, prev_row and undiff_buf may be the same row, so
+ * each group of Rb values is loaded before the group is stored and Rc is
+ * taken from the previous group's Rb rather than reloaded.
+ */
+
+/* Add the running value (in every lane of Ra4) to the prefix sum of x. */
+#define PREFIX_SUM(x)  \
+	(x = _mm_add_epi32(x, _mm_slli_si128(x, 4)), \
+	 x = _mm_add_epi32(x, _mm_slli_si128(x, 8)), \
+	 x = _mm_add_epi32(x, Ra4), \
+	 Ra4 = _mm_shuffle_epi32(x, 0xFF))
+
+/* No running value: the terms are the reconstructed samples. */
+#define NO_SUM(x)
+
+#define UNDIFFERENCE_1D_SSE2(INITIAL_PREDICTOR) \
+	const __m128i mask = _mm_set1_epi32(0xFFFF); \
+	__m128i diff, Ra4; \
+	unsigned int xindex; \
+	int Ra; \
+ \
+	Ra = (diff_buf[0] + INITIAL_PREDICTOR) & 0xFFFF; \
+	undiff_buf[0] = Ra; \
+	Ra4 = _mm_set1_epi32(Ra); \
+ \
+	for (xindex = 1; xindex + 4 <= width; xindex += 4) { \
+	  diff = _mm_loadu_si128((const __m128i *) (diff_buf + xindex)); \
+	  PREFIX_SUM(diff); \
+	  _mm_storeu_si128((__m128i *) (undiff_buf + xindex), \
+			   _mm_and_si128(diff, mask)); \
+	} \
+ \
+	Ra = _mm_cvtsi128_si32(Ra4) & 0xFFFF; \
+	for (; xindex < width; xindex++) { \
+	  Ra = (diff_buf[xindex] + PREDICTOR1) & 0xFFFF; \
+	  undiff_buf[xindex] = Ra; \
+	}
+
+/*
+ * TERM adds the part of the predictor that depends on Rb4/Rc4 to diff, and
+ * ACCUMULATE is PREFIX_SUM if the predictor also includes Ra.
+ */
+
+#define UNDIFFERENCE_2D_SSE2(TERM, ACCUMULATE, PREDICTOR) \
+	const __m128i mask = _mm_set1_epi32(0xFFFF); \
+	__m128i diff, Ra4, Rb4, Rc4, last; \
+	unsigned int xindex; \
+	int Ra, Rb, Rc; \
+ \
+	Rb = GETJSAMPLE(prev_row[0]); \
+	Ra = (diff_buf[0] + PREDICTOR2) & 0xFFFF; \
+	undiff_buf[0] = Ra; \
+	Ra4 = _mm_set1_epi32(Ra); \
+	last = _mm_slli_si128(_mm_cvtsi32_si128(Rb), 12); \
+ \
+	for (xindex = 1; xindex + 4 <= width; xindex += 4) { \
+	  diff = _mm_loadu_si128((const __m128i *) (diff_buf + xindex)); \
+	  Rb4 = _mm_loadu_si128((const __m128i *) (prev_row + xindex)); \
+	  Rc4 = _mm_or_si128(_mm_slli_si128(Rb4, 4), _mm_srli_si128(last, 12)); \
+	  last = Rb4; \
+	  TERM; \
+	  ACCUMULATE(diff); \
+	  _mm_storeu_si128((__m128i *) (undiff_buf + xindex), \
+			   _mm_and_si128(diff, mask)); \
+	} \
+ \
+	Rb = _mm_cvtsi128_si32(_mm_srli_si128(last, 12)); \
+	Ra = _mm_cvtsi128_si32(Ra4) & 0xFFFF; \
+	for (; xindex < width; xindex++) { \
+	  Rc = Rb; \
+	  Rb = GETJSAMPLE(prev_row[xindex]); \
+	  Ra = (diff_buf[xindex] + PREDICTOR) & 0xFFFF; \
+	  undiff_buf[xindex] = Ra; \
+	}
+
+
+METHODDEF(void)
+jpeg_undifference1_sse2(j_decompress_ptr cinfo, int comp_index,
+			JDIFFROW diff_buf, JDIFFROW prev_row,
+			JDIFFROW undiff_buf, JDIMENSION width)
+{
+  UNDIFFERENCE_1D_SSE2(INITIAL_PREDICTOR2);
+}
+
+METHODDEF(void)
+jpeg_undifference2_sse2(j_decompress_ptr cinfo, int comp_index,
+			JDIFFROW diff_buf, JDIFFROW prev_row,
+			JDIFFROW undiff_buf, JDIMENSION width)
+{
+  UNDIFFERENCE_2D_SSE2(diff = _mm_add_epi32(diff, Rb4), NO_SUM, PREDICTOR2);
+}
+
+METHODDEF(void)
+jpeg_undifference3_sse2(j_decompress_ptr cinfo, int comp_index,
+			JDIFFROW diff_buf, JDIFFROW prev_row,
+			JDIFFROW undiff_buf, JDIMENSION width)
+{
+  UNDIFFERENCE_2D_SSE2(diff = _mm_add_epi32(diff, Rc4), NO_SUM, PREDICTOR3);
+}
+
+METHODDEF(void)
+jpeg_undifference4_sse2(j_decompress_ptr cinfo, int comp_index,
+			JDIFFROW diff_buf, JDIFFROW prev_row,
+			JDIFFROW undiff_buf, JDIMENSION width)
+{
+  UNDIFFERENCE_2D_SSE2(diff = _mm_add_epi32(diff, _mm_sub_epi32(Rb4, Rc4)),
+		       PREFIX_SUM, PREDICTOR4);
+}
+
+METHODDEF(void)
+jpeg_undifference5_sse2(j_decompress_ptr cinfo, int comp_index,
+			JDIFFROW diff_buf, JDIFFROW prev_row,
+			JDIFFROW undiff_buf, JDIMENSION width)
+{
+  SHIFT_TEMPS
+  UNDIFFERENCE_2D_SSE2(diff = _mm_add_epi32(diff,
+			 _mm_srai_epi32(_mm_sub_epi32(Rb4, Rc4), 1)),
+		       PREFIX_SUM, PREDICTOR5);
+}
+
+#define UNDIFFERENCER(n)  (jpeg_simd_sse2() ? n##_sse2 : n)
+
+#else
+
+#define UNDIFFERENCER(n)  n
+
+#endif /* SSE2_SUPPORTED */
+
+
 /*
  * Undifferencer for the first row in a scan or restart interval.  The first
  * sample in the row is undifferenced using the special predictor constant
@@ -177,7 +324,14 @@ jpeg_undifference_first_row(j_decompress_ptr cinfo, int comp_index,
 {
   j_lossless_d_ptr losslsd = (j_lossless_d_ptr) cinfo->codec;
 
-  UNDIFFERENCE_1D(INITIAL_PREDICTORx);
+#ifdef SSE2_SUPPORTED
+  if (jpeg_simd_sse2()) {
+    UNDIFFERENCE_1D_SSE2(INITIAL_PREDICTORx);
+  } else
+#endif
+  {
+    UNDIFFERENCE_1D(INITIAL_PREDICTORx);
+  }
 
   /*
    * Now that we have undifferenced the first row, we want to use the
@@ -186,19 +340,24 @@ jpeg_undifference_first_row(j_decompress_ptr cinfo, int comp_index,
    */
   switch (cinfo->Ss) {
   case 1:
-    losslsd->predict_undifference[comp_index] = jpeg_undifference1;
+    losslsd->predict_undifference[comp_index] =
+      UNDIFFERENCER(jpeg_undifference1);
     break;
   case 2:
-    losslsd->predict_undifference[comp_index] = jpeg_undifference2;
+    losslsd->predict_undifference[comp_index] =
+      UNDIFFERENCER(jpeg_undifference2);
     break;
   case 3:
-    losslsd->predict_undifference[comp_index] = jpeg_undifference3;
+    losslsd->predict_undifference[comp_index] =
+      UNDIFFERENCER(jpeg_undifference3);
     break;
   case 4:
-    losslsd->predict_undifference[comp_index] = jpeg_undifference4;
+    losslsd->predict_undifference[comp_index] =
+      UNDIFFERENCER(jpeg_undifference4);
     break;
   case 5:
-    losslsd->predict_undifference[comp_index] = jpeg_undifference5;
+    losslsd->predict_undifference[comp_index] =
+      UNDIFFERENCER(jpeg_undifference5);
     break;
   case 6:
     losslsd->predict_undifference[comp_index] = jpeg_undifference6;
@@ -21,6 +21,10 @@
  * but you'd better have lots of main memory (or virtual memory) if you want
  * to process big images.
  * Note that the max_memory_to_use option is ignored by this implementation.
+ *
+ * An application can supply its own memory source with jpeg_attach_arena
+ * once the JPEG object has been created; the object's memory then comes
+ * from the arena and is returned to it rather than to free().
  */
 
 #define JPEG_INTERNALS
@@ -36,19 +40,59 @@ extern void free JPP((void *ptr));
 
 /*
  * Memory allocation and freeing are controlled by the regular library
- * routines malloc() and free().
+ * routines malloc() and free(), or by the application's arena if it set one.
+ *
+ * The memory manager object and the first pools are allocated while the
+ * JPEG object is created, before an arena can be attached, so every block
+ * starts with a header recording where it came from.  The header is as
+ * large as the arena's alignment, which the object keeps.
  */
 
+typedef union {
+  struct jpeg_arena_mgr * arena;	/* source of the block, or NULL */
+  char pad[16];
+} block_hdr;
+
+LOCAL(void *)
+get_block (j_common_ptr cinfo, size_t sizeofobject)
+{
+  block_hdr * hdr;
+
+  if (sizeofobject > (size_t) -1 - SIZEOF(block_hdr))
+    return NULL;
+  sizeofobject += SIZEOF(block_hdr);
+  if (cinfo->arena != NULL)
+    hdr = (block_hdr *) (*cinfo->arena->get_mem) (cinfo->arena, sizeofobject);
+  else
+    hdr = (block_hdr *) malloc(sizeofobject);
+  if (hdr == NULL)
+    return NULL;
+  hdr->arena = cinfo->arena;
+  return (void *) (hdr + 1);
+}
+
+LOCAL(void)
+free_block (void * object, size_t sizeofobject)
+{
+  block_hdr * hdr = (block_hdr *) object - 1;
+
+  if (hdr->arena != NULL)
+    (*hdr->arena->free_mem) (hdr->arena, (void *) hdr,
+			     sizeofobject + SIZEOF(block_hdr));
+  else
+    free((void *) hdr);
+}
+
 GLOBAL(void *)
 jpeg_get_small (j_common_ptr cinfo, size_t sizeofobject)
 {
-  return (void *) malloc(sizeofobject);
+  return get_block(cinfo, sizeofobject);
 }
 
 GLOBAL(void)
 jpeg_free_small (j_common_ptr cinfo, void * object, size_t sizeofobject)
 {
-  free(object);
+  free_block(object, sizeofobject);
 }
 
 
@@ -62,14 +106,25 @@ jpeg_free_small (j_common_ptr cinfo, void * object, size_t sizeofobject)
 GLOBAL(void FAR *)
 jpeg_get_large (j_common_ptr cinfo, size_t sizeofobject)
 {
-  return (void FAR *) malloc(sizeofobject);
+  return (void FAR *) get_block(cinfo, sizeofobject);
 }
 
 GLOBAL(void)
 jpeg_free_large (j_common_ptr cinfo, void FAR * object, size_t sizeofobject)
 {
+  free_block((void *) object, sizeofobject);
+}
+
+
+/*
+ * Attach an arena to a JPEG object that has been created.  The blocks it
+ * already has are still returned to free(); later ones come from the arena.
+ */
 
-	free(object);
+GLOBAL(void)
+jpeg_attach_arena (j_common_ptr cinfo, struct jpeg_arena_mgr * arena)
+{
+  cinfo->arena = arena;
 }
 
 
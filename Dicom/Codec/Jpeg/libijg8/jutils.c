@@ -23,6 +23,10 @@
 #include "jinclude8.h"
 #include "jpeglib8.h"
 
+#if defined(SSE2_SUPPORTED) && defined(_M_IX86)
+#include <intrin.h>
+#endif
+
 
 /*
  * jpeg_zigzag_order[i] is the zigzag-order position of the i'th element
@@ -185,3 +189,30 @@ jzero_far (void FAR * target, size_t bytestozero)
   }
 #endif
 }
+
+
+#ifdef SSE2_SUPPORTED
+
+/*
+ * Report whether the processor supports SSE2.  It is part of the x64
+ * baseline; 32-bit x86 processors have to be asked.
+ */
+
+GLOBAL(boolean)
+jpeg_simd_sse2 (void)
+{
+#ifdef _M_IX86
+  static int sse2 = -1;		/* benign race: every thread stores the same value */
+
+  if (sse2 < 0) {
+    int info[4];
+    __cpuid(info, 1);
+    sse2 = (info[3] >> 26) & 1;
+  }
+  return sse2 ? TRUE : FALSE;
+#else
+  return TRUE;
+#endif
+}
+
+#endif /* SSE2_SUPPORTED */
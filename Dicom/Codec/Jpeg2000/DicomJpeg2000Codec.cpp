@@ -146,6 +146,37 @@ void DicomJpeg2000Codec::Encode(DicomUncompressedPixelData^ oldPixelData, DicomC
 
 	int pixelCount = oldPixelData->ImageHeight * oldPixelData->ImageWidth;
 
+	bool lossy = newPixelData->TransferSyntax->Equals(TransferSyntax::Jpeg2000ImageCompression) && jparams->Irreversible;
+
+	// Extra quality layers in front of the final one, coarsest first
+	array<float>^ layerRates = jparams->QualityLayerRates;
+	int extraLayers = layerRates == nullptr ? 0 : layerRates->Length;
+	if (extraLayers > 99)
+		throw gcnew DicomCodecException("JPEG 2000 codec supports at most 100 quality layers");
+	for (int i = 0; i < extraLayers; i++) {
+		float next = i + 1 < extraLayers ? layerRates[i + 1] : (lossy ? jparams->Rate : 1);
+		if (!(layerRates[i] > next))
+			throw gcnew DicomCodecException(String::Format("Invalid JPEG 2000 quality layer rates: {0} must be greater than {1}", layerRates[i], next));
+	}
+
+	// Tiles; a size of 0 keeps the frame in one tile along that axis
+	bool tiled = jparams->TileWidth > 0 || jparams->TileHeight > 0;
+	int tileWidth = jparams->TileWidth > 0 ? jparams->TileWidth : oldPixelData->ImageWidth;
+	int tileHeight = jparams->TileHeight > 0 ? jparams->TileHeight : oldPixelData->ImageHeight;
+	int tileOriginX = jparams->TileWidth > 0 ? jparams->TileOriginX : 0;
+	int tileOriginY = jparams->TileHeight > 0 ? jparams->TileOriginY : 0;
+	if (tileOriginX >= tileWidth || tileOriginY >= tileHeight)
+		throw gcnew DicomCodecException("JPEG 2000 tile origin must be less than the tile size");
+	if ((Int64)((tileOriginX + oldPixelData->ImageWidth - 1) / tileWidth + 1)
+		* ((tileOriginY + oldPixelData->ImageHeight - 1) / tileHeight + 1) > 65535)
+		throw gcnew DicomCodecException("JPEG 2000 codec supports at most 65535 tiles");
+
+	// The frame starts on the reference grid at a multiple of 32, the step of the coarsest of the 6
+	// resolution levels, so each level keeps the size DecodeFrameAtResolution reports; the tile grid
+	// starts tileOrigin before it
+	int frameX0 = (tileOriginX + 31) & ~31;
+	int frameY0 = (tileOriginY + 31) & ~31;
+
 	for (int frame = 0; frame < oldPixelData->NumberOfFrames; frame++) {
 		array<unsigned char>^ frameArray = oldPixelData->GetFrame(frame);
 		pin_ptr<unsigned char> framePin = &frameArray[0];
@@ -175,19 +206,26 @@ void DicomJpeg2000Codec::Encode(DicomUncompressedPixelData^ oldPixelData, DicomC
 		// Progression order by quality
 		eparams.prog_order = LRCP;
 		// Use Tiles?
-		eparams.tile_size_on=false;
+		eparams.tile_size_on=tiled;
 		// Tile Size
-		eparams.cp_tdx=1;
-		eparams.cp_tdy=1;
+		eparams.cp_tdx=tiled ? tileWidth : 1;
+		eparams.cp_tdy=tiled ? tileHeight : 1;
 		// Tile Origin
-		eparams.cp_tx0=0;
-		eparams.cp_ty0=0;
+		eparams.cp_tx0=frameX0 - tileOriginX;
+		eparams.cp_ty0=frameY0 - tileOriginY;
 
 		eparams.numresolution = 6;
 
+		// Threads encoding the code-blocks
+		eparams.num_threads = jparams->EncodeThreads > 0 ? jparams->EncodeThreads : Environment::ProcessorCount;
+
 		// Image Offset
-		eparams.image_offset_x0 = 0;
-		eparams.image_offset_y0 = 0;
+		eparams.image_offset_x0 = frameX0;
+		eparams.image_offset_y0 = frameY0;
+
+		// Random access markers
+		eparams.tlm_on = jparams->EnableTlm;
+		eparams.plt_on = jparams->EnablePlt;
 
 		// Mode
 		eparams.mode = (jparams->EnableBypass ? 1 : 0) + (jparams->EnableReset ? 2 : 0)
@@ -197,18 +235,17 @@ void DicomJpeg2000Codec::Encode(DicomUncompressedPixelData^ oldPixelData, DicomC
 		// Comment
 		eparams.cp_comment = "ClearCanvas DICOM OpenJPEG";
 
-		if (newPixelData->TransferSyntax->Equals(TransferSyntax::Jpeg2000ImageCompression) && jparams->Irreversible) {
+		if (lossy) {
 			eparams.irreversible = 1;
-			eparams.tcp_rates[0] = jparams->Rate;
-			eparams.tcp_numlayers = 1;
-			eparams.cp_disto_alloc = 1;
-
+			eparams.tcp_rates[extraLayers] = jparams->Rate;
 		} else {
 			eparams.irreversible = 0;
-			eparams.tcp_rates[0] = 1; // Lossless = 1
-			eparams.tcp_numlayers = 1;
-			eparams.cp_disto_alloc = 1;
+			eparams.tcp_rates[extraLayers] = 0; // Lossless = 0, no limit; a rate of 1 can clip a small tile
 		}
+		for (int i = 0; i < extraLayers; i++)
+			eparams.tcp_rates[i] = layerRates[i];
+		eparams.tcp_numlayers = extraLayers + 1;
+		eparams.cp_disto_alloc = 1;
 
 		if (oldPixelData->PhotometricInterpretation == "RGB" && jparams->AllowMCT)
 			eparams.tcp_mct = 1;
@@ -222,14 +259,16 @@ void DicomJpeg2000Codec::Encode(DicomUncompressedPixelData^ oldPixelData, DicomC
 			cmptparm[i].dy = eparams.subsampling_dy;
 			cmptparm[i].h = oldPixelData->ImageHeight;
 			cmptparm[i].w = oldPixelData->ImageWidth;
+			cmptparm[i].x0 = frameX0;
+			cmptparm[i].y0 = frameY0;
 		}
 
 		try {
 			OPJ_COLOR_SPACE color_space = getOpenJpegColorSpace(oldPixelData->PhotometricInterpretation);
 			image = opj_image_create(oldPixelData->SamplesPerPixel, &cmptparm[0], color_space);
 
-			image->x0 = 0;
-			image->y0 = 0;
+			image->x0 = frameX0;
+			image->y0 = frameY0;
 			image->x1 =	image->x0 + ((oldPixelData->ImageWidth - 1) * eparams.subsampling_dx) + 1;
 			image->y1 =	image->y0 + ((oldPixelData->ImageHeight - 1) * eparams.subsampling_dy) + 1;
 
@@ -339,7 +378,7 @@ void DicomJpeg2000Codec::Encode(DicomUncompressedPixelData^ oldPixelData, DicomC
 		}
 	}
 
-	if (newPixelData->TransferSyntax->Equals(TransferSyntax::Jpeg2000ImageCompression) && jparams->Irreversible) {
+	if (lossy) {
 		newPixelData->LossyImageCompressionMethod = "ISO_15444_1";
 		
 		double oldSize = oldPixelData->BitsStoredFrameSize;
@@ -355,16 +394,61 @@ void DicomJpeg2000Codec::DecodeFrame(int frame, DicomCompressedPixelData^ oldPix
 	if (jparams == nullptr)
 		jparams = (DicomJpeg2000Parameters^)GetDefaultParameters();
 
-	array<unsigned char>^ destArray = gcnew array<unsigned char>(oldPixelData->UncompressedFrameSize);
-	pin_ptr<unsigned char> destPin = &destArray[0];
-	unsigned char* destData = destPin;
-	int destDataSize = destArray->Length;
-
-	int pixelCount = oldPixelData->ImageHeight * oldPixelData->ImageWidth;
-
 	if (newPixelData->PhotometricInterpretation == "YBR_RCT" || newPixelData->PhotometricInterpretation == "YBR_ICT")
 		newPixelData->PhotometricInterpretation = "RGB";
 
+	// The decoded frame replaces the compressed pixel data, so every quality layer is decoded and a
+	// lossless frame stays lossless; DecodeLayers only applies to the previews below
+	newPixelData->AppendFrame(DecodeFrameData(frame, 0, 0, 0, 0, oldPixelData->ImageWidth, oldPixelData->ImageHeight, oldPixelData, jparams));
+}
+
+array<unsigned char>^ DicomJpeg2000Codec::DecodeFrameAtResolution(int frame, int reduce, DicomCompressedPixelData^ oldPixelData, DicomCodecParameters^ parameters) {
+	DicomJpeg2000Parameters^ jparams = (DicomJpeg2000Parameters^)parameters;
+	if (jparams == nullptr)
+		jparams = (DicomJpeg2000Parameters^)GetDefaultParameters();
+
+	if (reduce < 0 || reduce >= 32)
+		throw gcnew ArgumentOutOfRangeException("reduce");
+
+	// The frame at resolution level reduce is 2^reduce times smaller, rounded up
+	int width = ((oldPixelData->ImageWidth - 1) >> reduce) + 1;
+	int height = ((oldPixelData->ImageHeight - 1) >> reduce) + 1;
+
+	return DecodeFrameData(frame, reduce, jparams->DecodeLayers, 0, 0, width, height, oldPixelData, jparams);
+}
+
+array<unsigned char>^ DicomJpeg2000Codec::DecodeFrameRegion(int frame, int reduce, int x, int y, int width, int height, DicomCompressedPixelData^ oldPixelData, DicomCodecParameters^ parameters) {
+	DicomJpeg2000Parameters^ jparams = (DicomJpeg2000Parameters^)parameters;
+	if (jparams == nullptr)
+		jparams = (DicomJpeg2000Parameters^)GetDefaultParameters();
+
+	if (reduce < 0 || reduce >= 32)
+		throw gcnew ArgumentOutOfRangeException("reduce");
+
+	int frameWidth = ((oldPixelData->ImageWidth - 1) >> reduce) + 1;
+	int frameHeight = ((oldPixelData->ImageHeight - 1) >> reduce) + 1;
+
+	if (x < 0 || x >= frameWidth)
+		throw gcnew ArgumentOutOfRangeException("x");
+	if (y < 0 || y >= frameHeight)
+		throw gcnew ArgumentOutOfRangeException("y");
+	if (width <= 0 || width > frameWidth - x)
+		throw gcnew ArgumentOutOfRangeException("width");
+	if (height <= 0 || height > frameHeight - y)
+		throw gcnew ArgumentOutOfRangeException("height");
+
+	return DecodeFrameData(frame, reduce, jparams->DecodeLayers, x, y, width, height, oldPixelData, jparams);
+}
+
+array<unsigned char>^ DicomJpeg2000Codec::DecodeFrameData(int frame, int reduce, int layers, int x, int y, int width, int height, DicomCompressedPixelData^ oldPixelData, DicomJpeg2000Parameters^ jparams) {
+	int pixelCount = height * width;
+	bool wholeFrame = reduce == 0 && width == oldPixelData->ImageWidth && height == oldPixelData->ImageHeight;
+
+	array<unsigned char>^ destArray = gcnew array<unsigned char>(wholeFrame ? oldPixelData->UncompressedFrameSize
+		: pixelCount * oldPixelData->SamplesPerPixel * oldPixelData->BytesAllocated);
+	pin_ptr<unsigned char> destPin = &destArray[0];
+	unsigned char* destData = destPin;
+
 	array<unsigned char>^ jpegArray = oldPixelData->GetFrameFragmentData(frame);
 	pin_ptr<unsigned char> jpegPin = &jpegArray[0];
 	unsigned char* jpegData = jpegPin;
@@ -384,8 +468,17 @@ void DicomJpeg2000Codec::DecodeFrame(int frame, DicomCompressedPixelData^ oldPix
 	}
 
 	opj_set_default_decoder_parameters(&dparams);
-	dparams.cp_layer=0;
-	dparams.cp_reduce=0;
+	dparams.cp_layer=layers;
+	dparams.cp_reduce=reduce;
+	if (!wholeFrame) {
+		// The window is given to the decoder on the full frame; the frame starts on a multiple of
+		// 2^reduce, so it maps back onto exactly the requested pixels of the reduced level
+		dparams.DA_x0 = x << reduce;
+		dparams.DA_y0 = y << reduce;
+		dparams.DA_x1 = Math::Min(oldPixelData->ImageWidth, (x + width) << reduce);
+		dparams.DA_y1 = Math::Min(oldPixelData->ImageHeight, (y + height) << reduce);
+	}
+	dparams.num_threads = jparams->DecodeThreads > 0 ? jparams->DecodeThreads : Environment::ProcessorCount;
 
 	try {
 		dinfo = opj_create_decompress(CODEC_J2K);
@@ -406,6 +499,11 @@ void DicomJpeg2000Codec::DecodeFrame(int frame, DicomCompressedPixelData^ oldPix
 		for (int c = 0; c < image->numcomps; c++) {
 			opj_image_comp_t* comp = &image->comps[c];
 
+			// A codestream from elsewhere may place the frame at an odd offset, which changes the
+			// size of its reduced levels and windows
+			if (comp->w != width || comp->h != height)
+				throw gcnew DicomCodecException("JPEG 2000 frame size does not match the resolution level");
+
 			int pos = 0;
 			int offset = 0;
 
@@ -462,8 +560,6 @@ void DicomJpeg2000Codec::DecodeFrame(int frame, DicomCompressedPixelData^ oldPix
 			else
 				throw gcnew DicomCodecUnsupportedSopException("JPEG 2000 module only supports Bytes Allocated == 8 or 16!");
 		}
-
-		newPixelData->AppendFrame(destArray);
 	}
 	finally {
 		if (cio != nullptr)
@@ -473,7 +569,8 @@ void DicomJpeg2000Codec::DecodeFrame(int frame, DicomCompressedPixelData^ oldPix
 		if (image != nullptr)
 			opj_image_destroy(image);
 	}
-	
+
+	return destArray;
 }
 
 void DicomJpeg2000Codec::Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters) {
@@ -68,6 +68,8 @@ namespace Jpeg2000 {
 	private:
 		bool _irreversible;
 		float _rate;
+		array<float>^ _qualityLayerRates;
+		int _decodeLayers;
 		bool _isVerbose;
 		bool _enableMct;
 		bool _updatePmi;
@@ -77,11 +79,21 @@ namespace Jpeg2000 {
 		bool _enablevsc;
 		bool _enableerterm;
 		bool _enablesegmark;
+		bool _enabletlm;
+		bool _enableplt;
+		int _encodeThreads;
+		int _decodeThreads;
+		int _tileWidth;
+		int _tileHeight;
+		int _tileOriginX;
+		int _tileOriginY;
 
 	public:
 		DicomJpeg2000Parameters() {
 			_irreversible = false;
 			_rate = 8;
+			_qualityLayerRates = nullptr;
+			_decodeLayers = 0;
 			_isVerbose = false;
 			_enableMct = true;
 			_updatePmi = true;
@@ -91,6 +103,14 @@ namespace Jpeg2000 {
 			_enablevsc = false;
 			_enableerterm = false;
 			_enablesegmark = false;
+			_enabletlm = false;
+			_enableplt = false;
+			_encodeThreads = 0;
+			_decodeThreads = 0;
+			_tileWidth = 0;
+			_tileHeight = 0;
+			_tileOriginX = 0;
+			_tileOriginY = 0;
 		}
 
 		property bool Irreversible {
@@ -106,6 +126,31 @@ namespace Jpeg2000 {
 			void set(float value) { _rate = value; }
 		}
 
+		///<summary>
+		/// Compression ratios of extra quality layers written in front of the final one, coarsest first,
+		/// e.g. { 80, 20 }.  The final layer is lossless, or coded at Rate for a lossy frame, so each ratio
+		/// must be greater than the next.  A decoder stopping after the first layers gets a lossy preview
+		/// from the front of the codestream.  Default is null (a single layer).
+		///</summary>
+		property array<float>^ QualityLayerRates {
+			array<float>^ get() { return _qualityLayerRates; }
+			void set(array<float>^ value) { _qualityLayerRates = value; }
+		}
+
+		///<summary>
+		/// The number of quality layers DecodeFrameAtResolution and DecodeFrameRegion decode; the passes
+		/// of the later layers are skipped, and the image is lossy unless all of them are decoded.  Decode
+		/// and DecodeFrame always decode every layer.  Default is 0 (all layers).
+		///</summary>
+		property int DecodeLayers {
+			int get() { return _decodeLayers; }
+			void set(int value) {
+				if (value < 0)
+					throw gcnew ArgumentOutOfRangeException("value");
+				_decodeLayers = value;
+			}
+		}
+
 		property bool IsVerbose {
 			bool get() { return _isVerbose; }
 			void set(bool value) { _isVerbose = value; }
@@ -147,6 +192,24 @@ namespace Jpeg2000 {
 			void set(bool value) { _enablesegmark = value; }
 		}
 
+		///<summary>
+		/// Write TLM markers, giving the length of each tile.  A reader holding only the main header can
+		/// then fetch the tiles it needs.
+		///</summary>
+		property bool EnableTlm {
+			bool get() { return _enabletlm; }
+			void set(bool value) { _enabletlm = value; }
+		}
+
+		///<summary>
+		/// Write PLT markers, giving the length of each packet.  The decoder then steps over the packets
+		/// of the resolution levels, quality layers and regions it leaves out without reading their headers.
+		///</summary>
+		property bool EnablePlt {
+			bool get() { return _enableplt; }
+			void set(bool value) { _enableplt = value; }
+		}
+
 		/// <summary>
 		/// Multi-component transorm enabled, ie, transform to YBR
 		/// </summary>
@@ -159,6 +222,76 @@ namespace Jpeg2000 {
 			bool get() { return _updatePmi; }
 			void set(bool value) { _updatePmi = value; }
 		}
+
+		///<summary>
+		/// The maximum number of threads encoding the code-blocks of a frame.  The codestream does not
+		/// depend on it.  Default is 0 (one per processor); 1 disables parallel encoding.
+		///</summary>
+		property int EncodeThreads {
+			int get() { return _encodeThreads; }
+			void set(int value) { _encodeThreads = value; }
+		}
+
+		///<summary>
+		/// The maximum number of threads decoding the code-blocks of a frame.
+		/// Default is 0 (one per processor); 1 disables parallel decoding.
+		///</summary>
+		property int DecodeThreads {
+			int get() { return _decodeThreads; }
+			void set(int value) { _decodeThreads = value; }
+		}
+
+		///<summary>
+		/// The width of the tiles a frame is cut into.  Tiles are coded independently, so the decoder
+		/// works on several at once and holds the wavelet data of only one tile per thread.
+		/// Default is 0 (the frame is one tile across).
+		///</summary>
+		property int TileWidth {
+			int get() { return _tileWidth; }
+			void set(int value) {
+				if (value < 0)
+					throw gcnew ArgumentOutOfRangeException("value");
+				_tileWidth = value;
+			}
+		}
+
+		///<summary>
+		/// The height of the tiles a frame is cut into.  Default is 0 (the frame is one tile down).
+		///</summary>
+		property int TileHeight {
+			int get() { return _tileHeight; }
+			void set(int value) {
+				if (value < 0)
+					throw gcnew ArgumentOutOfRangeException("value");
+				_tileHeight = value;
+			}
+		}
+
+		///<summary>
+		/// How far the tile grid starts to the left of the frame, so the first column of tiles is
+		/// TileWidth - TileOriginX pixels wide.  Must be less than TileWidth.  Default is 0.
+		///</summary>
+		property int TileOriginX {
+			int get() { return _tileOriginX; }
+			void set(int value) {
+				if (value < 0)
+					throw gcnew ArgumentOutOfRangeException("value");
+				_tileOriginX = value;
+			}
+		}
+
+		///<summary>
+		/// How far the tile grid starts above the frame, so the first row of tiles is
+		/// TileHeight - TileOriginY pixels high.  Must be less than TileHeight.  Default is 0.
+		///</summary>
+		property int TileOriginY {
+			int get() { return _tileOriginY; }
+			void set(int value) {
+				if (value < 0)
+					throw gcnew ArgumentOutOfRangeException("value");
+				_tileOriginY = value;
+			}
+		}
 	};
 
 
@@ -175,6 +308,27 @@ namespace Jpeg2000 {
 		virtual void Encode(DicomUncompressedPixelData^ oldPixelData, DicomCompressedPixelData^ newPixelData, DicomCodecParameters^ parameters);
 		virtual void Decode(DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters);
 		virtual void DecodeFrame(int frame, DicomCompressedPixelData^ oldPixelData, DicomUncompressedPixelData^ newPixelData, DicomCodecParameters^ parameters);
+
+		///<summary>
+		/// Decodes one frame at resolution level reduce, 2^reduce times smaller than the full image in
+		/// each direction (rounded up), in the same layout as DecodeFrame.  The code-blocks of the finer
+		/// levels are neither read nor decoded, so small thumbnails come at a fraction of the full cost.
+		/// reduce must be less than the number of resolution levels in the codestream (6 for frames
+		/// encoded by this codec).  Only the first DecodeLayers quality layers are decoded when it is set.
+		///</summary>
+		virtual array<unsigned char>^ DecodeFrameAtResolution(int frame, int reduce, DicomCompressedPixelData^ oldPixelData, DicomCodecParameters^ parameters);
+
+		///<summary>
+		/// Decodes the width x height pixels at (x, y) of one frame at resolution level reduce, with the
+		/// coordinates taken on that level, in the same layout as DecodeFrame.  Tiles away from the region
+		/// are skipped and only the code-blocks whose wavelet support reaches it are decoded, so panning
+		/// a viewport over a large tiled frame costs little more than the pixels shown.  Only the first
+		/// DecodeLayers quality layers are decoded when it is set.
+		///</summary>
+		virtual array<unsigned char>^ DecodeFrameRegion(int frame, int reduce, int x, int y, int width, int height, DicomCompressedPixelData^ oldPixelData, DicomCodecParameters^ parameters);
+
+	private:
+		array<unsigned char>^ DecodeFrameData(int frame, int reduce, int layers, int x, int y, int width, int height, DicomCompressedPixelData^ oldPixelData, DicomJpeg2000Parameters^ jparams);
 	};
 
 	public ref class DicomJpeg2000LossyCodec : public DicomJpeg2000Codec
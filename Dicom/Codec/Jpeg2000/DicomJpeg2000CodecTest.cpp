@@ -145,6 +145,318 @@ void DicomJpeg2000CodecTest::LossyCodecTest()
 	LossyImageTest(syntax, file);
 }
 
+void DicomJpeg2000CodecTest::DecodeThreadsTest()
+{
+	TransferSyntax^ syntax = TransferSyntax::Jpeg2000ImageCompression;
+	array<DicomFile^>^ files = gcnew array<DicomFile^> {
+		CreateFile(512, 512, "MONOCHROME2", 12, 16, true, 1),
+		CreateFile(255, 255, "MONOCHROME1", 8, 8, false, 2),
+		CreateFile(512, 512, "RGB", 8, 8, false, 1)
+	};
+
+	for each (DicomFile^ file in files)
+	{
+		DicomJpeg2000Parameters^ parameters = gcnew DicomJpeg2000Parameters();
+		DicomJpeg2000LossyCodec^ codec = gcnew DicomJpeg2000LossyCodec();
+		file->ChangeTransferSyntax(syntax, codec, parameters);
+		DicomFile^ threadedCopy = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+
+		// The code-blocks decoded on one thread and on four must give the same image
+		parameters->DecodeThreads = 1;
+		file->ChangeTransferSyntax(TransferSyntax::ExplicitVrLittleEndian, codec, parameters);
+		parameters->DecodeThreads = 4;
+		threadedCopy->ChangeTransferSyntax(TransferSyntax::ExplicitVrLittleEndian, codec, parameters);
+
+		String^ failureDescription;
+		bool result = Compare(DicomPixelData::CreateFrom(threadedCopy), DicomPixelData::CreateFrom(file), failureDescription);
+		Assert::IsTrue(result, failureDescription);
+	}
+}
+
+void DicomJpeg2000CodecTest::EncodeThreadsTest()
+{
+	array<DicomJpeg2000Codec^>^ codecs = gcnew array<DicomJpeg2000Codec^> {
+		gcnew DicomJpeg2000LosslessCodec(),
+		gcnew DicomJpeg2000LossyCodec()
+	};
+
+	for each (DicomJpeg2000Codec^ codec in codecs)
+	{
+		DicomFile^ file = CreateFile(512, 512, "RGB", 8, 8, false, 2);
+		DicomFile^ threadedCopy = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+
+		// The code-blocks encoded on one thread and on four must give the same codestream
+		DicomJpeg2000Parameters^ parameters = gcnew DicomJpeg2000Parameters();
+		parameters->EncodeThreads = 1;
+		file->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, parameters);
+		parameters->EncodeThreads = 4;
+		threadedCopy->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, parameters);
+
+		DicomCompressedPixelData^ pixelData = (DicomCompressedPixelData^)DicomPixelData::CreateFrom(file);
+		DicomCompressedPixelData^ threadedPixelData = (DicomCompressedPixelData^)DicomPixelData::CreateFrom(threadedCopy);
+		Assert::AreEqual(pixelData->NumberOfFrames, threadedPixelData->NumberOfFrames);
+		for (int frame = 0; frame < pixelData->NumberOfFrames; frame++)
+			CollectionAssert::AreEqual(pixelData->GetFrameFragmentData(frame), threadedPixelData->GetFrameFragmentData(frame));
+	}
+}
+
+void DicomJpeg2000CodecTest::DecodeAtResolutionTest()
+{
+	array<DicomFile^>^ files = gcnew array<DicomFile^> {
+		CreateFile(512, 512, "MONOCHROME2", 12, 16, false, 1),
+		CreateFile(255, 129, "RGB", 8, 8, false, 1)
+	};
+
+	for each (DicomFile^ file in files)
+	{
+		DicomJpeg2000LosslessCodec^ codec = gcnew DicomJpeg2000LosslessCodec();
+		file->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, nullptr);
+		DicomCompressedPixelData^ pixelData = (DicomCompressedPixelData^)DicomPixelData::CreateFrom(file);
+
+		// Level 0 is the whole frame, as DecodeFrame gives it
+		DicomUncompressedPixelData^ decoded = gcnew DicomUncompressedPixelData(pixelData);
+		codec->DecodeFrame(0, pixelData, decoded, nullptr);
+		CollectionAssert::AreEqual(decoded->GetFrame(0), codec->DecodeFrameAtResolution(0, 0, pixelData, nullptr));
+
+		for (int reduce = 1; reduce < 6; reduce++)
+		{
+			int width = ((pixelData->ImageWidth - 1) >> reduce) + 1;
+			int height = ((pixelData->ImageHeight - 1) >> reduce) + 1;
+			array<unsigned char>^ frame = codec->DecodeFrameAtResolution(0, reduce, pixelData, nullptr);
+			Assert::AreEqual(width * height * pixelData->SamplesPerPixel * pixelData->BytesAllocated, frame->Length);
+		}
+
+		// The codec writes 6 resolution levels, so there is no level 6
+		bool rejected = false;
+		try {
+			codec->DecodeFrameAtResolution(0, 6, pixelData, nullptr);
+		}
+		catch (DicomCodecException^) {
+			rejected = true;
+		}
+		Assert::IsTrue(rejected, "Resolution level beyond the codestream was not rejected");
+	}
+
+	// Colour tiles undo the MCT at each reduced size
+	DicomJpeg2000LosslessCodec^ codec = gcnew DicomJpeg2000LosslessCodec();
+	DicomJpeg2000Parameters^ parameters = gcnew DicomJpeg2000Parameters();
+	parameters->TileWidth = 256;
+	parameters->TileHeight = 16;
+	parameters->EnableVsc = true;
+	DicomFile^ file = CreateFile(369, 371, "RGB", 8, 8, false, 1);
+	file->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, parameters);
+	DicomCompressedPixelData^ pixelData = (DicomCompressedPixelData^)DicomPixelData::CreateFrom(file);
+	for (int reduce = 1; reduce < 6; reduce++)
+	{
+		int width = ((pixelData->ImageWidth - 1) >> reduce) + 1;
+		int height = ((pixelData->ImageHeight - 1) >> reduce) + 1;
+		array<unsigned char>^ frame = codec->DecodeFrameAtResolution(0, reduce, pixelData, parameters);
+		Assert::AreEqual(width * height * pixelData->SamplesPerPixel, frame->Length);
+	}
+}
+
+void DicomJpeg2000CodecTest::QualityLayersTest()
+{
+	DicomFile^ file = CreateFile(512, 512, "MONOCHROME2", 12, 16, false, 1);
+	DicomFile^ original = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+
+	DicomJpeg2000LosslessCodec^ codec = gcnew DicomJpeg2000LosslessCodec();
+	DicomJpeg2000Parameters^ parameters = gcnew DicomJpeg2000Parameters();
+	parameters->QualityLayerRates = gcnew array<float> { 40, 10 };
+	file->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, parameters);
+	DicomCompressedPixelData^ pixelData = (DicomCompressedPixelData^)DicomPixelData::CreateFrom(file);
+
+	// The first layer alone gives a preview of the same size, but not the lossless samples
+	parameters->DecodeLayers = 1;
+	array<unsigned char>^ preview = codec->DecodeFrameAtResolution(0, 0, pixelData, parameters);
+	parameters->DecodeLayers = 0;
+	array<unsigned char>^ full = codec->DecodeFrameAtResolution(0, 0, pixelData, parameters);
+	Assert::AreEqual(full->Length, preview->Length);
+	CollectionAssert::AreNotEqual(full, preview);
+
+	// Decoding the whole frame ignores DecodeLayers, so all three layers give back the original frame
+	parameters->DecodeLayers = 1;
+	file->ChangeTransferSyntax(TransferSyntax::ExplicitVrLittleEndian, codec, parameters);
+	String^ failureDescription;
+	bool result = Compare(DicomPixelData::CreateFrom(original), DicomPixelData::CreateFrom(file), failureDescription);
+	Assert::IsTrue(result, failureDescription);
+
+	// Each layer must be coarser than the next
+	parameters->QualityLayerRates = gcnew array<float> { 10, 40 };
+	bool rejected = false;
+	try {
+		original->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, parameters);
+	}
+	catch (DicomCodecException^) {
+		rejected = true;
+	}
+	Assert::IsTrue(rejected, "Quality layer rates out of order were not rejected");
+}
+
+void DicomJpeg2000CodecTest::TiledCodecTest()
+{
+	DicomJpeg2000LosslessCodec^ codec = gcnew DicomJpeg2000LosslessCodec();
+	DicomJpeg2000Parameters^ parameters = gcnew DicomJpeg2000Parameters();
+	parameters->TileWidth = 128;
+	parameters->TileHeight = 100;
+	parameters->TileOriginX = 40;
+	parameters->TileOriginY = 7;
+
+	array<DicomFile^>^ files = gcnew array<DicomFile^> {
+		CreateFile(512, 512, "MONOCHROME2", 12, 16, false, 1),
+		CreateFile(255, 129, "RGB", 8, 8, false, 1)
+	};
+
+	for each (DicomFile^ file in files)
+	{
+		DicomFile^ original = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+		file->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, parameters);
+		DicomCompressedPixelData^ pixelData = (DicomCompressedPixelData^)DicomPixelData::CreateFrom(file);
+
+		// Each resolution level keeps its size, wherever the tiles fall
+		for (int reduce = 1; reduce < 6; reduce++)
+		{
+			int width = ((pixelData->ImageWidth - 1) >> reduce) + 1;
+			int height = ((pixelData->ImageHeight - 1) >> reduce) + 1;
+			array<unsigned char>^ frame = codec->DecodeFrameAtResolution(0, reduce, pixelData, parameters);
+			Assert::AreEqual(width * height * pixelData->SamplesPerPixel * pixelData->BytesAllocated, frame->Length);
+		}
+
+		// The tiles decode back to the original frame
+		file->ChangeTransferSyntax(TransferSyntax::ExplicitVrLittleEndian, codec, parameters);
+		String^ failureDescription;
+		bool result = Compare(DicomPixelData::CreateFrom(original), DicomPixelData::CreateFrom(file), failureDescription);
+		Assert::IsTrue(result, failureDescription);
+	}
+
+	// The tile grid cannot start a whole tile before the frame
+	parameters->TileOriginX = 128;
+	bool rejected = false;
+	try {
+		CreateFile(255, 129, "RGB", 8, 8, false, 1)->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, parameters);
+	}
+	catch (DicomCodecException^) {
+		rejected = true;
+	}
+	Assert::IsTrue(rejected, "Tile origin outside the first tile was not rejected");
+}
+
+void DicomJpeg2000CodecTest::TiledBypassCodecTest()
+{
+	DicomJpeg2000LosslessCodec^ codec = gcnew DicomJpeg2000LosslessCodec();
+	DicomJpeg2000Parameters^ parameters = gcnew DicomJpeg2000Parameters();
+	parameters->EnableBypass = true;
+
+	// Small tiles end many more bypass segments than whole frames do
+	array<DicomFile^>^ files = gcnew array<DicomFile^> {
+		CreateFile(129, 255, "MONOCHROME2", 12, 16, false, 1),
+		CreateFile(37, 1000, "MONOCHROME2", 16, 16, false, 1)
+	};
+	array<int>^ tileWidths = gcnew array<int> { 16, 64 };
+
+	for (int i = 0; i < files->Length; i++)
+	{
+		DicomFile^ file = files[i];
+		DicomFile^ original = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+		parameters->TileWidth = tileWidths[i];
+		parameters->TileHeight = 16;
+		parameters->EnableRestart = i == 1;
+
+		file->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, parameters);
+		file->ChangeTransferSyntax(TransferSyntax::ExplicitVrLittleEndian, codec, parameters);
+
+		String^ failureDescription;
+		bool result = Compare(DicomPixelData::CreateFrom(original), DicomPixelData::CreateFrom(file), failureDescription);
+		Assert::IsTrue(result, failureDescription);
+	}
+}
+
+void DicomJpeg2000CodecTest::DecodeFrameRegionTest()
+{
+	DicomJpeg2000LossyCodec^ codec = gcnew DicomJpeg2000LossyCodec();
+	DicomJpeg2000Parameters^ untiled = gcnew DicomJpeg2000Parameters();
+	DicomJpeg2000Parameters^ tiled = gcnew DicomJpeg2000Parameters();
+	tiled->TileWidth = 128;
+	tiled->TileHeight = 100;
+	tiled->TileOriginX = 40;
+	tiled->TileOriginY = 7;
+
+	for each (DicomJpeg2000Parameters^ parameters in gcnew array<DicomJpeg2000Parameters^> { untiled, tiled })
+	{
+		parameters->Irreversible = true;
+		for each (DicomFile^ file in gcnew array<DicomFile^> {
+			CreateFile(512, 512, "MONOCHROME2", 12, 16, false, 1),
+			CreateFile(255, 129, "RGB", 8, 8, false, 1) })
+		{
+			file->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, parameters);
+			DicomCompressedPixelData^ pixelData = (DicomCompressedPixelData^)DicomPixelData::CreateFrom(file);
+			int planes = pixelData->IsPlanar ? pixelData->SamplesPerPixel : 1;
+			int pixelSize = pixelData->SamplesPerPixel / planes * pixelData->BytesAllocated;
+
+			// A region is the same as the pixels cut from the whole level
+			for (int reduce = 0; reduce < 3; reduce++)
+			{
+				int width = ((pixelData->ImageWidth - 1) >> reduce) + 1;
+				int height = ((pixelData->ImageHeight - 1) >> reduce) + 1;
+				array<unsigned char>^ frame = codec->DecodeFrameAtResolution(0, reduce, pixelData, parameters);
+
+				int x = width / 3, y = height / 4, w = width / 3, h = height - y;
+				array<unsigned char>^ region = codec->DecodeFrameRegion(0, reduce, x, y, w, h, pixelData, parameters);
+				Assert::AreEqual(w * h * planes * pixelSize, region->Length);
+
+				for (int plane = 0; plane < planes; plane++)
+					for (int row = 0; row < h; row++)
+						for (int i = 0; i < w * pixelSize; i++)
+							Assert::AreEqual(frame[(plane * height + y + row) * width * pixelSize + x * pixelSize + i],
+								region[(plane * h + row) * w * pixelSize + i], "Region differs at row {0}, reduce {1}", row, reduce);
+			}
+
+			bool rejected = false;
+			try {
+				codec->DecodeFrameRegion(0, 1, 10, 10, pixelData->ImageWidth / 2, 10, pixelData, parameters);
+			}
+			catch (ArgumentOutOfRangeException^) {
+				rejected = true;
+			}
+			Assert::IsTrue(rejected, "A region beyond the frame was not rejected");
+		}
+	}
+}
+
+void DicomJpeg2000CodecTest::RandomAccessMarkersTest()
+{
+	DicomJpeg2000LosslessCodec^ codec = gcnew DicomJpeg2000LosslessCodec();
+	DicomJpeg2000Parameters^ plain = gcnew DicomJpeg2000Parameters();
+	DicomJpeg2000Parameters^ marked = gcnew DicomJpeg2000Parameters();
+	for each (DicomJpeg2000Parameters^ parameters in gcnew array<DicomJpeg2000Parameters^> { plain, marked })
+	{
+		parameters->QualityLayerRates = gcnew array<float> { 40, 10 };
+		parameters->TileWidth = 128;
+		parameters->TileHeight = 128;
+	}
+	marked->EnableTlm = true;
+	marked->EnablePlt = true;
+
+	DicomFile^ file = CreateFile(300, 200, "MONOCHROME2", 12, 16, false, 1);
+	DicomFile^ original = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+	DicomFile^ reference = gcnew DicomFile(file->Filename, file->MetaInfo->Copy(), file->DataSet->Copy());
+	file->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, marked);
+	reference->ChangeTransferSyntax(codec->CodecTransferSyntax, codec, plain);
+	DicomCompressedPixelData^ pixelData = (DicomCompressedPixelData^)DicomPixelData::CreateFrom(file);
+	DicomCompressedPixelData^ referenceData = (DicomCompressedPixelData^)DicomPixelData::CreateFrom(reference);
+
+	// The packets stepped over through the PLT markers are the ones the decoder leaves out anyway
+	CollectionAssert::AreEqual(codec->DecodeFrameAtResolution(0, 2, referenceData, plain),
+		codec->DecodeFrameAtResolution(0, 2, pixelData, marked));
+	CollectionAssert::AreEqual(codec->DecodeFrameRegion(0, 1, 20, 70, 50, 25, referenceData, plain),
+		codec->DecodeFrameRegion(0, 1, 20, 70, 50, 25, pixelData, marked));
+
+	file->ChangeTransferSyntax(TransferSyntax::ExplicitVrLittleEndian, codec, marked);
+	String^ failureDescription;
+	bool result = Compare(DicomPixelData::CreateFrom(original), DicomPixelData::CreateFrom(file), failureDescription);
+	Assert::IsTrue(result, failureDescription);
+}
+
 }
 }
 }
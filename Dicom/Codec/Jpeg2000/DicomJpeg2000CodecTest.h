@@ -57,6 +57,8 @@ using namespace ClearCanvas::Dicom;
 using namespace ClearCanvas::Dicom::Codec;
 using namespace ClearCanvas::Dicom::Codec::Tests;
 
+#include "DicomJpeg2000Codec.h"
+
 namespace ClearCanvas {
 namespace Dicom {
 namespace Codec {
@@ -71,6 +73,30 @@ public:
 
 	[NUnit::Framework::Test]
 	void DicomJpeg2000CodecTest::LosslessCodecTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpeg2000CodecTest::DecodeThreadsTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpeg2000CodecTest::EncodeThreadsTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpeg2000CodecTest::DecodeAtResolutionTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpeg2000CodecTest::QualityLayersTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpeg2000CodecTest::TiledCodecTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpeg2000CodecTest::TiledBypassCodecTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpeg2000CodecTest::DecodeFrameRegionTest();
+
+	[NUnit::Framework::Test]
+	void DicomJpeg2000CodecTest::RandomAccessMarkersTest();
 };
 
 }
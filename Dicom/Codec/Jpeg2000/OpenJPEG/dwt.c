@@ -77,10 +77,28 @@ static const float c13318 = 1.625732422f;
 
 /*@}*/
 
+/**
+Number of columns the vertical passes transform together: a 64 byte cache line of samples,
+so that every line of the tile brought into the cache is used in full
+*/
+#define DWT_STRIP 16
+
 /**
 Virtual function type for wavelet transform in 1-D 
 */
 typedef void (*DWT1DFN)(dwt_t* v);
+/**
+Virtual function type for forward wavelet transform in 1-D
+*/
+typedef void (*DWT1DENCFN)(int *a, int dn, int sn, int cas);
+#ifdef OPJ_SSE2
+/**
+Virtual function type for wavelet transform in 1-D, of 4 signals at once
+*/
+typedef void (*V4DWT1DFN)(__m128i* w, int n, int cas);
+#else
+typedef void (*V4DWT1DFN)(void* w, int n, int cas);
+#endif
 
 /** @name Local static functions */
 /*@{*/
@@ -90,17 +108,17 @@ Forward lazy transform (horizontal)
 */
 static void dwt_deinterleave_h(int *a, int *b, int dn, int sn, int cas);
 /**
-Forward lazy transform (vertical)
-*/
-static void dwt_deinterleave_v(int *a, int *b, int dn, int sn, int x, int cas);
-/**
 Inverse lazy transform (horizontal)
 */
 static void dwt_interleave_h(dwt_t* h, int *a);
 /**
-Inverse lazy transform (vertical)
+Load count rows of cols columns of a into every step-th sample of the columns b + c * bw
+*/
+static void dwt_load_strip(int* restrict b, int bw, int step, const int* restrict a, int w, int cols, int count);
+/**
+Store every step-th sample of the columns b + c * bw into count rows of cols columns of a
 */
-static void dwt_interleave_v(dwt_t* v, int *a, int x);
+static void dwt_store_strip(int* restrict a, int w, const int* restrict b, int bw, int step, int cols, int count);
 /**
 Forward 5-3 wavelet transform in 1-D
 */
@@ -118,9 +136,43 @@ Explicit calculation of the Quantization Stepsizes
 */
 static void dwt_encode_stepsize(int stepsize, int numbps, opj_stepsize_t *bandno_stepsize);
 /**
+Forward wavelet transform in 2-D.
+*/
+static void dwt_encode_tile(opj_tcd_tilecomp_t* tilec, DWT1DENCFN fn, V4DWT1DFN v4fn);
+/**
 Inverse wavelet transform in 2-D.
 */
-static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int i, DWT1DFN fn);
+static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int i, DWT1DFN fn, V4DWT1DFN v4fn);
+#ifdef OPJ_SSE2
+/**
+Load count samples of 4 rows, a + k * w for k = 0..3, into every step-th vector of b
+*/
+static void v4dwt_load_h(__m128i* restrict b, int step, const int* restrict a, int w, int count);
+/**
+Store every step-th vector of b into count samples of 4 rows, a + k * w for k = 0..3
+*/
+static void v4dwt_store_h(int* restrict a, int w, const __m128i* restrict b, int step, int count);
+/**
+Load count rows of 4 * groups columns of a into every step-th vector of b + g * bw
+*/
+static void v4dwt_load_v(__m128i* restrict b, int bw, int step, const int* restrict a, int w, int groups, int count);
+/**
+Store every step-th vector of b + g * bw into count rows of 4 * groups columns of a
+*/
+static void v4dwt_store_v(int* restrict a, int w, const __m128i* restrict b, int bw, int step, int groups, int count);
+/**
+Forward 5-3 wavelet transform in 1-D, of 4 signals at once
+*/
+static void v4dwt53_encode_1(__m128i* w, int n, int cas);
+/**
+Inverse 5-3 wavelet transform in 1-D, of 4 signals at once
+*/
+static void v4dwt53_decode_1(__m128i* w, int n, int cas);
+/**
+Forward 9-7 wavelet transform in 1-D, of 4 signals at once
+*/
+static void v4dwt97_encode_1(__m128i* w, int n, int cas);
+#endif
 
 /*@}*/
 
@@ -169,15 +221,6 @@ static void dwt_deinterleave_h(int *a, int *b, int dn, int sn, int cas) {
     for (i=0; i<dn; i++) b[sn+i]=a[(2*i+1-cas)];
 }
 
-/* <summary>                             */  
-/* Forward lazy transform (vertical).    */
-/* </summary>                            */ 
-static void dwt_deinterleave_v(int *a, int *b, int dn, int sn, int x, int cas) {
-    int i;
-    for (i=0; i<sn; i++) b[i*x]=a[2*i+cas];
-    for (i=0; i<dn; i++) b[(sn+i)*x]=a[(2*i+1-cas)];
-}
-
 /* <summary>                             */
 /* Inverse lazy transform (horizontal).  */
 /* </summary>                            */
@@ -198,26 +241,34 @@ static void dwt_interleave_h(dwt_t* h, int *a) {
     }
 }
 
-/* <summary>                             */  
-/* Inverse lazy transform (vertical).    */
-/* </summary>                            */ 
-static void dwt_interleave_v(dwt_t* v, int *a, int x) {
-    int *ai = a;
-    int *bi = v->mem + v->cas;
-    int  i = v->sn;
-    while( i-- ) {
-      *bi = *ai;
-	  bi += 2;
-	  ai += x;
-    }
-    ai = a + (v->sn * x);
-    bi = v->mem + 1 - v->cas;
-    i = v->dn ;
-    while( i-- ) {
-      *bi = *ai;
-	  bi += 2;  
-	  ai += x;
-    }
+/* <summary>                                           */
+/* Copy a strip of columns to separate column buffers,  */
+/* reading the tile a row at a time.                    */
+/* </summary>                                          */
+static void dwt_load_strip(int* restrict b, int bw, int step, const int* restrict a, int w, int cols, int count) {
+	int i, c;
+	for (i = 0; i < count; i++) {
+		const int* restrict ai = &a[i * w];
+		int* restrict bi = &b[i * step];
+		for (c = 0; c < cols; c++) {
+			bi[c * bw] = ai[c];
+		}
+	}
+}
+
+/* <summary>                                           */
+/* Copy separate column buffers back to a strip of      */
+/* columns, writing the tile a row at a time.           */
+/* </summary>                                          */
+static void dwt_store_strip(int* restrict a, int w, const int* restrict b, int bw, int step, int cols, int count) {
+	int i, c;
+	for (i = 0; i < count; i++) {
+		int* restrict ai = &a[i * w];
+		const int* restrict bi = &b[i * step];
+		for (c = 0; c < cols; c++) {
+			ai[c] = bi[c * bw];
+		}
+	}
 }
 
 
@@ -326,55 +377,11 @@ static void dwt_encode_stepsize(int stepsize, int numbps, opj_stepsize_t *bandno
 /* Forward 5-3 wavelet transform in 2-D. */
 /* </summary>                           */
 void dwt_encode(opj_tcd_tilecomp_t * tilec) {
-	int i, j, k;
-	int *a = NULL;
-	int *aj = NULL;
-	int *bj = NULL;
-	int w, l;
-	
-	w = tilec->x1-tilec->x0;
-	l = tilec->numresolutions-1;
-	a = tilec->data;
-	
-	for (i = 0; i < l; i++) {
-		int rw;			/* width of the resolution level computed                                                           */
-		int rh;			/* height of the resolution level computed                                                          */
-		int rw1;		/* width of the resolution level once lower than computed one                                       */
-		int rh1;		/* height of the resolution level once lower than computed one                                      */
-		int cas_col;	/* 0 = non inversion on horizontal filtering 1 = inversion between low-pass and high-pass filtering */
-		int cas_row;	/* 0 = non inversion on vertical filtering 1 = inversion between low-pass and high-pass filtering   */
-		int dn, sn;
-		
-		rw = tilec->resolutions[l - i].x1 - tilec->resolutions[l - i].x0;
-		rh = tilec->resolutions[l - i].y1 - tilec->resolutions[l - i].y0;
-		rw1= tilec->resolutions[l - i - 1].x1 - tilec->resolutions[l - i - 1].x0;
-		rh1= tilec->resolutions[l - i - 1].y1 - tilec->resolutions[l - i - 1].y0;
-		
-		cas_row = tilec->resolutions[l - i].x0 % 2;
-		cas_col = tilec->resolutions[l - i].y0 % 2;
-        
-		sn = rh1;
-		dn = rh - rh1;
-		bj = (int*)opj_malloc(rh * sizeof(int));
-		for (j = 0; j < rw; j++) {
-			aj = a + j;
-			for (k = 0; k < rh; k++)  bj[k] = aj[k*w];
-			dwt_encode_1(bj, dn, sn, cas_col);
-			dwt_deinterleave_v(bj, aj, dn, sn, w, cas_col);
-		}
-		opj_free(bj);
-		
-		sn = rw1;
-		dn = rw - rw1;
-		bj = (int*)opj_malloc(rw * sizeof(int));
-		for (j = 0; j < rh; j++) {
-			aj = a + j * w;
-			for (k = 0; k < rw; k++)  bj[k] = aj[k];
-			dwt_encode_1(bj, dn, sn, cas_row);
-			dwt_deinterleave_h(bj, aj, dn, sn, cas_row);
-		}
-		opj_free(bj);
-	}
+#ifdef OPJ_SSE2
+	dwt_encode_tile(tilec, &dwt_encode_1, opj_sse2() ? &v4dwt53_encode_1 : NULL);
+#else
+	dwt_encode_tile(tilec, &dwt_encode_1, NULL);
+#endif
 }
 
 
@@ -382,7 +389,11 @@ void dwt_encode(opj_tcd_tilecomp_t * tilec) {
 /* Inverse 5-3 wavelet transform in 2-D. */
 /* </summary>                           */
 void dwt_decode(opj_tcd_tilecomp_t* tilec, int numres) {
-	dwt_decode_tile(tilec, numres, &dwt_decode_1);
+#ifdef OPJ_SSE2
+	dwt_decode_tile(tilec, numres, &dwt_decode_1, opj_sse2() ? &v4dwt53_decode_1 : NULL);
+#else
+	dwt_decode_tile(tilec, numres, &dwt_decode_1, NULL);
+#endif
 }
 
 
@@ -409,55 +420,11 @@ double dwt_getnorm(int level, int orient) {
 /* </summary>                            */
 
 void dwt_encode_real(opj_tcd_tilecomp_t * tilec) {
-	int i, j, k;
-	int *a = NULL;
-	int *aj = NULL;
-	int *bj = NULL;
-	int w, l;
-	
-	w = tilec->x1-tilec->x0;
-	l = tilec->numresolutions-1;
-	a = tilec->data;
-	
-	for (i = 0; i < l; i++) {
-		int rw;			/* width of the resolution level computed                                                     */
-		int rh;			/* height of the resolution level computed                                                    */
-		int rw1;		/* width of the resolution level once lower than computed one                                 */
-		int rh1;		/* height of the resolution level once lower than computed one                                */
-		int cas_col;	/* 0 = non inversion on horizontal filtering 1 = inversion between low-pass and high-pass filtering */
-		int cas_row;	/* 0 = non inversion on vertical filtering 1 = inversion between low-pass and high-pass filtering   */
-		int dn, sn;
-		
-		rw = tilec->resolutions[l - i].x1 - tilec->resolutions[l - i].x0;
-		rh = tilec->resolutions[l - i].y1 - tilec->resolutions[l - i].y0;
-		rw1= tilec->resolutions[l - i - 1].x1 - tilec->resolutions[l - i - 1].x0;
-		rh1= tilec->resolutions[l - i - 1].y1 - tilec->resolutions[l - i - 1].y0;
-		
-		cas_row = tilec->resolutions[l - i].x0 % 2;
-		cas_col = tilec->resolutions[l - i].y0 % 2;
-		
-		sn = rh1;
-		dn = rh - rh1;
-		bj = (int*)opj_malloc(rh * sizeof(int));
-		for (j = 0; j < rw; j++) {
-			aj = a + j;
-			for (k = 0; k < rh; k++)  bj[k] = aj[k*w];
-			dwt_encode_1_real(bj, dn, sn, cas_col);
-			dwt_deinterleave_v(bj, aj, dn, sn, w, cas_col);
-		}
-		opj_free(bj);
-		
-		sn = rw1;
-		dn = rw - rw1;
-		bj = (int*)opj_malloc(rw * sizeof(int));
-		for (j = 0; j < rh; j++) {
-			aj = a + j * w;
-			for (k = 0; k < rw; k++)  bj[k] = aj[k];
-			dwt_encode_1_real(bj, dn, sn, cas_row);
-			dwt_deinterleave_h(bj, aj, dn, sn, cas_row);
-		}
-		opj_free(bj);
-	}
+#ifdef OPJ_SSE2
+	dwt_encode_tile(tilec, &dwt_encode_1_real, opj_sse2() ? &v4dwt97_encode_1 : NULL);
+#else
+	dwt_encode_tile(tilec, &dwt_encode_1_real, NULL);
+#endif
 }
 
 
@@ -515,12 +482,109 @@ static int dwt_decode_max_resolution(opj_tcd_resolution_t* restrict r, int i) {
 }
 
 
-/* <summary>                            */
-/* Inverse wavelet transform in 2-D.     */
-/* </summary>                           */
-static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1D) {
+/* <summary>                                                */
+/* Forward wavelet transform in 2-D.                         */
+/* The columns are transformed DWT_STRIP at a time, and with */
+/* v4dwt_1D, if any, 4 columns or rows at once.              */
+/* </summary>                                               */
+static void dwt_encode_tile(opj_tcd_tilecomp_t * tilec, DWT1DENCFN dwt_1D, V4DWT1DFN v4dwt_1D) {
+	int i, j, k;
+	int *a = NULL;
+	int *aj = NULL;
+	int *bj = NULL;
+	int w, l;
+	
+	w = tilec->x1-tilec->x0;
+	l = tilec->numresolutions-1;
+	a = tilec->data;
+
+	/* room for a strip of columns, or for 4 rows of vectors */
+	bj = (int*) opj_aligned_malloc(DWT_STRIP * int_max(w, tilec->y1 - tilec->y0) * sizeof(int));
+	
+	for (i = 0; i < l; i++) {
+		int rw;			/* width of the resolution level computed                                                           */
+		int rh;			/* height of the resolution level computed                                                          */
+		int rw1;		/* width of the resolution level once lower than computed one                                       */
+		int rh1;		/* height of the resolution level once lower than computed one                                      */
+		int cas_col;	/* 0 = non inversion on horizontal filtering 1 = inversion between low-pass and high-pass filtering */
+		int cas_row;	/* 0 = non inversion on vertical filtering 1 = inversion between low-pass and high-pass filtering   */
+		int dn, sn;
+		
+		rw = tilec->resolutions[l - i].x1 - tilec->resolutions[l - i].x0;
+		rh = tilec->resolutions[l - i].y1 - tilec->resolutions[l - i].y0;
+		rw1= tilec->resolutions[l - i - 1].x1 - tilec->resolutions[l - i - 1].x0;
+		rh1= tilec->resolutions[l - i - 1].y1 - tilec->resolutions[l - i - 1].y0;
+		
+		cas_row = tilec->resolutions[l - i].x0 % 2;
+		cas_col = tilec->resolutions[l - i].y0 % 2;
+        
+		sn = rh1;
+		dn = rh - rh1;
+		j = 0;
+#ifdef OPJ_SSE2
+		if (v4dwt_1D) {
+			__m128i *v4 = (__m128i*) bj;
+			while (j + 4 <= rw) {
+				int groups = int_min(DWT_STRIP, rw - j) / 4;
+				aj = a + j;
+				v4dwt_load_v(v4, rh, 1, aj, w, groups, rh);
+				for (k = 0; k < groups; k++) {
+					v4dwt_1D(v4 + k * rh, rh, cas_col);
+				}
+				v4dwt_store_v(aj, w, v4 + cas_col, rh, 2, groups, sn);
+				v4dwt_store_v(aj + sn * w, w, v4 + 1 - cas_col, rh, 2, groups, dn);
+				j += groups * 4;
+			}
+		}
+#endif
+		while (j < rw) {
+			int cols = int_min(DWT_STRIP, rw - j);
+			aj = a + j;
+			dwt_load_strip(bj, rh, 1, aj, w, cols, rh);
+			for (k = 0; k < cols; k++) {
+				dwt_1D(bj + k * rh, dn, sn, cas_col);
+			}
+			dwt_store_strip(aj, w, bj + cas_col, rh, 2, cols, sn);
+			dwt_store_strip(aj + sn * w, w, bj + 1 - cas_col, rh, 2, cols, dn);
+			j += cols;
+		}
+		
+		sn = rw1;
+		dn = rw - rw1;
+		j = 0;
+#ifdef OPJ_SSE2
+		if (v4dwt_1D) {
+			__m128i *v4 = (__m128i*) bj;
+			for (; j + 4 <= rh; j += 4) {
+				aj = a + j * w;
+				v4dwt_load_h(v4, 1, aj, w, rw);
+				v4dwt_1D(v4, rw, cas_row);
+				v4dwt_store_h(aj, w, v4 + cas_row, 2, sn);
+				v4dwt_store_h(aj + sn, w, v4 + 1 - cas_row, 2, dn);
+			}
+		}
+#endif
+		for (; j < rh; j++) {
+			aj = a + j * w;
+			for (k = 0; k < rw; k++)  bj[k] = aj[k];
+			dwt_1D(bj, dn, sn, cas_row);
+			dwt_deinterleave_h(bj, aj, dn, sn, cas_row);
+		}
+	}
+
+	opj_aligned_free(bj);
+}
+
+
+/* <summary>                                                */
+/* Inverse wavelet transform in 2-D.                         */
+/* The columns are transformed DWT_STRIP at a time, and with */
+/* v4dwt_1D, if any, 4 columns or rows at once.              */
+/* </summary>                                               */
+static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1D, V4DWT1DFN v4dwt_1D) {
 	dwt_t h;
 	dwt_t v;
+	int* buf;
 
 	opj_tcd_resolution_t* tr = tilec->resolutions;
 
@@ -529,12 +593,13 @@ static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1
 
 	int w = tilec->x1 - tilec->x0;
 
-	h.mem = opj_aligned_malloc(dwt_decode_max_resolution(tr, numres) * sizeof(int));
-	v.mem = h.mem;
+	/* room for a strip of columns, or for 4 rows of vectors */
+	buf = (int*) opj_aligned_malloc(DWT_STRIP * dwt_decode_max_resolution(tr, numres) * sizeof(int));
+	h.mem = buf;
 
 	while( --numres) {
 		int * restrict tiledp = tilec->data;
-		int j;
+		int j, k;
 
 		++tr;
 		h.sn = rw;
@@ -546,7 +611,20 @@ static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1
 		h.dn = rw - h.sn;
 		h.cas = tr->x0 % 2;
 
-		for(j = 0; j < rh; ++j) {
+		j = 0;
+#ifdef OPJ_SSE2
+		if (v4dwt_1D) {
+			__m128i* v4 = (__m128i*) buf;
+			for(; j + 4 <= rh; j += 4) {
+				int* aj = &tiledp[j*w];
+				v4dwt_load_h(v4 + h.cas, 2, aj, w, h.sn);
+				v4dwt_load_h(v4 + 1 - h.cas, 2, aj + h.sn, w, h.dn);
+				v4dwt_1D(v4, rw, h.cas);
+				v4dwt_store_h(aj, w, v4, 1, rw);
+			}
+		}
+#endif
+		for(; j < rh; ++j) {
 			dwt_interleave_h(&h, &tiledp[j*w]);
 			(dwt_1D)(&h);
 			memcpy(&tiledp[j*w], h.mem, rw * sizeof(int));
@@ -555,18 +633,211 @@ static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1
 		v.dn = rh - v.sn;
 		v.cas = tr->y0 % 2;
 
-		for(j = 0; j < rw; ++j){
-			int k;
-			dwt_interleave_v(&v, &tiledp[j], w);
-			(dwt_1D)(&v);
-			for(k = 0; k < rh; ++k) {
-				tiledp[k * w + j] = v.mem[k];
+		j = 0;
+#ifdef OPJ_SSE2
+		if (v4dwt_1D) {
+			__m128i* v4 = (__m128i*) buf;
+			while(j + 4 <= rw) {
+				int groups = int_min(DWT_STRIP, rw - j) / 4;
+				int* aj = &tiledp[j];
+				v4dwt_load_v(v4 + v.cas, rh, 2, aj, w, groups, v.sn);
+				v4dwt_load_v(v4 + 1 - v.cas, rh, 2, aj + v.sn * w, w, groups, v.dn);
+				for(k = 0; k < groups; ++k) {
+					v4dwt_1D(v4 + k * rh, rh, v.cas);
+				}
+				v4dwt_store_v(aj, w, v4, rh, 1, groups, rh);
+				j += groups * 4;
 			}
 		}
+#endif
+		while(j < rw) {
+			int cols = int_min(DWT_STRIP, rw - j);
+			int* aj = &tiledp[j];
+			dwt_load_strip(buf + v.cas, rh, 2, aj, w, cols, v.sn);
+			dwt_load_strip(buf + 1 - v.cas, rh, 2, aj + v.sn * w, w, cols, v.dn);
+			for(k = 0; k < cols; ++k) {
+				v.mem = buf + k * rh;
+				(dwt_1D)(&v);
+			}
+			dwt_store_strip(aj, w, buf, rh, 1, cols, rh);
+			j += cols;
+		}
+	}
+	opj_aligned_free(buf);
+}
+
+#ifdef OPJ_SSE2
+
+/* Transpose the 4x4 block of samples in r0..r3 */
+#define V4DWT_TRANSPOSE(r0, r1, r2, r3) { \
+	__m128i t0 = _mm_unpacklo_epi32(r0, r1); \
+	__m128i t1 = _mm_unpacklo_epi32(r2, r3); \
+	__m128i t2 = _mm_unpackhi_epi32(r0, r1); \
+	__m128i t3 = _mm_unpackhi_epi32(r2, r3); \
+	r0 = _mm_unpacklo_epi64(t0, t1); \
+	r1 = _mm_unpackhi_epi64(t0, t1); \
+	r2 = _mm_unpacklo_epi64(t2, t3); \
+	r3 = _mm_unpackhi_epi64(t2, t3); \
+}
+
+static void v4dwt_load_h(__m128i* restrict b, int step, const int* restrict a, int w, int count) {
+	int i;
+	for (i = 0; i + 4 <= count; i += 4) {
+		__m128i r0 = _mm_loadu_si128((const __m128i*) &a[i]);
+		__m128i r1 = _mm_loadu_si128((const __m128i*) &a[w + i]);
+		__m128i r2 = _mm_loadu_si128((const __m128i*) &a[2 * w + i]);
+		__m128i r3 = _mm_loadu_si128((const __m128i*) &a[3 * w + i]);
+		V4DWT_TRANSPOSE(r0, r1, r2, r3);
+		b[i * step] = r0;
+		b[(i + 1) * step] = r1;
+		b[(i + 2) * step] = r2;
+		b[(i + 3) * step] = r3;
+	}
+	for (; i < count; i++) {
+		b[i * step] = _mm_set_epi32(a[3 * w + i], a[2 * w + i], a[w + i], a[i]);
+	}
+}
+
+static void v4dwt_store_h(int* restrict a, int w, const __m128i* restrict b, int step, int count) {
+	int i;
+	for (i = 0; i + 4 <= count; i += 4) {
+		__m128i r0 = b[i * step];
+		__m128i r1 = b[(i + 1) * step];
+		__m128i r2 = b[(i + 2) * step];
+		__m128i r3 = b[(i + 3) * step];
+		V4DWT_TRANSPOSE(r0, r1, r2, r3);
+		_mm_storeu_si128((__m128i*) &a[i], r0);
+		_mm_storeu_si128((__m128i*) &a[w + i], r1);
+		_mm_storeu_si128((__m128i*) &a[2 * w + i], r2);
+		_mm_storeu_si128((__m128i*) &a[3 * w + i], r3);
+	}
+	for (; i < count; i++) {
+		__m128i v = b[i * step];
+		a[i] = _mm_cvtsi128_si32(v);
+		a[w + i] = _mm_cvtsi128_si32(_mm_srli_si128(v, 4));
+		a[2 * w + i] = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+		a[3 * w + i] = _mm_cvtsi128_si32(_mm_srli_si128(v, 12));
+	}
+}
+
+static void v4dwt_load_v(__m128i* restrict b, int bw, int step, const int* restrict a, int w, int groups, int count) {
+	int i, g;
+	for (i = 0; i < count; i++) {
+		for (g = 0; g < groups; g++) {
+			b[g * bw + i * step] = _mm_loadu_si128((const __m128i*) &a[i * w + g * 4]);
+		}
+	}
+}
+
+static void v4dwt_store_v(int* restrict a, int w, const __m128i* restrict b, int bw, int step, int groups, int count) {
+	int i, g;
+	for (i = 0; i < count; i++) {
+		for (g = 0; g < groups; g++) {
+			_mm_storeu_si128((__m128i*) &a[i * w + g * 4], b[g * bw + i * step]);
+		}
+	}
+}
+
+/* Lifting step of the 5-3 transform on the n interleaved samples of w, for   */
+/* every other sample from p: w[p] op= (w[p - 1] + w[p + 1] + round) >> shift. */
+/* The ends use the same symmetric extension as S_, D_, SS_ and DD_.          */
+#define V4DWT53_LIFT(name, op, round, shift) \
+static void name(__m128i* w, int n, int p) { \
+	const __m128i r = _mm_set1_epi32(round); \
+	if (p == 0) { \
+		w[0] = op(w[0], _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(w[1], w[1]), r), shift)); \
+		p = 2; \
+	} \
+	for (; p < n - 1; p += 2) { \
+		w[p] = op(w[p], _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(w[p - 1], w[p + 1]), r), shift)); \
+	} \
+	if (p == n - 1) { \
+		w[p] = op(w[p], _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(w[p - 1], w[p - 1]), r), shift)); \
+	} \
+}
+
+V4DWT53_LIFT(v4dwt53_predict_add, _mm_add_epi32, 0, 1)
+V4DWT53_LIFT(v4dwt53_predict_sub, _mm_sub_epi32, 0, 1)
+V4DWT53_LIFT(v4dwt53_update_add, _mm_add_epi32, 2, 2)
+V4DWT53_LIFT(v4dwt53_update_sub, _mm_sub_epi32, 2, 2)
+
+/* <summary>                                              */
+/* Forward 5-3 wavelet transform in 1-D, of 4 signals.     */
+/* The low-pass samples are at the odd positions if cas.   */
+/* </summary>                                             */
+static void v4dwt53_encode_1(__m128i* w, int n, int cas) {
+	if (n == 1) {
+		if (cas) {
+			w[0] = _mm_slli_epi32(w[0], 1);
+		}
+		return;
+	}
+	v4dwt53_predict_sub(w, n, 1 - cas);
+	v4dwt53_update_add(w, n, cas);
+}
+
+/* <summary>                                              */
+/* Inverse 5-3 wavelet transform in 1-D, of 4 signals.     */
+/* </summary>                                             */
+static void v4dwt53_decode_1(__m128i* w, int n, int cas) {
+	if (n == 1) {
+		if (cas) {
+			/* S(0) /= 2, rounding towards zero */
+			w[0] = _mm_srai_epi32(_mm_add_epi32(w[0], _mm_srli_epi32(w[0], 31)), 1);
+		}
+		return;
+	}
+	v4dwt53_update_sub(w, n, cas);
+	v4dwt53_predict_add(w, n, 1 - cas);
+}
+
+/* Lifting step of the fixed point 9-7 transform on the n interleaved samples */
+/* of w, for every other sample from p: w[p] op= fix_mul(w[p - 1] + w[p + 1], c). */
+/* The ends use the same symmetric extension as S_, D_, SS_ and DD_.          */
+#define V4DWT97_LIFT(name, op) \
+static void name(__m128i* w, int n, int p, int c) { \
+	const __m128i k = _mm_set1_epi32(c); \
+	if (p == 0) { \
+		w[0] = op(w[0], fix_mul_sse2(_mm_add_epi32(w[1], w[1]), k)); \
+		p = 2; \
+	} \
+	for (; p < n - 1; p += 2) { \
+		w[p] = op(w[p], fix_mul_sse2(_mm_add_epi32(w[p - 1], w[p + 1]), k)); \
+	} \
+	if (p == n - 1) { \
+		w[p] = op(w[p], fix_mul_sse2(_mm_add_epi32(w[p - 1], w[p - 1]), k)); \
+	} \
+}
+
+V4DWT97_LIFT(v4dwt97_lift_add, _mm_add_epi32)
+V4DWT97_LIFT(v4dwt97_lift_sub, _mm_sub_epi32)
+
+/* Scale every other sample of w from p by the fixed point c */
+static void v4dwt97_scale(__m128i* w, int n, int p, int c) {
+	const __m128i k = _mm_set1_epi32(c);
+	for (; p < n; p += 2) {
+		w[p] = fix_mul_sse2(w[p], k);
 	}
-	opj_aligned_free(h.mem);
 }
 
+/* <summary>                                              */
+/* Forward 9-7 wavelet transform in 1-D, of 4 signals.     */
+/* The low-pass samples are at the odd positions if cas.   */
+/* </summary>                                             */
+static void v4dwt97_encode_1(__m128i* w, int n, int cas) {
+	if (n == 1) {
+		return;
+	}
+	v4dwt97_lift_sub(w, n, 1 - cas, 12993);
+	v4dwt97_lift_sub(w, n, cas, 434);
+	v4dwt97_lift_add(w, n, 1 - cas, 7233);
+	v4dwt97_lift_add(w, n, cas, 3633);
+	v4dwt97_scale(w, n, 1 - cas, 5038);
+	v4dwt97_scale(w, n, cas, 6659);
+}
+
+#endif /* OPJ_SSE2 */
+
 static void v4dwt_interleave_h(v4dwt_t* restrict w, float* restrict a, int x, int size){
 	float* restrict bi = (float*) (w->wavelet + w->cas);
 	int count = w->sn;
@@ -592,16 +863,20 @@ static void v4dwt_interleave_h(v4dwt_t* restrict w, float* restrict a, int x, in
 	}
 }
 
-static void v4dwt_interleave_v(v4dwt_t* restrict v , float* restrict a , int x){
+static void v4dwt_interleave_v(v4dwt_t* restrict v , float* restrict a , int x, int groups, int bw){
 	v4* restrict bi = v->wavelet + v->cas;
-	int i;
+	int i, g;
 	for(i = 0; i < v->sn; ++i){
-		memcpy(&bi[i*2], &a[i*x], 4 * sizeof(float));
+		for(g = 0; g < groups; ++g){
+			memcpy(&bi[g*bw + i*2], &a[i*x + g*4], 4 * sizeof(float));
+		}
 	}
 	a += v->sn * x;
 	bi = v->wavelet + 1 - v->cas;
 	for(i = 0; i < v->dn; ++i){
-		memcpy(&bi[i*2], &a[i*x], 4 * sizeof(float));
+		for(g = 0; g < groups; ++g){
+			memcpy(&bi[g*bw + i*2], &a[i*x + g*4], 4 * sizeof(float));
+		}
 	}
 }
 
@@ -756,8 +1031,10 @@ void dwt_decode_real(opj_tcd_tilecomp_t* restrict tilec, int numres){
 
 	int w = tilec->x1 - tilec->x0;
 
-	h.wavelet = (v4*) opj_aligned_malloc((dwt_decode_max_resolution(res, numres)+5) * sizeof(v4));
-	v.wavelet = h.wavelet;
+	/* one wavelet per group of 4 columns of a strip */
+	int bw = dwt_decode_max_resolution(res, numres) + 5;
+
+	h.wavelet = (v4*) opj_aligned_malloc((DWT_STRIP / 4) * bw * sizeof(v4));
 
 	while( --numres) {
 		float * restrict aj = (float*) tilec->data;
@@ -804,21 +1081,21 @@ void dwt_decode_real(opj_tcd_tilecomp_t* restrict tilec, int numres){
 		v.cas = res->y0 % 2;
 
 		aj = (float*) tilec->data;
-		for(j = rw; j > 0; j -= 4){
-			v4dwt_interleave_v(&v, aj, w);
-			v4dwt_decode(&v);
-			if(j >= 4){
-				int k;
-				for(k = 0; k < rh; ++k){
-					memcpy(&aj[k*w], &v.wavelet[k], 4 * sizeof(float));
-				}
-			}else{
-				int k;
-				for(k = 0; k < rh; ++k){
-					memcpy(&aj[k*w], &v.wavelet[k], j * sizeof(float));
+		for(j = rw; j > 0; j -= DWT_STRIP){
+			int groups = (int_min(j, DWT_STRIP) + 3) / 4;
+			int g, k;
+			v.wavelet = h.wavelet;
+			v4dwt_interleave_v(&v, aj, w, groups, bw);
+			for(g = 0; g < groups; ++g){
+				v.wavelet = h.wavelet + g * bw;
+				v4dwt_decode(&v);
+			}
+			for(k = 0; k < rh; ++k){
+				for(g = 0; g < groups; ++g){
+					memcpy(&aj[k*w + g*4], &h.wavelet[g*bw + k], int_min(j - g*4, 4) * sizeof(float));
 				}
 			}
-			aj += 4;
+			aj += DWT_STRIP;
 		}
 	}
 
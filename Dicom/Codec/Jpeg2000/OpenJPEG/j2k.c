@@ -178,11 +178,26 @@ Read the PPT marker (packet packet headers, tile-part header)
 */
 static void j2k_read_ppt(opj_j2k_t *j2k);
 /**
-Write the TLM marker (Mainheader)
+Write the TLM markers (Mainheader), with room for the length of each tile-part
 @param j2k J2K handle
 */
 static void j2k_write_tlm(opj_j2k_t *j2k);
 /**
+Get the size of the tile index in the TLM markers
+@param cp Coding parameters
+@return Returns the number of bytes of each Ttlm
+*/
+static int j2k_get_tlm_st(opj_cp_t *cp);
+/**
+Write the PLT markers of a tile-part in front of its SOD marker, moving the packets after them
+@param j2k J2K handle
+@param tile Tile holding the length of each packet written
+@param packno Number of the first packet of the tile-part
+@param len Length of the packets of the tile-part
+@return Returns the length of the PLT markers
+*/
+static int j2k_write_plt(opj_j2k_t *j2k, opj_tcd_tile_t *tile, int packno, int len);
+/**
 Write the SOT marker (start of tile-part)
 @param j2k J2K handle
 */
@@ -197,13 +212,20 @@ Write the SOD marker (start of data)
 @param j2k J2K handle
 @param tile_coder Pointer to a TCD handle
 */
-static void j2k_write_sod(opj_j2k_t *j2k, void *tile_coder);
+static bool j2k_write_sod(opj_j2k_t *j2k, void *tile_coder);
 /**
 Read the SOD marker (start of data)
 @param j2k J2K handle
 */
 static void j2k_read_sod(opj_j2k_t *j2k);
 /**
+Tell whether a tile meets the decoded window
+@param j2k J2K handle
+@param tileno Number of the tile
+@return Returns true if some samples of the tile are decoded
+*/
+static bool j2k_tile_in_window(opj_j2k_t *j2k, int tileno);
+/**
 Write the RGN marker (region-of-interest)
 @param j2k J2K handle
 @param compno Number of the component concerned by the information written
@@ -226,6 +248,13 @@ Read the EOC marker (end of codestream)
 */
 static void j2k_read_eoc(opj_j2k_t *j2k);
 /**
+Decode one of the tiles read from the codestream, as a job of opj_run_jobs
+@param user_data Tile decoding state shared by the jobs (opj_tile_job_t)
+@param jobno Index of the tile in cp->tileno
+@param workerno Index of the worker, selecting its TCD handle
+*/
+static void j2k_decode_tile_job(void *user_data, int jobno, int workerno);
+/**
 Read an unknown marker
 @param j2k J2K handle
 */
@@ -644,6 +673,23 @@ static void j2k_read_siz(opj_j2k_t *j2k) {
 	j2k->tile_len = (int*) opj_calloc(cp->tw * cp->th, sizeof(int));
 	j2k->state = J2K_STATE_MH;
 
+	/* decoded window on the reference grid, the whole image unless one was set */
+	if (cp->da_x1 > cp->da_x0 && cp->da_y1 > cp->da_y0) {
+		cp->da_x0 = int_max(image->x0 + cp->da_x0, image->x0);
+		cp->da_y0 = int_max(image->y0 + cp->da_y0, image->y0);
+		cp->da_x1 = int_min(image->x0 + cp->da_x1, image->x1);
+		cp->da_y1 = int_min(image->y0 + cp->da_y1, image->y1);
+		if (cp->da_x1 <= cp->da_x0 || cp->da_y1 <= cp->da_y0) {
+			opj_event_msg(j2k->cinfo, EVT_ERROR, "Error decoding the image.\nThe window to decode lies outside the image\nModify the DA_x0, DA_y0, DA_x1 and DA_y1 parameters.\n\n");
+			j2k->state |= J2K_STATE_ERR;
+		}
+	} else {
+		cp->da_x0 = image->x0;
+		cp->da_y0 = image->y0;
+		cp->da_x1 = image->x1;
+		cp->da_y1 = image->y1;
+	}
+
 	/* Index */
 	if (j2k->cstr_info) {
 		opj_codestream_info_t *cstr_info = j2k->cstr_info;
@@ -1136,15 +1182,21 @@ static void j2k_read_plm(opj_j2k_t *j2k) {
 static void j2k_read_plt(opj_j2k_t *j2k) {
 	int len, i, Zplt, packet_len = 0, add;
 	
+	opj_tcp_t *tcp = j2k->cp->tcps + j2k->curtileno;
 	opj_cio_t *cio = j2k->cio;
 	
 	len = cio_read(cio, 2);		/* Lplt */
 	Zplt = cio_read(cio, 1);	/* Zplt */
 	for (i = len - 3; i > 0; i--) {
 		add = cio_read(cio, 1);
-		packet_len = (packet_len << 7) + add;	/* Iplt_i */
+		packet_len = (packet_len << 7) + (add & 0x7f);	/* Iplt_i */
 		if ((add & 0x80) == 0) {
-			/* New packet */
+			/* New packet: the lengths of the tile-parts follow each other, like their packets */
+			if (tcp->plt_num == tcp->plt_max) {
+				tcp->plt_max = tcp->plt_max ? 2 * tcp->plt_max : 64;
+				tcp->plt_len = (int*) opj_realloc(tcp->plt_len, tcp->plt_max * sizeof(int));
+			}
+			tcp->plt_len[tcp->plt_num++] = packet_len;
 			packet_len = 0;
 		}
 	}
@@ -1236,16 +1288,66 @@ static void j2k_read_ppt(opj_j2k_t *j2k) {
 	tcp->ppt_store = j;
 }
 
+static int j2k_get_tlm_st(opj_cp_t *cp) {
+	return cp->tw * cp->th > 256 ? 2 : 1;
+}
+
 static void j2k_write_tlm(opj_j2k_t *j2k){
-	int lenp;
+	int lenp, i, num_tp;
 	opj_cio_t *cio = j2k->cio;
+	int ST = j2k_get_tlm_st(j2k->cp);
+	/* each marker but the last is full */
+	int max_tp = (65535 - 4) / (ST + 4);
 	j2k->tlm_start = cio_tell(cio);
-	cio_write(cio, J2K_MS_TLM, 2);/* TLM */
-	lenp = 4 + (5*j2k->totnum_tp);
-	cio_write(cio,lenp,2);				/* Ltlm */
-	cio_write(cio, 0,1);					/* Ztlm=0*/
-	cio_write(cio,80,1);					/* Stlm ST=1(8bits-255 tiles max),SP=1(Ptlm=32bits) */
-	cio_skip(cio,5*j2k->totnum_tp);
+	j2k->tlm_tp_num = 0;
+	for (i = 0; i < j2k->totnum_tp; i += num_tp) {
+		num_tp = int_min(j2k->totnum_tp - i, max_tp);
+		cio_write(cio, J2K_MS_TLM, 2);/* TLM */
+		lenp = 4 + ((ST + 4)*num_tp);
+		cio_write(cio,lenp,2);				/* Ltlm */
+		cio_write(cio, i / max_tp,1);			/* Ztlm */
+		cio_write(cio,(ST << 4) | 0x40,1);		/* Stlm ST=1 or 2(16bits-65535 tiles max),SP=1(Ptlm=32bits) */
+		cio_skip(cio,(ST + 4)*num_tp);
+	}
+}
+
+static int j2k_write_plt(opj_j2k_t *j2k, opj_tcd_tile_t *tile, int packno, int len) {
+	int i, n, lenp, size = 0, Zplt = 0;
+	opj_cio_t *cio = j2k->cio;
+	int sod_start = cio_tell(cio) - 2;
+
+	/* each marker holds as many lengths as fit, 7 bits to the byte */
+	for (i = packno; i < tile->packno; i = n) {
+		lenp = 3;
+		for (n = i; n < tile->packno && lenp + (int_floorlog2(tile->packet_len[n]) / 7 + 1) <= 65535; n++) {
+			lenp += int_floorlog2(tile->packet_len[n]) / 7 + 1;
+		}
+		size += 2 + lenp;
+	}
+
+	/* the packets were written straight after the SOD marker */
+	memmove(cio_getbp(cio) - 2 + size, cio_getbp(cio) - 2, len + 2);
+	cio_seek(cio, sod_start);
+
+	for (i = packno; i < tile->packno; i = n) {
+		lenp = 3;
+		for (n = i; n < tile->packno && lenp + (int_floorlog2(tile->packet_len[n]) / 7 + 1) <= 65535; n++) {
+			lenp += int_floorlog2(tile->packet_len[n]) / 7 + 1;
+		}
+		cio_write(cio, J2K_MS_PLT, 2);		/* PLT */
+		cio_write(cio, lenp, 2);			/* Lplt */
+		cio_write(cio, Zplt++, 1);			/* Zplt */
+		for (; i < n; i++) {
+			int shift;
+			for (shift = int_floorlog2(tile->packet_len[i]) / 7 * 7; shift > 0; shift -= 7) {
+				cio_write(cio, 0x80 | ((tile->packet_len[i] >> shift) & 0x7f), 1);
+			}
+			cio_write(cio, tile->packet_len[i] & 0x7f, 1);	/* Iplt_i */
+		}
+	}
+	cio_skip(cio, 2);
+
+	return size;
 }
 
 static void j2k_write_sot(opj_j2k_t *j2k) {
@@ -1391,6 +1493,9 @@ static void j2k_read_sot(opj_j2k_t *j2k) {
 		tcp->ppt = 0;
 		tcp->ppt_data = NULL;
 		tcp->ppt_data_first = NULL;
+		tcp->plt_len = NULL;
+		tcp->plt_num = 0;
+		tcp->plt_max = 0;
 		tcp->tccps = tmp;
 
 		for (i = 0; i < j2k->image->numcomps; i++) {
@@ -1400,9 +1505,10 @@ static void j2k_read_sot(opj_j2k_t *j2k) {
 	}
 }
 
-static void j2k_write_sod(opj_j2k_t *j2k, void *tile_coder) {
+static bool j2k_write_sod(opj_j2k_t *j2k, void *tile_coder) {
 	int l, layno;
 	int totlen;
+	int packno, plt_len = 0;
 	opj_tcp_t *tcp = NULL;
 	opj_codestream_info_t *cstr_info = NULL;
 	
@@ -1451,8 +1557,45 @@ static void j2k_write_sod(opj_j2k_t *j2k, void *tile_coder) {
 		if(cstr_info)
 			cstr_info->packno = 0;
 	}
+	packno = tcd->tcd_image->tiles->packno;
+
+	if (cp->plt_on) {
+		/* room for the PLT markers, at most 5 bytes a packet */
+		opj_tcd_tile_t *tile = tcd->tcd_image->tiles;
+		int compno, resno, numpacks = 0;
+		for (compno = 0; compno < tile->numcomps; compno++) {
+			for (resno = 0; resno < tile->comps[compno].numresolutions; resno++) {
+				numpacks += tile->comps[compno].resolutions[resno].pw * tile->comps[compno].resolutions[resno].ph;
+			}
+		}
+		numpacks *= tcp->numlayers;
+		plt_len = 5 * numpacks + 5 * (5 * numpacks / 65532 + 1);
+	}
 	
-	l = tcd_encode_tile(tcd, j2k->curtileno, cio_getbp(cio), cio_numbytesleft(cio) - 2, cstr_info);
+	l = tcd_encode_tile(tcd, j2k->curtileno, cio_getbp(cio), cio_numbytesleft(cio) - 2 - plt_len, cstr_info);
+	if (l < 0) {
+		opj_event_msg(j2k->cinfo, EVT_ERROR, "Not enough space to encode tile %d\n", j2k->curtileno);
+		return false;
+	}
+
+	if (cp->plt_on && l >= 0) {
+		plt_len = j2k_write_plt(j2k, tcd->tcd_image->tiles, packno, l);
+		/* INDEX >> */
+		if (cstr_info) {
+			/* the packets were moved after the PLT markers */
+			opj_tile_info_t *info_TL = &cstr_info->tile[j2k->curtileno];
+			info_TL->tp[j2k->cur_tp_num].tp_end_header += plt_len;
+			if (!j2k->cur_tp_num) {
+				info_TL->end_header += plt_len;
+			}
+			for (packno = cstr_info->packno - (tcd->tcd_image->tiles->packno - packno); packno < cstr_info->packno && cstr_info->index_write; packno++) {
+				info_TL->packet[packno].start_pos += plt_len;
+				info_TL->packet[packno].end_ph_pos += plt_len;
+				info_TL->packet[packno].end_pos += plt_len;
+			}
+		}
+		/* << INDEX */
+	}
 	
 	/* Writing Psot in SOT marker */
 	totlen = cio_tell(cio) + l - j2k->sot_start;
@@ -1460,16 +1603,22 @@ static void j2k_write_sod(opj_j2k_t *j2k, void *tile_coder) {
 	cio_write(cio, totlen, 4);
 	cio_seek(cio, j2k->sot_start + totlen);
 	/* Writing Ttlm and Ptlm in TLM marker */
-	if(cp->cinema){
-		cio_seek(cio, j2k->tlm_start + 6 + (5*j2k->cur_tp_num));
-		cio_write(cio, j2k->curtileno, 1);
+	if(cp->cinema || cp->tlm_on){
+		int ST = j2k_get_tlm_st(cp);
+		int max_tp = (65535 - 4) / (ST + 4);
+		cio_seek(cio, j2k->tlm_start + (j2k->tlm_tp_num / max_tp) * (6 + (ST + 4) * max_tp)
+			+ 6 + ((ST + 4) * (j2k->tlm_tp_num % max_tp)));
+		cio_write(cio, j2k->curtileno, ST);
 		cio_write(cio, totlen, 4);
+		j2k->tlm_tp_num++;
 	}
 	cio_seek(cio, j2k->sot_start + totlen);
+
+	return true;
 }
 
 static void j2k_read_sod(opj_j2k_t *j2k) {
-	int len, truncate = 0, i;
+	int len, truncate = 0;
 	unsigned char *data = NULL, *data_ptr = NULL;
 
 	opj_cio_t *cio = j2k->cio;
@@ -1484,22 +1633,30 @@ static void j2k_read_sod(opj_j2k_t *j2k) {
 		j2k->cstr_info->packno = 0;
 	}
 	
-	len = int_min(j2k->eot - cio_getbp(cio), cio_numbytesleft(cio) + 1);
+	len = int_max(int_min(j2k->eot - cio_getbp(cio), cio_numbytesleft(cio) + 1), 0);
 
 	if (len == cio_numbytesleft(cio) + 1) {
 		truncate = 1;		/* Case of a truncate codestream */
 	}	
 
-	data = j2k->tile_data[curtileno];
-	data = (unsigned char*) opj_realloc(data, (j2k->tile_len[curtileno] + len) * sizeof(unsigned char));
+	/* the data of a tile outside the decoded window is stepped over rather than */
+	/* copied, unless its packet headers sit in a PPM marker or an index is built */
+	if (!j2k->cp->ppm && !j2k->cstr_info && !j2k_tile_in_window(j2k, curtileno)) {
+		cio_skip(cio, len - truncate);
+	} else {
+		data = j2k->tile_data[curtileno];
+		data = (unsigned char*) opj_realloc(data, (j2k->tile_len[curtileno] + len) * sizeof(unsigned char));
 
-	data_ptr = data + j2k->tile_len[curtileno];
-	for (i = 0; i < len; i++) {
-		data_ptr[i] = cio_read(cio, 1);
-	}
+		data_ptr = data + j2k->tile_len[curtileno];
+		memcpy(data_ptr, cio_getbp(cio), len - truncate);
+		cio_skip(cio, len - truncate);
+		if (truncate) {
+			data_ptr[len - 1] = cio_read(cio, 1);
+		}
 
-	j2k->tile_len[curtileno] += len;
-	j2k->tile_data[curtileno] = data;
+		j2k->tile_len[curtileno] += len;
+		j2k->tile_data[curtileno] = data;
+	}
 	
 	if (!truncate) {
 		j2k->state = J2K_STATE_TPHSOT;
@@ -1509,6 +1666,18 @@ static void j2k_read_sod(opj_j2k_t *j2k) {
 	j2k->cur_tp_num++;
 }
 
+static bool j2k_tile_in_window(opj_j2k_t *j2k, int tileno) {
+	opj_cp_t *cp = j2k->cp;
+	opj_image_t *image = j2k->image;
+	int p = tileno % cp->tw;
+	int q = tileno / cp->tw;
+
+	return int_max(cp->tx0 + p * cp->tdx, image->x0) < cp->da_x1
+		&& int_min(cp->tx0 + (p + 1) * cp->tdx, image->x1) > cp->da_x0
+		&& int_max(cp->ty0 + q * cp->tdy, image->y0) < cp->da_y1
+		&& int_min(cp->ty0 + (q + 1) * cp->tdy, image->y1) > cp->da_y0;
+}
+
 static void j2k_write_rgn(opj_j2k_t *j2k, int compno, int tileno) {
 	opj_cp_t *cp = j2k->cp;
 	opj_tcp_t *tcp = &cp->tcps[tileno];
@@ -1565,26 +1734,84 @@ static void j2k_write_eoc(opj_j2k_t *j2k) {
 /* <<UniPG */
 }
 
+/**
+Tile decoding state shared by the jobs of j2k_read_eoc
+*/
+typedef struct opj_tile_job {
+	/** J2K handle */
+	opj_j2k_t *j2k;
+	/** TCD handles, one per worker, sharing the tiles of the image */
+	opj_tcd_t *tcds;
+	/** index in cp->tileno of each tile to decode */
+	int *indices;
+	/** decoding status of each tile to decode */
+	bool *success;
+} opj_tile_job_t;
+
+static void j2k_decode_tile_job(void *user_data, int jobno, int workerno) {
+	opj_tile_job_t *job = (opj_tile_job_t*) user_data;
+	opj_j2k_t *j2k = job->j2k;
+	opj_tcd_t *tcd = &job->tcds[workerno];
+	int tileno = j2k->cp->tileno[job->indices[jobno]];
+
+	/* each worker holds the code-blocks and samples of one tile at a time */
+	tcd_malloc_decode_tile(tcd, j2k->image, j2k->cp, job->indices[jobno], j2k->cstr_info);
+	job->success[jobno] = tcd_decode_tile(tcd, j2k->tile_data[tileno], j2k->tile_len[tileno], tileno, j2k->cstr_info);
+	opj_free(j2k->tile_data[tileno]);
+	j2k->tile_data[tileno] = NULL;
+	tcd_free_decode_tile(tcd, tileno);
+}
+
 static void j2k_read_eoc(opj_j2k_t *j2k) {
 	int i, tileno;
-	bool success;
 
 	/* if packets should be decoded */
 	if (j2k->cp->limit_decoding != DECODE_ALL_BUT_PACKETS) {
+		opj_cp_t *cp = j2k->cp;
 		opj_tcd_t *tcd = tcd_create(j2k->cinfo);
-		tcd_malloc_decode(tcd, j2k->image, j2k->cp);
-		for (i = 0; i < j2k->cp->tileno_size; i++) {
-			tcd_malloc_decode_tile(tcd, j2k->image, j2k->cp, i, j2k->cstr_info);
-			tileno = j2k->cp->tileno[i];
-			success = tcd_decode_tile(tcd, j2k->tile_data[tileno], j2k->tile_len[tileno], tileno, j2k->cstr_info);
-			opj_free(j2k->tile_data[tileno]);
-			j2k->tile_data[tileno] = NULL;
-			tcd_free_decode_tile(tcd, i);
-			if (success == false) {
+		opj_tile_job_t job;
+		int numjobs = 0;
+		int numworkers = 1;
+
+		tcd_malloc_decode(tcd, j2k->image, cp);
+
+		/* the tiles outside the decoded window are not even read, unless their packet */
+		/* headers sit in a PPM marker shared with the next tiles or an index is built */
+		job.indices = (int*) opj_malloc(cp->tileno_size * sizeof(int));
+		for (i = 0; i < cp->tileno_size; i++) {
+			if (cp->ppm || j2k->cstr_info || j2k_tile_in_window(j2k, cp->tileno[i])) {
+				job.indices[numjobs++] = i;
+			} else {
+				opj_free(j2k->tile_data[cp->tileno[i]]);
+				j2k->tile_data[cp->tileno[i]] = NULL;
+				tcd_free_decode_tile(tcd, cp->tileno[i]);
+			}
+		}
+
+		/* the tiles are independent, so they are decoded concurrently unless their packet */
+		/* headers share a PPM marker or an index is built, which need codestream order; */
+		/* the threads left over decode the code-blocks of each tile */
+		if (cp->num_threads > 1 && numjobs > 1 && !cp->ppm && !j2k->cstr_info) {
+			numworkers = int_min(cp->num_threads, numjobs);
+		}
+		tcd->num_threads = cp->num_threads / numworkers;
+
+		job.j2k = j2k;
+		job.tcds = (opj_tcd_t*) opj_malloc(numworkers * sizeof(opj_tcd_t));
+		job.success = (bool*) opj_malloc(numjobs * sizeof(bool));
+		for (i = 0; i < numworkers; i++) {
+			job.tcds[i] = *tcd;
+		}
+		opj_run_jobs(numworkers, numjobs, j2k_decode_tile_job, &job);
+		for (i = 0; i < numjobs; i++) {
+			if (job.success[i] == false) {
 				j2k->state |= J2K_STATE_ERR;
-				break;
 			}
 		}
+		opj_free(job.success);
+		opj_free(job.tcds);
+		opj_free(job.indices);
+
 		tcd_free_decode(tcd);
 		tcd_destroy(tcd);
 	}
@@ -1769,6 +1996,7 @@ void j2k_destroy_decompress(opj_j2k_t *j2k) {
 				if(cp->tcps[i].ppt_data_first != NULL) {
 					opj_free(cp->tcps[i].ppt_data_first);
 				}
+				opj_free(cp->tcps[i].plt_len);
 				if(cp->tcps[i].tccps != NULL) {
 					opj_free(cp->tcps[i].tccps);
 				}
@@ -1797,6 +2025,11 @@ void j2k_setup_decoder(opj_j2k_t *j2k, opj_dparameters_t *parameters) {
 		cp->reduce = parameters->cp_reduce;	
 		cp->layer = parameters->cp_layer;
 		cp->limit_decoding = parameters->cp_limit_decoding;
+		cp->num_threads = parameters->num_threads;
+		cp->da_x0 = parameters->DA_x0;
+		cp->da_y0 = parameters->DA_y0;
+		cp->da_x1 = parameters->DA_x1;
+		cp->da_y1 = parameters->DA_y1;
 
 #ifdef USE_JPWL
 		cp->correct = parameters->jpwl_correct;
@@ -2028,6 +2261,38 @@ void j2k_destroy_compress(opj_j2k_t *j2k) {
 	opj_free(j2k);
 }
 
+/**
+Upper bound of the bytes one tile-component adds to the codestream on top of its samples.
+Small tiles and the BYPASS and TERMALL modes end many more code-block segments, each with
+its own MQ flush and length in the packet header, than the default estimate allows for.
+*/
+static int j2k_get_tile_overhead(opj_cp_t *cp, opj_tccp_t *tccp, int numlayers, int prec) {
+	int resno, numpasses, numterms;
+	int overhead = 64 + 8 * tccp->numresolutions * numlayers;	/* SOT, SOD, COC, QCC, SOP and EPH */
+
+	numpasses = 3 * (prec + tccp->numgbits + 2) - 2;
+	if (tccp->cblksty & J2K_CCP_CBLKSTY_TERMALL) {
+		numterms = numpasses;
+	} else if (tccp->cblksty & J2K_CCP_CBLKSTY_LAZY) {
+		numterms = 2 * numpasses / 3;
+	} else {
+		numterms = 1;
+	}
+
+	for (resno = 0; resno < tccp->numresolutions; resno++) {
+		int levelno = tccp->numresolutions - 1 - resno + (resno ? 1 : 0);
+		int bw = int_ceildivpow2(cp->tdx, levelno);
+		int bh = int_ceildivpow2(cp->tdy, levelno);
+		int cbw = 1 << int_min(tccp->cblkw, tccp->prcw[resno] - (resno ? 1 : 0));
+		int cbh = 1 << int_min(tccp->cblkh, tccp->prch[resno] - (resno ? 1 : 0));
+		/* a band not aligned on the code-block grid straddles one more code-block each way */
+		int numcblks = ((bw - 1) / cbw + 2) * ((bh - 1) / cbh + 2);
+		overhead += (resno ? 3 : 1) * numcblks * (numlayers + 4 * numterms);
+	}
+
+	return overhead;
+}
+
 void j2k_setup_encoder(opj_j2k_t *j2k, opj_cparameters_t *parameters, opj_image_t *image) {
 	int i, j, tileno, numpocs_tile;
 	opj_cp_t *cp = NULL;
@@ -2055,6 +2320,7 @@ void j2k_setup_encoder(opj_j2k_t *j2k, opj_cparameters_t *parameters, opj_image_
 	cp->disto_alloc = parameters->cp_disto_alloc;
 	cp->fixed_alloc = parameters->cp_fixed_alloc;
 	cp->fixed_quality = parameters->cp_fixed_quality;
+	cp->num_threads = parameters->num_threads;
 
 	/* mod fixed_quality */
 	if(parameters->cp_matrice) {
@@ -2095,11 +2361,14 @@ void j2k_setup_encoder(opj_j2k_t *j2k, opj_cparameters_t *parameters, opj_image_
 		cp->tp_flag = parameters->tp_flag;
 		cp->tp_on = 1;
 	}
+	cp->tlm_on = parameters->tlm_on;
+	cp->plt_on = parameters->plt_on;
 	
 	cp->img_size = 0;
 	for(i=0;i<image->numcomps ;i++){
 	cp->img_size += (image->comps[i].w *image->comps[i].h * image->comps[i].prec);
 	}
+	cp->overhead_size = 0;
 
 
 #ifdef USE_JPWL
@@ -2282,6 +2551,7 @@ void j2k_setup_encoder(opj_j2k_t *j2k, opj_cparameters_t *parameters, opj_image_
 			}
 
 			dwt_calc_explicit_stepsizes(tccp, image->comps[i].prec);
+			cp->overhead_size += j2k_get_tile_overhead(cp, tccp, tcp->numlayers, image->comps[i].prec);
 		}
 	}
 }
@@ -2350,11 +2620,11 @@ bool j2k_encode(opj_j2k_t *j2k, opj_cio_t *cio, opj_image_t *image, opj_codestre
 
 	j2k->totnum_tp = j2k_calculate_tp(cp,image->numcomps,image,j2k);
 	/* TLM Marker*/
-	if(cp->cinema){
+	if(cp->cinema || cp->tlm_on){
 		j2k_write_tlm(j2k);
-		if (cp->cinema == CINEMA4K_24) {
-			j2k_write_poc(j2k);
-		}
+	}
+	if (cp->cinema == CINEMA4K_24) {
+		j2k_write_poc(j2k);
 	}
 
 	/* uncomment only for testing JPSEC marker writing */
@@ -2431,7 +2701,12 @@ bool j2k_encode(opj_j2k_t *j2k, opj_cio_t *cio, opj_image_t *image, opj_codestre
 					cio_tell(cio) + j2k->pos_correction + 1;
 				/* << INDEX */
 
-				j2k_write_sod(j2k, tcd);
+				if (!j2k_write_sod(j2k, tcd)) {
+					tcd_free_encode(tcd);
+					tcd_destroy(tcd);
+					opj_free(j2k->cur_totnum_tp);
+					return false;
+				}
 
 				/* INDEX >> */
 				if(cstr_info) {
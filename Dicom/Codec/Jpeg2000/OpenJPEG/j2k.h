@@ -195,6 +195,12 @@ typedef struct opj_tcp {
 	int ppt_store;
 	/** ppmbug1 */
 	int ppt_len;
+	/** lengths of the packets of the tile read from its PLT markers, in codestream order */
+	int *plt_len;
+	/** number of packet lengths read */
+	int plt_num;
+	/** number of packet lengths plt_len can hold */
+	int plt_max;
 	/** add fixed_quality */
 	float distoratio[100];
 	/** tile-component coding parameters */
@@ -211,6 +217,8 @@ typedef struct opj_cp {
 	int max_comp_size;
 	/** Size of the image in bits*/
 	int img_size;
+	/** Bytes allowed on top of img_size for the tile headers, packet headers and code-block terminations */
+	int overhead_size;
 	/** Rsiz*/
 	OPJ_RSIZ_CAPABILITIES rsiz;
 	/** Enabling Tile part generation*/
@@ -219,6 +227,10 @@ typedef struct opj_cp {
 	char tp_flag;
 	/** Position of tile part flag in progression order*/
 	int tp_pos;
+	/** Enabling TLM markers (length of each tile-part) */
+	char tlm_on;
+	/** Enabling PLT markers (length of each packet of a tile-part) */
+	char plt_on;
 	/** allocation by rate/distortion */
 	int disto_alloc;
 	/** allocation by fixed layer */
@@ -231,6 +243,13 @@ typedef struct opj_cp {
 	int layer;
 	/** if == NO_LIMITATION, decode entire codestream; if == LIMIT_TO_MAIN_HEADER then only decode the main header */
 	OPJ_LIMIT_DECODING limit_decoding;
+	/** maximum number of threads coding the code-blocks of a tile; if <= 1, the code-blocks are coded on the calling thread */
+	int num_threads;
+	/** decoded window, from the image origin as set by the user, then on the reference grid once the SIZ marker is read */
+	int da_x0;
+	int da_y0;
+	int da_x1;
+	int da_y1;
 	/** XTOsiz */
 	int tx0;
 	/** YTOsiz */
@@ -336,6 +355,8 @@ typedef struct opj_j2k {
 	/** Total num of tile parts in whole image = num tiles* num tileparts in each tile*/
 	/** used in TLMmarker*/
 	int totnum_tp;	
+	/** number of tile-parts written so far, i.e. the index of the next one in the TLM markers */
+	int tlm_tp_num;
 	/** 
 	locate the position of the end of the tile in the codestream, 
 	used to detect a truncated codestream (in j2k_read_sod)
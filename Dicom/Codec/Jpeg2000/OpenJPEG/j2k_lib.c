@@ -34,6 +34,9 @@
 #include <sys/times.h>
 #endif /* WIN32 */
 #include "opj_includes.h"
+#ifdef _M_IX86
+#include <intrin.h>
+#endif
 
 double opj_clock(void) {
 #ifdef WIN32
@@ -59,3 +62,18 @@ double opj_clock(void) {
 #endif
 }
 
+int opj_sse2(void) {
+#ifdef _M_IX86
+	static int sse2 = -1;		/* benign race: every thread stores the same value */
+	if (sse2 < 0) {
+		int info[4];
+		__cpuid(info, 1);
+		sse2 = (info[3] >> 26) & 1;
+	}
+	return sse2;
+#elif defined(OPJ_SSE2)
+	return 1;
+#else
+	return 0;
+#endif
+}
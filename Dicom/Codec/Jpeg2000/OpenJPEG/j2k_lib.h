@@ -48,6 +48,12 @@ Difference in successive opj_clock() calls tells you the elapsed time
 */
 double opj_clock(void);
 
+/**
+Check that the processor supports SSE2, which is always the case on x64
+@return Returns 1 if the SSE2 instructions can be used, 0 otherwise
+*/
+int opj_sse2(void);
+
 /* ----------------------------------------------------------------------- */
 /*@}*/
 
@@ -52,8 +52,21 @@ void mct_encode(
 		int* restrict c2,
 		int n)
 {
-	int i;
-	for(i = 0; i < n; ++i) {
+	int i = 0;
+#ifdef OPJ_SSE2
+	if (opj_sse2()) {
+		for(; i + 4 <= n; i += 4) {
+			__m128i r = _mm_loadu_si128((const __m128i*) &c0[i]);
+			__m128i g = _mm_loadu_si128((const __m128i*) &c1[i]);
+			__m128i b = _mm_loadu_si128((const __m128i*) &c2[i]);
+			__m128i y = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(r, _mm_add_epi32(g, g)), b), 2);
+			_mm_storeu_si128((__m128i*) &c0[i], y);
+			_mm_storeu_si128((__m128i*) &c1[i], _mm_sub_epi32(b, g));
+			_mm_storeu_si128((__m128i*) &c2[i], _mm_sub_epi32(r, g));
+		}
+	}
+#endif
+	for(; i < n; ++i) {
 		int r = c0[i];
 		int g = c1[i];
 		int b = c2[i];
@@ -75,8 +88,21 @@ void mct_decode(
 		int* restrict c2, 
 		int n)
 {
-	int i;
-	for (i = 0; i < n; ++i) {
+	int i = 0;
+#ifdef OPJ_SSE2
+	if (opj_sse2()) {
+		for(; i + 4 <= n; i += 4) {
+			__m128i y = _mm_loadu_si128((const __m128i*) &c0[i]);
+			__m128i u = _mm_loadu_si128((const __m128i*) &c1[i]);
+			__m128i v = _mm_loadu_si128((const __m128i*) &c2[i]);
+			__m128i g = _mm_sub_epi32(y, _mm_srai_epi32(_mm_add_epi32(u, v), 2));
+			_mm_storeu_si128((__m128i*) &c0[i], _mm_add_epi32(v, g));
+			_mm_storeu_si128((__m128i*) &c1[i], g);
+			_mm_storeu_si128((__m128i*) &c2[i], _mm_add_epi32(u, g));
+		}
+	}
+#endif
+	for (; i < n; ++i) {
 		int y = c0[i];
 		int u = c1[i];
 		int v = c2[i];
@@ -105,8 +131,26 @@ void mct_encode_real(
 		int* restrict c2,
 		int n)
 {
-	int i;
-	for(i = 0; i < n; ++i) {
+	int i = 0;
+#ifdef OPJ_SSE2
+	if (opj_sse2()) {
+		const __m128i ry = _mm_set1_epi32(2449), gy = _mm_set1_epi32(4809), by = _mm_set1_epi32(934);
+		const __m128i ru = _mm_set1_epi32(1382), gu = _mm_set1_epi32(2714), bu = _mm_set1_epi32(4096);
+		const __m128i rv = _mm_set1_epi32(4096), gv = _mm_set1_epi32(3430), bv = _mm_set1_epi32(666);
+		for(; i + 4 <= n; i += 4) {
+			__m128i r = _mm_loadu_si128((const __m128i*) &c0[i]);
+			__m128i g = _mm_loadu_si128((const __m128i*) &c1[i]);
+			__m128i b = _mm_loadu_si128((const __m128i*) &c2[i]);
+			__m128i y = _mm_add_epi32(_mm_add_epi32(fix_mul_sse2(r, ry), fix_mul_sse2(g, gy)), fix_mul_sse2(b, by));
+			__m128i u = _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(_mm_setzero_si128(), fix_mul_sse2(r, ru)), fix_mul_sse2(g, gu)), fix_mul_sse2(b, bu));
+			__m128i v = _mm_sub_epi32(_mm_sub_epi32(fix_mul_sse2(r, rv), fix_mul_sse2(g, gv)), fix_mul_sse2(b, bv));
+			_mm_storeu_si128((__m128i*) &c0[i], y);
+			_mm_storeu_si128((__m128i*) &c1[i], u);
+			_mm_storeu_si128((__m128i*) &c2[i], v);
+		}
+	}
+#endif
+	for(; i < n; ++i) {
 		int r = c0[i];
 		int g = c1[i];
 		int b = c2[i];
@@ -128,8 +172,23 @@ void mct_decode_real(
 		float* restrict c2,
 		int n)
 {
-	int i;
-	for(i = 0; i < n; ++i) {
+	int i = 0;
+#ifdef OPJ_SSE2
+	if (opj_sse2()) {
+		const __m128 vr = _mm_set1_ps(1.402f);
+		const __m128 ug = _mm_set1_ps(0.34413f), vg = _mm_set1_ps(0.71414f);
+		const __m128 ub = _mm_set1_ps(1.772f);
+		for(; i + 4 <= n; i += 4) {
+			__m128 y = _mm_loadu_ps(&c0[i]);
+			__m128 u = _mm_loadu_ps(&c1[i]);
+			__m128 v = _mm_loadu_ps(&c2[i]);
+			_mm_storeu_ps(&c0[i], _mm_add_ps(y, _mm_mul_ps(v, vr)));
+			_mm_storeu_ps(&c1[i], _mm_sub_ps(_mm_sub_ps(y, _mm_mul_ps(u, ug)), _mm_mul_ps(v, vg)));
+			_mm_storeu_ps(&c2[i], _mm_add_ps(y, _mm_mul_ps(u, ub)));
+		}
+	}
+#endif
+	for(; i < n; ++i) {
 		float y = c0[i];
 		float u = c1[i];
 		float v = c2[i];
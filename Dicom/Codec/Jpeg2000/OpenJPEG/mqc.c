@@ -393,46 +393,48 @@ void mqc_flush(opj_mqc_t *mqc) {
 	}
 }
 
+/* raw bytes are written at bp, one past the last byte of the terminated MQ segment */
 void mqc_bypass_init_enc(opj_mqc_t *mqc) {
 	mqc->c = 0;
 	mqc->ct = 8;
-	/*if (*mqc->bp == 0xff) {
-	mqc->ct = 7;
-     } */
 }
 
 void mqc_bypass_enc(opj_mqc_t *mqc, int d) {
 	mqc->ct--;
 	mqc->c = mqc->c + (d << mqc->ct);
 	if (mqc->ct == 0) {
-		mqc->bp++;
 		*mqc->bp = mqc->c;
 		mqc->ct = 8;
+		/* a byte after 0xff carries only 7 bits */
 		if (*mqc->bp == 0xff) {
 			mqc->ct = 7;
 		}
+		mqc->bp++;
 		mqc->c = 0;
 	}
 }
 
-int mqc_bypass_flush_enc(opj_mqc_t *mqc) {
-	unsigned char bit_padding;
-	
-	bit_padding = 0;
-	
-	if (mqc->ct != 0) {
+int mqc_bypass_get_extra_bytes(opj_mqc_t *mqc, int erterm) {
+	return (mqc->ct < 7 || (mqc->ct == 7 && (erterm || mqc->bp[-1] != 0xff))) ? 1 : 0;
+}
+
+void mqc_bypass_flush_enc(opj_mqc_t *mqc, int erterm) {
+	if (mqc->ct < 7 || (mqc->ct == 7 && (erterm || mqc->bp[-1] != 0xff))) {
+		/* pad the last byte with alternating 0s and 1s */
+		unsigned char bit_padding = 0;
 		while (mqc->ct > 0) {
 			mqc->ct--;
 			mqc->c += bit_padding << mqc->ct;
-			bit_padding = (bit_padding + 1) & 0x01;
+			bit_padding = 1 - bit_padding;
 		}
-		mqc->bp++;
 		*mqc->bp = mqc->c;
-		mqc->ct = 8;
-		mqc->c = 0;
+		mqc->bp++;
+	} else if (mqc->ct == 7 && mqc->bp[-1] == 0xff) {
+		/* a segment may not end with 0xff, and the decoder reads the missing bits as 1s */
+		mqc->bp--;
 	}
-	
-	return 1;
+	mqc->ct = 8;
+	mqc->c = 0;
 }
 
 void mqc_reset_enc(opj_mqc_t *mqc) {
@@ -131,27 +131,31 @@ Flush the encoder, so that all remaining data is written
 */
 void mqc_flush(opj_mqc_t *mqc);
 /**
-BYPASS mode switch, initialization operation. 
+BYPASS mode switch, initialization operation, after a terminated MQ segment. 
 JPEG 2000 p 505. 
-<h2>Not fully implemented and tested !!</h2>
 @param mqc MQC handle
 */
 void mqc_bypass_init_enc(opj_mqc_t *mqc);
 /**
 BYPASS mode switch, coding operation. 
 JPEG 2000 p 505. 
-<h2>Not fully implemented and tested !!</h2>
 @param mqc MQC handle
 @param d The symbol to be encoded (0 or 1)
 */
 void mqc_bypass_enc(opj_mqc_t *mqc, int d);
 /**
+BYPASS mode switch, the number of bytes mqc_bypass_flush_enc would add
+@param mqc MQC handle
+@param erterm Whether the segment is terminated predictably (PTERM)
+@return Returns 0 or 1
+*/
+int mqc_bypass_get_extra_bytes(opj_mqc_t *mqc, int erterm);
+/**
 BYPASS mode switch, flush operation
-<h2>Not fully implemented and tested !!</h2>
 @param mqc MQC handle
-@return Returns 1 (always)
+@param erterm Whether the segment is terminated predictably (PTERM)
 */
-int mqc_bypass_flush_enc(opj_mqc_t *mqc);
+void mqc_bypass_flush_enc(opj_mqc_t *mqc, int erterm);
 /**
 RESET mode switch
 @param mqc MQC handle
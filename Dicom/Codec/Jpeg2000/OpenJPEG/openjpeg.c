@@ -119,6 +119,7 @@ void OPJ_CALLCONV opj_set_default_decoder_parameters(opj_dparameters_t *paramete
 		parameters->cp_layer = 0;
 		parameters->cp_reduce = 0;
 		parameters->cp_limit_decoding = NO_LIMITATION;
+		parameters->num_threads = 1;
 
 		parameters->decod_format = -1;
 		parameters->cod_format = -1;
@@ -243,6 +244,7 @@ void OPJ_CALLCONV opj_set_default_encoder_parameters(opj_cparameters_t *paramete
 		parameters->tcp_rates[0] = 0;   
         parameters->tcp_numlayers = 1;
         parameters->cp_disto_alloc = 1;
+		parameters->num_threads = 1;
 
 /* UniPG>> */
 #ifdef USE_JPWL
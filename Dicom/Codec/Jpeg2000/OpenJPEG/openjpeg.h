@@ -368,6 +368,12 @@ typedef struct opj_cparameters {
 	char tp_flag;
 	/** MCT (multiple component transform) */
 	char tcp_mct;
+	/** maximum number of threads encoding the code-blocks of a tile; if <= 1, they are encoded on the calling thread */
+	int num_threads;
+	/** write TLM markers in the main header, giving the length of each tile-part */
+	char tlm_on;
+	/** write PLT markers in each tile-part header, giving the length of each packet */
+	char plt_on;
 } opj_cparameters_t;
 
 /**
@@ -389,6 +395,23 @@ typedef struct opj_dparameters {
 	if == 0 or not used, all the quality layers are decoded 
 	*/
 	int cp_layer;
+	/**
+	Set the maximum number of threads decoding the code-blocks of a tile-component.
+	if > 1, the code-blocks are decoded in parallel; 
+	if <= 1 or not used, they are decoded on the calling thread 
+	*/
+	int num_threads;
+	/**
+	Set the window to decode, in samples of the full-resolution image from its top-left corner
+	(DA_x0 and DA_y0 inclusive, DA_x1 and DA_y1 exclusive). Only the tiles and code-blocks whose
+	wavelet support meets the window are decoded, and the decoded image covers the window alone.
+	if DA_x1 > DA_x0 and DA_y1 > DA_y0, the window (clipped to the image) is decoded; 
+	otherwise or if not used, the whole image is decoded 
+	*/
+	int DA_x0;
+	int DA_y0;
+	int DA_x1;
+	int DA_y1;
 
 	/**@name command line encoder parameters (not used inside the library) */
 	/*@{*/
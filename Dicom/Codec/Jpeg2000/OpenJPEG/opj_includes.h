@@ -111,6 +111,13 @@ static INLINE long lrintf(float f){
 #endif
 #endif
 
+/* SSE2 intrinsics.  The Microsoft compilers emit them on x86 and x64 whatever the */
+/* /arch setting, so code using them checks opj_sse2() first. */
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)))
+#define OPJ_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "j2k_lib.h"
 #include "opj_malloc.h"
 #include "event.h"
@@ -131,6 +138,7 @@ static INLINE long lrintf(float f){
 #include "dwt.h"
 #include "t2.h"
 #include "mct.h"
+#include "thread.h"
 #include "int.h"
 #include "fix.h"
 
@@ -38,6 +38,50 @@
 /** @defgroup T1 T1 - Implementation of the tier-1 coding */
 /*@{*/
 
+/**
+A code-block to encode, and where its coefficients are in the tile-component
+*/
+typedef struct opj_t1_cblk_enc_job {
+	opj_tcd_cblk_enc_t *cblk;
+	opj_tcd_band_t *band;
+	int compno;
+	int resno;
+	/** offset of the code-block in the tile-component data */
+	int x, y;
+} opj_t1_cblk_enc_job_t;
+
+/**
+The code-blocks of a tile, encoded by opj_run_jobs
+*/
+typedef struct opj_t1_encode_batch {
+	/** one T1 handle per worker */
+	opj_t1_t **t1;
+	opj_tcd_tile_t *tile;
+	opj_tcp_t *tcp;
+	opj_t1_cblk_enc_job_t *jobs;
+} opj_t1_encode_batch_t;
+
+/**
+A code-block to decode, and where its coefficients go in the tile-component
+*/
+typedef struct opj_t1_cblk_job {
+	opj_tcd_cblk_dec_t *cblk;
+	opj_tcd_band_t *band;
+	/** offset of the code-block in the tile-component data */
+	int x, y;
+} opj_t1_cblk_job_t;
+
+/**
+The code-blocks of a tile-component, decoded by opj_run_jobs
+*/
+typedef struct opj_t1_decode_batch {
+	/** one T1 handle per worker */
+	opj_t1_t **t1;
+	opj_tcd_tilecomp_t *tilec;
+	opj_tccp_t *tccp;
+	opj_t1_cblk_job_t *jobs;
+} opj_t1_decode_batch_t;
+
 /** @name Local static functions */
 /*@{*/
 
@@ -203,8 +247,15 @@ static void t1_encode_cblk(
 		int qmfbid,
 		double stepsize,
 		int cblksty,
-		int numcomps,
-		opj_tcd_tile_t * tile);
+		int numcomps);
+/**
+Encode 1 code-block of a tile, from the coefficients of its tile-component.
+Runs as a job of opj_run_jobs, with the T1 handle of the worker.
+@param user_data The opj_t1_encode_batch_t of the tile
+@param jobno Index of the code-block job
+@param workerno Index of the T1 handle to use
+*/
+static void t1_encode_cblk_job(void *user_data, int jobno, int workerno);
 /**
 Decode 1 code-block
 @param t1 T1 handle
@@ -219,6 +270,14 @@ static void t1_decode_cblk(
 		int orient,
 		int roishift,
 		int cblksty);
+/**
+Decode 1 code-block of a tile-component, and dequantize it into the tile-component data.
+Runs as a job of opj_run_jobs, with the T1 handle of the worker.
+@param user_data The opj_t1_decode_batch_t of the tile-component
+@param jobno Index of the code-block job
+@param workerno Index of the T1 handle to use
+*/
+static void t1_decode_cblk_job(void *user_data, int jobno, int workerno);
 
 /*@}*/
 
@@ -801,8 +860,7 @@ static void t1_encode_cblk(
 		int qmfbid,
 		double stepsize,
 		int cblksty,
-		int numcomps,
-		opj_tcd_tile_t * tile)
+		int numcomps)
 {
 	double cumwmsedec = 0.0;
 
@@ -833,9 +891,16 @@ static void t1_encode_cblk(
 	
 	for (passno = 0; bpno >= 0; ++passno) {
 		opj_tcd_pass_t *pass = &cblk->passes[passno];
-		int correction = 3;
 		type = ((bpno < (cblk->numbps - 4)) && (passtype < 2) && (cblksty & J2K_CCP_CBLKSTY_LAZY)) ? T1_TYPE_RAW : T1_TYPE_MQ;
 		
+		/* a pass after a terminated one starts a new segment */
+		if (passno > 0 && cblk->passes[passno - 1].term) {
+			if (type == T1_TYPE_RAW)
+				mqc_bypass_init_enc(mqc);
+			else
+				mqc_restart_init_enc(mqc);
+		}
+		
 		switch (passtype) {
 			case 0:
 				t1_enc_sigpass(t1, bpno, orient, &nmsedec, type, cblksty);
@@ -854,34 +919,27 @@ static void t1_encode_cblk(
 		/* fixed_quality */
 		tempwmsedec = t1_getwmsedec(nmsedec, compno, level, orient, bpno, qmfbid, stepsize, numcomps);
 		cumwmsedec += tempwmsedec;
-		tile->distotile += tempwmsedec;
+		pass->wmsedec = tempwmsedec;
 		
-		/* Code switch "RESTART" (i.e. TERMALL) */
-		if ((cblksty & J2K_CCP_CBLKSTY_TERMALL)	&& !((passtype == 2) && (bpno - 1 < 0))) {
-			if (type == T1_TYPE_RAW) {
-				mqc_flush(mqc);
-				correction = 1;
-				/* correction = mqc_bypass_flush_enc(); */
-			} else {			/* correction = mqc_restart_enc(); */
+		/* The last pass ends a segment, as does every pass with code switch "RESTART" (i.e. TERMALL),
+		   and with BYPASS the fourth cleanup pass and after it the refinement (raw) and cleanup (MQ)
+		   passes.  The rate of a terminated pass is exact; otherwise it includes the bytes a flush
+		   would still add */
+		if ((passtype == 2 && bpno == 0) || (cblksty & J2K_CCP_CBLKSTY_TERMALL)
+			|| ((cblksty & J2K_CCP_CBLKSTY_LAZY)
+				&& ((bpno == cblk->numbps - 4 && passtype == 2) || (bpno < cblk->numbps - 4 && passtype > 0)))) {
+			if (type == T1_TYPE_RAW)
+				mqc_bypass_flush_enc(mqc, cblksty & J2K_CCP_CBLKSTY_PTERM);
+			else if (cblksty & J2K_CCP_CBLKSTY_PTERM)	/* Code switch "ERTERM" (i.e. PTERM) */
+				mqc_erterm_enc(mqc);
+			else
 				mqc_flush(mqc);
-				correction = 1;
-			}
 			pass->term = 1;
+			pass->rate = mqc_numbytes(mqc);
 		} else {
-			if (((bpno < (cblk->numbps - 4) && (passtype > 0)) 
-				|| ((bpno == (cblk->numbps - 4)) && (passtype == 2))) && (cblksty & J2K_CCP_CBLKSTY_LAZY)) {
-				if (type == T1_TYPE_RAW) {
-					mqc_flush(mqc);
-					correction = 1;
-					/* correction = mqc_bypass_flush_enc(); */
-				} else {		/* correction = mqc_restart_enc(); */
-					mqc_flush(mqc);
-					correction = 1;
-				}
-				pass->term = 1;
-			} else {
-				pass->term = 0;
-			}
+			pass->term = 0;
+			pass->rate = mqc_numbytes(mqc)
+				+ (type == T1_TYPE_RAW ? mqc_bypass_get_extra_bytes(mqc, cblksty & J2K_CCP_CBLKSTY_PTERM) : 3);
 		}
 		
 		if (++passtype == 3) {
@@ -889,34 +947,25 @@ static void t1_encode_cblk(
 			bpno--;
 		}
 		
-		if (pass->term && bpno > 0) {
-			type = ((bpno < (cblk->numbps - 4)) && (passtype < 2) && (cblksty & J2K_CCP_CBLKSTY_LAZY)) ? T1_TYPE_RAW : T1_TYPE_MQ;
-			if (type == T1_TYPE_RAW)
-				mqc_bypass_init_enc(mqc);
-			else
-				mqc_restart_init_enc(mqc);
-		}
-		
 		pass->distortiondec = cumwmsedec;
-		pass->rate = mqc_numbytes(mqc) + correction;	/* FIXME */
 		
 		/* Code-switch "RESET" */
 		if (cblksty & J2K_CCP_CBLKSTY_RESET)
 			mqc_reset_enc(mqc);
 	}
 	
-	/* Code switch "ERTERM" (i.e. PTERM) */
-	if (cblksty & J2K_CCP_CBLKSTY_PTERM)
-		mqc_erterm_enc(mqc);
-	else /* Default coding */ if (!(cblksty & J2K_CCP_CBLKSTY_LAZY))
-		mqc_flush(mqc);
-	
 	cblk->totalpasses = passno;
 
+	/* The estimated rate of a pass that is not terminated can run past the end of its segment;
+	   truncation points must not decrease */
+	for (passno = cblk->totalpasses - 2; passno >= 0; passno--) {
+		opj_tcd_pass_t *pass = &cblk->passes[passno];
+		if (pass->rate > cblk->passes[passno + 1].rate)
+			pass->rate = cblk->passes[passno + 1].rate;
+	}
+
 	for (passno = 0; passno<cblk->totalpasses; passno++) {
 		opj_tcd_pass_t *pass = &cblk->passes[passno];
-		if (pass->rate > mqc_numbytes(mqc))
-			pass->rate = mqc_numbytes(mqc);
 		/*Preventing generation of FF as last data byte of a pass*/
 		if((pass->rate>1) && (cblk->data[pass->rate - 1] == 0xFF)){
 			pass->rate--;
@@ -970,7 +1019,7 @@ static void t1_decode_cblk(
 			mqc_init_dec(mqc, (*seg->data) + seg->dataindex, seg->len);
 		}
 		
-		for (passno = 0; passno < seg->numpasses; ++passno) {
+		for (passno = 0; passno < seg->realnumpasses; ++passno) {
 			switch (passtype) {
 				case 0:
 					t1_dec_sigpass(t1, bpno+1, orient, type, cblksty);
@@ -1028,19 +1077,103 @@ void t1_destroy(opj_t1_t *t1) {
 	}
 }
 
+static void t1_encode_cblk_job(void *user_data, int jobno, int workerno) {
+	opj_t1_encode_batch_t *batch = (opj_t1_encode_batch_t*)user_data;
+	opj_t1_cblk_enc_job_t *job = &batch->jobs[jobno];
+	opj_t1_t *t1 = batch->t1[workerno];
+	opj_tcd_tile_t *tile = batch->tile;
+	opj_tcd_tilecomp_t *tilec = &tile->comps[job->compno];
+	opj_tccp_t *tccp = &batch->tcp->tccps[job->compno];
+	opj_tcd_cblk_enc_t *cblk = job->cblk;
+	opj_tcd_band_t *band = job->band;
+	int tile_w = tilec->x1 - tilec->x0;
+	int* restrict datap;
+	int* restrict tiledp;
+	int cblk_w;
+	int cblk_h;
+	int i, j;
+
+	if(!allocate_buffers(
+				t1,
+				cblk->x1 - cblk->x0,
+				cblk->y1 - cblk->y0))
+	{
+		return;
+	}
+
+	datap=t1->data;
+	cblk_w = t1->w;
+	cblk_h = t1->h;
+
+	tiledp=&tilec->data[(job->y * tile_w) + job->x];
+	if (tccp->qmfbid == 1) {
+		for (j = 0; j < cblk_h; ++j) {
+			for (i = 0; i < cblk_w; ++i) {
+				int tmp = tiledp[(j * tile_w) + i];
+				datap[(j * cblk_w) + i] = tmp << T1_NMSEDEC_FRACBITS;
+			}
+		}
+	} else {		/* if (tccp->qmfbid == 0) */
+		for (j = 0; j < cblk_h; ++j) {
+			for (i = 0; i < cblk_w; ++i) {
+				int tmp = tiledp[(j * tile_w) + i];
+				datap[(j * cblk_w) + i] =
+					fix_mul(
+					tmp,
+					8192 * 8192 / ((int) floor(band->stepsize * 8192))) >> (11 - T1_NMSEDEC_FRACBITS);
+			}
+		}
+	}
+
+	t1_encode_cblk(
+			t1,
+			cblk,
+			band->bandno,
+			job->compno,
+			tilec->numresolutions - 1 - job->resno,
+			tccp->qmfbid,
+			band->stepsize,
+			tccp->cblksty,
+			tile->numcomps);
+}
+
 void t1_encode_cblks(
-		opj_t1_t *t1,
+		opj_t1_t **t1,
+		int numt1,
 		opj_tcd_tile_t *tile,
 		opj_tcp_t *tcp)
 {
-	int compno, resno, bandno, precno, cblkno;
+	int compno, resno, bandno, precno, cblkno, passno;
+	int jobno, numjobs = 0;
+	opj_t1_encode_batch_t batch;
 
 	tile->distotile = 0;		/* fixed_quality */
 
 	for (compno = 0; compno < tile->numcomps; ++compno) {
 		opj_tcd_tilecomp_t* tilec = &tile->comps[compno];
-		opj_tccp_t* tccp = &tcp->tccps[compno];
-		int tile_w = tilec->x1 - tilec->x0;
+		for (resno = 0; resno < tilec->numresolutions; ++resno) {
+			opj_tcd_resolution_t *res = &tilec->resolutions[resno];
+			for (bandno = 0; bandno < res->numbands; ++bandno) {
+				opj_tcd_band_t* band = &res->bands[bandno];
+				for (precno = 0; precno < res->pw * res->ph; ++precno) {
+					opj_tcd_precinct_t *prc = &band->precincts[precno];
+					numjobs += prc->cw * prc->ch;
+				}
+			}
+		}
+	}
+
+	batch.t1 = t1;
+	batch.tile = tile;
+	batch.tcp = tcp;
+	batch.jobs = (opj_t1_cblk_enc_job_t*) opj_malloc(numjobs * sizeof(opj_t1_cblk_enc_job_t));
+	if (!batch.jobs) {
+		return;
+	}
+	numjobs = 0;
+
+	for (compno = 0; compno < tile->numcomps; ++compno) {
+		opj_tcd_tilecomp_t* tilec = &tile->comps[compno];
 
 		for (resno = 0; resno < tilec->numresolutions; ++resno) {
 			opj_tcd_resolution_t *res = &tilec->resolutions[resno];
@@ -1053,82 +1186,133 @@ void t1_encode_cblks(
 
 					for (cblkno = 0; cblkno < prc->cw * prc->ch; ++cblkno) {
 						opj_tcd_cblk_enc_t* cblk = &prc->cblks.enc[cblkno];
-						int* restrict datap;
-						int* restrict tiledp;
-						int cblk_w;
-						int cblk_h;
-						int i, j;
-
-						int x = cblk->x0 - band->x0;
-						int y = cblk->y0 - band->y0;
+						opj_t1_cblk_enc_job_t* job = &batch.jobs[numjobs++];
+
+						job->cblk = cblk;
+						job->band = band;
+						job->compno = compno;
+						job->resno = resno;
+						job->x = cblk->x0 - band->x0;
+						job->y = cblk->y0 - band->y0;
 						if (band->bandno & 1) {
 							opj_tcd_resolution_t *pres = &tilec->resolutions[resno - 1];
-							x += pres->x1 - pres->x0;
+							job->x += pres->x1 - pres->x0;
 						}
 						if (band->bandno & 2) {
 							opj_tcd_resolution_t *pres = &tilec->resolutions[resno - 1];
-							y += pres->y1 - pres->y0;
-						}
-
-						if(!allocate_buffers(
-									t1,
-									cblk->x1 - cblk->x0,
-									cblk->y1 - cblk->y0))
-						{
-							return;
+							job->y += pres->y1 - pres->y0;
 						}
-
-						datap=t1->data;
-						cblk_w = t1->w;
-						cblk_h = t1->h;
-
-						tiledp=&tilec->data[(y * tile_w) + x];
-						if (tccp->qmfbid == 1) {
-							for (j = 0; j < cblk_h; ++j) {
-								for (i = 0; i < cblk_w; ++i) {
-									int tmp = tiledp[(j * tile_w) + i];
-									datap[(j * cblk_w) + i] = tmp << T1_NMSEDEC_FRACBITS;
-								}
-							}
-						} else {		/* if (tccp->qmfbid == 0) */
-							for (j = 0; j < cblk_h; ++j) {
-								for (i = 0; i < cblk_w; ++i) {
-									int tmp = tiledp[(j * tile_w) + i];
-									datap[(j * cblk_w) + i] =
-										fix_mul(
-										tmp,
-										8192 * 8192 / ((int) floor(band->stepsize * 8192))) >> (11 - T1_NMSEDEC_FRACBITS);
-								}
-							}
-						}
-
-						t1_encode_cblk(
-								t1,
-								cblk,
-								band->bandno,
-								compno,
-								tilec->numresolutions - 1 - resno,
-								tccp->qmfbid,
-								band->stepsize,
-								tccp->cblksty,
-								tile->numcomps,
-								tile);
-
 					} /* cblkno */
 				} /* precno */
 			} /* bandno */
 		} /* resno  */
 	} /* compno  */
+
+	opj_run_jobs(numt1, numjobs, t1_encode_cblk_job, &batch);
+
+	/* fixed_quality: sum the distortion decreases in the order of the serial coder, */
+	/* so that the rate allocation, and so the codestream, do not depend on the thread count */
+	for (jobno = 0; jobno < numjobs; ++jobno) {
+		opj_tcd_cblk_enc_t* cblk = batch.jobs[jobno].cblk;
+		for (passno = 0; passno < cblk->totalpasses; ++passno) {
+			tile->distotile += cblk->passes[passno].wmsedec;
+		}
+	}
+
+	opj_free(batch.jobs);
+}
+
+static void t1_decode_cblk_job(void *user_data, int jobno, int workerno) {
+	opj_t1_decode_batch_t *batch = (opj_t1_decode_batch_t*)user_data;
+	opj_t1_cblk_job_t *job = &batch->jobs[jobno];
+	opj_t1_t *t1 = batch->t1[workerno];
+	opj_tcd_tilecomp_t *tilec = batch->tilec;
+	opj_tccp_t *tccp = batch->tccp;
+	opj_tcd_cblk_dec_t *cblk = job->cblk;
+	opj_tcd_band_t *band = job->band;
+	int tile_w = tilec->x1 - tilec->x0;
+	int* restrict datap;
+	void* restrict tiledp;
+	int cblk_w, cblk_h;
+	int i, j;
+
+	t1_decode_cblk(
+			t1,
+			cblk,
+			band->bandno,
+			tccp->roishift,
+			tccp->cblksty);
+
+	datap=t1->data;
+	cblk_w = t1->w;
+	cblk_h = t1->h;
+
+	if (tccp->roishift) {
+		int thresh = 1 << tccp->roishift;
+		for (j = 0; j < cblk_h; ++j) {
+			for (i = 0; i < cblk_w; ++i) {
+				int val = datap[(j * cblk_w) + i];
+				int mag = abs(val);
+				if (mag >= thresh) {
+					mag >>= tccp->roishift;
+					datap[(j * cblk_w) + i] = val < 0 ? -mag : mag;
+				}
+			}
+		}
+	}
+
+	/* code-blocks do not overlap, so the workers write to disjoint parts of tilec->data */
+	tiledp=(void*)&tilec->data[(job->y * tile_w) + job->x];
+	if (tccp->qmfbid == 1) {
+		for (j = 0; j < cblk_h; ++j) {
+			for (i = 0; i < cblk_w; ++i) {
+				int tmp = datap[(j * cblk_w) + i];
+				((int*)tiledp)[(j * tile_w) + i] = tmp / 2;
+			}
+		}
+	} else {		/* if (tccp->qmfbid == 0) */
+		for (j = 0; j < cblk_h; ++j) {
+			for (i = 0; i < cblk_w; ++i) {
+				float tmp = datap[(j * cblk_w) + i] * band->stepsize;
+				((float*)tiledp)[(j * tile_w) + i] = tmp;
+			}
+		}
+	}
+	opj_free(cblk->data);
+	opj_free(cblk->segs);
 }
 
 void t1_decode_cblks(
-		opj_t1_t* t1,
+		opj_t1_t** t1,
+		int numt1,
 		opj_tcd_tilecomp_t* tilec,
-		opj_tccp_t* tccp)
+		opj_tccp_t* tccp,
+		int numres)
 {
 	int resno, bandno, precno, cblkno;
+	int numjobs = 0;
+	opj_t1_cblk_job_t* jobs;
+	opj_t1_cblk_job_t single;
+	opj_t1_decode_batch_t batch;
 
-	int tile_w = tilec->x1 - tilec->x0;
+	for (resno = 0; resno < numres; ++resno) {
+		opj_tcd_resolution_t* res = &tilec->resolutions[resno];
+		for (bandno = 0; bandno < res->numbands; ++bandno) {
+			opj_tcd_band_t* band = &res->bands[bandno];
+			for (precno = 0; precno < res->pw * res->ph; ++precno) {
+				opj_tcd_precinct_t* precinct = &band->precincts[precno];
+				numjobs += precinct->cw * precinct->ch;
+			}
+		}
+	}
+
+	batch.t1 = t1;
+	batch.tilec = tilec;
+	batch.tccp = tccp;
+	/* without a job list, each code-block is decoded on this thread as it is found */
+	jobs = (opj_t1_cblk_job_t*) opj_malloc(numjobs * sizeof(opj_t1_cblk_job_t));
+	batch.jobs = jobs ? jobs : &single;
+	numjobs = 0;
 
 	for (resno = 0; resno < tilec->numresolutions; ++resno) {
 		opj_tcd_resolution_t* res = &tilec->resolutions[resno];
@@ -1141,70 +1325,62 @@ void t1_decode_cblks(
 
 				for (cblkno = 0; cblkno < precinct->cw * precinct->ch; ++cblkno) {
 					opj_tcd_cblk_dec_t* cblk = &precinct->cblks.dec[cblkno];
-					int* restrict datap;
-					void* restrict tiledp;
-					int cblk_w, cblk_h;
-					int x, y;
-					int i, j;
-
-					t1_decode_cblk(
-							t1,
-							cblk,
-							band->bandno,
-							tccp->roishift,
-							tccp->cblksty);
-
-					x = cblk->x0 - band->x0;
-					y = cblk->y0 - band->y0;
+					opj_t1_cblk_job_t* job = jobs ? &jobs[numjobs] : &single;
+
+					if (resno >= numres) {
+						opj_free(cblk->data);
+						opj_free(cblk->segs);
+						continue;
+					}
+
+					job->cblk = cblk;
+					job->band = band;
+					job->x = cblk->x0 - band->x0;
+					job->y = cblk->y0 - band->y0;
 					if (band->bandno & 1) {
 						opj_tcd_resolution_t* pres = &tilec->resolutions[resno - 1];
-						x += pres->x1 - pres->x0;
+						job->x += pres->x1 - pres->x0;
 					}
 					if (band->bandno & 2) {
 						opj_tcd_resolution_t* pres = &tilec->resolutions[resno - 1];
-						y += pres->y1 - pres->y0;
+						job->y += pres->y1 - pres->y0;
 					}
-
-					datap=t1->data;
-					cblk_w = t1->w;
-					cblk_h = t1->h;
-
-					if (tccp->roishift) {
-						int thresh = 1 << tccp->roishift;
-						for (j = 0; j < cblk_h; ++j) {
-							for (i = 0; i < cblk_w; ++i) {
-								int val = datap[(j * cblk_w) + i];
-								int mag = abs(val);
-								if (mag >= thresh) {
-									mag >>= tccp->roishift;
-									datap[(j * cblk_w) + i] = val < 0 ? -mag : mag;
-								}
-							}
+					if (!cblk->in_window) {
+						/* its data was never read; the synthesis of the window only */
+						/* needs its coefficients to be defined */
+						int tile_w = tilec->x1 - tilec->x0;
+						int* tiledp = &tilec->data[(job->y * tile_w) + job->x];
+						int j;
+						for (j = 0; j < cblk->y1 - cblk->y0; ++j) {
+							memset(&tiledp[j * tile_w], 0, (cblk->x1 - cblk->x0) * sizeof(int));
 						}
+						opj_free(cblk->data);
+						opj_free(cblk->segs);
+						continue;
 					}
-
-					tiledp=(void*)&tilec->data[(y * tile_w) + x];
-					if (tccp->qmfbid == 1) {
-						for (j = 0; j < cblk_h; ++j) {
-							for (i = 0; i < cblk_w; ++i) {
-								int tmp = datap[(j * cblk_w) + i];
-								((int*)tiledp)[(j * tile_w) + i] = tmp / 2;
-							}
-						}
-					} else {		/* if (tccp->qmfbid == 0) */
-						for (j = 0; j < cblk_h; ++j) {
-							for (i = 0; i < cblk_w; ++i) {
-								float tmp = datap[(j * cblk_w) + i] * band->stepsize;
-								((float*)tiledp)[(j * tile_w) + i] = tmp;
-							}
-						}
+					if (jobs) {
+						numjobs++;
+					} else {
+						t1_decode_cblk_job(&batch, 0, 0);
 					}
-					opj_free(cblk->data);
-					opj_free(cblk->segs);
 				} /* cblkno */
-				opj_free(precinct->cblks.dec);
 			} /* precno */
 		} /* bandno */
 	} /* resno */
+
+	if (jobs) {
+		opj_run_jobs(numt1, numjobs, t1_decode_cblk_job, &batch);
+		opj_free(jobs);
+	}
+
+	for (resno = 0; resno < tilec->numresolutions; ++resno) {
+		opj_tcd_resolution_t* res = &tilec->resolutions[resno];
+		for (bandno = 0; bandno < res->numbands; ++bandno) {
+			opj_tcd_band_t* band = &res->bands[bandno];
+			for (precno = 0; precno < res->pw * res->ph; ++precno) {
+				opj_free(band->precincts[precno].cblks.dec);
+			}
+		}
+	}
 }
 
@@ -129,19 +129,24 @@ Destroy a previously created T1 handle
 */
 void t1_destroy(opj_t1_t *t1);
 /**
-Encode the code-blocks of a tile
-@param t1 T1 handle
+Encode the code-blocks of a tile.
+The code-blocks are encoded in parallel on up to numt1 threads, each with its own T1 handle.
+@param t1 Array of numt1 T1 handles
+@param numt1 Number of T1 handles, and so of threads
 @param tile The tile to encode
 @param tcp Tile coding parameters
 */
-void t1_encode_cblks(opj_t1_t *t1, opj_tcd_tile_t *tile, opj_tcp_t *tcp);
+void t1_encode_cblks(opj_t1_t **t1, int numt1, opj_tcd_tile_t *tile, opj_tcp_t *tcp);
 /**
-Decode the code-blocks of a tile
-@param t1 T1 handle
-@param tile The tile to decode
-@param tcp Tile coding parameters
+Decode the code-blocks of a tile-component, and dequantize them into tilec->data.
+The code-blocks are decoded in parallel on up to numt1 threads, each with its own T1 handle.
+@param t1 Array of numt1 T1 handles
+@param numt1 Number of T1 handles, and so of threads
+@param tilec The tile-component to decode
+@param tccp Tile-component coding parameters
+@param numres Number of resolutions to decode; the code-blocks of the higher ones are discarded
 */
-void t1_decode_cblks(opj_t1_t* t1, opj_tcd_tilecomp_t* tilec, opj_tccp_t* tccp);
+void t1_decode_cblks(opj_t1_t** t1, int numt1, opj_tcd_tilecomp_t* tilec, opj_tccp_t* tccp, int numres);
 /* ----------------------------------------------------------------------- */
 /*@}*/
 
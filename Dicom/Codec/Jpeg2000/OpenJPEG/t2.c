@@ -78,6 +78,14 @@ Decode a packet of a tile from a source buffer
 */
 static int t2_decode_packet(opj_t2_t* t2, unsigned char *src, int len, opj_tcd_tile_t *tile, 
 														opj_tcp_t *tcp, opj_pi_iterator_t *pi, opj_packet_info_t *pack_info);
+/**
+Tell whether no code-block of a packet is decoded, because of its resolution, its layer or the decoded window
+@param cp Coding parameters
+@param tile Tile for which the packet is decoded
+@param pi Packet identity
+@return Returns true if the whole packet can be stepped over
+*/
+static bool t2_packet_unused(opj_cp_t *cp, opj_tcd_tile_t *tile, opj_pi_iterator_t *pi);
 
 /*@}*/
 
@@ -177,6 +185,10 @@ static int t2_encode_packet(opj_tcd_tile_t * tile, opj_tcp_t * tcp, opj_pi_itera
 	for (bandno = 0; bandno < res->numbands; bandno++) {
 		opj_tcd_band_t *band = &res->bands[bandno];
 		opj_tcd_precinct_t *prc = &band->precincts[precno];
+
+		/* an empty band of a small edge tile holds no code-blocks for the decoder */
+		if ((band->x1-band->x0 == 0)||(band->y1-band->y0 == 0)) continue;
+
 		for (cblkno = 0; cblkno < prc->cw * prc->ch; cblkno++) {
 			opj_tcd_cblk_enc_t* cblk = &prc->cblks.enc[cblkno];
 			opj_tcd_layer_t *layer = &cblk->layers[layno];
@@ -268,6 +280,7 @@ static int t2_encode_packet(opj_tcd_tile_t * tile, opj_tcp_t * tcp, opj_pi_itera
 	for (bandno = 0; bandno < res->numbands; bandno++) {
 		opj_tcd_band_t *band = &res->bands[bandno];
 		opj_tcd_precinct_t *prc = &band->precincts[precno];
+		if ((band->x1-band->x0 == 0)||(band->y1-band->y0 == 0)) continue;
 		for (cblkno = 0; cblkno < prc->cw * prc->ch; cblkno++) {
 			opj_tcd_cblk_enc_t* cblk = &prc->cblks.enc[cblkno];
 			opj_tcd_layer_t *layer = &cblk->layers[layno];
@@ -303,6 +316,7 @@ static void t2_init_seg(opj_tcd_cblk_dec_t* cblk, int index, int cblksty, int fi
 	seg->data = NULL;
 	seg->dataindex = 0;
 	seg->numpasses = 0;
+	seg->realnumpasses = 0;
 	seg->len = 0;
 	if (cblksty & J2K_CCP_CBLKSTY_TERMALL) {
 		seg->maxpasses = 1;
@@ -332,6 +346,13 @@ static int t2_decode_packet(opj_t2_t* t2, unsigned char *src, int len, opj_tcd_t
 
 	opj_tcd_resolution_t* res = &tile->comps[compno].resolutions[resno];
 
+	/* the code-blocks of a resolution discarded by cp->reduce are never decoded, */
+	/* nor are the passes of a layer beyond cp->layer or the code-blocks outside */
+	/* the decoded window, so their data is stepped over rather than copied; the */
+	/* header is still read to keep the tag trees and segment state in step */
+	int skip = resno >= tile->comps[compno].numresolutions - cp->reduce
+		|| (cp->layer && layno >= cp->layer);
+
 	unsigned char *hd = NULL;
 	int present;
 	
@@ -567,15 +588,18 @@ static int t2_decode_packet(opj_t2_t* t2, unsigned char *src, int len, opj_tcd_t
 
 #endif /* USE_JPWL */
 				
-				cblk->data = (unsigned char*) opj_realloc(cblk->data, (cblk->len + seg->newlen) * sizeof(unsigned char*));
-				memcpy(cblk->data + cblk->len, c, seg->newlen);
-				if (seg->numpasses == 0) {
-					seg->data = &cblk->data;
-					seg->dataindex = cblk->len;
+				if (!skip && cblk->in_window) {
+					cblk->data = (unsigned char*) opj_realloc(cblk->data, (cblk->len + seg->newlen) * sizeof(unsigned char*));
+					memcpy(cblk->data + cblk->len, c, seg->newlen);
+					if (seg->numpasses == 0) {
+						seg->data = &cblk->data;
+						seg->dataindex = cblk->len;
+					}
+					cblk->len += seg->newlen;
+					seg->len += seg->newlen;
+					seg->realnumpasses = seg->numpasses + seg->numnewpasses;
 				}
 				c += seg->newlen;
-				cblk->len += seg->newlen;
-				seg->len += seg->newlen;
 				seg->numpasses += seg->numnewpasses;
 				cblk->numnewpasses -= seg->numnewpasses;
 				if (cblk->numnewpasses > 0) {
@@ -589,6 +613,25 @@ static int t2_decode_packet(opj_t2_t* t2, unsigned char *src, int len, opj_tcd_t
 	return (c - src);
 }
 
+static bool t2_packet_unused(opj_cp_t *cp, opj_tcd_tile_t *tile, opj_pi_iterator_t *pi) {
+	int bandno, cblkno;
+	opj_tcd_resolution_t *res = &tile->comps[pi->compno].resolutions[pi->resno];
+
+	if (pi->resno >= tile->comps[pi->compno].numresolutions - cp->reduce
+		|| (cp->layer && pi->layno >= cp->layer)) {
+		return true;
+	}
+	for (bandno = 0; bandno < res->numbands; bandno++) {
+		opj_tcd_precinct_t *prc = &res->bands[bandno].precincts[pi->precno];
+		for (cblkno = 0; cblkno < prc->cw * prc->ch; cblkno++) {
+			if (prc->cblks.dec[cblkno].in_window) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 /* ----------------------------------------------------------------------- */
 
 int t2_encode_packets(opj_t2_t* t2,int tileno, opj_tcd_tile_t *tile, int maxlayers, unsigned char *dest, int len, opj_codestream_info_t *cstr_info,int tpnum, int tppos,int pino, J2K_T2_MODE t2_mode, int cur_totnum_tp){
@@ -667,6 +710,14 @@ int t2_encode_packets(opj_t2_t* t2,int tileno, opj_tcd_tile_t *tile, int maxlaye
 					cstr_info->packno++;
 				}
 				/* << INDEX */
+				if (cp->plt_on) {
+					/* kept for the PLT markers of the tile-part */
+					if (tile->packno == tile->maxpackets) {
+						tile->maxpackets = tile->maxpackets ? 2 * tile->maxpackets : 64;
+						tile->packet_len = (int*) opj_realloc(tile->packet_len, tile->maxpackets * sizeof(int));
+					}
+					tile->packet_len[tile->packno] = e;
+				}
 				tile->packno++;
 			}
 		}
@@ -690,6 +741,12 @@ int t2_decode_packets(opj_t2_t *t2, unsigned char *src, int len, int tileno, opj
 
 	opj_image_t *image = t2->image;
 	opj_cp_t *cp = t2->cp;
+	opj_tcp_t *tcp = &cp->tcps[tileno];
+
+	/* with the length of every packet from the PLT markers, a packet none of whose */
+	/* code-blocks is decoded is stepped over without reading its header; packed */
+	/* headers and the index need every header read */
+	bool use_plt = tcp->plt_num > 0 && !cp->ppm && !tcp->ppt && !cstr_info;
 	
 	/* create a packet iterator */
 	pi = pi_create_decode(image, cp, tileno);
@@ -702,22 +759,38 @@ int t2_decode_packets(opj_t2_t *t2, unsigned char *src, int len, int tileno, opj
 	
 	for (pino = 0; pino <= cp->tcps[tileno].numpocs; pino++) {
 		while (pi_next(&pi[pino])) {
-			if ((cp->layer==0) || (cp->layer>=((pi[pino].layno)+1))) {
-				opj_packet_info_t *pack_info;
-				if (cstr_info)
-					pack_info = &cstr_info->tile[tileno].packet[cstr_info->packno];
-				else
-					pack_info = NULL;
-				e = t2_decode_packet(t2, c, src + len - c, tile, &cp->tcps[tileno], &pi[pino], pack_info);
-			} else {
-				e = 0;
+			opj_packet_info_t *pack_info;
+			/* in layer order, the packets left in the last progression are all */
+			/* beyond cp->layer and need not even be parsed, unless their headers */
+			/* sit in a PPM marker shared with the next tiles */
+			if (cp->layer && pi[pino].layno >= cp->layer && pi[pino].poc.prg == LRCP
+				&& pino == cp->tcps[tileno].numpocs && !cp->ppm && !cstr_info) {
+				break;
+			}
+			if (use_plt && (n >= tcp->plt_num || tcp->plt_len[n] > src + len - c)) {
+				opj_event_msg(t2->cinfo, EVT_WARNING, "PLT markers do not match the packets of tile %d\n", tileno);
+				use_plt = false;
+			}
+			if (use_plt && t2_packet_unused(cp, tile, &pi[pino])) {
+				c += tcp->plt_len[n];
+				n++;
+				continue;
+			}
+			if (cstr_info)
+				pack_info = &cstr_info->tile[tileno].packet[cstr_info->packno];
+			else
+				pack_info = NULL;
+			e = t2_decode_packet(t2, c, src + len - c, tile, &cp->tcps[tileno], &pi[pino], pack_info);
+			if (use_plt && e != -999 && e != tcp->plt_len[n]) {
+				opj_event_msg(t2->cinfo, EVT_WARNING, "PLT markers do not match the packets of tile %d\n", tileno);
+				use_plt = false;
 			}
 			
 			/* progression in resolution */
-			image->comps[pi[pino].compno].resno_decoded =	
+			tile->comps[pi[pino].compno].resno_decoded =	
 				(e > 0) ? 
-				int_max(pi[pino].resno, image->comps[pi[pino].compno].resno_decoded) 
-				: image->comps[pi[pino].compno].resno_decoded;
+				int_max(pi[pino].resno, tile->comps[pi[pino].compno].resno_decoded) 
+				: tile->comps[pi[pino].compno].resno_decoded;
 			n++;
 
 			/* INDEX >> */
@@ -132,6 +132,8 @@ void tcd_malloc_encode(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp, int c
 	tcd->tcd_image->tw = cp->tw;
 	tcd->tcd_image->th = cp->th;
 	tcd->tcd_image->tiles = (opj_tcd_tile_t *) opj_malloc(sizeof(opj_tcd_tile_t));
+	tcd->tcd_image->tiles->packet_len = NULL;
+	tcd->tcd_image->tiles->maxpackets = 0;
 	
 	for (tileno = 0; tileno < 1; tileno++) {
 		opj_tcp_t *tcp = &cp->tcps[curtileno];
@@ -391,6 +393,8 @@ void tcd_free_encode(opj_tcd_t *tcd) {
 		} /* for (compno */
 		opj_free(tile->comps);
 		tile->comps = NULL;
+		opj_free(tile->packet_len);
+		tile->packet_len = NULL;
 	} /* for (tileno */
 	opj_free(tcd->tcd_image->tiles);
 	tcd->tcd_image->tiles = NULL;
@@ -560,6 +564,13 @@ void tcd_init_encode(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp, int cur
 						prc->x1 = int_min(cbgxend, band->x1);
 						prc->y1 = int_min(cbgyend, band->y1);
 
+						/* free the code-blocks of the previous tile */
+						for (cblkno = 0; cblkno < prc->cw * prc->ch; cblkno++) {
+							opj_free(prc->cblks.enc[cblkno].data - 2);
+							opj_free(prc->cblks.enc[cblkno].layers);
+							opj_free(prc->cblks.enc[cblkno].passes);
+						}
+
 						tlcblkxstart = int_floordivpow2(prc->x0, cblkwidthexpn) << cblkwidthexpn;
 						tlcblkystart = int_floordivpow2(prc->y0, cblkheightexpn) << cblkheightexpn;
 						brcblkxend = int_ceildivpow2(prc->x1, cblkwidthexpn) << cblkwidthexpn;
@@ -613,6 +624,8 @@ void tcd_malloc_decode(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp) {
 	unsigned int x0 = 0, y0 = 0, x1 = 0, y1 = 0, w, h;
 
 	tcd->image = image;
+	tcd->cp = cp;
+	tcd->num_threads = cp->num_threads;
 	tcd->tcd_image->tw = cp->tw;
 	tcd->tcd_image->th = cp->th;
 	tcd->tcd_image->tiles = (opj_tcd_tile_t *) opj_malloc(cp->tw * cp->th * sizeof(opj_tcd_tile_t));
@@ -626,12 +639,13 @@ void tcd_malloc_decode(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp) {
 		opj_tcd_tile_t *tile;
 		
 		tileno = cp->tileno[j];		
-		tile = &(tcd->tcd_image->tiles[cp->tileno[tileno]]);		
+		tile = &(tcd->tcd_image->tiles[tileno]);		
 		tile->numcomps = image->numcomps;
 		tile->comps = (opj_tcd_tilecomp_t*) opj_calloc(image->numcomps, sizeof(opj_tcd_tilecomp_t));
 	}
 
 	for (i = 0; i < image->numcomps; i++) {
+		int numres = 0;
 		for (j = 0; j < cp->tileno_size; j++) {
 			opj_tcd_tile_t *tile;
 			opj_tcd_tilecomp_t *tilec;
@@ -640,7 +654,7 @@ void tcd_malloc_decode(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp) {
 			
 			tileno = cp->tileno[j];
 			
-			tile = &(tcd->tcd_image->tiles[cp->tileno[tileno]]);
+			tile = &(tcd->tcd_image->tiles[tileno]);
 			tilec = &tile->comps[i];
 			
 			p = tileno % cp->tw;	/* si numerotation matricielle .. */
@@ -658,18 +672,33 @@ void tcd_malloc_decode(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp) {
 			tilec->y1 = int_ceildiv(tile->y1, image->comps[i].dy);
 
 			x0 = j == 0 ? tilec->x0 : int_min(x0, (unsigned int) tilec->x0);
-			y0 = j == 0 ? tilec->y0 : int_min(y0,	(unsigned int) tilec->x0);
+			y0 = j == 0 ? tilec->y0 : int_min(y0,	(unsigned int) tilec->y0);
 			x1 = j == 0 ? tilec->x1 : int_max(x1,	(unsigned int) tilec->x1);
 			y1 = j == 0 ? tilec->y1 : int_max(y1,	(unsigned int) tilec->y1);
+			numres = j == 0 ? cp->tcps[tileno].tccps[i].numresolutions : int_min(numres, cp->tcps[tileno].tccps[i].numresolutions);
 		}
 
-		w = int_ceildivpow2(x1 - x0, image->comps[i].factor);
-		h = int_ceildivpow2(y1 - y0, image->comps[i].factor);
+		/* only the decoded window is kept */
+		x0 = int_max(x0, int_ceildiv(cp->da_x0, image->comps[i].dx));
+		y0 = int_max(y0, int_ceildiv(cp->da_y0, image->comps[i].dy));
+		x1 = int_min(x1, int_ceildiv(cp->da_x1, image->comps[i].dx));
+		y1 = int_min(y1, int_ceildiv(cp->da_y1, image->comps[i].dy));
+
+		/* the reduced component spans the samples of the reduced tile-components, */
+		/* whose borders are rounded up from those of the full ones */
+		w = int_ceildivpow2(x1, image->comps[i].factor) - int_ceildivpow2(x0, image->comps[i].factor);
+		h = int_ceildivpow2(y1, image->comps[i].factor) - int_ceildivpow2(y0, image->comps[i].factor);
 
 		image->comps[i].w = w;
 		image->comps[i].h = h;
 		image->comps[i].x0 = x0;
 		image->comps[i].y0 = y0;
+		image->comps[i].resno_decoded = numres - 1 - image->comps[i].factor;
+
+		/* allocated up front, as the tiles may be decoded concurrently */
+		if (!image->comps[i].data) {
+			image->comps[i].data = (int*) opj_malloc(w * h * sizeof(int));
+		}
 	}
 }
 
@@ -688,6 +717,7 @@ void tcd_malloc_decode_tile(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp,
 	for (compno = 0; compno < tile->numcomps; compno++) {
 		opj_tccp_t *tccp = &tcp->tccps[compno];
 		opj_tcd_tilecomp_t *tilec = &tile->comps[compno];
+		int wx0, wy0, wx1, wy1, margin;
 		
 		/* border of each tile component (global) */
 		tilec->x0 = int_ceildiv(tile->x0, image->comps[compno].dx);
@@ -695,8 +725,18 @@ void tcd_malloc_decode_tile(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp,
 		tilec->x1 = int_ceildiv(tile->x1, image->comps[compno].dx);
 		tilec->y1 = int_ceildiv(tile->y1, image->comps[compno].dy);
 
+		/* decoded window (global), and how many coefficients of a band on either side of */
+		/* it still reach it through the synthesis filters of all the levels */
+		wx0 = int_ceildiv(cp->da_x0, image->comps[compno].dx);
+		wy0 = int_ceildiv(cp->da_y0, image->comps[compno].dy);
+		wx1 = int_ceildiv(cp->da_x1, image->comps[compno].dx);
+		wy1 = int_ceildiv(cp->da_y1, image->comps[compno].dy);
+		margin = tccp->qmfbid == 1 ? 2 : 4;
+
 		tilec->numresolutions = tccp->numresolutions;
 		tilec->resolutions = (opj_tcd_resolution_t *) opj_malloc(tilec->numresolutions * sizeof(opj_tcd_resolution_t));
+		/* edge tiles may carry no packets for their top resolutions */
+		tilec->resno_decoded = tilec->numresolutions - 1 - cp->reduce;
 		
 		for (resno = 0; resno < tilec->numresolutions; resno++) {
 			int pdx, pdy;
@@ -755,6 +795,7 @@ void tcd_malloc_decode_tile(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp,
 			for (bandno = 0; bandno < res->numbands; bandno++) {
 				int x0b, y0b;
 				int gain, numbps;
+				int bwx0, bwy0, bwx1, bwy1;
 				opj_stepsize_t *ss = NULL;
 				
 				opj_tcd_band_t *band = &res->bands[bandno];
@@ -768,13 +809,27 @@ void tcd_malloc_decode_tile(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp,
 					band->y0 = int_ceildivpow2(tilec->y0, levelno);
 					band->x1 = int_ceildivpow2(tilec->x1, levelno);
 					band->y1 = int_ceildivpow2(tilec->y1, levelno);
+					/* decoded window in the band */
+					bwx0 = int_ceildivpow2(wx0, levelno);
+					bwy0 = int_ceildivpow2(wy0, levelno);
+					bwx1 = int_ceildivpow2(wx1, levelno);
+					bwy1 = int_ceildivpow2(wy1, levelno);
 				} else {
 					/* band border (global) */
 					band->x0 = int_ceildivpow2(tilec->x0 - (1 << levelno) * x0b, levelno + 1);
 					band->y0 = int_ceildivpow2(tilec->y0 - (1 << levelno) * y0b, levelno + 1);
 					band->x1 = int_ceildivpow2(tilec->x1 - (1 << levelno) * x0b, levelno + 1);
 					band->y1 = int_ceildivpow2(tilec->y1 - (1 << levelno) * y0b, levelno + 1);
+					/* decoded window in the band */
+					bwx0 = int_ceildivpow2(wx0 - (1 << levelno) * x0b, levelno + 1);
+					bwy0 = int_ceildivpow2(wy0 - (1 << levelno) * y0b, levelno + 1);
+					bwx1 = int_ceildivpow2(wx1 - (1 << levelno) * x0b, levelno + 1);
+					bwy1 = int_ceildivpow2(wy1 - (1 << levelno) * y0b, levelno + 1);
 				}
+				bwx0 -= margin;
+				bwy0 -= margin;
+				bwx1 += margin;
+				bwy1 += margin;
 				
 				ss = &tccp->stepsizes[resno == 0 ? 0 : 3 * (resno - 1) + bandno + 1];
 				gain = tccp->qmfbid == 0 ? dwt_getgain_real(band->bandno) : dwt_getgain(band->bandno);
@@ -825,6 +880,7 @@ void tcd_malloc_decode_tile(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp,
 						cblk->x1 = int_min(cblkxend, prc->x1);
 						cblk->y1 = int_min(cblkyend, prc->y1);
 						cblk->numsegs = 0;
+						cblk->in_window = cblk->x0 < bwx1 && cblk->x1 > bwx0 && cblk->y0 < bwy1 && cblk->y1 > bwy0;
 					}
 				} /* precno */
 			} /* bandno */
@@ -1177,8 +1233,9 @@ int tcd_encode_tile(opj_tcd_t *tcd, int tileno, unsigned char *dest, int len, op
 	opj_tccp_t *tccp = &tcp->tccps[0];
 	opj_image_t *image = tcd->image;
 	
-	opj_t1_t *t1 = NULL;		/* T1 component */
+	opj_t1_t **t1 = NULL;		/* T1 components, one per thread */
 	opj_t2_t *t2 = NULL;		/* T2 component */
+	int numt1;
 
 	tcd->tcd_tileno = tileno;
 	tcd->tcd_tile = tcd->tcd_image->tiles;
@@ -1269,9 +1326,16 @@ int tcd_encode_tile(opj_tcd_t *tcd, int tileno, unsigned char *dest, int len, op
 		}
 		
 		/*------------------TIER1-----------------*/
-		t1 = t1_create(tcd->cinfo);
-		t1_encode_cblks(t1, tile, tcd_tcp);
-		t1_destroy(t1);
+		numt1 = cp->num_threads > 1 ? cp->num_threads : 1;
+		t1 = (opj_t1_t**) opj_malloc(numt1 * sizeof(opj_t1_t*));
+		for (i = 0; i < numt1; i++) {
+			t1[i] = t1_create(tcd->cinfo);
+		}
+		t1_encode_cblks(t1, numt1, tile, tcd_tcp);
+		for (i = 0; i < numt1; i++) {
+			t1_destroy(t1[i]);
+		}
+		opj_free(t1);
 		
 		/*-----------RATE-ALLOCATE------------------*/
 		
@@ -1322,7 +1386,9 @@ bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno, op
 	double tile_time, t1_time, dwt_time;
 	opj_tcd_tile_t *tile = NULL;
 
-	opj_t1_t *t1 = NULL;		/* T1 component */
+	opj_t1_t **t1 = NULL;		/* T1 components, one per thread */
+	int numt1;
+	int i;
 	opj_t2_t *t2 = NULL;		/* T2 component */
 	
 	tcd->tcd_tileno = tileno;
@@ -1374,14 +1440,21 @@ bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno, op
 	/*------------------TIER1-----------------*/
 	
 	t1_time = opj_clock();	/* time needed to decode a tile */
-	t1 = t1_create(tcd->cinfo);
+	numt1 = tcd->num_threads > 1 ? tcd->num_threads : 1;
+	t1 = (opj_t1_t**) opj_malloc(numt1 * sizeof(opj_t1_t*));
+	for (i = 0; i < numt1; i++) {
+		t1[i] = t1_create(tcd->cinfo);
+	}
 	for (compno = 0; compno < tile->numcomps; ++compno) {
 		opj_tcd_tilecomp_t* tilec = &tile->comps[compno];
 		/* The +3 is headroom required by the vectorized DWT */
 		tilec->data = (int*) opj_aligned_malloc((((tilec->x1 - tilec->x0) * (tilec->y1 - tilec->y0))+3) * sizeof(int));
-		t1_decode_cblks(t1, tilec, &tcd->tcp->tccps[compno]);
+		t1_decode_cblks(t1, numt1, tilec, &tcd->tcp->tccps[compno], tilec->numresolutions - tcd->cp->reduce);
 	}
-	t1_destroy(t1);
+	for (i = 0; i < numt1; i++) {
+		t1_destroy(t1[i]);
+	}
+	opj_free(t1);
 	t1_time = opj_clock() - t1_time;
 	opj_event_msg(tcd->cinfo, EVT_INFO, "- tiers-1 took %f s\n", t1_time);
 	
@@ -1393,16 +1466,15 @@ bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno, op
 		int numres2decode;
 
 		if (tcd->cp->reduce != 0) {
-			tcd->image->comps[compno].resno_decoded =
-				tile->comps[compno].numresolutions - tcd->cp->reduce - 1;
-			if (tcd->image->comps[compno].resno_decoded < 0) {				
+			tilec->resno_decoded = tilec->numresolutions - tcd->cp->reduce - 1;
+			if (tilec->resno_decoded < 0) {				
 				opj_event_msg(tcd->cinfo, EVT_ERROR, "Error decoding tile. The number of resolutions to remove [%d+1] is higher than the number "
 					" of resolutions in the original codestream [%d]\nModify the cp_reduce parameter.\n", tcd->cp->reduce, tile->comps[compno].numresolutions);
 				return false;
 			}
 		}
 
-		numres2decode = tcd->image->comps[compno].resno_decoded + 1;
+		numres2decode = tilec->resno_decoded + 1;
 		if(numres2decode > 0){
 			if (tcd->tcp->tccps[compno].qmfbid == 1) {
 				dwt_decode(tilec, numres2decode);
@@ -1417,19 +1489,25 @@ bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno, op
 	/*----------------MCT-------------------*/
 
 	if (tcd->tcp->mct) {
-		int n = (tile->comps[0].x1 - tile->comps[0].x0) * (tile->comps[0].y1 - tile->comps[0].y0);
-		if (tcd->tcp->tccps[0].qmfbid == 1) {
-			mct_decode(
-					tile->comps[0].data,
-					tile->comps[1].data,
-					tile->comps[2].data, 
-					n);
-		} else {
-			mct_decode_real(
-					(float*)tile->comps[0].data,
-					(float*)tile->comps[1].data,
-					(float*)tile->comps[2].data, 
-					n);
+		/* only the decoded resolution holds coefficients, at the top left of each tile-component */
+		opj_tcd_resolution_t* res = &tile->comps[0].resolutions[tile->comps[0].resno_decoded];
+		int tw = tile->comps[0].x1 - tile->comps[0].x0;
+		int n = res->x1 - res->x0;
+		int j;
+		for (j = 0; j < res->y1 - res->y0; ++j) {
+			if (tcd->tcp->tccps[0].qmfbid == 1) {
+				mct_decode(
+						&tile->comps[0].data[j * tw],
+						&tile->comps[1].data[j * tw],
+						&tile->comps[2].data[j * tw], 
+						n);
+			} else {
+				mct_decode_real(
+						&((float*)tile->comps[0].data)[j * tw],
+						&((float*)tile->comps[1].data)[j * tw],
+						&((float*)tile->comps[2].data)[j * tw], 
+						n);
+			}
 		}
 	}
 
@@ -1438,7 +1516,7 @@ bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno, op
 	for (compno = 0; compno < tile->numcomps; ++compno) {
 		opj_tcd_tilecomp_t* tilec = &tile->comps[compno];
 		opj_image_comp_t* imagec = &tcd->image->comps[compno];
-		opj_tcd_resolution_t* res = &tilec->resolutions[imagec->resno_decoded];
+		opj_tcd_resolution_t* res = &tilec->resolutions[tilec->resno_decoded];
 		int adjust = imagec->sgnd ? 0 : 1 << (imagec->prec - 1);
 		int min = imagec->sgnd ? -(1 << (imagec->prec - 1)) : 0;
 		int max = imagec->sgnd ?  (1 << (imagec->prec - 1)) - 1 : (1 << imagec->prec) - 1;
@@ -1449,21 +1527,24 @@ bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno, op
 		int offset_x = int_ceildivpow2(imagec->x0, imagec->factor);
 		int offset_y = int_ceildivpow2(imagec->y0, imagec->factor);
 
+		/* the part of the tile inside the decoded window */
+		int x0 = int_max(res->x0, offset_x);
+		int y0 = int_max(res->y0, offset_y);
+		int x1 = int_min(res->x1, offset_x + w);
+		int y1 = int_min(res->y1, offset_y + imagec->h);
+
 		int i, j;
-		if(!imagec->data){
-			imagec->data = (int*) opj_malloc(imagec->w * imagec->h * sizeof(int));
-		}
 		if(tcd->tcp->tccps[compno].qmfbid == 1) {
-			for(j = res->y0; j < res->y1; ++j) {
-				for(i = res->x0; i < res->x1; ++i) {
+			for(j = y0; j < y1; ++j) {
+				for(i = x0; i < x1; ++i) {
 					int v = tilec->data[i - res->x0 + (j - res->y0) * tw];
 					v += adjust;
 					imagec->data[(i - offset_x) + (j - offset_y) * w] = int_clamp(v, min, max);
 				}
 			}
 		}else{
-			for(j = res->y0; j < res->y1; ++j) {
-				for(i = res->x0; i < res->x1; ++i) {
+			for(j = y0; j < y1; ++j) {
+				for(i = x0; i < x1; ++i) {
 					float tmp = ((float*)tilec->data)[i - res->x0 + (j - res->y0) * tw];
 					int v = lrintf(tmp);
 					v += adjust;
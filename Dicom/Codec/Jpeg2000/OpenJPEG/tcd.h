@@ -51,6 +51,7 @@ typedef struct opj_tcd_seg {
   unsigned char** data;
   int dataindex;
   int numpasses;
+  int realnumpasses;	/* passes whose data was read; numpasses also counts those of skipped layers */
   int len;
   int maxpasses;
   int numnewpasses;
@@ -63,6 +64,7 @@ FIXME: documentation
 typedef struct opj_tcd_pass {
   int rate;
   double distortiondec;
+  double wmsedec;		/* distortion decrease of this pass alone */
   int term, len;
 } opj_tcd_pass_t;
 
@@ -100,6 +102,7 @@ typedef struct opj_tcd_cblk_dec {
   int len;			/* length */
   int numnewpasses;		/* number of pass added to the code-blocks */
   int numsegs;			/* number of segments */
+  int in_window;		/* whether the wavelet support of the code-block meets the decoded window */
 } opj_tcd_cblk_dec_t;
 
 /**
@@ -146,6 +149,7 @@ typedef struct opj_tcd_tilecomp {
   opj_tcd_resolution_t *resolutions;	/* resolutions information */
   int *data;			/* data of the component */
   int numpix;			/* add fixed_quality */
+  int resno_decoded;		/* highest resolution level decoded */
 } opj_tcd_tilecomp_t;
 
 /**
@@ -160,6 +164,10 @@ typedef struct opj_tcd_tile {
   double distolayer[100];	/* add fixed_quality */
   /** packet number */
   int packno;
+  /** length of each packet written, by packet number, when PLT markers are written */
+  int *packet_len;
+  /** number of packet lengths packet_len can hold */
+  int maxpackets;
 } opj_tcd_tile_t;
 
 /**
@@ -199,6 +207,8 @@ typedef struct opj_tcd {
 	opj_tcp_t *tcp;
 	/** current encoded/decoded tile */
 	int tcd_tileno;
+	/** maximum number of threads decoding the code-blocks of a tile */
+	int num_threads;
 	/** Time taken to encode a tile*/
 	double encoding_time;
 } opj_tcd_t;
@@ -244,12 +254,22 @@ Initialize the tile coder (reuses the memory allocated by tcd_malloc_encode)
 */
 void tcd_init_encode(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp, int curtileno);
 /**
-Initialize the tile decoder
+Initialize the tile decoder, and allocate the components of the decoded image
 @param tcd TCD handle
 @param image Raw image
 @param cp Coding parameters
 */
 void tcd_malloc_decode(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp);
+/**
+Allocate the structures decoding one tile.
+Several tiles may be allocated, decoded and freed concurrently, each with its own copy of the TCD handle
+initialized by tcd_malloc_decode.
+@param tcd TCD handle
+@param image Raw image
+@param cp Coding parameters
+@param tileno Index of the tile in cp->tileno
+@param cstr_info Codestream information structure
+*/
 void tcd_malloc_decode_tile(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp, int tileno, opj_codestream_info_t *cstr_info);
 void tcd_makelayer_fixed(opj_tcd_t *tcd, int layno, int final);
 void tcd_rateallocate_fixed(opj_tcd_t *tcd);
@@ -278,6 +298,11 @@ Free the memory allocated for decoding
 @param tcd TCD handle
 */
 void tcd_free_decode(opj_tcd_t *tcd);
+/**
+Free the structures decoding one tile
+@param tcd TCD handle
+@param tileno Number that identifies the tile
+*/
 void tcd_free_decode_tile(opj_tcd_t *tcd, int tileno);
 
 /* ----------------------------------------------------------------------- */
@@ -0,0 +1,176 @@
+#pragma region License (non-CC)
+/*
+ * Copyright (c) 2002-2007, Communications and Remote Sensing Laboratory, Universite catholique de Louvain (UCL), Belgium
+ * Copyright (c) 2002-2007, Professor Benoit Macq
+ * Copyright (c) 2003-2007, Francois-Olivier Devaux and Antonin Descampe
+ * Copyright (c) 2005, Herve Drolon, FreeImage Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#endif /* WIN32 */
+#include "opj_includes.h"
+
+/** @defgroup THREAD THREAD - Implementation of a simple job scheduler */
+/*@{*/
+
+/**
+A batch of jobs shared by the workers
+*/
+typedef struct opj_job_batch {
+	/** callback running one job */
+	opj_job_fn job;
+	/** data passed to the callback */
+	void *user_data;
+	/** number of jobs */
+	int num_jobs;
+	/** number of jobs taken so far */
+#ifdef WIN32
+	volatile LONG next_job;
+#else
+	volatile int next_job;
+#endif
+} opj_job_batch_t;
+
+/**
+A worker thread and the batch it takes its jobs from
+*/
+typedef struct opj_job_worker {
+	opj_job_batch_t *batch;
+	int workerno;
+#ifdef WIN32
+	HANDLE thread;
+#else
+	pthread_t thread;
+#endif
+	/** true if the thread was started, and must be joined */
+	int started;
+} opj_job_worker_t;
+
+/** @name Local static functions */
+/*@{*/
+
+/**
+Take the index of the next job of a batch, or return num_jobs if none is left
+*/
+static int opj_next_job(opj_job_batch_t *batch);
+/**
+Run jobs of a batch until none is left
+*/
+static void opj_work(opj_job_batch_t *batch, int workerno);
+
+/*@}*/
+
+/*@}*/
+
+/* ----------------------------------------------------------------------- */
+
+static int opj_next_job(opj_job_batch_t *batch) {
+	int jobno;
+#ifdef WIN32
+	jobno = (int)InterlockedIncrement(&batch->next_job) - 1;
+#else
+	jobno = __sync_fetch_and_add(&batch->next_job, 1);
+#endif
+	return jobno < batch->num_jobs ? jobno : batch->num_jobs;
+}
+
+static void opj_work(opj_job_batch_t *batch, int workerno) {
+	int jobno;
+	while ((jobno = opj_next_job(batch)) < batch->num_jobs) {
+		batch->job(batch->user_data, jobno, workerno);
+	}
+}
+
+#ifdef WIN32
+static unsigned __stdcall opj_worker_main(void *arg) {
+	opj_job_worker_t *worker = (opj_job_worker_t*)arg;
+	opj_work(worker->batch, worker->workerno);
+	return 0;
+}
+#else
+static void* opj_worker_main(void *arg) {
+	opj_job_worker_t *worker = (opj_job_worker_t*)arg;
+	opj_work(worker->batch, worker->workerno);
+	return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+void opj_run_jobs(int num_threads, int num_jobs, opj_job_fn job, void *user_data) {
+	opj_job_batch_t batch;
+	opj_job_worker_t *workers = NULL;
+	int i;
+
+	if (num_threads > num_jobs) {
+		num_threads = num_jobs;
+	}
+	if (num_threads > 1) {
+		workers = (opj_job_worker_t*)opj_calloc(num_threads - 1, sizeof(opj_job_worker_t));
+	}
+	if (!workers) {
+		for (i = 0; i < num_jobs; i++) {
+			job(user_data, i, 0);
+		}
+		return;
+	}
+
+	batch.job = job;
+	batch.user_data = user_data;
+	batch.num_jobs = num_jobs;
+	batch.next_job = 0;
+
+	for (i = 0; i < num_threads - 1; i++) {
+		opj_job_worker_t *worker = &workers[i];
+		worker->batch = &batch;
+		worker->workerno = i + 1;
+#ifdef WIN32
+		worker->thread = (HANDLE)_beginthreadex(NULL, 0, opj_worker_main, worker, 0, NULL);
+		worker->started = worker->thread != NULL;
+#else
+		worker->started = pthread_create(&worker->thread, NULL, opj_worker_main, worker) == 0;
+#endif
+	}
+
+	opj_work(&batch, 0);
+
+	for (i = 0; i < num_threads - 1; i++) {
+		opj_job_worker_t *worker = &workers[i];
+		if (!worker->started) {
+			continue;
+		}
+#ifdef WIN32
+		WaitForSingleObject(worker->thread, INFINITE);
+		CloseHandle(worker->thread);
+#else
+		pthread_join(worker->thread, NULL);
+#endif
+	}
+	opj_free(workers);
+}
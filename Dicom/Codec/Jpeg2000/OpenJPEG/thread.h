@@ -0,0 +1,73 @@
+#pragma region License (non-CC)
+/*
+ * Copyright (c) 2002-2007, Communications and Remote Sensing Laboratory, Universite catholique de Louvain (UCL), Belgium
+ * Copyright (c) 2002-2007, Professor Benoit Macq
+ * Copyright (c) 2003-2007, Francois-Olivier Devaux and Antonin Descampe
+ * Copyright (c) 2005, Herve Drolon, FreeImage Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __THREAD_H
+#define __THREAD_H
+/**
+@file thread.h
+@brief Implementation of a simple job scheduler (THREAD)
+
+The functions in THREAD.C run a batch of independent jobs, such as the code-blocks
+of a tile-component, on several threads.  The Tier-1 coder uses them to encode and decode
+code-blocks in parallel.
+*/
+
+/** @defgroup THREAD THREAD - Implementation of a simple job scheduler */
+/*@{*/
+
+/**
+Callback running one job of a batch
+@param user_data Data shared by all the jobs of the batch
+@param jobno Index of the job to run, in [0, num_jobs)
+@param workerno Index of the thread running the job, in [0, num_threads).
+Jobs run by the same worker never overlap, so the index can select per-thread scratch data.
+*/
+typedef void (*opj_job_fn)(void *user_data, int jobno, int workerno);
+
+/** @name Exported functions */
+/*@{*/
+/* ----------------------------------------------------------------------- */
+/**
+Run a batch of jobs on up to num_threads threads, and return when they have all completed.
+The calling thread is worker 0.  The other workers are started for the batch and take jobs
+from a shared counter, so that long and short jobs balance out.  If a worker cannot be started,
+its share of the jobs is run by the others.
+@param num_threads Maximum number of threads; the jobs run on the calling thread if <= 1
+@param num_jobs Number of jobs
+@param job Callback running one job
+@param user_data Data passed to every call of the callback
+*/
+void opj_run_jobs(int num_threads, int num_jobs, opj_job_fn job, void *user_data);
+/* ----------------------------------------------------------------------- */
+/*@}*/
+
+/*@}*/
+
+#endif /* __THREAD_H */